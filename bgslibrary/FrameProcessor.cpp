@@ -1,12 +1,32 @@
+#include <cerrno>
 #include <iomanip>
+#include <stdexcept>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
 
 #include "FrameProcessor.h"
 
 namespace bgslibrary
 {
+  namespace
+  {
+    // true when the directory exists afterwards (its parent must exist)
+    bool makeDirectory(const std::string &path)
+    {
+#ifdef _WIN32
+      const int result = _mkdir(path.c_str());
+#else
+      const int result = mkdir(path.c_str(), 0755);
+#endif
+      return result == 0 || errno == EEXIST;
+    }
+  }
+
   FrameProcessor::FrameProcessor() : 
     firstTime(true), frameNumber(0), duration(0), 
-    tictoc(""), frameToStop(0)
+    tictoc(""), frameToStop(0), headless(false), outputPath("./output")
   {
     debug_construction(FrameProcessor);
     initLoadSaveConfig(quote(FrameProcessor));
@@ -18,8 +38,18 @@ namespace bgslibrary
 
   void FrameProcessor::init()
   {
+    if (enableParallel)
+    {
+      threadPool = std::make_unique<ThreadPool>(numThreads > 0 ? numThreads : 0);
+      std::cout << "FrameProcessor: running in parallel with " << threadPool->size() << " threads" << std::endl;
+    }
+
     if (enablePreProcessor)
+    {
       preProcessor = std::make_unique<PreProcessor>();
+      if (headless)
+        preProcessor->setShowOutput(false);
+    }
 
     if (enableFrameDifference)
       frameDifference = std::make_shared<FrameDifference>();
@@ -160,26 +190,160 @@ namespace bgslibrary
     if (enableCodeBook)
       codeBook = std::make_shared<CodeBook>();
 
+    // the masks are written to <outputPath>/fg
+    if (headless && (!makeDirectory(outputPath) || !makeDirectory(outputPath + "/fg")))
+      throw std::runtime_error("Cannot create " + outputPath + "/fg");
+
     if (enableForegroundMaskAnalysis)
+    {
       foregroundMaskAnalysis = std::make_shared<tools::ForegroundMaskAnalysis>();
+      if (headless)
+        foregroundMaskAnalysis->setHeadless(outputPath + "/similarity.csv");
+    }
+
+    if (headless)
+    {
+      const std::string statsPath = outputPath + "/stats.csv";
+      statsFile.open(statsPath.c_str());
+      if (statsFile.is_open())
+        statsFile << "frame,algorithm,seconds" << std::endl;
+      else
+        std::cerr << "Cannot write " << statsPath << std::endl;
+    }
   }
   
   void FrameProcessor::process(const std::string name, const std::shared_ptr<IBGS> &bgs, const cv::Mat &img_input, cv::Mat &img_bgs)
   {
+    auto &output = outputs[name];
+
+    if (firstTime)
+    {
+      output.img_output = &img_bgs;
+      if (headless)
+        bgs->setShowOutput(false);
+
+      // highgui is not thread-safe, the masks are displayed by showOutputs() instead
+      if ((enableParallel || deferDisplay) && bgs->getShowOutput())
+      {
+        bgs->setShowOutput(false);
+        output.windowName = bgs->getAlgorithmName() + "_FG";
+      }
+    }
+
+    // the algorithms drawing from the shared rand() stay on this thread and
+    // in the serial order, so they consume the same sequence as without
+    // enableParallel (the tasks only start in runTasks())
+    if (!enableParallel || bgs->usesSharedRandom())
+    {
+      execute(name, bgs, img_input, img_bgs, output);
+      return;
+    }
+
+    // outputs is not modified while the tasks run, so each task owns its entry
+    AlgorithmOutput *output_ptr = &output;
+    tasks.push_back([this, name, bgs, &img_input, &img_bgs, output_ptr]() {
+      execute(name, bgs, img_input, img_bgs, *output_ptr);
+    });
+  }
+
+  void FrameProcessor::execute(const std::string &name, const std::shared_ptr<IBGS> &bgs, const cv::Mat &img_input, cv::Mat &img_bgs, AlgorithmOutput &output)
+  {
+    // only one algorithm matches tictoc, so tic/toc are never called concurrently
     if (tictoc == name)
       tic(name);
     
-    cv::Mat img_bkgmodel;
-    bgs->process(img_input, img_bgs, img_bkgmodel);
+    int64 start_time = cv::getTickCount();
+    bgs->processFrame(img_input, img_bgs, output.img_bkgmodel);
+    output.duration = (cv::getTickCount() - start_time) / cv::getTickFrequency();
     
     if (tictoc == name)
       toc();
   }
-  
+
+  void FrameProcessor::runTasks()
+  {
+    if (tasks.empty())
+      return;
+
+    std::vector<std::future<void>> results;
+    results.reserve(tasks.size());
+    for (auto &task : tasks)
+      results.push_back(threadPool->enqueue(task));
+
+    // wait for every algorithm before rethrowing, the tasks reference img_preProcessor
+    for (auto &result : results)
+      result.wait();
+    tasks.clear();
+    for (auto &result : results)
+      result.get();
+  }
+
+  void FrameProcessor::showOutputs()
+  {
+    if (deferDisplay)
+      windows.clear();
+
+    if (showPreProcessor)
+      show("PreProcessor", img_preProcessor);
+
+    for (const auto &output : outputs)
+      if (!output.second.windowName.empty() && !output.second.img_output->empty())
+        show(output.second.windowName, *output.second.img_output);
+  }
+
+  void FrameProcessor::show(const std::string &windowName, const cv::Mat &img)
+  {
+    // the buffers are overwritten by the next frame while the caller shows them
+    if (deferDisplay)
+      windows.push_back(std::make_pair(windowName, img.clone()));
+    else
+      cv::imshow(windowName, img);
+  }
+
+  void FrameProcessor::setDeferDisplay(bool _deferDisplay)
+  {
+    deferDisplay = _deferDisplay;
+  }
+
+  void FrameProcessor::takeWindows(Windows &_windows)
+  {
+    _windows.swap(windows);
+    windows.clear();
+  }
+
+  void FrameProcessor::saveResults()
+  {
+    for (const auto &output : outputs)
+    {
+      const cv::Mat &img_output = *output.second.img_output;
+      if (!img_output.empty())
+      {
+        const std::string maskPath = outputPath + "/fg/" + output.first + "_" + std::to_string(frameNumber) + ".png";
+        if (!cv::imwrite(maskPath, img_output))
+          throw std::runtime_error("Cannot write " + maskPath);
+      }
+
+      if (statsFile.is_open())
+        statsFile << frameNumber << "," << output.first << "," << std::fixed << std::setprecision(6) << output.second.duration << "\n";
+    }
+  }
+
   void FrameProcessor::process(const cv::Mat &img_input)
   {
     frameNumber++;
 
+    // highgui is left to the caller, see IFrameProcessor::setDeferDisplay
+    if (firstTime && deferDisplay)
+    {
+      if (enablePreProcessor && preProcessor->getShowOutput())
+      {
+        preProcessor->setShowOutput(false);
+        showPreProcessor = true;
+      }
+      if (enableForegroundMaskAnalysis)
+        foregroundMaskAnalysis->setShowOutput(false);
+    }
+
     if (enablePreProcessor)
       preProcessor->process(img_input, img_preProcessor);
     else
@@ -328,6 +492,11 @@ namespace bgslibrary
     if (enableCodeBook)
       process("CodeBook", codeBook, img_preProcessor, img_codeBook);
 
+    if (enableParallel)
+      runTasks();
+
+    showOutputs();
+
     if (enableForegroundMaskAnalysis)
     {
       foregroundMaskAnalysis->stopAt = frameToStop;
@@ -394,10 +563,22 @@ namespace bgslibrary
       foregroundMaskAnalysis->process(frameNumber, "CodeBook", img_codeBook);
     }
 
+    if (headless)
+      saveResults();
+
     firstTime = false;
   }
 
-  void FrameProcessor::finish(void){}
+  void FrameProcessor::finish(void)
+  {
+    if (statsFile.is_open())
+      statsFile.close();
+
+    if (headless) {
+      StatsRegistry::Instance()->dumpJSON(outputPath + "/algorithm_stats.json");
+      StatsRegistry::Instance()->dumpCSV(outputPath + "/algorithm_stats.csv");
+    }
+  }
 
   void FrameProcessor::tic(std::string value)
   {
@@ -413,6 +594,8 @@ namespace bgslibrary
 
   void FrameProcessor::save_config(cv::FileStorage &fs) {
     fs << "tictoc" << tictoc;
+    fs << "enableParallel" << enableParallel;
+    fs << "numThreads" << numThreads;
     fs << "enablePreProcessor" << enablePreProcessor;
     fs << "enableForegroundMaskAnalysis" << enableForegroundMaskAnalysis;
     fs << "enableFrameDifference" << enableFrameDifference;
@@ -478,6 +661,8 @@ namespace bgslibrary
 
   void FrameProcessor::load_config(cv::FileStorage &fs) {
     fs["tictoc"] >> tictoc;
+    fs["enableParallel"] >> enableParallel;
+    fs["numThreads"] >> numThreads;
     fs["enablePreProcessor"] >> enablePreProcessor;
     fs["enableForegroundMaskAnalysis"] >> enableForegroundMaskAnalysis;
     fs["enableFrameDifference"] >> enableFrameDifference;
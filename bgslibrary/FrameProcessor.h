@@ -3,6 +3,7 @@
 
 #include "IFrameProcessor.h"
 #include "PreProcessor.h"
+#include "utils/ThreadPool.h"
 
 #include "algorithms/algorithms.h"
 #include "tools/ForegroundMaskAnalysis.h"
@@ -18,6 +19,24 @@ namespace bgslibrary
     double duration;
     std::string tictoc;
 
+    bool enableParallel = false;
+    int numThreads = 0;
+    std::unique_ptr<ThreadPool> threadPool;
+    std::vector<std::function<void()>> tasks;
+
+    struct AlgorithmOutput
+    {
+      const cv::Mat *img_output = nullptr;
+      std::string windowName; // shown by FrameProcessor instead of the algorithm
+      double duration = 0;    // seconds spent in the last call to process
+      cv::Mat img_bkgmodel;   // kept between frames to avoid reallocations
+    };
+    std::map<std::string, AlgorithmOutput> outputs;
+    bool deferDisplay = false;
+    bool showPreProcessor = false; // shown by FrameProcessor instead of the PreProcessor
+    Windows windows;
+    std::ofstream statsFile;
+
     cv::Mat img_preProcessor;
     std::unique_ptr<PreProcessor> preProcessor;
     bool enablePreProcessor = false;
@@ -213,13 +232,22 @@ namespace bgslibrary
 
     long frameToStop;
     std::string imgref;
+    bool headless;
+    std::string outputPath;
 
     void init();
     void process(const cv::Mat &img_input);
     void finish(void);
+    void setDeferDisplay(bool _deferDisplay);
+    void takeWindows(Windows &_windows);
 
   private:
     void process(const std::string name, const std::shared_ptr<IBGS> &bgs, const cv::Mat &img_input, cv::Mat &img_bgs);
+    void execute(const std::string &name, const std::shared_ptr<IBGS> &bgs, const cv::Mat &img_input, cv::Mat &img_bgs, AlgorithmOutput &output);
+    void runTasks();
+    void showOutputs();
+    void show(const std::string &windowName, const cv::Mat &img);
+    void saveResults();
     void tic(std::string value);
     void toc();
     
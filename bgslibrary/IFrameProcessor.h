@@ -1,5 +1,8 @@
 #pragma once
 
+#include <string>
+#include <utility>
+#include <vector>
 #include <opencv2/opencv.hpp>
 
 #include "utils/GenericMacros.h"
@@ -16,5 +19,15 @@ namespace bgslibrary
       //debug_destruction(IFrameProcessor);
     }
     virtual void process(const cv::Mat &input) = 0;
+
+    // (window name, image) pairs of the last processed frame.
+    typedef std::vector<std::pair<std::string, cv::Mat>> Windows;
+    // When the display is deferred, process() does not call highgui (which
+    // must stay on one thread) and keeps the images it would show instead,
+    // to be taken by takeWindows() and shown by the caller.
+    virtual void setDeferDisplay(bool _deferDisplay) {}
+    virtual void takeWindows(Windows &windows) {
+      windows.clear();
+    }
   };
 }
@@ -32,6 +32,9 @@ namespace bgslibrary
           {
             videoAnalysis->start();
 
+            if (videoAnalysis->isHeadless())
+              break;
+
             std::cout << "Processing finished, enter:" << std::endl;
             std::cout << "R - Repeat" << std::endl;
             std::cout << "Q - Quit" << std::endl;
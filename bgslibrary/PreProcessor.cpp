@@ -3,7 +3,7 @@
 namespace bgslibrary
 {
   PreProcessor::PreProcessor() : 
-    firstTime(true), equalizeHist(false), gaussianBlur(false)
+    firstTime(true), equalizeHist(false), gaussianBlur(false), enableShow(false)
   {
     debug_construction(PreProcessor);
     initLoadSaveConfig(quote(PreProcessor));
@@ -21,6 +21,14 @@ namespace bgslibrary
     gaussianBlur = value;
   }
 
+  void PreProcessor::setShowOutput(bool value) {
+    enableShow = value;
+  }
+
+  bool PreProcessor::getShowOutput() const {
+    return enableShow;
+  }
+
   cv::Mat PreProcessor::getGrayScale() {
     return img_gray.clone();
   }
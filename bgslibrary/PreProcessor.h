@@ -30,6 +30,8 @@ namespace bgslibrary
 
     void setEqualizeHist(bool value);
     void setGaussianBlur(bool value);
+    void setShowOutput(bool value);
+    bool getShowOutput() const;
     cv::Mat getGrayScale();
 
     void process(const cv::Mat &img_input, cv::Mat &img_output);
@@ -4,7 +4,8 @@ namespace bgslibrary
 {
   VideoAnalysis::VideoAnalysis() :
     use_file(false), use_camera(false), cameraIndex(0),
-    use_comp(false), frameToStop(0)
+    use_comp(false), frameToStop(0), headless(false),
+    outputPath("./output")
   {
     debug_construction(VideoAnalysis);
   }
@@ -27,6 +28,8 @@ namespace bgslibrary
       "{co|use_comp|false|Use mask comparator}"
       "{st|stopAt|0|Frame number to stop}"
       "{im|imgref||Specify image file}"
+      "{hl|headless|false|Run without GUI, save results to disk}"
+      "{od|output||Specify output directory}"
       ;
 #elif CV_MAJOR_VERSION >= 3
     const std::string keys =
@@ -38,6 +41,8 @@ namespace bgslibrary
       "{co use_comp  |false| Use mask comparator  }"
       "{st stopAt    | 0   | Frame number to stop }"
       "{im imgref    |     | Specify a image file }"
+      "{hl headless  |false| Run without GUI, save results to disk }"
+      "{od output    |     | Specify an output directory }"
       ;
 #endif
 
@@ -73,6 +78,9 @@ namespace bgslibrary
     use_comp = cmd.get<bool>("co"); //use_comp
     frameToStop = cmd.get<int>("st"); //stopAt
     imgref = cmd.get<std::string>("im"); //imgref
+    headless = cmd.get<bool>("hl"); //headless
+    if (!cmd.get<std::string>("od").empty())
+      outputPath = cmd.get<std::string>("od"); //output
 
     std::cout << "use_file:    " << use_file << std::endl;
     std::cout << "filename:    " << filename << std::endl;
@@ -81,6 +89,8 @@ namespace bgslibrary
     std::cout << "use_comp:    " << use_comp << std::endl;
     std::cout << "frameToStop: " << frameToStop << std::endl;
     std::cout << "imgref:      " << imgref << std::endl;
+    std::cout << "headless:    " << headless << std::endl;
+    std::cout << "output:      " << outputPath << std::endl;
     //return false;
 
     if (use_file) {
@@ -113,11 +123,14 @@ namespace bgslibrary
       videoCapture = std::make_unique<VideoCapture>();
       frameProcessor = std::make_shared<FrameProcessor>();
 
+      frameProcessor->headless = headless;
+      frameProcessor->outputPath = outputPath;
       frameProcessor->init();
       frameProcessor->frameToStop = frameToStop;
       frameProcessor->imgref = imgref;
 
       videoCapture->setFrameProcessor(frameProcessor);
+      videoCapture->setHeadless(headless);
 
       if (use_file)
         videoCapture->setVideo(filename);
@@ -127,15 +140,20 @@ namespace bgslibrary
 
       videoCapture->start();
 
+      frameProcessor->finish();
+
       if (use_file || use_camera)
         break;
 
-      frameProcessor->finish();
-
       auto key = cv::waitKey(500);
       if (key == KEY_ESC)
         break;
 
     } while (1);
   }
+
+  bool VideoAnalysis::isHeadless() const
+  {
+    return headless;
+  }
 }
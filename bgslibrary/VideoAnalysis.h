@@ -20,6 +20,8 @@ namespace bgslibrary
     bool use_comp;
     long frameToStop;
     std::string imgref;
+    bool headless;
+    std::string outputPath;
 
   public:
     VideoAnalysis();
@@ -27,5 +29,6 @@ namespace bgslibrary
 
     bool setup(int argc, const char **argv);
     void start();
+    bool isHeadless() const;
   };
 }
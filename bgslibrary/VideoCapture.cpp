@@ -110,6 +110,13 @@ namespace bgslibrary
     useCamera = false;
   }
 
+  void VideoCapture::setHeadless(bool _headless)
+  {
+    headless = _headless;
+    if (headless)
+      showOutput = false;
+  }
+
   void VideoCapture::setUpVideo()
   {
     std::cout << "Openning: " << videoFileName << std::endl;
@@ -121,6 +128,68 @@ namespace bgslibrary
       std::cout << "OK" << std::endl;
   }
 
+  void VideoCapture::prepareFrame(cv::Mat &img)
+  {
+    cv::resize(img, img, cv::Size(), input_resize_percent/100., input_resize_percent / 100.);
+
+    if (firstTime && input_resize_percent != 100)
+    {
+      std::cout << "Resized to:" << std::endl;
+      std::cout << "input->width:" << img.size().width << std::endl;
+      std::cout << "input->height:" << img.size().height << std::endl;
+    }
+    
+    //if (enableFlip)
+    //  cvFlip(img, img, 0);
+
+    if (VC_ROI::use_roi == true && VC_ROI::roi_defined == false && firstTime == true)
+    {
+      VC_ROI::reset();
+
+      do
+      {
+        cv::Mat img_input;
+        img.copyTo(img_input);
+
+        if (showOutput)
+        {
+          cv::imshow("Input", img_input);
+
+          std::cout << "Set ROI (press ESC to skip)" << std::endl;
+          //VC_ROI::img_input1 = new IplImage(img_input);
+          cvSetMouseCallback("Input", VC_ROI::VideoCapture_on_mouse, NULL);
+          key = cv::waitKey(0);
+          //delete VC_ROI::img_input1;
+        }
+        else
+          key = KEY_ESC;
+
+        if (key == KEY_ESC)
+        {
+          std::cout << "ROI disabled" << std::endl;
+          VC_ROI::reset();
+          VC_ROI::use_roi = false;
+          break;
+        }
+
+        if (VC_ROI::roi_defined)
+        {
+          std::cout << "ROI defined (" << VC_ROI::roi_x0 << "," << VC_ROI::roi_y0 << "," << VC_ROI::roi_x1 << "," << VC_ROI::roi_y1 << ")" << std::endl;
+          break;
+        }
+        else
+          std::cout << "ROI undefined" << std::endl;
+
+      } while (1);
+    }
+
+    if (VC_ROI::use_roi == true && VC_ROI::roi_defined == true)
+    {
+      cv::Rect roi(VC_ROI::roi_x0, VC_ROI::roi_y0, VC_ROI::roi_x1 - VC_ROI::roi_x0, VC_ROI::roi_y1 - VC_ROI::roi_y0);
+      img = img(roi);
+    }
+  }
+
   void VideoCapture::start()
   {
     if (useCamera) setUpCamera();
@@ -131,7 +200,13 @@ namespace bgslibrary
     do
     {
       capture >> frame;
-      if (frame.empty())
+      if (frame.empty() && headless)
+      {
+        std::cerr << "Frame is not ready" << std::endl;
+        capture.release();
+        return;
+      }
+      else if (frame.empty())
       {
         std::cout << "Frame is not ready" << std::endl;
         std::string dummy;
@@ -151,74 +226,44 @@ namespace bgslibrary
 
     if (input_fps > 0)
       loopDelay = (1. / input_fps)*1000.;
-    std::cout << "loopDelay:" << loopDelay << std::endl;
+    if (!headless)
+      std::cout << "loopDelay:" << loopDelay << std::endl;
+
+    if (headless)
+      std::cout << "Running headless, processing as fast as possible..." << std::endl;
+    else
+      std::cout << "Press 'ESC' to stop..." << std::endl;
+    int64 run_start_time = cv::getTickCount();
+
+    if (enablePipeline)
+      startPipeline();
+    else
+      startSequential();
 
-    std::cout << "Press 'ESC' to stop..." << std::endl;
+    if (headless)
+    {
+      double seconds = (cv::getTickCount() - run_start_time) / cv::getTickFrequency();
+      std::cout << "Processed " << frameNumber << " frames in " << seconds << " sec ("
+        << frameNumber / seconds << " fps)" << std::endl;
+    }
+
+    capture.release();
+  }
+
+  void VideoCapture::startSequential()
+  {
     do
     {
       frameNumber++;
 
       capture >> frame;
-      if (frame.empty()) break;
-
-      cv::resize(frame, frame, cv::Size(), input_resize_percent/100., input_resize_percent / 100.);
-
-      if (firstTime && input_resize_percent != 100)
-      {
-        std::cout << "Resized to:" << std::endl;
-        std::cout << "input->width:" << frame.size().width << std::endl;
-        std::cout << "input->height:" << frame.size().height << std::endl;
-      }
-      
-      //if (enableFlip)
-      //  cvFlip(frame, frame, 0);
-
-      if (VC_ROI::use_roi == true && VC_ROI::roi_defined == false && firstTime == true)
+      if (frame.empty())
       {
-        VC_ROI::reset();
-
-        do
-        {
-          cv::Mat img_input;
-          frame.copyTo(img_input);
-
-          if (showOutput)
-          {
-            cv::imshow("Input", img_input);
-
-            std::cout << "Set ROI (press ESC to skip)" << std::endl;
-            //VC_ROI::img_input1 = new IplImage(img_input);
-            cvSetMouseCallback("Input", VC_ROI::VideoCapture_on_mouse, NULL);
-            key = cv::waitKey(0);
-            //delete VC_ROI::img_input1;
-          }
-          else
-            key = KEY_ESC;
-
-          if (key == KEY_ESC)
-          {
-            std::cout << "ROI disabled" << std::endl;
-            VC_ROI::reset();
-            VC_ROI::use_roi = false;
-            break;
-          }
-
-          if (VC_ROI::roi_defined)
-          {
-            std::cout << "ROI defined (" << VC_ROI::roi_x0 << "," << VC_ROI::roi_y0 << "," << VC_ROI::roi_x1 << "," << VC_ROI::roi_y1 << ")" << std::endl;
-            break;
-          }
-          else
-            std::cout << "ROI undefined" << std::endl;
-
-        } while (1);
+        frameNumber--;
+        break;
       }
 
-      if (VC_ROI::use_roi == true && VC_ROI::roi_defined == true)
-      {
-        cv::Rect roi(VC_ROI::roi_x0, VC_ROI::roi_y0, VC_ROI::roi_x1 - VC_ROI::roi_x0, VC_ROI::roi_y1 - VC_ROI::roi_y0);
-        frame = frame(roi);
-      }
+      prepareFrame(frame);
 
       cv::Mat img_input;
       frame.copyTo(img_input);
@@ -229,6 +274,14 @@ namespace bgslibrary
       freq = cv::getTickFrequency();
       fps = freq / delta_time;
       //std::cout << "FPS: " << fps << std::endl;
+
+      if (headless)
+      {
+        if (stopAt > 0 && stopAt == frameNumber)
+          break;
+        firstTime = false;
+        continue;
+      }
       
       if (showFPS)
         cv::putText(img_input,
@@ -258,8 +311,152 @@ namespace bgslibrary
 
       firstTime = false;
     } while (1);
+  }
 
-    capture.release();
+  // Three stage pipeline: a decoder thread feeds a processing thread through
+  // a bounded queue, the processed frames are displayed on the calling thread
+  // (highgui must stay on it, so the frame processor hands over the images it
+  // would show with each frame). Each stage only waits for the slowest one.
+  void VideoCapture::startPipeline()
+  {
+    const size_t depth = std::max(pipelineDepth, 1);
+    BoundedQueue<PipelineFrame> decodedFrames(depth);
+    BoundedQueue<PipelineFrame> processedFrames(depth);
+    std::atomic<bool> stopRequested(false);
+    std::exception_ptr decoderError;
+    std::exception_ptr processorError;
+
+    std::cout << "Pipeline enabled (depth: " << decodedFrames.capacity()
+      << ", dropFrames: " << dropFrames << ")" << std::endl;
+
+    // the processor shows its windows again on every way out of here
+    struct DeferDisplayGuard
+    {
+      IFrameProcessor &processor;
+      explicit DeferDisplayGuard(IFrameProcessor &_processor) : processor(_processor) {
+        processor.setDeferDisplay(true);
+      }
+      ~DeferDisplayGuard() {
+        processor.setDeferDisplay(false);
+      }
+    } deferDisplay(*frameProcessor);
+
+    // the first frame may ask for the ROI, so it is prepared here
+    PipelineFrame first;
+    first.frameNumber = ++frameNumber;
+    capture >> first.frame;
+    if (first.frame.empty())
+    {
+      frameNumber--;
+      return;
+    }
+    prepareFrame(first.frame);
+    firstTime = false;
+    decodedFrames.push(std::move(first));
+
+    std::thread decoder([&]() {
+      try
+      {
+        int number = frameNumber;
+        while (!stopRequested)
+        {
+          PipelineFrame item;
+          capture >> item.frame;
+          if (item.frame.empty())
+            break;
+          prepareFrame(item.frame);
+          item.frameNumber = ++number;
+          if (!decodedFrames.push(std::move(item), dropFrames))
+            break;
+        }
+      }
+      catch (...)
+      {
+        decoderError = std::current_exception();
+      }
+      decodedFrames.close();
+    });
+
+    std::thread processor([&]() {
+      try
+      {
+        PipelineFrame item;
+        while (!stopRequested && decodedFrames.pop(item))
+        {
+          int64 process_start = cv::getTickCount();
+          frameProcessor->process(item.frame);
+          item.fps = cv::getTickFrequency() / (cv::getTickCount() - process_start);
+          frameProcessor->takeWindows(item.windows);
+          if (!processedFrames.push(std::move(item), dropFrames))
+            break;
+        }
+      }
+      catch (...)
+      {
+        processorError = std::current_exception();
+      }
+      processedFrames.close();
+    });
+
+    // with dropFrames the frame stopAt may never reach the display
+    bool stoppedAt = false;
+    PipelineFrame item;
+    while (processedFrames.pop(item))
+    {
+      frameNumber = item.frameNumber;
+      fps = item.fps;
+
+      if (headless)
+      {
+        if (stopAt > 0 && frameNumber >= stopAt)
+          break;
+        continue;
+      }
+
+      if (showFPS)
+        cv::putText(item.frame,
+              "FPS: " + std::to_string(fps),
+              cv::Point(10,15), // Coordinates
+              cv::FONT_HERSHEY_COMPLEX_SMALL, // Font
+              1.0, // Scale. 2.0 = 2x bigger
+              cv::Scalar(0,0,255), // BGR Color
+              1); // Line Thickness (Optional)
+
+      for (const auto &window : item.windows)
+        cv::imshow(window.first, window.second);
+
+      if (showOutput)
+        cv::imshow("Input", item.frame);
+
+      key = cv::waitKey(loopDelay);
+
+      if (key == KEY_SPACE)
+        key = cv::waitKey(0);
+
+      if (key == KEY_ESC)
+        break;
+
+      if (stopAt > 0 && frameNumber >= stopAt && !stoppedAt)
+      {
+        stoppedAt = true;
+        key = cv::waitKey(0);
+      }
+    }
+
+    stopRequested = true;
+    decodedFrames.close();
+    processedFrames.close();
+    decoder.join();
+    processor.join();
+
+    if (dropFrames)
+      std::cout << "Dropped frames: " << decodedFrames.droppedCount()
+        << " (decoder), " << processedFrames.droppedCount() << " (display)" << std::endl;
+
+    if (decoderError)
+      std::rethrow_exception(decoderError);
+    if (processorError)
+      std::rethrow_exception(processorError);
   }
 
   void VideoCapture::save_config(cv::FileStorage &fs) {
@@ -274,6 +471,9 @@ namespace bgslibrary
     fs << "roi_y1" << VC_ROI::roi_y1;
     fs << "showFPS" << showFPS;
     fs << "showOutput" << showOutput;
+    fs << "enablePipeline" << enablePipeline;
+    fs << "pipelineDepth" << pipelineDepth;
+    fs << "dropFrames" << dropFrames;
   }
 
   void VideoCapture::load_config(cv::FileStorage &fs) {
@@ -288,5 +488,8 @@ namespace bgslibrary
     fs["roi_y1"] >> VC_ROI::roi_y1;
     fs["showFPS"] >> showFPS;
     fs["showOutput"] >> showOutput;
+    fs["enablePipeline"] >> enablePipeline;
+    fs["pipelineDepth"] >> pipelineDepth;
+    fs["dropFrames"] >> dropFrames;
   }
 }
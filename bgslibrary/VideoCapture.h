@@ -4,7 +4,9 @@
 #include <fstream>
 #include <memory>
 //#include <chrono>
-//#include <thread>
+#include <thread>
+#include <atomic>
+#include <exception>
 #include <opencv2/opencv.hpp>
 // opencv legacy includes
 //#include <opencv2/highgui/highgui_c.h>
@@ -13,6 +15,7 @@
 
 #include "utils/GenericKeys.h"
 #include "utils/ILoadSaveConfig.h"
+#include "utils/BoundedQueue.h"
 #include "IFrameProcessor.h"
 
 namespace bgslibrary
@@ -40,6 +43,18 @@ namespace bgslibrary
     bool enableFlip;
     double loopDelay = 33.333;
     bool firstTime = true;
+    bool headless = false;
+    bool enablePipeline = false;
+    int pipelineDepth = 4;
+    bool dropFrames = false;
+
+    struct PipelineFrame
+    {
+      int frameNumber = 0;
+      double fps = 0;
+      cv::Mat frame;
+      IFrameProcessor::Windows windows;
+    };
 
   public:
     VideoCapture();
@@ -48,11 +63,15 @@ namespace bgslibrary
     void setFrameProcessor(const std::shared_ptr<IFrameProcessor> &_frameProcessor);
     void setCamera(int _index);
     void setVideo(std::string _filename);
+    void setHeadless(bool _headless);
     void start();
 
   private:
     void setUpCamera();
     void setUpVideo();
+    void prepareFrame(cv::Mat &img);
+    void startSequential();
+    void startPipeline();
     
     void save_config(cv::FileStorage &fs);
     void load_config(cv::FileStorage &fs);
@@ -1,7 +1,175 @@
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CODEBOOK_SIMD_SSE2
+#endif
+
 #include "CodeBook.h"
 
 using namespace bgslibrary::algorithms;
 
+void codebook::CodewordSlab::allocate(int rows, int _cols, int _slotSize)
+{
+  cols = _cols;
+  slotSize = _slotSize;
+  const size_t pixels = (size_t)rows * cols;
+  const bool allocated = slab.allocate(pixels * 4 * slotSize) && headers.allocate(pixels);
+  CV_Assert(allocated);
+  // the unused lanes are matched (and masked out) too, keep them finite
+  std::fill(slab.data(), slab.data() + slab.size(), 0.f);
+  for (size_t p = 0; p < pixels; ++p) {
+    headers[p].size = 0;
+    headers[p].capacity = slotSize;
+    headers[p].offset = -1;
+  }
+  pools.assign(rows, Pool());
+}
+
+void codebook::CodewordSlab::append(int row, int col, const codeword &cw)
+{
+  Header &h = headers[(size_t)row * cols + col];
+  if (h.size == h.capacity) {
+    Pool &pool = pools[row];
+    const int capacity = h.capacity * 2;
+    const int offset = acquireBlock(pool, capacity);
+    // after acquireBlock, which may move the pool
+    const Book old = get(row, col);
+    float *base = pool.values.data() + offset;
+    std::copy(old.min, old.min + h.size, base);
+    std::copy(old.max, old.max + h.size, base + capacity);
+    std::copy(old.f, old.f + h.size, base + 2 * capacity);
+    std::copy(old.l, old.l + h.size, base + 3 * capacity);
+    if (h.offset >= 0)
+      releaseBlock(pool, h.offset, h.capacity);
+    h.offset = offset;
+    h.capacity = capacity;
+  }
+  Book b = get(row, col);
+  b.min[h.size] = cw.min;
+  b.max[h.size] = cw.max;
+  b.f[h.size] = cw.f;
+  b.l[h.size] = cw.l;
+  h.size++;
+}
+
+void codebook::CodewordSlab::shrink(int row, int col, int size)
+{
+  const size_t pixel = (size_t)row * cols + col;
+  Header &h = headers[pixel];
+  h.size = size;
+  if (h.offset < 0 || size > slotSize)
+    return;
+
+  // back to the slot of the pixel
+  const Book b = get(row, col);
+  float *slot = slab.data() + pixel * 4 * slotSize;
+  std::copy(b.min, b.min + size, slot);
+  std::copy(b.max, b.max + size, slot + slotSize);
+  std::copy(b.f, b.f + size, slot + 2 * slotSize);
+  std::copy(b.l, b.l + size, slot + 3 * slotSize);
+  releaseBlock(pools[row], h.offset, h.capacity);
+  h.offset = -1;
+  h.capacity = slotSize;
+}
+
+size_t codebook::CodewordSlab::sizeClass(int capacity) const
+{
+  size_t c = 0;
+  while ((slotSize << (c + 1)) < capacity)
+    ++c;
+  return c;
+}
+
+int codebook::CodewordSlab::acquireBlock(Pool &pool, int capacity)
+{
+  const size_t c = sizeClass(capacity);
+  if (c < pool.freeBlocks.size() && !pool.freeBlocks[c].empty()) {
+    const int offset = pool.freeBlocks[c].back();
+    pool.freeBlocks[c].pop_back();
+    return offset;
+  }
+  const int offset = (int)pool.values.size();
+  pool.values.resize(pool.values.size() + 4 * (size_t)capacity, 0.f);
+  return offset;
+}
+
+void codebook::CodewordSlab::releaseBlock(Pool &pool, int offset, int capacity)
+{
+  const size_t c = sizeClass(capacity);
+  if (c >= pool.freeBlocks.size())
+    pool.freeBlocks.resize(c + 1);
+  pool.freeBlocks[c].push_back(offset);
+}
+
+size_t codebook::CodewordSlab::getModelSize() const
+{
+  size_t bytes = slab.bytes() + headers.bytes() + pools.capacity() * sizeof(Pool);
+  for (const Pool &pool : pools) {
+    bytes += pool.values.capacity() * sizeof(float);
+    for (const std::vector<int> &blocks : pool.freeBlocks)
+      bytes += blocks.capacity() * sizeof(int);
+  }
+  return bytes;
+}
+
+namespace
+{
+  typedef codebook::CodewordSlab::Book Book;
+
+  // Index of the first codeword with min <= pix <= max, -1 if none.
+  inline int findMatch(const Book &b, float pix)
+  {
+    int k = 0;
+#if defined(CODEBOOK_SIMD_SSE2)
+    const __m128 p = _mm_set1_ps(pix);
+    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+    for (; k < b.size && k + 4 <= b.capacity; k += 4) {
+      const __m128 valid = _mm_castsi128_ps(_mm_cmplt_epi32(lanes, _mm_set1_epi32(b.size - k)));
+      const __m128 in = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(b.min + k), p), _mm_cmple_ps(p, _mm_loadu_ps(b.max + k)));
+      int mask = _mm_movemask_ps(_mm_and_ps(in, valid));
+      if (mask) {
+        while (!(mask & 1)) {
+          mask >>= 1;
+          ++k;
+        }
+        return k;
+      }
+    }
+#endif
+    for (; k < b.size; ++k)
+      if (b.min[k] <= pix && pix <= b.max[k])
+        return k;
+    return -1;
+  }
+
+  // Increments l of all the codewords but the matched one, which is reset to
+  // 0. Returns false when none of them can have reached lmax.
+  inline bool ageCodewords(const Book &b, int matched, float lmax)
+  {
+    bool stale = false;
+    int k = 0;
+#if defined(CODEBOOK_SIMD_SSE2)
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 threshold = _mm_set1_ps(lmax);
+    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+    for (; k < b.size && k + 4 <= b.capacity; k += 4) {
+      const __m128 valid = _mm_castsi128_ps(_mm_cmplt_epi32(lanes, _mm_set1_epi32(b.size - k)));
+      const __m128 l = _mm_add_ps(_mm_loadu_ps(b.l + k), one);
+      _mm_storeu_ps(b.l + k, l);
+      stale |= _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(l, threshold), valid)) != 0;
+    }
+#endif
+    for (; k < b.size; ++k) {
+      b.l[k]++;
+      stale |= b.l[k] >= lmax;
+    }
+    if (matched >= 0)
+      b.l[matched] = 0;
+    return stale;
+  }
+}
+
 CodeBook::CodeBook() :
   IBGS(quote(CodeBook)),
   t(0), learningFrames(DEFAULT_LEARNFRAMES), 
@@ -47,15 +215,23 @@ void CodeBook::process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &i
   firstTime = false;
 }
 
-void CodeBook::initializeCodebook(int w, int h)
+size_t CodeBook::getModelMemory() const
 {
-  cbMain = new std::vector<codeword>*[w];
-  for (int i = 0; i < w; ++i)
-    cbMain[i] = new std::vector<codeword>[h];
+  return IBGS::getModelMemory() + cbMain.getModelSize() + cbCache.getModelSize();
+}
 
-  cbCache = new std::vector<codeword>*[w];
-  for (int i = 0; i < w; ++i)
-    cbCache[i] = new std::vector<codeword>[h];
+void CodeBook::initializeCodebook(int rows, int cols)
+{
+  cbMain.allocate(rows, cols, MAIN_SLOT_SIZE);
+  cbCache.allocate(rows, cols, CACHE_SLOT_SIZE);
+
+  const int bands = nParallelBands > 0 ? nParallelBands : (int)ThreadPool::defaultNumThreads();
+  if (bands > 1) {
+    if (!bandThreadPool || (int)bandThreadPool->size() != bands - 1)
+      bandThreadPool.reset(new ThreadPool(bands - 1));
+  }
+  else
+    bandThreadPool.reset();
 }
 
 void CodeBook::update_cb(const cv::Mat& frame)
@@ -63,115 +239,116 @@ void CodeBook::update_cb(const cv::Mat& frame)
   if (t > learningFrames)
     return;
 
-  for (int i = 0; i < frame.rows; i++)
+  parallelBands(bandThreadPool.get(), frame.rows, [&](int rowBegin, int rowEnd) {
+    update_cb_rows(frame, rowBegin, rowEnd);
+  });
+  t++;
+}
+
+void CodeBook::update_cb_rows(const cv::Mat& frame, int rowBegin, int rowEnd)
+{
+  for (int i = rowBegin; i < rowEnd; i++)
   {
+    const uchar* row = frame.ptr<uchar>(i);
     for (int j = 0; j < frame.cols; j++)
     {
-      int pix = frame.at<uchar>(i, j);
-      std::vector<codeword>& cm = cbMain[i][j];
-      bool found = false;
-      for (int k = 0; k < (int)cm.size(); k++)
+      int pix = row[j];
+      Book cm = cbMain.get(i, j);
+      int k = findMatch(cm, (float)pix);
+      ageCodewords(cm, k, (float)Tdel);
+      if (k >= 0)
       {
-        if (cm[k].min <= pix && pix <= cm[k].max && !found)
-        {
-          found = true;
-          cm[k].min = ((pix - alpha) + (cm[k].f*cm[k].min)) / (cm[k].f + 1);
-          cm[k].max = ((pix + alpha) + (cm[k].f*cm[k].max)) / (cm[k].f + 1);
-          cm[k].l = 0;
-          cm[k].last = t;
-          cm[k].f++;
-        }
-        else
-        {
-          cm[k].l++;
-        }
+        cm.min[k] = ((pix - alpha) + (cm.f[k]*cm.min[k])) / (cm.f[k] + 1);
+        cm.max[k] = ((pix + alpha) + (cm.f[k]*cm.max[k])) / (cm.f[k] + 1);
+        cm.f[k]++;
       }
-      if (!found)
+      else
       {
         codeword n = {};
         n.min = std::max(0, pix - alpha);
         n.max = std::min(255, pix + alpha);
         n.f = 1;
         n.l = 0;
-        n.first = t;
-        n.last = t;
-        cm.push_back(n);
+        cbMain.append(i, j, n);
       }
     }
   }
-  t++;
 }
 
 void CodeBook::fg_cb(const cv::Mat& frame, cv::Mat& fg)
 {
   //fg = cv::Mat::zeros(frame.size(), CV_8UC1);
   //if (cbMain == 0) initializeCodebook(frame.rows, frame.cols);
-  
+
   if (t <= learningFrames) {
     update_cb(frame);
     return;
   }
 
-  for (int i = 0; i<frame.rows; i++)
+  parallelBands(bandThreadPool.get(), frame.rows, [&](int rowBegin, int rowEnd) {
+    fg_cb_rows(frame, fg, rowBegin, rowEnd);
+  });
+}
+
+void CodeBook::fg_cb_rows(const cv::Mat& frame, cv::Mat& fg, int rowBegin, int rowEnd)
+{
+  for (int i = rowBegin; i < rowEnd; i++)
   {
-    for (int j = 0; j<frame.cols; j++)
+    const uchar* row = frame.ptr<uchar>(i);
+    uchar* fgRow = fg.ptr<uchar>(i);
+    for (int j = 0; j < frame.cols; j++)
     {
-      int pix = frame.at<uchar>(i, j);
-      std::vector<codeword>& cm = cbMain[i][j];
-      bool found = false;
-      for (int k = 0; k < (int)cm.size(); k++)
+      int pix = row[j];
+      Book cm = cbMain.get(i, j);
+      int k = findMatch(cm, (float)pix);
+      const bool stale = ageCodewords(cm, k, (float)Tdel);
+      if (k >= 0)
       {
-        if (cm[k].min <= pix && pix <= cm[k].max && !found)
-        {
-          cm[k].min = ((1 - beta)*(pix - alpha)) + (beta*cm[k].min);
-          cm[k].max = ((1 - beta)*(pix + alpha)) + (beta*cm[k].max);
-          cm[k].l = 0;
-          cm[k].first = t;
-          cm[k].f++;
-          found = true;
-        }
-        else
-          cm[k].l++;
+        cm.min[k] = ((1 - beta)*(pix - alpha)) + (beta*cm.min[k]);
+        cm.max[k] = ((1 - beta)*(pix + alpha)) + (beta*cm.max[k]);
+        cm.f[k]++;
       }
-      cm.erase(remove_if(cm.begin(), cm.end(), [](codeword& c) { return c.l >= Tdel; }), cm.end());
-      fg.at<uchar>(i, j) = found ? 0 : 255;
-      if (found) continue;
-      found = false;
-      std::vector<codeword>& cc = cbCache[i][j];
-      for (int k = 0; k < (int)cc.size(); k++)
+      if (stale)
+        cbMain.removeIf(i, j, [](const Book& b, int c) { return b.l[c] >= Tdel; });
+      fgRow[j] = k >= 0 ? 0 : 255;
+      if (k >= 0) continue;
+
+      Book cc = cbCache.get(i, j);
+      k = findMatch(cc, (float)pix);
+      const bool staleCache = ageCodewords(cc, k, (float)Th);
+      if (k >= 0)
       {
-        if (cc[k].min <= pix && pix <= cc[k].max && !found)
-        {
-          cc[k].min = ((1 - beta)*(pix - alpha)) + (beta*cc[k].min);
-          cc[k].max = ((1 - beta)*(pix + alpha)) + (beta*cc[k].max);
-          cc[k].l = 0;
-          cc[k].first = t;
-          cc[k].f++;
-          found = true;
-        }
-        else
-          cc[k].l++;
+        cc.min[k] = ((1 - beta)*(pix - alpha)) + (beta*cc.min[k]);
+        cc.max[k] = ((1 - beta)*(pix + alpha)) + (beta*cc.max[k]);
+        cc.f[k]++;
       }
-
-      if (!found)
+      else
       {
         codeword n = {};
         n.min = std::max(0, pix - alpha);
         n.max = std::min(255, pix + alpha);
         n.f = 1;
         n.l = 0;
-        n.first = t;
-        n.last = t;
-        cc.push_back(n);
+        cbCache.append(i, j, n);
       }
 
-      cc.erase(remove_if(cc.begin(), cc.end(), [](codeword& c) { return c.l >= Th; }), cc.end());
+      if (staleCache)
+        cbCache.removeIf(i, j, [](const Book& b, int c) { return b.l[c] >= Th; });
 
-      for (std::vector<codeword>::iterator it = cc.begin(); it != cc.end(); it++)
-        if (it->f > Tadd)
-          cm.push_back(*it);
+      cc = cbCache.get(i, j);
+      bool promoted = false;
+      for (int c = 0; c < cc.size; c++)
+      {
+        if (cc.f[c] > Tadd)
+        {
+          codeword n = { cc.min[c], cc.max[c], cc.f[c], cc.l[c] };
+          cbMain.append(i, j, n);
+          promoted = true;
+        }
+      }
 
-      cc.erase(remove_if(cc.begin(), cc.end(), [](codeword& c) { return c.f > Tadd; }), cc.end());
+      if (promoted)
+        cbCache.removeIf(i, j, [](const Book& b, int c) { return b.f[c] > Tadd; });
     }
   }
 }
@@ -180,6 +357,7 @@ void CodeBook::save_config(cv::FileStorage &fs) {
   fs << "alpha" << alpha;
   fs << "beta" << beta;
   fs << "learningFrames" << learningFrames;
+  fs << "nParallelBands" << nParallelBands;
   fs << "showOutput" << showOutput;
 }
 
@@ -187,5 +365,6 @@ void CodeBook::load_config(cv::FileStorage &fs) {
   fs["alpha"] >> alpha;
   fs["beta"] >> beta;
   fs["learningFrames"] >> learningFrames;
+  fs["nParallelBands"] >> nParallelBands;
   fs["showOutput"] >> showOutput;
 }
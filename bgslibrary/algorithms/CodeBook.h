@@ -3,6 +3,8 @@
 #include <opencv2/opencv.hpp>
 
 #include "IBGS.h"
+#include "../utils/AlignedBuffer.h"
+#include "../utils/ThreadPool.h"
 
 namespace bgslibrary
 {
@@ -14,9 +16,84 @@ namespace bgslibrary
         float max;
         float f;
         float l;
-        int first;
-        int last;
-        bool isStale;
+      };
+
+      // Codebooks of all the pixels of a frame. The codewords of a pixel are
+      // stored as arrays of min, max, f and l (in that order), so that they
+      // can be matched four at a time. Every pixel owns a slot of slotSize
+      // codewords in one aligned slab; a pixel needing more moves to a block
+      // of the overflow pool of its row (2, 4, ... times slotSize codewords)
+      // and back to its slot once it fits again. A row only touches its own
+      // pool, so different rows can be updated concurrently.
+      class CodewordSlab
+      {
+      public:
+        // Codewords of one pixel, valid until the next append() or
+        // removeIf() on that pixel.
+        struct Book {
+          float *min;
+          float *max;
+          float *f;
+          float *l;
+          int size;
+          int capacity;
+        };
+
+        CodewordSlab() : cols(0), slotSize(0) {}
+
+        void allocate(int rows, int cols, int slotSize);
+
+        Book get(int row, int col) {
+          const size_t pixel = (size_t)row * cols + col;
+          const Header &h = headers[pixel];
+          float *base = h.offset < 0 ? slab.data() + pixel * 4 * slotSize : pools[row].values.data() + h.offset;
+          Book b = { base, base + h.capacity, base + 2 * h.capacity, base + 3 * h.capacity, h.size, h.capacity };
+          return b;
+        }
+
+        void append(int row, int col, const codeword &cw);
+
+        // Removes the codewords k for which pred(book, k) is true, keeping
+        // the order of the others.
+        template<typename Pred>
+        void removeIf(int row, int col, Pred pred) {
+          Book b = get(row, col);
+          int n = 0;
+          for (int k = 0; k < b.size; ++k) {
+            if (pred(b, k))
+              continue;
+            b.min[n] = b.min[k];
+            b.max[n] = b.max[k];
+            b.f[n] = b.f[k];
+            b.l[n] = b.l[k];
+            ++n;
+          }
+          shrink(row, col, n);
+        }
+
+        size_t getModelSize() const;
+
+      private:
+        struct Header {
+          int size;
+          int capacity;
+          int offset;   // in the pool of the row, -1 while in the slot
+        };
+        struct Pool {
+          std::vector<float> values;
+          std::vector<std::vector<int>> freeBlocks;   // per size class
+        };
+
+        int cols;
+        int slotSize;
+        AlignedBuffer<float> slab;
+        AlignedBuffer<Header> headers;
+        std::vector<Pool> pools;
+
+        void shrink(int row, int col, int size);
+        size_t sizeClass(int capacity) const;
+        int acquireBlock(Pool &pool, int capacity);
+        void releaseBlock(Pool &pool, int offset, int capacity);
       };
     }
 
@@ -29,11 +106,18 @@ namespace bgslibrary
       ~CodeBook();
 
       void process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img_bgmodel);
+      int getStripeHalo() const { return 0; }
+      size_t getModelMemory() const;
 
     private:
+      typedef codebook::CodewordSlab::Book Book;
+
       static const int Tdel = 200;
       static const int Tadd = 150;
       static const int Th = 200;
+      // codewords per pixel before moving to the overflow pool
+      static const int MAIN_SLOT_SIZE = 4;
+      static const int CACHE_SLOT_SIZE = 2;
       const int DEFAULT_ALPHA = 10;
       const float DEFAULT_BETA = 1.;
       const int DEFAULT_LEARNFRAMES = 10;
@@ -41,13 +125,18 @@ namespace bgslibrary
       int learningFrames = 10;
       int alpha = 10;
       float beta = 1;
-      std::vector<codeword> **cbMain;
-      std::vector<codeword> **cbCache;
+      // row bands processed concurrently, 0 for one per hardware thread
+      int nParallelBands = 1;
+      codebook::CodewordSlab cbMain;
+      codebook::CodewordSlab cbCache;
+      std::unique_ptr<ThreadPool> bandThreadPool;
 
-      void initializeCodebook(int w, int h);
+      void initializeCodebook(int rows, int cols);
       void update_cb(const cv::Mat& frame);
+      void update_cb_rows(const cv::Mat& frame, int rowBegin, int rowEnd);
       void fg_cb(const cv::Mat& frame, cv::Mat& fg);
-      
+      void fg_cb_rows(const cv::Mat& frame, cv::Mat& fg, int rowBegin, int rowEnd);
+
       void save_config(cv::FileStorage &fs);
       void load_config(cv::FileStorage &fs);
     };
@@ -28,6 +28,7 @@ namespace bgslibrary
       ~DPAdaptiveMedian();
 
       void process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img_bgmodel);
+      int getStripeHalo() const { return 0; }
 
     private:
       void save_config(cv::FileStorage &fs);
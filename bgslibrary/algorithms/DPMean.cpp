@@ -66,6 +66,44 @@ void DPMean::process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img
   frameNumber++;
 }
 
+void DPMean::processBatch(const std::vector<cv::Mat> &imgs_input, std::vector<cv::Mat> &imgs_foreground)
+{
+  setShowOutput(false);
+  imgs_foreground.resize(imgs_input.size());
+
+  // the first frame initializes the model
+  size_t first = 0;
+  if (firstTime && !imgs_input.empty()) {
+    cv::Mat img_bgmodel;
+    process(imgs_input[0], imgs_foreground[0], img_bgmodel);
+    first = 1;
+  }
+  if (first == imgs_input.size())
+    return;
+
+  std::vector<IplImage> _frames;
+  std::vector<IplImage> _masks;
+  for (size_t i = first; i < imgs_input.size(); ++i) {
+    imgs_foreground[i].create(imgs_input[i].size(), CV_8UC1);
+    _frames.push_back(cvIplImage(imgs_input[i]));
+    _masks.push_back(cvIplImage(imgs_foreground[i]));
+  }
+
+  std::vector<const IplImage*> frames;
+  std::vector<IplImage*> masks;
+  for (size_t i = 0; i < _frames.size(); ++i) {
+    frames.push_back(&_frames[i]);
+    masks.push_back(&_masks[i]);
+  }
+
+  bgs.SubtractUpdate(frames, masks);
+
+  imgs_foreground.back().copyTo(img_foreground);
+  img_background = cv::cvarrToMat(bgs.Background()->Ptr());
+
+  frameNumber += static_cast<long>(frames.size());
+}
+
 void DPMean::save_config(cv::FileStorage &fs) {
   fs << "threshold" << threshold;
   fs << "alpha" << alpha;
@@ -101,7 +101,7 @@ void DPTexture::process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &
 
   img_foreground = cv::cvarrToMat(fgMask.Ptr());
   //img_background = cv::cvarrToMat(bgs.Background()->Ptr());
-  img_background = cv::Mat::zeros(img_input.size(), img_input.type());
+  createZeros(img_background, img_input.size(), img_input.type());
 
 #ifndef MEX_COMPILE_FLAG
   if (showOutput)
@@ -44,6 +44,42 @@ void FrameDifference::process(const cv::Mat &img_input, cv::Mat &img_output, cv:
   firstTime = false;
 }
 
+void FrameDifference::processBatch(const std::vector<cv::Mat> &imgs_input, std::vector<cv::Mat> &imgs_foreground)
+{
+  setShowOutput(false);
+  imgs_foreground.resize(imgs_input.size());
+  if (imgs_input.empty())
+    return;
+
+  size_t first = 0;
+  if (img_background.empty()) {
+    cv::Mat img_bgmodel;
+    process(imgs_input[0], imgs_foreground[0], img_bgmodel);
+    first = 1;
+  }
+
+  // the background of each frame is the previous input, no need to copy it around
+  for (size_t i = first; i < imgs_input.size(); ++i) {
+    const cv::Mat &img_previous = (i == 0) ? img_background : imgs_input[i - 1];
+    cv::Mat &img_output = imgs_foreground[i];
+
+    cv::absdiff(img_previous, imgs_input[i], img_output);
+
+    if (img_output.channels() == 3)
+      cv::cvtColor(img_output, img_output, CV_BGR2GRAY);
+
+    if (enableThreshold)
+      cv::threshold(img_output, img_output, threshold, 255, cv::THRESH_BINARY);
+  }
+
+  if (first < imgs_input.size()) {
+    imgs_foreground.back().copyTo(img_foreground);
+    imgs_input.back().copyTo(img_background);
+  }
+
+  firstTime = false;
+}
+
 void FrameDifference::save_config(cv::FileStorage &fs) {
   fs << "enableThreshold" << enableThreshold;
   fs << "threshold" << threshold;
@@ -17,6 +17,7 @@ namespace bgslibrary
       ~FrameDifference();
 
       void process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img_bgmodel);
+      void processBatch(const std::vector<cv::Mat> &imgs_input, std::vector<cv::Mat> &imgs_foreground);
 
     private:
       void save_config(cv::FileStorage &fs);
@@ -54,7 +54,7 @@ void FuzzySugenoIntegral::process(const cv::Mat &img_input, cv::Mat &img_output,
     img_background_f3.convertTo(img_background, CV_8U, 255.0 / (maxVal - minVal), -minVal);
     img_background.copyTo(img_bgmodel);
 
-    img_foreground = cv::Mat::zeros(img_input.size(), img_input.type());
+    createZeros(img_foreground, img_input.size(), img_input.type());
     img_foreground.copyTo(img_output);
 
 #ifndef MEX_COMPILE_FLAG
@@ -7,6 +7,8 @@
 #include <string>
 #include <functional>
 #include <map>
+#include <mutex>
+#include <vector>
 
 #include <opencv2/opencv.hpp>
 
@@ -18,6 +20,8 @@
 #endif
 
 #include "../utils/ILoadSaveConfig.h"
+#include "../utils/AlgorithmStats.h"
+#include "../utils/FastRNG.h"
 
 #if !defined(bgs_register)
 #define bgs_register(x) static BGS_Register<x> register_##x(quote(x))
@@ -51,13 +55,58 @@ namespace bgslibrary
       void setShowOutput(const bool _showOutput) {
         showOutput = _showOutput;
       }
+      bool getShowOutput() const {
+        return showOutput;
+      }
+      // Seed of the random generator of the model (algorithms using random
+      // sampling), used when the model is (re)initialized.
+      void setRandomSeed(const uint64_t _randomSeed) {
+        randomSeed = _randomSeed;
+      }
       cv::Mat apply(const cv::Mat &img_input) {
+        // the caller usually still holds the previous mask (fg = apply(frame)),
+        // so two buffers alternate; a mask still held is never overwritten
+        cv::Mat &img_output = img_apply_foreground[isShared(img_apply_foreground[0]) ? 1 : 0];
+        if (isShared(img_output))
+          img_output.release();
+        applyInto(img_input, img_output);
+        return img_output;
+      }
+      // Same as apply() but the mask is written into img_output, which is
+      // only reallocated when its size or type changes (no allocation per
+      // frame, whatever the caller does with the previous masks).
+      void applyInto(const cv::Mat &img_input, cv::Mat &img_output) {
         setShowOutput(false);
-        cv::Mat _img_foreground;
-        cv::Mat _img_background;
-        process(img_input, _img_foreground, _img_background);
-                _img_background.copyTo(img_background);
-        return _img_foreground;
+        processFrame(img_input, img_output, img_apply_background);
+        img_apply_background.copyTo(img_background);
+      }
+      std::vector<cv::Mat> applyBatch(const std::vector<cv::Mat> &imgs_input) {
+        std::vector<cv::Mat> imgs_foreground;
+        int64 start_time = cv::getTickCount();
+        long allocations = allocationCount();
+        processBatch(imgs_input, imgs_foreground);
+        if (!imgs_input.empty())
+          recordStats(start_time, allocations, static_cast<long>(imgs_input.size()));
+        return imgs_foreground;
+      }
+      // Same as process(), and records the call in the stats of the algorithm.
+      void processFrame(const cv::Mat &img_input, cv::Mat &img_foreground, cv::Mat &img_background) {
+        int64 start_time = cv::getTickCount();
+        long allocations = allocationCount();
+        process(img_input, img_foreground, img_background);
+        recordStats(start_time, allocations, 1);
+      }
+      // Latency, frames, model size and allocations of all the instances of
+      // the algorithm (only the calls made through processFrame, apply,
+      // applyInto and applyBatch are recorded).
+      AlgorithmStats::Summary getStats() {
+        return StatsRegistry::Instance()->get(algorithmName)->getSummary();
+      }
+      // Bytes held by the model. The default only counts the buffers of IBGS,
+      // algorithms with their own model storage report it as well.
+      virtual size_t getModelMemory() const {
+        return img_background.total() * img_background.elemSize() +
+          img_foreground.total() * img_foreground.elemSize();
       }
       cv::Mat getBackgroundModel() {
         return img_background;
@@ -74,18 +123,70 @@ namespace bgslibrary
         //debug_destruction(IBGS);
       }
       virtual void process(const cv::Mat &img_input, cv::Mat &img_foreground, cv::Mat &img_background) = 0;
+      // Processes a sequence of frames, imgs_foreground[i] is the mask of imgs_input[i].
+      // Algorithms whose model update is cheap to run across time override it.
+      virtual void processBatch(const std::vector<cv::Mat> &imgs_input, std::vector<cv::Mat> &imgs_foreground) {
+        setShowOutput(false);
+        imgs_foreground.resize(imgs_input.size());
+        for (size_t i = 0; i < imgs_input.size(); ++i) {
+          // applyBatch records the whole batch
+          process(imgs_input[i], imgs_foreground[i], img_apply_background);
+          img_apply_background.copyTo(img_background);
+        }
+      }
+      // Rows of context needed to process a horizontal stripe of the frame
+      // on its own: 0 for strictly per-pixel models, N when the model reads
+      // neighbours up to N rows away, -1 when it cannot be split. Models
+      // updating the state of neighbouring pixels (ViBe, PBAS) cannot: the
+      // updates crossing a stripe border would be lost, and the masks would
+      // depend on the number of stripes.
+      virtual int getStripeHalo() const {
+        return -1;
+      }
+      // True for the algorithms still drawing from the process-wide rand():
+      // they cannot run concurrently with each other without interleaving
+      // their random sequences (and so making their masks scheduling-dependent).
+      virtual bool usesSharedRandom() const {
+        return false;
+      }
     protected:
       std::string algorithmName;
       bool firstTime = true;
       bool showOutput = true;
+      uint64_t randomSeed = FastRNG::DEFAULT_SEED;
       cv::Mat img_background;
       cv::Mat img_foreground;
       void init(const cv::Mat &img_input, cv::Mat &img_outfg, cv::Mat &img_outbg) {
         assert(img_input.empty() == false);
         //img_outfg = cv::Mat::zeros(img_input.size(), img_input.type());
         //img_outbg = cv::Mat::zeros(img_input.size(), img_input.type());
-        img_outfg = cv::Mat::zeros(img_input.size(), CV_8UC1);
-        img_outbg = cv::Mat::zeros(img_input.size(), CV_8UC3);
+        createZeros(img_outfg, img_input.size(), CV_8UC1);
+        createZeros(img_outbg, img_input.size(), CV_8UC3);
+      }
+      // Same as img = cv::Mat::zeros(size, type), but the buffer of img is kept
+      // when its size and type match and no other Mat references it.
+      static void createZeros(cv::Mat &img, const cv::Size &size, int type) {
+        if (isShared(img))
+          img.release();
+        img.create(size, type);
+        img.setTo(cv::Scalar::all(0));
+      }
+      static bool isShared(const cv::Mat &img) {
+#if CV_MAJOR_VERSION == 2
+        return img.refcount != NULL && *img.refcount > 1;
+#else
+        return img.u != NULL && img.u->refcount > 1;
+#endif
+      }
+    private:
+      cv::Mat img_apply_foreground[2];
+      cv::Mat img_apply_background;
+      std::shared_ptr<AlgorithmStats> stats;
+      void recordStats(int64 start_time, long allocations, long frames) {
+        double seconds = (cv::getTickCount() - start_time) / cv::getTickFrequency();
+        if (!stats)
+          stats = StatsRegistry::Instance()->get(algorithmName);
+        stats->record(seconds, allocationCount() - allocations, getModelMemory(), frames);
       }
     };
     
@@ -104,21 +205,70 @@ namespace bgslibrary
       }
 
       std::shared_ptr<IBGS> Create(std::string name) {
-        IBGS* instance = nullptr;
-
-        // find name in the registry and call factory method.
-        auto it = factoryFunctionRegistry.find(name);
-        if (it != factoryFunctionRegistry.end())
-          instance = it->second();
+        std::function<IBGS*(void)> factoryFunction;
+        {
+          // find name in the registry, the instance is built outside of the lock
+          std::lock_guard<std::mutex> lock(mutex);
+          auto it = factoryFunctionRegistry.find(name);
+          if (it != factoryFunctionRegistry.end())
+            factoryFunction = it->second;
+        }
 
-        // wrap instance in a shared ptr and return
+        // call factory method and wrap instance in a shared ptr
+        IBGS* instance = nullptr;
+        if (factoryFunction)
+          instance = factoryFunction();
         if (instance != nullptr)
           return std::shared_ptr<IBGS>(instance);
         else
           return nullptr;
       }
 
+      // Same as Create, but returns one of the instances built beforehand
+      // by Prewarm when there is one left.
+      std::shared_ptr<IBGS> Acquire(std::string name) {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          auto it = instancePool.find(name);
+          if (it != instancePool.end() && !it->second.empty()) {
+            std::shared_ptr<IBGS> instance = it->second.back();
+            it->second.pop_back();
+            return instance;
+          }
+        }
+        return Create(name);
+      }
+
+      // Builds count instances of the algorithm ahead of time (and so reads
+      // its config file), returns false if the name is not registered.
+      bool Prewarm(std::string name, size_t count) {
+        std::vector<std::shared_ptr<IBGS>> instances;
+        instances.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+          std::shared_ptr<IBGS> instance = Create(name);
+          if (!instance)
+            return false;
+          instances.push_back(instance);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        auto &pool = instancePool[name];
+        pool.insert(pool.end(), instances.begin(), instances.end());
+        return true;
+      }
+
+      size_t PooledCount(std::string name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = instancePool.find(name);
+        return it != instancePool.end() ? it->second.size() : 0;
+      }
+
+      void ClearPool() {
+        std::lock_guard<std::mutex> lock(mutex);
+        instancePool.clear();
+      }
+
       std::vector<std::string> GetRegisteredAlgorithmsName() {
+        std::lock_guard<std::mutex> lock(mutex);
         std::vector<std::string> algorithmsName;
         for (auto it = factoryFunctionRegistry.begin(); it != factoryFunctionRegistry.end(); ++it) {
           algorithmsName.push_back(it->first);
@@ -129,11 +279,16 @@ namespace bgslibrary
       void RegisterFactoryFunction(std::string name,
         std::function<IBGS*(void)> classFactoryFunction) {
         // register the class factory function
+        std::lock_guard<std::mutex> lock(mutex);
         factoryFunctionRegistry[name] = classFactoryFunction;
       }
       
     private:
+      std::mutex mutex;
       std::map<std::string, std::function<IBGS*(void)>> factoryFunctionRegistry;
+      // instances are handed out once and never returned: the algorithms
+      // cannot reset their model, so a used instance is not reusable
+      std::map<std::string, std::vector<std::shared_ptr<IBGS>>> instancePool;
     };
 
     template<class T>
@@ -4,6 +4,115 @@ using namespace bgslibrary::algorithms::imbs;
 using namespace std;
 using namespace cv;
 
+// Create a HSV pixel from the RGB pixel using the full 8-bits, since OpenCV only allows Hues up to 180 instead of 255.
+// ref: "http://cs.haifa.ac.il/hagit/courses/ist/Lectures/Demos/ColorApplet2/t_convert.html"
+static Vec3b convertPixelRGBtoHSV(const Vec3b& pixelRGB)
+{
+  float fR, fG, fB;
+  float fH, fS, fV;
+  const float FLOAT_TO_BYTE = 255.0f;
+  const float BYTE_TO_FLOAT = 1.0f / FLOAT_TO_BYTE;
+
+  // Get the RGB pixel components. NOTE that OpenCV stores RGB pixels in B,G,R order.
+  int bB = pixelRGB[0];	// Blue component
+  int bG = pixelRGB[1];	// Green component
+  int bR = pixelRGB[2];	// Red component
+
+  // Convert from 8-bit integers to floats.
+  fR = bR * BYTE_TO_FLOAT;
+  fG = bG * BYTE_TO_FLOAT;
+  fB = bB * BYTE_TO_FLOAT;
+
+  // Convert from RGB to HSV, using float ranges 0.0 to 1.0.
+  float fDelta;
+  float fMin, fMax;
+  int iMax;
+  // Get the min and max, but use integer comparisons for slight speedup.
+  if (bB < bG) {
+    if (bB < bR) {
+      fMin = fB;
+      if (bR > bG) {
+        iMax = bR;
+        fMax = fR;
+      }
+      else {
+        iMax = bG;
+        fMax = fG;
+      }
+    }
+    else {
+      fMin = fR;
+      fMax = fG;
+      iMax = bG;
+    }
+  }
+  else {
+    if (bG < bR) {
+      fMin = fG;
+      if (bB > bR) {
+        fMax = fB;
+        iMax = bB;
+      }
+      else {
+        fMax = fR;
+        iMax = bR;
+      }
+    }
+    else {
+      fMin = fR;
+      fMax = fB;
+      iMax = bB;
+    }
+  }
+  fDelta = fMax - fMin;
+  fV = fMax;				// Value (Brightness).
+  if (iMax != 0) {			// Make sure its not pure black.
+    fS = fDelta / fMax;		// Saturation.
+    float ANGLE_TO_UNIT = 1.0f / (6.0f * fDelta);	// Make the Hues between 0.0 to 1.0 instead of 6.0
+    if (iMax == bR) {		// between yellow and magenta.
+      fH = (fG - fB) * ANGLE_TO_UNIT;
+    }
+    else if (iMax == bG) {		// between cyan and yellow.
+      fH = (2.0f / 6.0f) + (fB - fR) * ANGLE_TO_UNIT;
+    }
+    else {				// between magenta and cyan.
+      fH = (4.0f / 6.0f) + (fR - fG) * ANGLE_TO_UNIT;
+    }
+    // Wrap outlier Hues around the circle.
+    if (fH < 0.0f)
+      fH += 1.0f;
+    if (fH >= 1.0f)
+      fH -= 1.0f;
+  }
+  else {
+    // color is pure Black.
+    fS = 0;
+    fH = 0;	// undefined hue
+  }
+
+  // Convert from floats to 8-bit integers.
+  int bH = (int)(0.5f + fH * 255.0f);
+  int bS = (int)(0.5f + fS * 255.0f);
+  int bV = (int)(0.5f + fV * 255.0f);
+
+  // Clip the values to make sure it fits within the 8bits.
+  if (bH > 255)
+    bH = 255;
+  if (bH < 0)
+    bH = 0;
+  if (bS > 255)
+    bS = 255;
+  if (bS < 0)
+    bS = 0;
+  if (bV > 255)
+    bV = 255;
+  if (bV < 0)
+    bV = 0;
+
+  // Set the HSV pixel components.
+  return Vec3b((uchar)bH, (uchar)bS, (uchar)bV);
+}
+
 BackgroundSubtractorIMBS::BackgroundSubtractorIMBS()
 {
   fps = 0.;
@@ -18,15 +127,16 @@ BackgroundSubtractorIMBS::BackgroundSubtractorIMBS()
   tau_h = 40;
   minArea = 30.;
   nframes = 0;
-  bgBins = NULL;
-  bgModel = NULL;
-  persistenceMap = NULL;
+  pixelStride = 0;
+  sampleCapacity = 0;
   persistencePeriod = samplingPeriod*numSamples / 3.;//ms
 
   initial_tick_count = (double)getTickCount();
 
   //morphological Opening and closing
   morphologicalFiltering = false;
+
+  parallelBands = 1;
 }
 
 BackgroundSubtractorIMBS::BackgroundSubtractorIMBS(
@@ -63,9 +173,8 @@ BackgroundSubtractorIMBS::BackgroundSubtractorIMBS(
   this->tau_h = tau_h;
   this->minArea = minArea;
   nframes = 0;
-  bgBins = NULL;
-  bgModel = NULL;
-  persistenceMap = NULL;
+  pixelStride = 0;
+  sampleCapacity = 0;
 
   if (fps == 0.)
     initial_tick_count = (double)getTickCount();
@@ -74,13 +183,12 @@ BackgroundSubtractorIMBS::BackgroundSubtractorIMBS(
 
   //morphological Opening and closing
   this->morphologicalFiltering = morphologicalFiltering;
+
+  parallelBands = 1;
 }
 
 BackgroundSubtractorIMBS::~BackgroundSubtractorIMBS()
 {
-  delete[] bgBins;
-  delete[] bgModel;
-  delete[] persistenceMap;
 }
 
 void BackgroundSubtractorIMBS::initialize(Size frameSize, int frameType)
@@ -93,13 +201,8 @@ void BackgroundSubtractorIMBS::initialize(Size frameSize, int frameType)
   this->frameType = frameType;
   this->numPixels = frameSize.width*frameSize.height;
 
-  persistenceMap = new unsigned int[numPixels];
-  for (unsigned int i = 0; i < numPixels; i++) {
-    persistenceMap[i] = 0;
-  }
+  persistenceMap.assign(numPixels, 0);
 
-  bgBins = new Bins[numPixels];
-  bgModel = new BgModel[numPixels];
   maxBgBins = numSamples / minBinHeight;
 
   timestamp = 0.;//ms
@@ -135,11 +238,25 @@ void BackgroundSubtractorIMBS::initialize(Size frameSize, int frameType)
     minBinHeight = 1;
   }
 
-  for (unsigned int p = 0; p < numPixels; ++p)
-  {
-    bgBins[p].initialize(numSamples);
-    bgModel[p].initialize(maxBgBins);
+  //one record per pixel for its bins and its model (all invalid)
+  sampleCapacity = numSamples;
+  pixelStride = 5 * sampleCapacity + 6 * maxBgBins;
+  const bool allocated = pool.allocate(numPixels * pixelStride);
+  CV_Assert(allocated);
+  std::fill(pool.data(), pool.data() + pool.size(), (uchar)0);
+
+  int bands = parallelBands > 0 ? parallelBands : (int)ThreadPool::defaultNumThreads();
+  if (bands > 1) {
+    if (!bandThreadPool || (int)bandThreadPool->size() != bands - 1)
+      bandThreadPool.reset(new ThreadPool(bands - 1));
   }
+  else
+    bandThreadPool.reset();
+}
+
+size_t BackgroundSubtractorIMBS::getModelSize() const
+{
+  return pool.bytes() + persistenceMap.capacity() * sizeof(unsigned int);
 }
 
 void BackgroundSubtractorIMBS::apply(InputArray _frame, OutputArray _fgmask, double learningRate)
@@ -175,7 +292,7 @@ void BackgroundSubtractorIMBS::apply(InputArray _frame, OutputArray _fgmask, dou
   }
 
   //wait for the first model to be generated
-  if (bgModel[0].isValid[0]) {
+  if (getModel(0).isValid[0]) {
     getFg();
     hsvSuppression();
     filterFg();
@@ -184,7 +301,7 @@ void BackgroundSubtractorIMBS::apply(InputArray _frame, OutputArray _fgmask, dou
   updateBg();
 
   //show an initial message if the first bg is not yet ready
-  if (!bgModel[0].isValid[0]) {
+  if (!getModel(0).isValid[0]) {
     initialMsgGray.copyTo(fgmask);
     initialMsgRGB.copyTo(bgImage);
   }
@@ -224,55 +341,50 @@ double BackgroundSubtractorIMBS::getTimestamp() {
 }
 
 void BackgroundSubtractorIMBS::hsvSuppression() {
+  bgslibrary::parallelBands(bandThreadPool.get(), numPixels, [&](unsigned int begin, unsigned int end) {
+    uchar h_i, s_i, v_i;
+    uchar h_b, s_b, v_b;
+    float h_diff, s_diff, v_ratio;
+
+    for (unsigned int p = begin; p < end; ++p) {
+      if (fgmask.data[p]) {
+
+        Vec3b hsv_i = convertPixelRGBtoHSV(frame.at<Vec3b>(p / frameSize.width, p % frameSize.width));
+        h_i = hsv_i[0];
+        s_i = hsv_i[1];
+        v_i = hsv_i[2];
+
+        Model model = getModel(p);
+        for (unsigned int n = 0; n < maxBgBins; ++n) {
+          if (!model.isValid[n]) {
+            break;
+          }
 
-  uchar h_i, s_i, v_i;
-  uchar h_b, s_b, v_b;
-  float h_diff, s_diff, v_ratio;
-
-  Mat bgrPixel(cv::Size(1, 1), CV_8UC3);
-
-  vector<Mat> imHSV;
-  cv::split(convertImageRGBtoHSV(frame), imHSV);
-
-  for (unsigned int p = 0; p < numPixels; ++p) {
-    if (fgmask.data[p]) {
-
-      h_i = imHSV[0].data[p];
-      s_i = imHSV[1].data[p];
-      v_i = imHSV[2].data[p];
-
-      for (unsigned int n = 0; n < maxBgBins; ++n) {
-        if (!bgModel[p].isValid[n]) {
-          break;
-        }
-
-        if (bgModel[p].isFg[n]) {
-          continue;
-        }
-
-        bgrPixel.at<cv::Vec3b>(0, 0) = bgModel[p].values[n];
-
-        cv::Mat hsvPixel = convertImageRGBtoHSV(bgrPixel);
-
-        h_b = hsvPixel.at<cv::Vec3b>(0, 0)[0];
-        s_b = hsvPixel.at<cv::Vec3b>(0, 0)[1];
-        v_b = hsvPixel.at<cv::Vec3b>(0, 0)[2];
-
-        v_ratio = (float)v_i / (float)v_b;
-        s_diff = std::abs(s_i - s_b);
-        h_diff = std::min(std::abs(h_i - h_b), 255 - std::abs(h_i - h_b));
+          if (model.isFg[n]) {
+            continue;
+          }
 
-        if (h_diff <= tau_h &&
-          s_diff <= tau_s &&
-          v_ratio >= alpha &&
-          v_ratio < beta)
-        {
-          fgmask.data[p] = SHADOW_LABEL;
-          break;
-        }
-      }//for
-    }//if
-  }//numPixels
+          Vec3b hsv_b = convertPixelRGBtoHSV(model.values[n]);
+          h_b = hsv_b[0];
+          s_b = hsv_b[1];
+          v_b = hsv_b[2];
+
+          v_ratio = (float)v_i / (float)v_b;
+          s_diff = std::abs(s_i - s_b);
+          h_diff = std::min(std::abs(h_i - h_b), 255 - std::abs(h_i - h_b));
+
+          if (h_diff <= tau_h &&
+            s_diff <= tau_s &&
+            v_ratio >= alpha &&
+            v_ratio < beta)
+          {
+            fgmask.data[p] = SHADOW_LABEL;
+            break;
+          }
+        }//for
+      }//if
+    }//pixels of the band
+  });
 }
 
 void BackgroundSubtractorIMBS::createBg(unsigned int bg_sample_number) {
@@ -283,126 +395,130 @@ void BackgroundSubtractorIMBS::createBg(unsigned int bg_sample_number) {
     //TODO vedere gestione errori
     abort();
   }
-  //aux variable
-  Vec3b currentPixel;
   //split bgSample in channels
   cv::split(bgSample, bgSampleBGR);
   //create a statistical model for each pixel (a set of bins of variable size)
-  for (unsigned int p = 0; p < numPixels; ++p) {
-    //create an initial bin for each pixel from the first sample (bg_sample_number = 0)
-    if (bg_sample_number == 0) {
-      for (int k = 0; k < 3; ++k) {
-        bgBins[p].binValues[0][k] = bgSampleBGR[k].data[p];
-      }
-      bgBins[p].binHeights[0] = 1;
-      for (unsigned int s = 1; s < numSamples; ++s) {
-        bgBins[p].binHeights[s] = 0;
-      }
-      //if the sample pixel is from foreground keep track of that situation
-      if (fgmask.data[p] == FOREGROUND_LABEL) {
-        bgBins[p].isFg[0] = true;
-      }
-      else {
-        bgBins[p].isFg[0] = false;
-      }
-    }//if(bg_sample_number == 0)
-    else { //bg_sample_number > 0
-      for (int k = 0; k < 3; ++k) {
-        currentPixel[k] = bgSampleBGR[k].data[p];
-      }
-      int den = 0;
-      for (unsigned int s = 0; s < bg_sample_number; ++s) {
-        //try to associate the current pixel values to an existing bin
-        if (std::abs(currentPixel[2] - bgBins[p].binValues[s][2]) <= associationThreshold &&
-          std::abs(currentPixel[1] - bgBins[p].binValues[s][1]) <= associationThreshold &&
-          std::abs(currentPixel[0] - bgBins[p].binValues[s][0]) <= associationThreshold)
-        {
-          den = (bgBins[p].binHeights[s] + 1);
-          for (int k = 0; k < 3; ++k) {
-            bgBins[p].binValues[s][k] =
-              (bgBins[p].binValues[s][k] * bgBins[p].binHeights[s] + currentPixel[k]) / den;
-          }
-          bgBins[p].binHeights[s]++; //increment the height of the bin
-          if (fgmask.data[p] == FOREGROUND_LABEL) {
-            bgBins[p].isFg[s] = true;
-          }
-          break;
+  bgslibrary::parallelBands(bandThreadPool.get(), numPixels, [&](unsigned int begin, unsigned int end) {
+    //aux variable
+    Vec3b currentPixel;
+    for (unsigned int p = begin; p < end; ++p) {
+      Bins bins = getBins(p);
+      Model model = getModel(p);
+      //create an initial bin for each pixel from the first sample (bg_sample_number = 0)
+      if (bg_sample_number == 0) {
+        for (int k = 0; k < 3; ++k) {
+          bins.binValues[0][k] = bgSampleBGR[k].data[p];
         }
-        //if the association is not possible, create a new bin
-        else if (bgBins[p].binHeights[s] == 0) {
-          bgBins[p].binValues[s] = currentPixel;
-          bgBins[p].binHeights[s]++;
-          if (fgmask.data[p] == FOREGROUND_LABEL) {
-            bgBins[p].isFg[s] = true;
-          }
-          else {
-            bgBins[p].isFg[s] = false;
-          }
-          break;
+        bins.binHeights[0] = 1;
+        for (unsigned int s = 1; s < numSamples; ++s) {
+          bins.binHeights[s] = 0;
+        }
+        //if the sample pixel is from foreground keep track of that situation
+        if (fgmask.data[p] == FOREGROUND_LABEL) {
+          bins.isFg[0] = true;
         }
-        else continue;
-      }//for(unsigned int s = 0; s <= bg_sample_number; ++s)
-
-      //if all samples have been processed
-      //it is time to compute the fg mask
-      if (bg_sample_number == (numSamples - 1)) {
-        unsigned int index = 0;
-        int max_height = -1;
-        for (unsigned int s = 0; s < numSamples; ++s) {
-          if (bgBins[p].binHeights[s] == 0) {
-            bgModel[p].isValid[index] = false;
+        else {
+          bins.isFg[0] = false;
+        }
+      }//if(bg_sample_number == 0)
+      else { //bg_sample_number > 0
+        for (int k = 0; k < 3; ++k) {
+          currentPixel[k] = bgSampleBGR[k].data[p];
+        }
+        int den = 0;
+        for (unsigned int s = 0; s < bg_sample_number; ++s) {
+          //try to associate the current pixel values to an existing bin
+          if (std::abs(currentPixel[2] - bins.binValues[s][2]) <= associationThreshold &&
+            std::abs(currentPixel[1] - bins.binValues[s][1]) <= associationThreshold &&
+            std::abs(currentPixel[0] - bins.binValues[s][0]) <= associationThreshold)
+          {
+            den = (bins.binHeights[s] + 1);
+            for (int k = 0; k < 3; ++k) {
+              bins.binValues[s][k] =
+                (bins.binValues[s][k] * bins.binHeights[s] + currentPixel[k]) / den;
+            }
+            bins.binHeights[s]++; //increment the height of the bin
+            if (fgmask.data[p] == FOREGROUND_LABEL) {
+              bins.isFg[s] = true;
+            }
             break;
           }
-          if (index == maxBgBins) {
+          //if the association is not possible, create a new bin
+          else if (bins.binHeights[s] == 0) {
+            bins.binValues[s] = currentPixel;
+            bins.binHeights[s]++;
+            if (fgmask.data[p] == FOREGROUND_LABEL) {
+              bins.isFg[s] = true;
+            }
+            else {
+              bins.isFg[s] = false;
+            }
             break;
           }
-          else if (bgBins[p].binHeights[s] >= minBinHeight) {
-            if (fgmask.data[p] == PERSISTENCE_LABEL) {
-              for (unsigned int n = 0; n < maxBgBins; n++) {
-                if (!bgModel[p].isValid[n]) {
-                  break;
-                }
-                unsigned int d = std::max((int)std::abs(bgModel[p].values[n][0] - bgBins[p].binValues[s][0]),
-                  std::abs(bgModel[p].values[n][1] - bgBins[p].binValues[s][1]));
-                d = std::max((int)d, std::abs(bgModel[p].values[n][2] - bgBins[p].binValues[s][2]));
-                if (d < fgThreshold) {
-                  bgModel[p].isFg[n] = false;
-                  bgBins[p].isFg[s] = false;
+          else continue;
+        }//for(unsigned int s = 0; s <= bg_sample_number; ++s)
+
+        //if all samples have been processed
+        //it is time to compute the fg mask
+        if (bg_sample_number == (numSamples - 1)) {
+          unsigned int index = 0;
+          int max_height = -1;
+          for (unsigned int s = 0; s < numSamples; ++s) {
+            if (bins.binHeights[s] == 0) {
+              model.isValid[index] = false;
+              break;
+            }
+            if (index == maxBgBins) {
+              break;
+            }
+            else if (bins.binHeights[s] >= minBinHeight) {
+              if (fgmask.data[p] == PERSISTENCE_LABEL) {
+                for (unsigned int n = 0; n < maxBgBins; n++) {
+                  if (!model.isValid[n]) {
+                    break;
+                  }
+                  unsigned int d = std::max((int)std::abs(model.values[n][0] - bins.binValues[s][0]),
+                    std::abs(model.values[n][1] - bins.binValues[s][1]));
+                  d = std::max((int)d, std::abs(model.values[n][2] - bins.binValues[s][2]));
+                  if (d < fgThreshold) {
+                    model.isFg[n] = false;
+                    bins.isFg[s] = false;
+                  }
                 }
               }
-            }
 
-            if (bgBins[p].binHeights[s] > max_height) {
-              max_height = bgBins[p].binHeights[s];
+              if (bins.binHeights[s] > max_height) {
+                max_height = bins.binHeights[s];
 
-              for (int k = 0; k < 3; ++k) {
-                bgModel[p].values[index][k] = bgModel[p].values[0][k];
-              }
-              bgModel[p].isValid[index] = true;
-              bgModel[p].isFg[index] = bgModel[p].isFg[0];
-              bgModel[p].counter[index] = bgModel[p].counter[0];
+                for (int k = 0; k < 3; ++k) {
+                  model.values[index][k] = model.values[0][k];
+                }
+                model.isValid[index] = true;
+                model.isFg[index] = model.isFg[0];
+                model.counter[index] = model.counter[0];
 
-              for (int k = 0; k < 3; ++k) {
-                bgModel[p].values[0][k] = bgBins[p].binValues[s][k];
+                for (int k = 0; k < 3; ++k) {
+                  model.values[0][k] = bins.binValues[s][k];
+                }
+                model.isValid[0] = true;
+                model.isFg[0] = bins.isFg[s];
+                model.counter[0] = bins.binHeights[s];
               }
-              bgModel[p].isValid[0] = true;
-              bgModel[p].isFg[0] = bgBins[p].isFg[s];
-              bgModel[p].counter[0] = bgBins[p].binHeights[s];
-            }
-            else {
-              for (int k = 0; k < 3; ++k) {
-                bgModel[p].values[index][k] = bgBins[p].binValues[s][k];
+              else {
+                for (int k = 0; k < 3; ++k) {
+                  model.values[index][k] = bins.binValues[s][k];
+                }
+                model.isValid[index] = true;
+                model.isFg[index] = bins.isFg[s];
+                model.counter[index] = bins.binHeights[s];
               }
-              bgModel[p].isValid[index] = true;
-              bgModel[p].isFg[index] = bgBins[p].isFg[s];
-              bgModel[p].counter[index] = bgBins[p].binHeights[s];
+              ++index;
             }
-            ++index;
-          }
-        } //for all numSamples
-      }//bg_sample_number == (numSamples - 1)
-    }//else --> if(frame_number == 0)
-  }//numPixels
+          } //for all numSamples
+        }//bg_sample_number == (numSamples - 1)
+      }//else --> if(frame_number == 0)
+    }//pixels of the band
+  });
 
   if (bg_sample_number == (numSamples - 1)) {
     //std::cout << "new bg created" << std::endl;
@@ -411,6 +527,10 @@ void BackgroundSubtractorIMBS::createBg(unsigned int bg_sample_number) {
     bg_reset = false;
     if (sudden_change) {
       numSamples *= 2.;
+      //the pool holds the bins of sampleCapacity samples per pixel
+      if (numSamples > sampleCapacity) {
+        numSamples = sampleCapacity;
+      }
       samplingPeriod *= 2.;
       sudden_change = false;
     }
@@ -422,7 +542,7 @@ void BackgroundSubtractorIMBS::createBg(unsigned int bg_sample_number) {
     unsigned int p = 0;
     for (int i = 0; i < bgImage.rows; ++i) {
       for (int j = 0; j < bgImage.cols; ++j, ++p) {
-        bgImage.at<cv::Vec3b>(i, j) = bgModel[p].values[0];
+        bgImage.at<cv::Vec3b>(i, j) = getModel(p).values[0];
       }
     }
   }
@@ -432,59 +552,62 @@ void BackgroundSubtractorIMBS::getFg() {
   fgmask = Scalar(0);
   cv::split(frame, frameBGR);
 
-  bool isFg = true;
-  bool conditionalUpdated = false;
-  unsigned int d = 0;
-  for (unsigned int p = 0; p < numPixels; ++p) {
-    isFg = true;
-    conditionalUpdated = false;
-    d = 0;
-    for (unsigned int n = 0; n < maxBgBins; ++n) {
-      if (!bgModel[p].isValid[n]) {
-        if (n == 0) {
-          isFg = false;
-        }
-        break;
-      }
-      else { //the model is valid
-        d = std::max(
-          (int)std::abs(bgModel[p].values[n][0] - frameBGR[0].data[p]),
-          std::abs(bgModel[p].values[n][1] - frameBGR[1].data[p]));
-        d = std::max(
-          (int)d, std::abs(bgModel[p].values[n][2] - frameBGR[2].data[p]));
-        if (d < fgThreshold) {
-          //check if it is a potential background pixel
-          //from stationary object
-          if (bgModel[p].isFg[n]) {
-            conditionalUpdated = true;
-            break;
-          }
-          else {
+  bgslibrary::parallelBands(bandThreadPool.get(), numPixels, [&](unsigned int begin, unsigned int end) {
+    bool isFg = true;
+    bool conditionalUpdated = false;
+    unsigned int d = 0;
+    for (unsigned int p = begin; p < end; ++p) {
+      Model model = getModel(p);
+      isFg = true;
+      conditionalUpdated = false;
+      d = 0;
+      for (unsigned int n = 0; n < maxBgBins; ++n) {
+        if (!model.isValid[n]) {
+          if (n == 0) {
             isFg = false;
-            persistenceMap[p] = 0;
           }
+          break;
         }
-      }
-    }
-    if (isFg) {
-      if (conditionalUpdated) {
-        fgmask.data[p] = PERSISTENCE_LABEL;
-        persistenceMap[p] += (timestamp - prev_timestamp);
-        if (persistenceMap[p] > persistencePeriod) {
-          for (unsigned int n = 0; n < maxBgBins; ++n) {
-            if (!bgModel[p].isValid[n]) {
+        else { //the model is valid
+          d = std::max(
+            (int)std::abs(model.values[n][0] - frameBGR[0].data[p]),
+            std::abs(model.values[n][1] - frameBGR[1].data[p]));
+          d = std::max(
+            (int)d, std::abs(model.values[n][2] - frameBGR[2].data[p]));
+          if (d < fgThreshold) {
+            //check if it is a potential background pixel
+            //from stationary object
+            if (model.isFg[n]) {
+              conditionalUpdated = true;
               break;
             }
-            bgModel[p].isFg[n] = false;
+            else {
+              isFg = false;
+              persistenceMap[p] = 0;
+            }
           }
         }
       }
-      else {
-        fgmask.data[p] = FOREGROUND_LABEL;
-        persistenceMap[p] = 0;
+      if (isFg) {
+        if (conditionalUpdated) {
+          fgmask.data[p] = PERSISTENCE_LABEL;
+          persistenceMap[p] += (timestamp - prev_timestamp);
+          if (persistenceMap[p] > persistencePeriod) {
+            for (unsigned int n = 0; n < maxBgBins; ++n) {
+              if (!model.isValid[n]) {
+                break;
+              }
+              model.isFg[n] = false;
+            }
+          }
+        }
+        else {
+          fgmask.data[p] = FOREGROUND_LABEL;
+          persistenceMap[p] = 0;
+        }
       }
     }
-  }
+  });
 }
 
 void BackgroundSubtractorIMBS::areaThresholding()
@@ -516,137 +639,6 @@ void BackgroundSubtractorIMBS::areaThresholding()
   }
 }
 
-// Create a HSV image from the RGB image using the full 8-bits, since OpenCV only allows Hues up to 180 instead of 255.
-// ref: "http://cs.haifa.ac.il/hagit/courses/ist/Lectures/Demos/ColorApplet2/t_convert.html"
-// Remember to free the generated HSV image.
-Mat BackgroundSubtractorIMBS::convertImageRGBtoHSV(const Mat& imageRGB)
-{
-  float fR, fG, fB;
-  float fH, fS, fV;
-  const float FLOAT_TO_BYTE = 255.0f;
-  const float BYTE_TO_FLOAT = 1.0f / FLOAT_TO_BYTE;
-
-  // Create a blank HSV image
-  Mat imageHSV(imageRGB.size(), CV_8UC3);
-  //if (!imageHSV || imageRGB->depth != 8 || imageRGB->nChannels != 3) {
-  //printf("ERROR in convertImageRGBtoHSV()! Bad input image.\n");
-  //exit(1);
-  //}
-
-  int h = imageRGB.rows;		// Pixel height.
-  int w = imageRGB.cols;		// Pixel width.
-  //int rowSizeRGB = imageRGB->widthStep;	// Size of row in bytes, including extra padding.
-  //char *imRGB = imageRGB->imageData;	// Pointer to the start of the image pixels.
-  //int rowSizeHSV = imageHSV->widthStep;	// Size of row in bytes, including extra padding.
-  //char *imHSV = imageHSV->imageData;	// Pointer to the start of the image pixels.
-  for (int y = 0; y < h; ++y) {
-    for (int x = 0; x < w; ++x) {
-      // Get the RGB pixel components. NOTE that OpenCV stores RGB pixels in B,G,R order.
-      //uchar *pRGB = (uchar*)(imRGB + y*rowSizeRGB + x*3);
-      int bB = imageRGB.at<Vec3b>(y, x)[0]; //*(uchar*)(pRGB+0);	// Blue component
-      int bG = imageRGB.at<Vec3b>(y, x)[1]; //*(uchar*)(pRGB+1);	// Green component
-      int bR = imageRGB.at<Vec3b>(y, x)[2]; //*(uchar*)(pRGB+2);	// Red component
-
-      // Convert from 8-bit integers to floats.
-      fR = bR * BYTE_TO_FLOAT;
-      fG = bG * BYTE_TO_FLOAT;
-      fB = bB * BYTE_TO_FLOAT;
-
-      // Convert from RGB to HSV, using float ranges 0.0 to 1.0.
-      float fDelta;
-      float fMin, fMax;
-      int iMax;
-      // Get the min and max, but use integer comparisons for slight speedup.
-      if (bB < bG) {
-        if (bB < bR) {
-          fMin = fB;
-          if (bR > bG) {
-            iMax = bR;
-            fMax = fR;
-          }
-          else {
-            iMax = bG;
-            fMax = fG;
-          }
-        }
-        else {
-          fMin = fR;
-          fMax = fG;
-          iMax = bG;
-        }
-      }
-      else {
-        if (bG < bR) {
-          fMin = fG;
-          if (bB > bR) {
-            fMax = fB;
-            iMax = bB;
-          }
-          else {
-            fMax = fR;
-            iMax = bR;
-          }
-        }
-        else {
-          fMin = fR;
-          fMax = fB;
-          iMax = bB;
-        }
-      }
-      fDelta = fMax - fMin;
-      fV = fMax;				// Value (Brightness).
-      if (iMax != 0) {			// Make sure its not pure black.
-        fS = fDelta / fMax;		// Saturation.
-        float ANGLE_TO_UNIT = 1.0f / (6.0f * fDelta);	// Make the Hues between 0.0 to 1.0 instead of 6.0
-        if (iMax == bR) {		// between yellow and magenta.
-          fH = (fG - fB) * ANGLE_TO_UNIT;
-        }
-        else if (iMax == bG) {		// between cyan and yellow.
-          fH = (2.0f / 6.0f) + (fB - fR) * ANGLE_TO_UNIT;
-        }
-        else {				// between magenta and cyan.
-          fH = (4.0f / 6.0f) + (fR - fG) * ANGLE_TO_UNIT;
-        }
-        // Wrap outlier Hues around the circle.
-        if (fH < 0.0f)
-          fH += 1.0f;
-        if (fH >= 1.0f)
-          fH -= 1.0f;
-      }
-      else {
-        // color is pure Black.
-        fS = 0;
-        fH = 0;	// undefined hue
-      }
-
-      // Convert from floats to 8-bit integers.
-      int bH = (int)(0.5f + fH * 255.0f);
-      int bS = (int)(0.5f + fS * 255.0f);
-      int bV = (int)(0.5f + fV * 255.0f);
-
-      // Clip the values to make sure it fits within the 8bits.
-      if (bH > 255)
-        bH = 255;
-      if (bH < 0)
-        bH = 0;
-      if (bS > 255)
-        bS = 255;
-      if (bS < 0)
-        bS = 0;
-      if (bV > 255)
-        bV = 255;
-      if (bV < 0)
-        bV = 0;
-
-      // Set the HSV pixel components.
-      imageHSV.at<Vec3b>(y, x)[0] = bH;		// H component
-      imageHSV.at<Vec3b>(y, x)[1] = bS;		// S component
-      imageHSV.at<Vec3b>(y, x)[2] = bV;		// V component
-    }
-  }
-  return imageHSV;
-}
-
 void BackgroundSubtractorIMBS::getBackgroundImage(OutputArray backgroundImage) const
 {
   bgImage.copyTo(backgroundImage);
@@ -718,14 +710,15 @@ void BackgroundSubtractorIMBS::getBgModel(BgModel bgModel_copy[], unsigned int s
     bgModel_copy[i].counter = new uchar[maxBgBins];
   }
   for (unsigned int p = 0; p < numPixels; ++p) {
+    Model model = getModel(p);
     for (unsigned int n = 0; n < maxBgBins; ++n) {
-      if (!bgModel[p].isValid[n]) {
+      if (!model.isValid[n]) {
         break;
       }
-      bgModel_copy[p].values[n] = bgModel[p].values[n];
-      bgModel_copy[p].isValid[n] = bgModel[p].isValid[n];
-      bgModel_copy[p].isFg[n] = bgModel[p].isFg[n];
-      bgModel_copy[p].counter[n] = bgModel[p].counter[n];
+      bgModel_copy[p].values[n] = model.values[n];
+      bgModel_copy[p].isValid[n] = model.isValid[n];
+      bgModel_copy[p].isFg[n] = model.isFg[n];
+      bgModel_copy[p].counter[n] = model.counter[n];
     }
   }
 }
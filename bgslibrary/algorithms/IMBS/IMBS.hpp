@@ -1,6 +1,8 @@
 #pragma once
 
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <vector>
 
 #include <opencv2/core/core.hpp>
@@ -14,6 +16,9 @@
 #include <opencv2/imgproc/types_c.h>
 #include <opencv2/imgproc/imgproc_c.h>
 
+#include "../../utils/AlignedBuffer.h"
+#include "../../utils/ThreadPool.h"
+
 namespace bgslibrary
 {
   namespace algorithms
@@ -51,6 +56,14 @@ namespace bgslibrary
         //! re-initiaization method
         void initialize(cv::Size frameSize, int frameType);
 
+        //! number of pixel bands processed concurrently (0: one per hardware thread), applied by initialize
+        void setParallelBands(int parallelBands) {
+          this->parallelBands = parallelBands;
+        }
+
+        //! bytes held by the bins, the background model and the persistence map
+        size_t getModelSize() const;
+
       private:
         //method for creating the background model
         void createBg(unsigned int bg_sample_number);
@@ -66,8 +79,6 @@ namespace bgslibrary
         void areaThresholding();
         //method for getting the current time
         double getTimestamp();
-        //method for converting from RGB to HSV
-        cv::Mat convertImageRGBtoHSV(const cv::Mat& imageRGB);
         //method for changing the bg in case of sudden changes
         void changeBg();
 
@@ -100,23 +111,37 @@ namespace bgslibrary
         cv::Mat initialMsgGray;
         cv::Mat initialMsgRGB;
 
-        //struct for modeling the background values for a single pixel
+        //bins of a single pixel (view of the pooled storage)
         typedef struct Bins {
-          void initialize(unsigned int numSamples) {
-            binValues = new cv::Vec3b[numSamples];
-            binHeights = new uchar[numSamples];
-            isFg = new bool[numSamples];
-          }
-          ~Bins() {
-            if (binValues)  { delete[] binValues; }
-            if (binHeights) { delete[] binHeights; }
-            if (isFg)       { delete[] isFg; }
-          }
           cv::Vec3b* binValues;
           uchar* binHeights;
           bool* isFg;
         } Bins;
-        Bins* bgBins;
+        //background model of a single pixel (view of the pooled storage)
+        typedef struct Model {
+          cv::Vec3b* values;
+          bool* isValid;
+          bool* isFg;
+          uchar* counter;
+        } Model;
+        //the bins and the model of all the pixels are stored in one pooled
+        //allocation, one record of pixelStride bytes per pixel: the bin
+        //values, heights and fg flags (sampleCapacity of each), followed by
+        //the model values, valid flags, fg flags and counters (maxBgBins of each)
+        AlignedBuffer<uchar> pool;
+        size_t pixelStride;
+        unsigned int sampleCapacity;
+
+        Bins getBins(unsigned int p) {
+          uchar* record = pool.data() + p * pixelStride;
+          Bins bins = { (cv::Vec3b*)record, record + 3 * sampleCapacity, (bool*)(record + 4 * sampleCapacity) };
+          return bins;
+        }
+        Model getModel(unsigned int p) {
+          uchar* record = pool.data() + p * pixelStride + 5 * sampleCapacity;
+          Model model = { (cv::Vec3b*)record, (bool*)(record + 3 * maxBgBins), (bool*)(record + 4 * maxBgBins), record + 5 * maxBgBins };
+          return model;
+        }
 
       public:
         //struct for modeling the background values for the entire frame
@@ -140,8 +165,6 @@ namespace bgslibrary
           uchar* counter;
         } BgModel;
       private:
-        BgModel* bgModel;
-
         //SHADOW SUPPRESSION PARAMETERS
         float alpha;
         float beta;
@@ -167,11 +190,15 @@ namespace bgslibrary
         uchar PERSISTENCE_LABEL;
         uchar FOREGROUND_LABEL;
         //persistence map
-        unsigned int* persistenceMap;
+        std::vector<unsigned int> persistenceMap;
         cv::Mat persistenceImage;
 
         bool morphologicalFiltering;
 
+        //parallel processing
+        int parallelBands;
+        std::unique_ptr<ThreadPool> bandThreadPool;
+
       public:
         unsigned int getMaxBgBins() {
           return maxBgBins;
@@ -3,11 +3,12 @@
 using namespace bgslibrary::algorithms;
 
 IndependentMultimodal::IndependentMultimodal() : 
-  IBGS(quote(IndependentMultimodal)), fps(10)
+  IBGS(quote(IndependentMultimodal)), fps(10), nParallelBands(1)
 {
   debug_construction(IndependentMultimodal);
   initLoadSaveConfig(algorithmName);
   pIMBS = new imbs::BackgroundSubtractorIMBS(fps);
+  pIMBS->setParallelBands(nParallelBands);
 }
 
 IndependentMultimodal::~IndependentMultimodal() {
@@ -38,12 +39,19 @@ void IndependentMultimodal::process(const cv::Mat &img_input, cv::Mat &img_outpu
   firstTime = false;
 }
 
+size_t IndependentMultimodal::getModelMemory() const
+{
+  return IBGS::getModelMemory() + pIMBS->getModelSize();
+}
+
 void IndependentMultimodal::save_config(cv::FileStorage &fs) {
   fs << "fps" << fps;
+  fs << "nParallelBands" << nParallelBands;
   fs << "showOutput" << showOutput;
 }
 
 void IndependentMultimodal::load_config(cv::FileStorage &fs) {
   fs["fps"] >> fps;
+  fs["nParallelBands"] >> nParallelBands;
   fs["showOutput"] >> showOutput;
 }
@@ -12,12 +12,14 @@ namespace bgslibrary
     private:
       imbs::BackgroundSubtractorIMBS* pIMBS;
       int fps;
+      int nParallelBands;
 
     public:
       IndependentMultimodal();
       ~IndependentMultimodal();
 
       void process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img_bgmodel);
+      size_t getModelMemory() const;
 
     private:
       void save_config(cv::FileStorage &fs);
@@ -6,7 +6,8 @@ KDE::KDE() :
   IBGS(quote(KDE)),
   SequenceLength(50), TimeWindowSize(100), 
   SDEstimationFlag(1), lUseColorRatiosFlag(1),
-  th(10e-8), alpha(0.3), framesToLearn(10), frameNumber(0)
+  th(10e-8), alpha(0.3), framesToLearn(10), frameNumber(0),
+  modelFile(""), saveModel(false)
 {
   debug_construction(KDE);
   initLoadSaveConfig(algorithmName);
@@ -15,6 +16,11 @@ KDE::KDE() :
 
 KDE::~KDE() {
   debug_destruction(KDE);
+  if (saveModel && frameNumber > framesToLearn) {
+    std::string fileName = modelFile.empty() ? "./" + algorithmName + ".npbg" : modelFile;
+    if (!p->SaveModel(fileName.c_str()))
+      std::cerr << algorithmName + " could not save the background model: " << fileName << std::endl;
+  }
   delete FGImage;
   delete p;
 }
@@ -47,6 +53,13 @@ void KDE::process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img_bg
     img_background = cv::Mat::zeros(img_input.size(), img_input.type());
 
     frameNumber = 0;
+    if (!modelFile.empty()) {
+      // a restored model skips the learning frames
+      if (p->LoadModel(modelFile.c_str()))
+        frameNumber = framesToLearn + 1;
+      else
+        std::cerr << algorithmName + " could not load the background model: " << modelFile << std::endl;
+    }
     firstTime = false;
   }
 
@@ -89,6 +102,8 @@ void KDE::save_config(cv::FileStorage &fs) {
   fs << "lUseColorRatiosFlag" << lUseColorRatiosFlag;
   fs << "th" << th;
   fs << "alpha" << alpha;
+  fs << "modelFile" << modelFile;
+  fs << "saveModel" << saveModel;
   fs << "showOutput" << showOutput;
 }
 
@@ -100,5 +115,7 @@ void KDE::load_config(cv::FileStorage &fs) {
   fs["lUseColorRatiosFlag"] >> lUseColorRatiosFlag;
   fs["th"] >> th;
   fs["alpha"] >> alpha;
+  fs["modelFile"] >> modelFile;
+  fs["saveModel"] >> saveModel;
   fs["showOutput"] >> showOutput;
 }
@@ -22,6 +22,10 @@ namespace bgslibrary
       double alpha;
       int framesToLearn;
       int frameNumber;
+      // model file restored instead of learning (when not empty), and
+      // written when the algorithm is destroyed (when saveModel is set)
+      std::string modelFile;
+      bool saveModel;
 
       unsigned char *FGImage;
       unsigned char *FilteredFGImage;
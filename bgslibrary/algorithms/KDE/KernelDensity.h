@@ -0,0 +1,99 @@
+#pragma once
+
+namespace bgslibrary
+{
+  namespace algorithms
+  {
+    namespace kde
+    {
+      // Kernel density sums of one pixel, used by NPBGSubtractor.
+      //
+      // The samples of the pixel are channel-planar: sample j of channel c is
+      // pSamples[c*SampleSize + j]. Each kernel points to the centre of the
+      // single precision kernel table row of the channel bandwidth (kernel[d]
+      // is the kernel value for a difference d in [-KERNELHALFWIDTH,
+      // KERNELHALFWIDTH]).
+      //
+      // The samples are accumulated in order until the sum reaches th, and the
+      // number of samples accumulated is returned in *pUsed. Most background
+      // pixels reach th within the first one or two samples.
+
+      // gray scale
+      inline float KernelDensityGray(const unsigned char *pSamples,
+        unsigned int SampleSize,
+        unsigned char value,
+        const float *kernel,
+        float th,
+        unsigned int *pUsed)
+      {
+        const int v = value;
+        float sum = 0;
+        unsigned int j = 0;
+
+        while (j < SampleSize && sum < th)
+        {
+          sum += kernel[pSamples[j] - v];
+          j++;
+        }
+        *pUsed = j;
+        return sum;
+      }
+
+      // RGB, product of the 3 channel kernels
+      inline float KernelDensityRGB(const unsigned char *pSamples,
+        unsigned int SampleSize,
+        const unsigned char *value,
+        const float *const *kernels,
+        float th,
+        unsigned int *pUsed)
+      {
+        const unsigned char *pSamples1 = pSamples + SampleSize;
+        const unsigned char *pSamples2 = pSamples1 + SampleSize;
+        const float *kernel0 = kernels[0] - value[0];
+        const float *kernel1 = kernels[1] - value[1];
+        const float *kernel2 = kernels[2] - value[2];
+        float sum = 0;
+        unsigned int j = 0;
+
+        while (j < SampleSize && sum < th)
+        {
+          sum += kernel0[pSamples[j]] * kernel1[pSamples1[j]] * kernel2[pSamples2[j]];
+          j++;
+        }
+        *pUsed = j;
+        return sum;
+      }
+
+      // color ratios (subset): product of the kernels of channels 1 and 2
+      // (kernels[1], kernels[2]), for the samples g of channel 0 such that
+      // lowerbound[g] < value[0] < upperbound[g]
+      inline float KernelDensityRatios(const unsigned char *pSamples,
+        unsigned int SampleSize,
+        const unsigned char *value,
+        const float *const *kernels,
+        const int *lowerbound,
+        const int *upperbound,
+        float th,
+        unsigned int *pUsed)
+      {
+        const unsigned char *pSamples1 = pSamples + SampleSize;
+        const unsigned char *pSamples2 = pSamples1 + SampleSize;
+        const float *kernel1 = kernels[1] - value[1];
+        const float *kernel2 = kernels[2] - value[2];
+        const int v = value[0];
+        float sum = 0;
+        unsigned int j = 0;
+
+        while (j < SampleSize && sum < th)
+        {
+          const unsigned char g = pSamples[j];
+          if (lowerbound[g] < v && v < upperbound[g])
+            sum += kernel1[pSamples1[j]] * kernel2[pSamples2[j]];
+          j++;
+        }
+        *pUsed = j;
+        return sum;
+      }
+    }
+  }
+}
@@ -15,8 +15,9 @@ KernelLUTable::KernelLUTable()
 
 KernelLUTable::~KernelLUTable()
 {
-  delete kerneltable;
-  delete kernelsums;
+  delete[] kerneltable;
+  delete[] kernelsums;
+  delete[] kerneltablef;
   std::cout << "~KernelLUTable()" << std::endl;
 }
 
@@ -37,6 +38,7 @@ KernelLUTable::KernelLUTable(int KernelHalfWidth, double Segmamin, double Segmam
   // allocate memory for the Kernal Table
   kerneltable = new double[segmabins*(2 * KernelHalfWidth + 1)];
   kernelsums = new double[segmabins];
+  kerneltablef = new float[segmabins*(2 * KernelHalfWidth + 1)];
 
   double segmastep = (maxsegma - minsegma) / segmabins;
   double y;
@@ -68,6 +70,10 @@ KernelLUTable::KernelLUTable(int KernelHalfWidth, double Segmamin, double Segmam
       v = kerneltable[b + KernelHalfWidth + x] / sum;
       kerneltable[b + KernelHalfWidth + x] = v;
       kerneltable[b + KernelHalfWidth - x] = v;
+      // values that small never matter against the thresholds, and dropping
+      // them keeps the products of 3 kernels out of the float denormals
+      kerneltablef[b + KernelHalfWidth + x] = (float)(v < 1e-12 ? 0 : v);
+      kerneltablef[b + KernelHalfWidth - x] = (float)(v < 1e-12 ? 0 : v);
     }
   }
 }
@@ -17,6 +17,8 @@ namespace bgslibrary
         int tablehalfwidth;
         double *kerneltable;
         double *kernelsums;
+        // same values as kerneltable, in single precision for the scoring kernels
+        float *kerneltablef;
 
       public:
         KernelLUTable();
@@ -1,8 +1,10 @@
 #include <assert.h>
 #include <math.h>
 #include <string.h>
+#include <fstream>
 
 #include "NPBGSubtractor.h"
+#include "KernelDensity.h"
 
 //#ifdef _DEBUG
 //#undef THIS_FILE
@@ -45,9 +47,9 @@ namespace bgslibrary
         }
       }
 
-      void UpdateDiffHist(unsigned char * image1, unsigned char * image2, DynamicMedianHistogram * pHist)
+      void UpdateDiffHist(unsigned char * pSamples, unsigned int SampleSize, DynamicMedianHistogram * pHist)
       {
-        unsigned int j;
+        unsigned int i, j;
         int bin, diff;
 
         unsigned int  imagesize = pHist->imagesize;
@@ -58,11 +60,16 @@ namespace bgslibrary
 
         for (j = 0; j < imagesize; j++)
         {
-          diff = (int)image1[j] - (int)image2[j];
-          diff = abs(diff);
-          // update histogram
-          bin = (diff < histbins ? diff : histbins_1);
-          pAbsDiffHist[j*histbins + bin]++;
+          // diffs between the consecutive samples of the pixel channel
+          for (i = 1; i < SampleSize; i++)
+          {
+            diff = (int)pSamples[i - 1] - (int)pSamples[i];
+            diff = abs(diff);
+            // update histogram
+            bin = (diff < histbins ? diff : histbins_1);
+            pAbsDiffHist[j*histbins + bin]++;
+          }
+          pSamples += SampleSize;
         }
       }
 
@@ -103,43 +110,35 @@ namespace bgslibrary
         }
       }
 
-      DynamicMedianHistogram BuildAbsDiffHist(unsigned char * pSequence,
-        unsigned int rows,
-        unsigned int cols,
-        unsigned int color_channels,
+      DynamicMedianHistogram AllocateAbsDiffHist(unsigned int imagesize,
         unsigned int SequenceLength,
         unsigned int histbins)
       {
-
-        unsigned int imagesize = rows*cols*color_channels;
-        unsigned int i;
-
         DynamicMedianHistogram Hist;
 
-        unsigned char *pAbsDiffHist = new unsigned char[rows*cols*color_channels*histbins];
-        unsigned char *pMedianBins = new unsigned char[rows*cols*color_channels];
-        unsigned char *pMedianFreq = new unsigned char[rows*cols*color_channels];
-        unsigned char *pAccSum = new unsigned char[rows*cols*color_channels];
-
-        memset(pAbsDiffHist, 0, rows*cols*color_channels*histbins);
-
-        Hist.Hist = pAbsDiffHist;
-        Hist.MedianBins = pMedianBins;
-        Hist.MedianFreq = pMedianFreq;
-        Hist.AccSum = pAccSum;
+        Hist.Hist = new unsigned char[imagesize*histbins];
+        Hist.MedianBins = new unsigned char[imagesize];
+        Hist.MedianFreq = new unsigned char[imagesize];
+        Hist.AccSum = new unsigned char[imagesize];
         Hist.histbins = histbins;
-        Hist.imagesize = rows*cols*color_channels;
+        Hist.imagesize = imagesize;
         Hist.histsum = SequenceLength - 1;
 
-        unsigned char *image1, *image2;
-        for (i = 1; i < SequenceLength; i++)
-        {
-          // find diff between frame i,i-1;
-          image1 = pSequence + (i - 1)*imagesize;
-          image2 = pSequence + (i)*imagesize;
+        return Hist;
+      }
 
-          UpdateDiffHist(image1, image2, &Hist);
-        }
+      DynamicMedianHistogram BuildAbsDiffHist(unsigned char * pSequence,
+        unsigned int rows,
+        unsigned int cols,
+        unsigned int color_channels,
+        unsigned int SequenceLength,
+        unsigned int histbins)
+      {
+        DynamicMedianHistogram Hist = AllocateAbsDiffHist(rows*cols*color_channels, SequenceLength, histbins);
+
+        memset(Hist.Hist, 0, rows*cols*color_channels*histbins);
+
+        UpdateDiffHist(pSequence, SequenceLength, &Hist);
 
         FindHistMedians(&Hist);
 
@@ -200,21 +199,29 @@ namespace bgslibrary
       // Construction/Destruction
       //////////////////////////////////////////////////////////////////////
 
-      NPBGSubtractor::NPBGSubtractor() {}
+      NPBGSubtractor::NPBGSubtractor()
+      {
+        imageindex = 0;
+        tempFrame = 0;
+        KernelTable = 0;
+        BGModel = 0;
+        memset(&AbsDiffHist, 0, sizeof(AbsDiffHist));
+        Pimage1 = 0;
+        Pimage2 = 0;
+      }
 
       NPBGSubtractor::~NPBGSubtractor()
       {
-        delete AbsDiffHist.Hist;
-        delete AbsDiffHist.MedianBins;
-        delete AbsDiffHist.MedianFreq;
-        delete AbsDiffHist.AccSum;
+        delete[] AbsDiffHist.Hist;
+        delete[] AbsDiffHist.MedianBins;
+        delete[] AbsDiffHist.MedianFreq;
+        delete[] AbsDiffHist.AccSum;
         delete KernelTable;
-        delete BGModel->SDbinsImage;
         delete BGModel;
-        delete Pimage1;
-        delete Pimage2;
-        delete tempFrame;
-        delete imageindex->List;
+        delete[] Pimage1;
+        delete[] Pimage2;
+        if (imageindex)
+          delete[] imageindex->List;
         delete imageindex;
       }
 
@@ -246,8 +253,6 @@ namespace bgslibrary
         Pimage1 = new double[rows*cols];
         Pimage2 = new double[rows*cols];
 
-        tempFrame = new unsigned char[rows*cols * 3];
-
         imageindex = new ImageIndex;
         imageindex->List = new unsigned int[rows*cols];
 
@@ -261,21 +266,26 @@ namespace bgslibrary
       void NPBGSubtractor::AddFrame(unsigned char *ImageBuffer)
       {
         if (UseColorRatiosFlag && color_channels == 3)
-          BGR2SnGnRn(ImageBuffer, ImageBuffer, rows, cols);
-
-        BGModel->AddFrame(ImageBuffer);
+        {
+          // converted in the free temporal buffer slot, the input is left as is
+          tempFrame = BGModel->TopFrame();
+          BGR2SnGnRn(ImageBuffer, tempFrame, rows, cols);
+          BGModel->AddFrame(tempFrame);
+        }
+        else
+          BGModel->AddFrame(ImageBuffer);
       }
 
       void NPBGSubtractor::Estimation()
       {
         int SampleSize = BGModel->SampleSize;
 
-        memset(BGModel->TemporalMask, 0, rows*cols*BGModel->TemporalBufferLength);
+        memset(BGModel->TemporalMask.data(), 0, BGModel->TemporalMask.bytes());
 
         //BGModel->AccMask= new unsigned int [rows*cols];
-        memset(BGModel->AccMask, 0, rows*cols * sizeof(unsigned int));
+        memset(BGModel->AccMask.data(), 0, BGModel->AccMask.bytes());
 
-        unsigned char *pSDs = new unsigned char[rows*cols*color_channels];
+        unsigned char *pSDs = BGModel->SDbinsImage.data();
 
         //DynamicMedianHistogram AbsDiffHist;
 
@@ -287,7 +297,7 @@ namespace bgslibrary
 
         if (SdEstimateFlag)
         {
-          AbsDiffHist = BuildAbsDiffHist(BGModel->Sequence, rows, cols, color_channels, SampleSize, Abshistbins);
+          AbsDiffHist = BuildAbsDiffHist(BGModel->Sequence.data(), rows, cols, color_channels, SampleSize, Abshistbins);
           EstimateSDsFromAbsDiffHist(&AbsDiffHist, pSDs, imagesize, SEGMAMIN, SEGMAMAX, SEGMABINS);
         }
         else
@@ -297,12 +307,86 @@ namespace bgslibrary
           memset(pSDs, bin, rows*cols*color_channels * sizeof(unsigned char));
         }
 
-        BGModel->SDbinsImage = pSDs;
-
         // Generate the Kernel
         KernelTable = new KernelLUTable(KERNELHALFWIDTH, SEGMAMIN, SEGMAMAX, SEGMABINS);
       }
 
+      bool NPBGSubtractor::SaveModel(const char *filename)
+      {
+        if (KernelTable == NULL)
+          return false;
+
+        std::ofstream out(filename, std::ios::out | std::ios::binary);
+        if (!out || !BGModel->Save(out))
+          return false;
+
+        out.write((const char*)&TimeIndex, sizeof(TimeIndex));
+        out.write((const char*)&UseColorRatiosFlag, sizeof(UseColorRatiosFlag));
+        out.write((const char*)&SdEstimateFlag, sizeof(SdEstimateFlag));
+        if (SdEstimateFlag)
+        {
+          // the deviation histograms keep being updated with the model pairs
+          unsigned int size = AbsDiffHist.imagesize;
+          out.write((const char*)&AbsDiffHist.histbins, sizeof(AbsDiffHist.histbins));
+          out.write((const char*)AbsDiffHist.Hist, size*AbsDiffHist.histbins);
+          out.write((const char*)AbsDiffHist.MedianBins, size);
+          out.write((const char*)AbsDiffHist.MedianFreq, size);
+          out.write((const char*)AbsDiffHist.AccSum, size);
+        }
+        return (bool)out;
+      }
+
+      bool NPBGSubtractor::LoadState(std::istream &in)
+      {
+        unsigned int StoredTimeIndex;
+        unsigned char StoredUseColorRatiosFlag, StoredSdEstimateFlag;
+        // the samples are stored in chromaticity space when color ratios are used
+        if (!in.read((char*)&StoredTimeIndex, sizeof(StoredTimeIndex))
+          || !in.read((char*)&StoredUseColorRatiosFlag, sizeof(StoredUseColorRatiosFlag))
+          || StoredUseColorRatiosFlag != UseColorRatiosFlag
+          || !in.read((char*)&StoredSdEstimateFlag, sizeof(StoredSdEstimateFlag))
+          || StoredSdEstimateFlag != SdEstimateFlag)
+          return false;
+
+        if (SdEstimateFlag)
+        {
+          unsigned char histbins;
+          if (!in.read((char*)&histbins, sizeof(histbins)))
+            return false;
+          if (AbsDiffHist.Hist == NULL)
+            AbsDiffHist = AllocateAbsDiffHist(imagesize, BGModel->SampleSize, histbins);
+          else if (AbsDiffHist.histbins != histbins)
+            return false;
+          unsigned int size = AbsDiffHist.imagesize;
+          if (!in.read((char*)AbsDiffHist.Hist, size*histbins)
+            || !in.read((char*)AbsDiffHist.MedianBins, size)
+            || !in.read((char*)AbsDiffHist.MedianFreq, size)
+            || !in.read((char*)AbsDiffHist.AccSum, size))
+            return false;
+        }
+
+        TimeIndex = StoredTimeIndex;
+        return true;
+      }
+
+      bool NPBGSubtractor::LoadModel(const char *filename)
+      {
+        std::ifstream in(filename, std::ios::in | std::ios::binary);
+        if (!in || !BGModel->Load(in))
+          return false;
+
+        if (!LoadState(in))
+        {
+          // do not learn on top of a half-restored model
+          BGModel->Reset();
+          return false;
+        }
+
+        if (KernelTable == NULL)
+          KernelTable = new KernelLUTable(KERNELHALFWIDTH, SEGMAMIN, SEGMAMAX, SEGMABINS);
+        return true;
+      }
+
       /*********************************************************************/
 
       void BuildImageIndex(unsigned char * Image,
@@ -621,17 +705,18 @@ namespace bgslibrary
         unsigned char * Mask)
       {
         unsigned int i, ic;
-        unsigned char * pSequence = BGModel->Sequence;
-        unsigned char * PixelQTop = BGModel->PixelQTop;
+        unsigned char * pSequence = BGModel->Sequence.data();
+        unsigned short * PixelQTop = BGModel->PixelQTop.data();
         //unsigned int Top = BGModel->Top;
         unsigned int rate;
 
-        int TemporalBufferTop = (int)BGModel->TemporalBufferTop;
-        unsigned char * pTemporalBuffer = BGModel->TemporalBuffer;
-        unsigned char * pTemporalMask = BGModel->TemporalMask;
-        int TemporalBufferLength = BGModel->TemporalBufferLength;
+        unsigned int TemporalBufferTop = BGModel->TemporalBufferTop;
+        unsigned char * pTemporalBuffer = BGModel->TemporalBuffer.data();
+        unsigned char * pTemporalMask = BGModel->TemporalMask.data();
+        unsigned int TemporalBufferLength = BGModel->TemporalBufferLength;
+        unsigned int TemporalBufferSlots = BGModel->TemporalBufferSlots;
 
-        unsigned int * AccMask = BGModel->AccMask;
+        unsigned int * AccMask = BGModel->AccMask.data();
         unsigned int ResetMaskTh = BGModel->ResetMaskTh;
 
         unsigned char *pAbsDiffHist = AbsDiffHist.Hist;
@@ -641,7 +726,7 @@ namespace bgslibrary
         int TimeWindowSize = BGModel->TimeWindowSize;
         int SampleSize = BGModel->SampleSize;
 
-        int TemporalBufferNext;
+        unsigned int TemporalBufferOldest, TemporalBufferNext;
 
         unsigned int imagebuffersize = rows*cols*color_channels;
         unsigned int imagespatialsize = rows*cols;
@@ -652,8 +737,6 @@ namespace bgslibrary
         unsigned char diff;
         unsigned char bin;
 
-        static int TBCount = 0;
-
         unsigned char * pTBbase1, *pTBbase2;
         unsigned char * pModelbase1, *pModelbase2;
 
@@ -661,32 +744,34 @@ namespace bgslibrary
         rate = (rate > 2) ? rate : 2;
 
 
-        TemporalBufferNext = (TemporalBufferTop + 1)
-          % TemporalBufferLength;
+        // the current frame (image) is already in the Top slot, the oldest
+        // pair of frames follows it in the ring
+        TemporalBufferOldest = (TemporalBufferTop + 1) % TemporalBufferSlots;
+        TemporalBufferNext = (TemporalBufferTop + 2) % TemporalBufferSlots;
 
-        // pointers to Masks : Top and Next
-        unsigned char * pTMaskTop = pTemporalMask + TemporalBufferTop*imagespatialsize;
+        // pointers to Masks : Oldest and Next
+        unsigned char * pTMaskOldest = pTemporalMask + TemporalBufferOldest*imagespatialsize;
         unsigned char * pTMaskNext = pTemporalMask + TemporalBufferNext*imagespatialsize;
 
-        // pointers to TB frames: Top and Next
-        unsigned char * pTBTop = pTemporalBuffer + TemporalBufferTop*imagebuffersize;
+        // pointers to TB frames: Oldest and Next
+        unsigned char * pTBOldest = pTemporalBuffer + TemporalBufferOldest*imagebuffersize;
         unsigned char * pTBNext = pTemporalBuffer + TemporalBufferNext*imagebuffersize;
 
-        if (((TimeIndex) % rate == 0) && TBCount >= TemporalBufferLength)
+        if (((TimeIndex) % rate == 0) && BGModel->TemporalBufferCount >= TemporalBufferLength)
         {
           for (i = 0, ic = 0; i < imagespatialsize; i++, ic += color_channels)
           {
-            mask = *(pTMaskTop + i) | *(pTMaskNext + i); // mask = *(pTMaskTop + i) || *(pTMaskNext + i);
+            mask = *(pTMaskOldest + i) | *(pTMaskNext + i); // mask = *(pTMaskOldest + i) || *(pTMaskNext + i);
 
             if (!mask)
             {
               // pointer to TB pixels to be added to the model
-              pTBbase1 = pTBTop + ic;
+              pTBbase1 = pTBOldest + ic;
               pTBbase2 = pTBNext + ic;
 
-              // pointers to Model pixels to be replaced
-              pModelbase1 = pSequence + PixelQTop[i] * imagebuffersize + ic;
-              pModelbase2 = pSequence + ((PixelQTop[i] + 1) % SampleSize)*imagebuffersize + ic;
+              // pointers to Model pixels to be replaced (channel c is SampleSize further)
+              pModelbase1 = pSequence + ic*SampleSize + PixelQTop[i];
+              pModelbase2 = pSequence + ic*SampleSize + (PixelQTop[i] + 1) % SampleSize;
 
               // update Deviation Histogram
               if (SdEstimateFlag)
@@ -738,35 +823,36 @@ namespace bgslibrary
                   pAbsDiffHist[histindex + bin]--;
 
                   histindex += histbins;
-                  diff = abs(*(pModelbase1 + 1) -
-                    *(pModelbase2 + 1));
+                  diff = abs(*(pModelbase1 + SampleSize) -
+                    *(pModelbase2 + SampleSize));
                   bin = (diff < histbins ? diff : histbins_1);
                   pAbsDiffHist[histindex + bin]--;
 
                   histindex += histbins;
-                  diff = abs(*(pModelbase1 + 2) -
-                    *(pModelbase2 + 2));
+                  diff = abs(*(pModelbase1 + 2 * SampleSize) -
+                    *(pModelbase2 + 2 * SampleSize));
                   bin = (diff < histbins ? diff : histbins_1);
                   pAbsDiffHist[histindex + bin]--;
                 }
               }
 
               // add new pair into the model
-              memcpy(pModelbase1, pTBbase1, color_channels * sizeof(unsigned char));
-
-              memcpy(pModelbase2, pTBbase2, color_channels * sizeof(unsigned char));
+              for (unsigned int c = 0; c < color_channels; c++)
+              {
+                pModelbase1[c*SampleSize] = pTBbase1[c];
+                pModelbase2[c*SampleSize] = pTBbase2[c];
+              }
 
-              PixelQTop[i] = (PixelQTop[i] + 2) % SampleSize;
+              PixelQTop[i] = (unsigned short)((PixelQTop[i] + 2) % SampleSize);
             }
           }
         } // end if (sampling event)
 
-        // update temporal buffer
-        // add new frame to Temporal buffer.
-        memcpy(pTBTop, image, imagebuffersize);
-
         // update AccMask
-        // update new Mask with information in AccMask
+        // update new Mask with information in AccMask, and add it to the
+        // Top slot of the temporal buffer
+
+        unsigned char * pTMaskTop = pTemporalMask + TemporalBufferTop*imagespatialsize;
 
         for (i = 0; i < rows*cols; i++)
         {
@@ -777,17 +863,15 @@ namespace bgslibrary
 
           if (AccMask[i] > ResetMaskTh)
             Mask[i] = 0;
-        }
 
-        // add new mask
-        memcpy(pTMaskTop, Mask, imagespatialsize);
-
-        // advance Temporal buffer pointer
-        TemporalBufferTop = (TemporalBufferTop + 1) % TemporalBufferLength;
+          pTMaskTop[i] = Mask[i];
+        }
 
-        BGModel->TemporalBufferTop = TemporalBufferTop;
+        // advance Temporal buffer pointer, the oldest frame slot receives the
+        // next frame
+        BGModel->TemporalBufferTop = TemporalBufferOldest;
 
-        TBCount++;
+        BGModel->TemporalBufferCount++;
 
         // estimate SDs
 
@@ -797,7 +881,7 @@ namespace bgslibrary
           double MinSD = KernelTable->minsegma;
           int KernelBins = KernelTable->segmabins;
 
-          unsigned char * pSDs = BGModel->SDbinsImage;
+          unsigned char * pSDs = BGModel->SDbinsImage.data();
 
           FindHistMedians(&(AbsDiffHist));
           EstimateSDsFromAbsDiffHist(&(AbsDiffHist), pSDs, imagebuffersize, MinSD, MaxSD, KernelBins);
@@ -832,31 +916,22 @@ namespace bgslibrary
         unsigned char * FilteredFGImage)
       {
         unsigned int i, j;
-        unsigned char *pSequence = BGModel->Sequence;
+        unsigned char *pSequence = BGModel->Sequence.data();
 
         unsigned int SampleSize = BGModel->SampleSize;
 
-        double *kerneltable = KernelTable->kerneltable;
+        const float *kerneltable = KernelTable->kerneltablef;
         int KernelHalfWidth = KernelTable->tablehalfwidth;
         //double *KernelSum = KernelTable->kernelsums;
         double KernelMaxSigma = KernelTable->maxsegma;
         double KernelMinSigma = KernelTable->minsegma;
         int KernelBins = KernelTable->segmabins;
-        unsigned char * SDbins = BGModel->SDbinsImage;
+        unsigned char * SDbins = BGModel->SDbinsImage.data();
 
         //unsigned char * SaturationImage = FilteredFGImage;
 
-        // default sigmas .. to be removed.
-        // double sigma1;
-        // double sigma2;
-        // double sigma3;
-
-        // sigma1 = 2.25;
-        // sigma2 = 2.25;
-        // sigma3 = 2.25;
-
         double p;
-        double th;
+        float th;
 
         double alpha;
 
@@ -867,33 +942,26 @@ namespace bgslibrary
         memset(FGImage, 0, rows*cols);
 
         //Threshold=1;
-        th = Threshold * SampleSize;
+        th = (float)(Threshold * SampleSize);
 
-        double sum = 0, kernel1, kernel2, kernel3;
+        float sum = 0, kernel1, kernel2, kernel3;
         int k, g;
 
+        // kernels point to the centre of the table row of their bandwidth
+        unsigned int kerneltablewidth = 2 * KernelHalfWidth + 1;
+        const float *kernels[3];
+        unsigned int used;
 
         if (color_channels == 1)
         {
           // gray scale
 
-          int kernelbase;
-
           for (i = 0; i < rows*cols; i++)
           {
-            kernelbase = SDbins[i] * (2 * KernelHalfWidth + 1);
-            sum = 0;
-            j = 0;
+            kernels[0] = kerneltable + SDbins[i] * kerneltablewidth + KernelHalfWidth;
+            sum = KernelDensityGray(pSequence + i*SampleSize, SampleSize, image[i], kernels[0], th, &used);
 
-            while (j < SampleSize && sum < th)
-            {
-              g = pSequence[j*imagesize + i];
-              k = g - image[i] + KernelHalfWidth;
-              sum += kerneltable[kernelbase + k];
-              j++;
-            }
-
-            p = sum / j;
+            p = sum / used;
             Pimage1[i] = p;
           }
         }
@@ -902,13 +970,6 @@ namespace bgslibrary
           // color ratios
 
           unsigned int ig;
-          int base;
-
-          // int kernelbase1;
-          int kernelbase2;
-          int kernelbase3;
-
-          unsigned int kerneltablewidth = 2 * KernelHalfWidth + 1;
 
           double beta = 3.0;    // minimum bound on the range.
           double betau = 100.0;
@@ -919,58 +980,38 @@ namespace bgslibrary
 
           double brightness_lowerbound = 1 - alpha;
           double brightness_upperbound = 1 + alpha;
-          int x1, x2;
-          unsigned int SubsampleCount;
 
-          for (i = 0, ig = 0; i < imagesize; i += 3, ig++)
+          // brightness range accepted for each sample value
+          for (g = 0; g < 256; g++)
           {
-            // kernelbase1 = SDbins[i] * kerneltablewidth;
-            kernelbase2 = SDbins[i + 1] * kerneltablewidth;
-            kernelbase3 = SDbins[i + 2] * kerneltablewidth;
-
-            sum = 0;
-            j = 0;
-            SubsampleCount = 0;
-
-            while (j < SampleSize && sum < th)
+            if (g < beta_over_alpha)
             {
-              base = j*imagesize + i;
-              g = pSequence[base];
-
-              if (g < beta_over_alpha)
-              {
-                x1 = (int)(g - beta);
-                x2 = (int)(g + beta);
-              }
-              else if (g > betau_over_alpha)
-              {
-                x1 = (int)(g - betau);
-                x2 = (int)(g + betau);
-              }
-              else
-              {
-                x1 = (int)(g*brightness_lowerbound + 0.5);
-                x2 = (int)(g*brightness_upperbound + 0.5);
-              }
-
-              if (x1 < image[i] && image[i] < x2)
-              {
-                g = pSequence[base + 1];
-                k = (g - image[i + 1]) + KernelHalfWidth;
-                kernel2 = kerneltable[kernelbase2 + k];
-
-                g = pSequence[base + 2];
-                k = (g - image[i + 2]) + KernelHalfWidth;
-                kernel3 = kerneltable[kernelbase3 + k];
+              BrightnessLowerBound[g] = (int)(g - beta);
+              BrightnessUpperBound[g] = (int)(g + beta);
+            }
+            else if (g > betau_over_alpha)
+            {
+              BrightnessLowerBound[g] = (int)(g - betau);
+              BrightnessUpperBound[g] = (int)(g + betau);
+            }
+            else
+            {
+              BrightnessLowerBound[g] = (int)(g*brightness_lowerbound + 0.5);
+              BrightnessUpperBound[g] = (int)(g*brightness_upperbound + 0.5);
+            }
+          }
 
-                sum += kernel2*kernel3;
+          for (i = 0, ig = 0; i < imagesize; i += 3, ig++)
+          {
+            // the brightness channel only selects the samples
+            kernels[0] = 0;
+            kernels[1] = kerneltable + SDbins[i + 1] * kerneltablewidth + KernelHalfWidth;
+            kernels[2] = kerneltable + SDbins[i + 2] * kerneltablewidth + KernelHalfWidth;
 
-                SubsampleCount++;
-              }
-              j++;
-            }
+            sum = KernelDensityRatios(pSequence + i*SampleSize, SampleSize, image + i, kernels,
+              BrightnessLowerBound, BrightnessUpperBound, th, &used);
 
-            p = sum / j;
+            p = sum / used;
             Pimage1[ig] = p;
           }
         }
@@ -986,8 +1027,6 @@ namespace bgslibrary
           int kernelbase2;
           int kernelbase3;
 
-          unsigned int kerneltablewidth = 2 * KernelHalfWidth + 1;
-
           int gmin, gmax;
           double gfactor;
 
@@ -1010,7 +1049,7 @@ namespace bgslibrary
 
             while (j < SampleSize && sum < th)
             {
-              base = j*imagesize + i;
+              base = i*SampleSize + j;
               g = pSequence[base];
 
               if (g < gmin)
@@ -1025,11 +1064,11 @@ namespace bgslibrary
               k = (g - image[i]) + KernelHalfWidth;
               kernel1 = kerneltable[kernelbase1 + k];
 
-              g = pSequence[base + 1];
+              g = pSequence[base + SampleSize];
               k = (g - image[i + 1]) + KernelHalfWidth;
               kernel2 = kerneltable[kernelbase2 + k];
 
-              g = pSequence[base + 2];
+              g = pSequence[base + 2 * SampleSize];
               k = (g - image[i + 2]) + KernelHalfWidth;
               kernel3 = kerneltable[kernelbase3 + k];
 
@@ -1044,42 +1083,17 @@ namespace bgslibrary
         else // RGB color
         {
           unsigned int ig;
-          int base;
-
-          int kernelbase1;
-          int kernelbase2;
-          int kernelbase3;
-          unsigned int kerneltablewidth = 2 * KernelHalfWidth + 1;
 
           for (i = 0, ig = 0; i < imagesize; i += 3, ig++)
           {
             // used extimated kernel width to access the right kernel
-            kernelbase1 = SDbins[i] * kerneltablewidth;
-            kernelbase2 = SDbins[i + 1] * kerneltablewidth;
-            kernelbase3 = SDbins[i + 2] * kerneltablewidth;
-
-            sum = 0;
-            j = 0;
-            while (j < SampleSize && sum < th)
-            {
-              base = j*imagesize + i;
-              g = pSequence[base];
-              k = (g - image[i]) + KernelHalfWidth;
-              kernel1 = kerneltable[kernelbase1 + k];
-
-              g = pSequence[base + 1];
-              k = (g - image[i + 1]) + KernelHalfWidth;
-              kernel2 = kerneltable[kernelbase2 + k];
+            kernels[0] = kerneltable + SDbins[i] * kerneltablewidth + KernelHalfWidth;
+            kernels[1] = kerneltable + SDbins[i + 1] * kerneltablewidth + KernelHalfWidth;
+            kernels[2] = kerneltable + SDbins[i + 2] * kerneltablewidth + KernelHalfWidth;
 
-              g = pSequence[base + 2];
-              k = (g - image[i + 2]) + KernelHalfWidth;
-              kernel3 = kerneltable[kernelbase3 + k];
+            sum = KernelDensityRGB(pSequence + i*SampleSize, SampleSize, image + i, kernels, th, &used);
 
-              sum += kernel1*kernel2*kernel3;
-              j++;
-            }
-
-            p = sum / j;
+            p = sum / used;
             Pimage1[ig] = p;
           }
         }
@@ -1094,7 +1108,11 @@ namespace bgslibrary
         unsigned char * FilteredFGImage,
         unsigned char ** DisplayBuffers)
       {
-        if (UseColorRatiosFlag)
+        // the frame is converted (or copied) directly into the free slot of
+        // the temporal buffer, where Update leaves it
+        tempFrame = BGModel->TopFrame();
+
+        if (UseColorRatiosFlag && color_channels == 3)
           BGR2SnGnRn(Frame, tempFrame, rows, cols);
         else
           memcpy(tempFrame, Frame, rows*cols*color_channels);
@@ -55,15 +55,21 @@ namespace bgslibrary
         double AlphaValue;
         unsigned int TimeIndex;
         ImageIndex  *imageindex;
+        // current frame, in the free slot of the model temporal buffer
         unsigned char *tempFrame;
         KernelLUTable *KernelTable;
         NPBGmodel *BGModel;
         DynamicMedianHistogram AbsDiffHist;
         double *Pimage1;
         double *Pimage2;
+        // brightness range of the color ratios subset, per sample value
+        int BrightnessLowerBound[256];
+        int BrightnessUpperBound[256];
         //
         void NPBGSubtraction_Subset_Kernel(unsigned char * image, unsigned char * FGImage, unsigned char * FilteredFGImage);
         void SequenceBGUpdate_Pairs(unsigned char * image, unsigned char * Mask);
+        // reads the time index and bandwidth histograms stored after the model
+        bool LoadState(std::istream &in);
 
       public:
         NPBGSubtractor();
@@ -89,6 +95,14 @@ namespace bgslibrary
 
         void Update(unsigned char *);
 
+        // Saves the model (once estimated) to a binary file, or restores it
+        // in a subtractor initialized with the same size, channels, sequence
+        // length and flags, which can then subtract without learning again.
+        // Both return false on failure; a failed load never leaves a partly
+        // restored model, which must then be learned again.
+        bool SaveModel(const char *filename);
+        bool LoadModel(const char *filename);
+
         void SetThresholds(double th, double alpha)
         {
           Threshold = th;
@@ -1,4 +1,5 @@
-#include "memory.h"
+#include <string.h>
+#include <utility>
 
 #include "NPBGmodel.h"
 
@@ -10,16 +11,40 @@
 
 using namespace bgslibrary::algorithms::kde;
 
+namespace
+{
+  const char MODEL_MAGIC[4] = { 'N', 'P', 'B', 'G' };
+  const unsigned int MODEL_VERSION = 1;
+
+  template<typename T>
+  void WriteValue(std::ostream &out, const T &value)
+  {
+    out.write((const char*)&value, sizeof(T));
+  }
+
+  template<typename T>
+  bool ReadValue(std::istream &in, T &value)
+  {
+    return (bool)in.read((char*)&value, sizeof(T));
+  }
+
+  template<typename T>
+  void WriteBuffer(std::ostream &out, const bgslibrary::AlignedBuffer<T> &buffer)
+  {
+    out.write((const char*)buffer.data(), buffer.bytes());
+  }
+
+  // reads count values into a new buffer
+  template<typename T>
+  bool ReadBuffer(std::istream &in, bgslibrary::AlignedBuffer<T> &buffer, size_t count)
+  {
+    return buffer.allocate(count) && in.read((char*)buffer.data(), buffer.bytes());
+  }
+}
+
 NPBGmodel::NPBGmodel() {}
 
-NPBGmodel::~NPBGmodel() {
-  delete Sequence;
-  delete PixelQTop;
-  delete TemporalBuffer;
-  delete TemporalMask;
-  delete AccMask;
-  //delete SDbinsImage;
-}
+NPBGmodel::~NPBGmodel() {}
 
 NPBGmodel::NPBGmodel(unsigned int Rows,
   unsigned int Cols,
@@ -38,30 +63,107 @@ NPBGmodel::NPBGmodel(unsigned int Rows,
 
   TimeWindowSize = pTimeWindowSize;
 
-  Sequence = new unsigned char[imagesize*Length];
+  Sequence.allocate((size_t)imagesize*Length);
   Top = 0;
-  memset(Sequence, 0, imagesize*Length);
+  memset(Sequence.data(), 0, Sequence.bytes());
 
-  PixelQTop = new unsigned char[rows*cols];
+  PixelQTop.allocate(rows*cols);
+
+  SDbinsImage.allocate(imagesize);
 
   // temporalBuffer
   TemporalBufferLength = (TimeWindowSize / Length > 2 ? TimeWindowSize / Length : 2);
-  TemporalBuffer = new unsigned char[imagesize*TemporalBufferLength];
-  TemporalMask = new unsigned char[rows*cols*TemporalBufferLength];
+  TemporalBufferSlots = TemporalBufferLength + 1;
+  TemporalBuffer.allocate((size_t)imagesize*TemporalBufferSlots);
+  TemporalMask.allocate((size_t)rows*cols*TemporalBufferSlots);
 
   TemporalBufferTop = 0;
+  TemporalBufferCount = 0;
 
-  AccMask = new unsigned int[rows*cols];
+  AccMask.allocate(rows*cols);
 
   ResetMaskTh = bg_suppression_time;
 }
 
 void NPBGmodel::AddFrame(unsigned char *ImageBuffer)
 {
-  memcpy(Sequence + Top*imagesize, ImageBuffer, imagesize);
+  unsigned char *pSamples = Sequence.data() + Top;
+  for (unsigned int i = 0; i < imagesize; i++, pSamples += SampleSize)
+    *pSamples = ImageBuffer[i];
   Top = (Top + 1) % SampleSize;
 
-  memset(PixelQTop, (unsigned char)Top, rows*cols);
+  for (unsigned int i = 0; i < rows*cols; i++)
+    PixelQTop[i] = (unsigned short)Top;
+}
 
-  memcpy(TemporalBuffer, ImageBuffer, imagesize);
+void NPBGmodel::Reset()
+{
+  memset(Sequence.data(), 0, Sequence.bytes());
+  Top = 0;
+  TemporalBufferTop = 0;
+  TemporalBufferCount = 0;
+}
+
+bool NPBGmodel::Save(std::ostream &out) const
+{
+  out.write(MODEL_MAGIC, sizeof(MODEL_MAGIC));
+  WriteValue(out, MODEL_VERSION);
+  WriteValue(out, rows);
+  WriteValue(out, cols);
+  WriteValue(out, color_channels);
+  WriteValue(out, SampleSize);
+  WriteValue(out, TemporalBufferLength);
+  WriteValue(out, Top);
+  WriteValue(out, TemporalBufferTop);
+  WriteValue(out, TemporalBufferCount);
+  WriteBuffer(out, Sequence);
+  WriteBuffer(out, PixelQTop);
+  WriteBuffer(out, SDbinsImage);
+  WriteBuffer(out, TemporalBuffer);
+  WriteBuffer(out, TemporalMask);
+  WriteBuffer(out, AccMask);
+  return (bool)out;
+}
+
+bool NPBGmodel::Load(std::istream &in)
+{
+  char magic[sizeof(MODEL_MAGIC)];
+  unsigned int version, Rows, Cols, ColorChannels, Length, BufferLength;
+  if (!in.read(magic, sizeof(magic)) || memcmp(magic, MODEL_MAGIC, sizeof(magic)) != 0)
+    return false;
+  if (!ReadValue(in, version) || version != MODEL_VERSION)
+    return false;
+  if (!ReadValue(in, Rows) || !ReadValue(in, Cols) || !ReadValue(in, ColorChannels)
+    || !ReadValue(in, Length) || !ReadValue(in, BufferLength))
+    return false;
+  if (Rows != rows || Cols != cols || ColorChannels != color_channels
+    || Length != SampleSize || BufferLength != TemporalBufferLength)
+    return false;
+  unsigned int StoredTop, StoredTemporalBufferTop, StoredTemporalBufferCount;
+  if (!ReadValue(in, StoredTop) || !ReadValue(in, StoredTemporalBufferTop) || !ReadValue(in, StoredTemporalBufferCount))
+    return false;
+  if (StoredTop >= SampleSize || StoredTemporalBufferTop >= TemporalBufferSlots)
+    return false;
+  // read into new buffers so that a short or corrupt file leaves the model as it was
+  AlignedBuffer<unsigned char> StoredSequence, StoredSDbinsImage, StoredTemporalBuffer, StoredTemporalMask;
+  AlignedBuffer<unsigned short> StoredPixelQTop;
+  AlignedBuffer<unsigned int> StoredAccMask;
+  if (!ReadBuffer(in, StoredSequence, Sequence.size()) || !ReadBuffer(in, StoredPixelQTop, PixelQTop.size())
+    || !ReadBuffer(in, StoredSDbinsImage, SDbinsImage.size()) || !ReadBuffer(in, StoredTemporalBuffer, TemporalBuffer.size())
+    || !ReadBuffer(in, StoredTemporalMask, TemporalMask.size()) || !ReadBuffer(in, StoredAccMask, AccMask.size()))
+    return false;
+  for (unsigned int i = 0; i < rows*cols; i++)
+    if (StoredPixelQTop[i] >= SampleSize)
+      return false;
+
+  Sequence = std::move(StoredSequence);
+  PixelQTop = std::move(StoredPixelQTop);
+  SDbinsImage = std::move(StoredSDbinsImage);
+  TemporalBuffer = std::move(StoredTemporalBuffer);
+  TemporalMask = std::move(StoredTemporalMask);
+  AccMask = std::move(StoredAccMask);
+  Top = StoredTop;
+  TemporalBufferTop = StoredTemporalBufferTop;
+  TemporalBufferCount = StoredTemporalBufferCount;
+  return true;
 }
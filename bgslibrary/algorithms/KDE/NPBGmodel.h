@@ -2,6 +2,8 @@
 
 #include <iostream>
 
+#include "../../utils/AlignedBuffer.h"
+
 namespace bgslibrary
 {
   namespace algorithms
@@ -11,7 +13,10 @@ namespace bgslibrary
       class NPBGmodel
       {
       private:
-        unsigned char *Sequence;
+        // samples, pixel-major and channel-planar: sample j of channel c of
+        // pixel i is Sequence[(i*color_channels + c)*SampleSize + j]. The
+        // samples of a pixel are a ring, PixelQTop[i] being the oldest one.
+        AlignedBuffer<unsigned char> Sequence;
         unsigned int SampleSize;
         unsigned int TimeWindowSize;
 
@@ -19,27 +24,26 @@ namespace bgslibrary
         unsigned int imagesize;
 
         unsigned int Top;
-        unsigned char *PixelQTop;
-
-        //unsigned int *PixelUpdateCounter;
-
-        unsigned char *SDbinsImage;
+        AlignedBuffer<unsigned short> PixelQTop;
 
-        unsigned char *TemporalBuffer;
-        unsigned char TemporalBufferLength;
-        unsigned char TemporalBufferTop;
-        unsigned char *TemporalBufferMask;
+        AlignedBuffer<unsigned char> SDbinsImage;
 
-        unsigned char *TemporalMask;
-        unsigned char TemporalMaskLength;
-        unsigned char TemporalMaskTop;
+        // ring of the last TemporalBufferLength frames (and their masks),
+        // plus the slot of the frame being processed (TemporalBufferTop),
+        // which the subtractor writes into directly. The oldest frame is in
+        // the slot after TemporalBufferTop.
+        AlignedBuffer<unsigned char> TemporalBuffer;
+        AlignedBuffer<unsigned char> TemporalMask;
+        unsigned int TemporalBufferLength;
+        unsigned int TemporalBufferSlots;
+        unsigned int TemporalBufferTop;
+        // number of frames added to the ring so far
+        unsigned int TemporalBufferCount;
 
-        unsigned int *AccMask;
+        AlignedBuffer<unsigned int> AccMask;
         unsigned int ResetMaskTh;	// Max continous duration a pixel can be detected before
         // it is forced to be updated...
 
-        double *weights;
-
       public:
         NPBGmodel();
         //~NPBGmodel();
@@ -52,8 +56,22 @@ namespace bgslibrary
           unsigned int pTimeWindowSize,
           unsigned int bg_suppression_time);
 
+        // adds a frame to the samples of all pixels
         void AddFrame(unsigned char *ImageBuffer);
 
+        // slot of the temporal buffer (and mask) receiving the current frame
+        unsigned char * TopFrame() { return TemporalBuffer.data() + (size_t)TemporalBufferTop*imagesize; }
+        unsigned char * TopMask() { return TemporalMask.data() + (size_t)TemporalBufferTop*rows*cols; }
+
+        // Binary (de)serialization of the samples, bandwidths and temporal
+        // buffer; Load fails (returning false) when the stored model does not
+        // have the size and length of this one or is truncated, and leaves
+        // the model as it was.
+        bool Save(std::ostream &out) const;
+        bool Load(std::istream &in);
+        // back to the empty model of a new instance (no samples, empty ring)
+        void Reset();
+
         friend class NPBGSubtractor;
       };
     }
@@ -34,7 +34,7 @@ void LBP_MRF::process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &im
   Detector->GetMotionsMask(OutputImage);
   img_foreground = cv::cvarrToMat((IplImage*)OutputImage.GetIplImage());
   //bitwise_not(img_foreground, img_background);
-  img_background = cv::Mat::zeros(img_input.size(), img_input.type());
+  createZeros(img_background, img_input.size(), img_input.type());
 
 #ifndef MEX_COMPILE_FLAG
   if (showOutput)
@@ -22,6 +22,7 @@ namespace bgslibrary
       ~LBP_MRF();
 
       void process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img_bgmodel);
+      bool usesSharedRandom() const { return true; }
 
     private:
       void save_config(cv::FileStorage &fs);
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <iomanip>
 #include <exception>
+#include <algorithm>
 
 #include <opencv2/imgproc/imgproc.hpp>
 #ifndef MEX_COMPILE_FLAG
@@ -29,6 +30,8 @@ namespace bgslibrary
     {
       // local define used to determine the default median blur kernel size
       const int DEFAULT_MEDIAN_BLUR_KERNEL_SIZE = 9;
+      // local define used to determine the minimal height of a row band
+      const size_t MIN_BAND_ROWS = 16;
 
       BackgroundSubtractorLBSP::BackgroundSubtractorLBSP(float fRelLBSPThreshold, size_t nLBSPThresholdOffset)
         : m_nImgChannels(0)
@@ -46,6 +49,7 @@ namespace bgslibrary
         , m_bInitialized(false)
         , m_bAutoModelResetEnabled(true)
         , m_bUsingMovingCamera(false)
+        , m_nParallelBands(1)
         , nDebugCoordX(0), nDebugCoordY(0) {
         CV_Assert(m_fRelLBSPThreshold >= 0);
       }
@@ -79,6 +83,71 @@ namespace bgslibrary
       void BackgroundSubtractorLBSP::setAutomaticModelReset(bool bVal) {
         m_bAutoModelResetEnabled = bVal;
       }
+
+      void BackgroundSubtractorLBSP::setRandomSeed(uint64_t nSeed) {
+        m_oRNG.seed(nSeed);
+        if (m_bInitialized)
+          initBands();
+      }
+
+      void BackgroundSubtractorLBSP::setParallelBands(size_t nBands) {
+        m_nParallelBands = nBands;
+        if (m_bInitialized)
+          initBands();
+      }
+
+      void BackgroundSubtractorLBSP::initBands() {
+        CV_Assert(m_aPxIdxLUT && m_nTotRelevantPxCount > 0);
+        const size_t nRows = (size_t)m_oImgSize.height;
+        const size_t nRequestedBands = m_nParallelBands > 0 ? m_nParallelBands : ThreadPool::defaultNumThreads();
+        const size_t nBands = std::max((size_t)1, std::min(nRequestedBands, nRows / MIN_BAND_ROWS));
+        m_voBands.resize(nBands);
+        for (size_t nBandIdx = 0; nBandIdx < nBands; ++nBandIdx) {
+          BandInfo& oBand = m_voBands[nBandIdx];
+          oBand.nRowBegin = (int)(nRows * nBandIdx / nBands);
+          oBand.nRowEnd = (int)(nRows * (nBandIdx + 1) / nBands);
+          // m_aPxIdxLUT is sorted, so the pixels of a row range are contiguous in it
+          oBand.nModelIterBegin = (size_t)(std::lower_bound(m_aPxIdxLUT, m_aPxIdxLUT + m_nTotRelevantPxCount, (size_t)oBand.nRowBegin * m_oImgSize.width) - m_aPxIdxLUT);
+          oBand.nModelIterEnd = (size_t)(std::lower_bound(m_aPxIdxLUT, m_aPxIdxLUT + m_nTotRelevantPxCount, (size_t)oBand.nRowEnd * m_oImgSize.width) - m_aPxIdxLUT);
+          // a single band keeps using m_oRNG, so the sequential results do not change
+          if (nBands > 1)
+            oBand.oRNG.seed(((uint64_t)m_oRNG.next() << 32) | m_oRNG.next());
+        }
+        if (nBands == 1)
+          m_pBandThreadPool.reset();
+        else if (!m_pBandThreadPool || m_pBandThreadPool->size() != nBands - 1)
+          m_pBandThreadPool.reset(new ThreadPool(nBands - 1));
+      }
+
+      void BackgroundSubtractorLBSP::forEachBand(const std::function<void(size_t)>& oBandFunc) {
+        if (m_voBands.size() == 1) {
+          oBandFunc(0);
+          return;
+        }
+        std::vector<std::future<void>> voBandResults;
+        voBandResults.reserve(m_voBands.size() - 1);
+        for (size_t nBandIdx = 1; nBandIdx < m_voBands.size(); ++nBandIdx)
+          voBandResults.push_back(m_pBandThreadPool->enqueue([&oBandFunc, nBandIdx]() { oBandFunc(nBandIdx); }));
+        std::exception_ptr pException;
+        try {
+          oBandFunc(0);
+        }
+        catch (...) {
+          pException = std::current_exception();
+        }
+        // all bands must be done before returning, even when one of them failed
+        for (auto& oResult : voBandResults) {
+          try {
+            oResult.get();
+          }
+          catch (...) {
+            if (!pException)
+              pException = std::current_exception();
+          }
+        }
+        if (pException)
+          std::rethrow_exception(pException);
+      }
     }
   }
 }
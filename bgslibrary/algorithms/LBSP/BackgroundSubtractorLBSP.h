@@ -1,9 +1,15 @@
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <vector>
+
 #include <opencv2/features2d/features2d.hpp>
 #include <opencv2/video/background_segm.hpp>
 
 #include "LBSP.h"
+#include "../../utils/FastRNG.h"
+#include "../../utils/ThreadPool.h"
 
 namespace bgslibrary
 {
@@ -40,6 +46,10 @@ namespace bgslibrary
         virtual void setROI(cv::Mat& oROI);
         //! turns automatic model reset on or off
         void setAutomaticModelReset(bool);
+        //! seeds the random generator used for model sampling & updates
+        void setRandomSeed(uint64_t nSeed);
+        //! sets the number of row bands analyzed concurrently by apply (1 = sequential, the default; 0 = one per hardware thread)
+        void setParallelBands(size_t nBands);
 
       protected:
         struct PxInfoBase {
@@ -47,6 +57,21 @@ namespace bgslibrary
           int nImgCoord_X;
           size_t nModelIdx;
         };
+        //! contiguous range of rows of the relevant pixels, analyzed by a single thread in apply
+        struct BandInfo {
+          //! range of m_aPxIdxLUT covered by the band
+          size_t nModelIterBegin, nModelIterEnd;
+          //! rows owned by the band; model updates landing outside of them are deferred until all bands are done
+          int nRowBegin, nRowEnd;
+          //! random generator of the band (only used when there is more than one band)
+          FastRNG oRNG;
+        };
+        //! splits the relevant pixels in row bands (needs m_aPxIdxLUT, called at the end of initialize)
+        void initBands();
+        //! calls oBandFunc(nBandIdx) for all bands, concurrently when there is more than one
+        void forEachBand(const std::function<void(size_t)>& oBandFunc);
+        //! returns the random generator to be used by a band
+        FastRNG& getBandRNG(size_t nBandIdx) { return m_voBands.size() > 1 ? m_voBands[nBandIdx].oRNG : m_oRNG; }
         //! background model ROI used for LBSP descriptor extraction (specific to the input image size)
         cv::Mat m_oROI;
         //! input image size
@@ -83,6 +108,14 @@ namespace bgslibrary
         cv::Mat m_oLastDescFrame;
         //! the foreground mask generated by the method at [t-1]
         cv::Mat m_oLastFGMask;
+        //! random generator of this instance (used instead of the shared rand())
+        FastRNG m_oRNG;
+        //! requested number of row bands (0 = one per hardware thread)
+        size_t m_nParallelBands;
+        //! row bands of the relevant pixels (a single band covering the whole image by default)
+        std::vector<BandInfo> m_voBands;
+        //! worker threads for all bands but the first one (which runs on the calling thread)
+        std::unique_ptr<ThreadPool> m_pBandThreadPool;
 
       public:
         // ######## DEBUG PURPOSES ONLY ##########
@@ -4,6 +4,7 @@
 #include <opencv2/video/background_segm.hpp>
 
 #include "LBSP_.h"
+#include "../../utils/FastRNG.h"
 
 namespace bgslibrary
 {
@@ -40,6 +41,8 @@ namespace bgslibrary
         virtual void setROI(cv::Mat& oROI);
         //! turns automatic model reset on or off
         void setAutomaticModelReset(bool);
+        //! seeds the random generator used for model sampling & updates
+        void setRandomSeed(uint64_t nSeed) { m_oRNG.seed(nSeed); }
 
       protected:
         struct PxInfoBase {
@@ -83,6 +86,8 @@ namespace bgslibrary
         cv::Mat m_oLastDescFrame;
         //! the foreground mask generated by the method at [t-1]
         cv::Mat m_oLastFGMask;
+        //! random generator of this instance (used instead of the shared rand())
+        FastRNG m_oRNG;
 
       private:
         //! copy constructor -- disabled since this class (and its children) use lots of dynamic structs based on raw pointers
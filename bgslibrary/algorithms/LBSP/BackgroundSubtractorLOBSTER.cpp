@@ -126,6 +126,7 @@ void BackgroundSubtractorLOBSTER::initialize(const cv::Mat& oInitImg, const cv::
       }
     }
   }
+  initBands();
   m_bInitialized = true;
   refreshModel(1.0f);
 }
@@ -135,14 +136,14 @@ void BackgroundSubtractorLOBSTER::refreshModel(float fSamplesRefreshFrac, bool b
   CV_Assert(m_bInitialized);
   CV_Assert(fSamplesRefreshFrac > 0.0f && fSamplesRefreshFrac <= 1.0f);
   const size_t nModelsToRefresh = fSamplesRefreshFrac < 1.0f ? (size_t)(fSamplesRefreshFrac*m_nBGSamples) : m_nBGSamples;
-  const size_t nRefreshStartPos = fSamplesRefreshFrac < 1.0f ? rand() % m_nBGSamples : 0;
+  const size_t nRefreshStartPos = fSamplesRefreshFrac < 1.0f ? m_oRNG() % m_nBGSamples : 0;
   if (m_nImgChannels == 1) {
     for (size_t nModelIter = 0; nModelIter < m_nTotRelevantPxCount; ++nModelIter) {
       const size_t nPxIter = m_aPxIdxLUT[nModelIter];
       if (bForceFGUpdate || !m_oLastFGMask.data[nPxIter]) {
         for (size_t nCurrModelIdx = nRefreshStartPos; nCurrModelIdx < nRefreshStartPos + nModelsToRefresh; ++nCurrModelIdx) {
           int nSampleImgCoord_Y, nSampleImgCoord_X;
-          getRandSamplePosition(nSampleImgCoord_X, nSampleImgCoord_Y, m_aPxInfoLUT[nPxIter].nImgCoord_X, m_aPxInfoLUT[nPxIter].nImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
+          getRandSamplePosition(m_oRNG, nSampleImgCoord_X, nSampleImgCoord_Y, m_aPxInfoLUT[nPxIter].nImgCoord_X, m_aPxInfoLUT[nPxIter].nImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
           const size_t nSamplePxIdx = m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
           if (bForceFGUpdate || !m_oLastFGMask.data[nSamplePxIdx]) {
             const size_t nCurrRealModelIdx = nCurrModelIdx%m_nBGSamples;
@@ -159,7 +160,7 @@ void BackgroundSubtractorLOBSTER::refreshModel(float fSamplesRefreshFrac, bool b
       if (bForceFGUpdate || !m_oLastFGMask.data[nPxIter]) {
         for (size_t nCurrModelIdx = nRefreshStartPos; nCurrModelIdx < nRefreshStartPos + nModelsToRefresh; ++nCurrModelIdx) {
           int nSampleImgCoord_Y, nSampleImgCoord_X;
-          getRandSamplePosition(nSampleImgCoord_X, nSampleImgCoord_Y, m_aPxInfoLUT[nPxIter].nImgCoord_X, m_aPxInfoLUT[nPxIter].nImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
+          getRandSamplePosition(m_oRNG, nSampleImgCoord_X, nSampleImgCoord_Y, m_aPxInfoLUT[nPxIter].nImgCoord_X, m_aPxInfoLUT[nPxIter].nImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
           const size_t nSamplePxIdx = m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
           if (bForceFGUpdate || !m_oLastFGMask.data[nSamplePxIdx]) {
             const size_t nCurrRealModelIdx = nCurrModelIdx%m_nBGSamples;
@@ -174,18 +175,12 @@ void BackgroundSubtractorLOBSTER::refreshModel(float fSamplesRefreshFrac, bool b
   }
 }
 
-void BackgroundSubtractorLOBSTER::apply(cv::InputArray _image, cv::OutputArray _fgmask, double learningRate) {
-  CV_Assert(m_bInitialized);
-  CV_Assert(learningRate > 0);
-  cv::Mat oInputImg = _image.getMat();
-  CV_Assert(oInputImg.type() == m_nImgType && oInputImg.size() == m_oImgSize);
-  CV_Assert(oInputImg.isContinuous());
-  _fgmask.create(m_oImgSize, CV_8UC1);
-  cv::Mat oCurrFGMask = _fgmask.getMat();
-  oCurrFGMask = cv::Scalar_<uchar>(0);
-  const size_t nLearningRate = (size_t)ceil(learningRate);
+void BackgroundSubtractorLOBSTER::applyBand(size_t nBandIdx, const cv::Mat& oInputImg, cv::Mat& oCurrFGMask, size_t nLearningRate) {
+  const BandInfo& oBand = m_voBands[nBandIdx];
+  FastRNG& oRNG = getBandRNG(nBandIdx);
+  std::vector<DeferredUpdate>& vDeferredUpdates = m_vvBandDeferredUpdates[nBandIdx];
   if (m_nImgChannels == 1) {
-    for (size_t nModelIter = 0; nModelIter < m_nTotRelevantPxCount; ++nModelIter) {
+    for (size_t nModelIter = oBand.nModelIterBegin; nModelIter < oBand.nModelIterEnd; ++nModelIter) {
       const size_t nPxIter = m_aPxIdxLUT[nModelIter];
       const size_t nDescIter = nPxIter * 2;
       const int nCurrImgCoord_X = m_aPxInfoLUT[nPxIter].nImgCoord_X;
@@ -211,19 +206,27 @@ void BackgroundSubtractorLOBSTER::apply(cv::InputArray _image, cv::OutputArray _
       if (nGoodSamplesCount < m_nRequiredBGSamples)
         oCurrFGMask.data[nPxIter] = UCHAR_MAX;
       else {
-        if ((rand() % nLearningRate) == 0) {
-          const size_t nSampleModelIdx = rand() % m_nBGSamples;
+        if ((oRNG() % nLearningRate) == 0) {
+          const size_t nSampleModelIdx = oRNG() % m_nBGSamples;
           ushort& nRandInputDesc = *((ushort*)(m_voBGDescSamples[nSampleModelIdx].data + nDescIter));
           LBSP::computeGrayscaleDescriptor(oInputImg, nCurrColor, nCurrImgCoord_X, nCurrImgCoord_Y, m_anLBSPThreshold_8bitLUT[nCurrColor], nRandInputDesc);
           m_voBGColorSamples[nSampleModelIdx].data[nPxIter] = nCurrColor;
         }
-        if ((rand() % nLearningRate) == 0) {
+        if ((oRNG() % nLearningRate) == 0) {
           int nSampleImgCoord_Y, nSampleImgCoord_X;
-          getRandNeighborPosition_3x3(nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
-          const size_t nSampleModelIdx = rand() % m_nBGSamples;
-          ushort& nRandInputDesc = m_voBGDescSamples[nSampleModelIdx].at<ushort>(nSampleImgCoord_Y, nSampleImgCoord_X);
-          LBSP::computeGrayscaleDescriptor(oInputImg, nCurrColor, nCurrImgCoord_X, nCurrImgCoord_Y, m_anLBSPThreshold_8bitLUT[nCurrColor], nRandInputDesc);
-          m_voBGColorSamples[nSampleModelIdx].at<uchar>(nSampleImgCoord_Y, nSampleImgCoord_X) = nCurrColor;
+          getRandNeighborPosition_3x3(oRNG, nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
+          const size_t nSampleModelIdx = oRNG() % m_nBGSamples;
+          if (nSampleImgCoord_Y < oBand.nRowBegin || nSampleImgCoord_Y >= oBand.nRowEnd) {
+            // the neighbour belongs to another band: apply once all bands are done
+            DeferredUpdate oUpdate = { (size_t)(m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X), nSampleModelIdx, { 0, 0, 0 }, { nCurrColor, 0, 0 } };
+            LBSP::computeGrayscaleDescriptor(oInputImg, nCurrColor, nCurrImgCoord_X, nCurrImgCoord_Y, m_anLBSPThreshold_8bitLUT[nCurrColor], oUpdate.anDesc[0]);
+            vDeferredUpdates.push_back(oUpdate);
+          }
+          else {
+            ushort& nRandInputDesc = m_voBGDescSamples[nSampleModelIdx].at<ushort>(nSampleImgCoord_Y, nSampleImgCoord_X);
+            LBSP::computeGrayscaleDescriptor(oInputImg, nCurrColor, nCurrImgCoord_X, nCurrImgCoord_Y, m_anLBSPThreshold_8bitLUT[nCurrColor], nRandInputDesc);
+            m_voBGColorSamples[nSampleModelIdx].at<uchar>(nSampleImgCoord_Y, nSampleImgCoord_X) = nCurrColor;
+          }
         }
       }
     }
@@ -235,7 +238,7 @@ void BackgroundSubtractorLOBSTER::apply(cv::InputArray _image, cv::OutputArray _
     const size_t nCurrSCColorDistThreshold = nCurrColorDistThreshold / 2;
     const size_t desc_row_step = m_voBGDescSamples[0].step.p[0];
     const size_t img_row_step = m_voBGColorSamples[0].step.p[0];
-    for (size_t nModelIter = 0; nModelIter < m_nTotRelevantPxCount; ++nModelIter) {
+    for (size_t nModelIter = oBand.nModelIterBegin; nModelIter < oBand.nModelIterEnd; ++nModelIter) {
       const size_t nPxIter = m_aPxIdxLUT[nModelIter];
       const int nCurrImgCoord_X = m_aPxInfoLUT[nPxIter].nImgCoord_X;
       const int nCurrImgCoord_Y = m_aPxInfoLUT[nPxIter].nImgCoord_Y;
@@ -268,27 +271,64 @@ void BackgroundSubtractorLOBSTER::apply(cv::InputArray _image, cv::OutputArray _
       if (nGoodSamplesCount < m_nRequiredBGSamples)
         oCurrFGMask.data[nPxIter] = UCHAR_MAX;
       else {
-        if ((rand() % nLearningRate) == 0) {
-          const size_t nSampleModelIdx = rand() % m_nBGSamples;
+        if ((oRNG() % nLearningRate) == 0) {
+          const size_t nSampleModelIdx = oRNG() % m_nBGSamples;
           ushort* anRandInputDesc = ((ushort*)(m_voBGDescSamples[nSampleModelIdx].data + nDescIterRGB));
           const size_t anCurrIntraLBSPThresholds[3] = { m_anLBSPThreshold_8bitLUT[anCurrColor[0]],m_anLBSPThreshold_8bitLUT[anCurrColor[1]],m_anLBSPThreshold_8bitLUT[anCurrColor[2]] };
           LBSP::computeRGBDescriptor(oInputImg, anCurrColor, nCurrImgCoord_X, nCurrImgCoord_Y, anCurrIntraLBSPThresholds, anRandInputDesc);
           for (size_t c = 0; c < 3; ++c)
             *(m_voBGColorSamples[nSampleModelIdx].data + nPxIterRGB + c) = anCurrColor[c];
         }
-        if ((rand() % nLearningRate) == 0) {
+        if ((oRNG() % nLearningRate) == 0) {
           int nSampleImgCoord_Y, nSampleImgCoord_X;
-          getRandNeighborPosition_3x3(nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
-          const size_t nSampleModelIdx = rand() % m_nBGSamples;
-          ushort* anRandInputDesc = ((ushort*)(m_voBGDescSamples[nSampleModelIdx].data + desc_row_step*nSampleImgCoord_Y + 6 * nSampleImgCoord_X));
+          getRandNeighborPosition_3x3(oRNG, nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
+          const size_t nSampleModelIdx = oRNG() % m_nBGSamples;
           const size_t anCurrIntraLBSPThresholds[3] = { m_anLBSPThreshold_8bitLUT[anCurrColor[0]],m_anLBSPThreshold_8bitLUT[anCurrColor[1]],m_anLBSPThreshold_8bitLUT[anCurrColor[2]] };
-          LBSP::computeRGBDescriptor(oInputImg, anCurrColor, nCurrImgCoord_X, nCurrImgCoord_Y, anCurrIntraLBSPThresholds, anRandInputDesc);
-          for (size_t c = 0; c < 3; ++c)
-            *(m_voBGColorSamples[nSampleModelIdx].data + img_row_step*nSampleImgCoord_Y + 3 * nSampleImgCoord_X + c) = anCurrColor[c];
+          if (nSampleImgCoord_Y < oBand.nRowBegin || nSampleImgCoord_Y >= oBand.nRowEnd) {
+            // the neighbour belongs to another band: apply once all bands are done
+            DeferredUpdate oUpdate = { (size_t)(m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X), nSampleModelIdx, { 0, 0, 0 }, { anCurrColor[0], anCurrColor[1], anCurrColor[2] } };
+            LBSP::computeRGBDescriptor(oInputImg, anCurrColor, nCurrImgCoord_X, nCurrImgCoord_Y, anCurrIntraLBSPThresholds, oUpdate.anDesc);
+            vDeferredUpdates.push_back(oUpdate);
+          }
+          else {
+            ushort* anRandInputDesc = ((ushort*)(m_voBGDescSamples[nSampleModelIdx].data + desc_row_step*nSampleImgCoord_Y + 6 * nSampleImgCoord_X));
+            LBSP::computeRGBDescriptor(oInputImg, anCurrColor, nCurrImgCoord_X, nCurrImgCoord_Y, anCurrIntraLBSPThresholds, anRandInputDesc);
+            for (size_t c = 0; c < 3; ++c)
+              *(m_voBGColorSamples[nSampleModelIdx].data + img_row_step*nSampleImgCoord_Y + 3 * nSampleImgCoord_X + c) = anCurrColor[c];
+          }
         }
       }
     }
   }
+}
+
+void BackgroundSubtractorLOBSTER::applyDeferredUpdate(const DeferredUpdate& oUpdate) {
+  const size_t nPxIterRGB = oUpdate.nPxIter * m_nImgChannels;
+  for (size_t c = 0; c < m_nImgChannels; ++c) {
+    *((ushort*)(m_voBGDescSamples[oUpdate.nSampleIdx].data + (nPxIterRGB + c) * 2)) = oUpdate.anDesc[c];
+    m_voBGColorSamples[oUpdate.nSampleIdx].data[nPxIterRGB + c] = oUpdate.anColor[c];
+  }
+}
+
+void BackgroundSubtractorLOBSTER::apply(cv::InputArray _image, cv::OutputArray _fgmask, double learningRate) {
+  CV_Assert(m_bInitialized);
+  CV_Assert(learningRate > 0);
+  cv::Mat oInputImg = _image.getMat();
+  CV_Assert(oInputImg.type() == m_nImgType && oInputImg.size() == m_oImgSize);
+  CV_Assert(oInputImg.isContinuous());
+  _fgmask.create(m_oImgSize, CV_8UC1);
+  cv::Mat oCurrFGMask = _fgmask.getMat();
+  oCurrFGMask = cv::Scalar_<uchar>(0);
+  const size_t nLearningRate = (size_t)ceil(learningRate);
+  m_vvBandDeferredUpdates.resize(m_voBands.size());
+  forEachBand([&](size_t nBandIdx) {
+    applyBand(nBandIdx, oInputImg, oCurrFGMask, nLearningRate);
+  });
+  for (size_t nBandIdx = 0; nBandIdx < m_voBands.size(); ++nBandIdx) {
+    for (const DeferredUpdate& oUpdate : m_vvBandDeferredUpdates[nBandIdx])
+      applyDeferredUpdate(oUpdate);
+    m_vvBandDeferredUpdates[nBandIdx].clear();
+  }
   cv::medianBlur(oCurrFGMask, m_oLastFGMask, m_nDefaultMedianBlurKernelSize);
   m_oLastFGMask.copyTo(oCurrFGMask);
 }
@@ -32,7 +32,8 @@ namespace bgslibrary
         For more details on the different parameters or on the algorithm itself, see P.-L. St-Charles and
         G.-A. Bilodeau, "Improving Background Subtraction using Local Binary Similarity Patterns", in WACV 2014.
 
-        This algorithm is currently NOT thread-safe.
+        A single instance is NOT thread-safe, but apply can analyze the frame in several row bands concurrently
+        (see BackgroundSubtractorLBSP::setParallelBands).
       */
       class BackgroundSubtractorLOBSTER : public BackgroundSubtractorLBSP {
       public:
@@ -57,6 +58,18 @@ namespace bgslibrary
         virtual void getBackgroundDescriptorsImage(cv::OutputArray backgroundDescImage) const;
 
       protected:
+        //! model update of a neighbour owned by another row band, applied after all bands are done
+        struct DeferredUpdate {
+          size_t nPxIter;
+          size_t nSampleIdx;
+          ushort anDesc[3];
+          uchar anColor[3];
+        };
+        //! analyzes the pixels of a row band
+        void applyBand(size_t nBandIdx, const cv::Mat& oInputImg, cv::Mat& oCurrFGMask, size_t nLearningRate);
+        //! applies a neighbour update deferred by applyBand
+        void applyDeferredUpdate(const DeferredUpdate& oUpdate);
+
         //! absolute color distance threshold
         const size_t m_nColorDistThreshold;
         //! absolute descriptor distance threshold
@@ -69,6 +82,8 @@ namespace bgslibrary
         std::vector<cv::Mat> m_voBGColorSamples;
         //! background model descriptors samples
         std::vector<cv::Mat> m_voBGDescSamples;
+        //! neighbour updates deferred by each row band during the current frame
+        std::vector<std::vector<DeferredUpdate>> m_vvBandDeferredUpdates;
       };
     }
   }
@@ -8,6 +8,7 @@
 
 #include "BackgroundSubtractorPAWCS.h"
 #include "RandUtils.h"
+#include "LBSPRows.h"
 
 //using namespace bgslibrary::algorithms::lbsp;
 
@@ -90,16 +91,9 @@ namespace bgslibrary
         , m_nMedianBlurKernelSize(m_nDefaultMedianBlurKernelSize)
         , m_nDownSampledROIPxCount(0)
         , m_nLocalWordWeightOffset(DEFAULT_LWORD_WEIGHT_OFFSET)
-        , m_apLocalWordDict(nullptr)
-        , m_aLocalWordList_1ch(nullptr)
-        , m_pLocalWordListIter_1ch(nullptr)
-        , m_aLocalWordList_3ch(nullptr)
-        , m_pLocalWordListIter_3ch(nullptr)
-        , m_apGlobalWordDict(nullptr)
+        , m_nLocalWordSize(0)
         , m_aGlobalWordList_1ch(nullptr)
-        , m_pGlobalWordListIter_1ch(nullptr)
         , m_aGlobalWordList_3ch(nullptr)
-        , m_pGlobalWordListIter_3ch(nullptr)
         , m_aPxInfoLUT_PAWCS(nullptr) {
         CV_Assert(m_nMaxLocalWords > 0 && m_nMaxGlobalWords > 0);
       }
@@ -232,18 +226,22 @@ namespace bgslibrary
         m_aPxInfoLUT_PAWCS = new PxInfo_PAWCS[m_nTotPxCount];
         memset(m_aPxInfoLUT_PAWCS, 0, sizeof(PxInfo_PAWCS)*m_nTotPxCount);
         m_aPxInfoLUT = m_aPxInfoLUT_PAWCS;
-        m_apLocalWordDict = new LocalWordBase*[m_nTotRelevantPxCount*m_nCurrLocalWords];
-        memset(m_apLocalWordDict, 0, sizeof(LocalWordBase*)*m_nTotRelevantPxCount*m_nCurrLocalWords);
-        m_apGlobalWordDict = new GlobalWordBase*[m_nCurrGlobalWords];
-        memset(m_apGlobalWordDict, 0, sizeof(GlobalWordBase*)*m_nCurrGlobalWords);
+        // all words live in a few large blocks and are referred to with 32-bit indices
+        CV_Assert(m_nTotRelevantPxCount*m_nCurrLocalWords < (size_t)EMPTY_WORD_IDX);
+        m_nLocalWordSize = (m_nImgChannels == 1) ? sizeof(LocalWord_1ch) : sizeof(LocalWord_3ch);
+        const bool bAllocated =
+          m_aLocalWordArena.allocate(m_nTotRelevantPxCount*m_nCurrLocalWords*m_nLocalWordSize) &&
+          m_anLocalWordDict.allocate(m_nTotRelevantPxCount*m_nCurrLocalWords) &&
+          m_anGlobalWordDict.allocate(m_nCurrGlobalWords) &&
+          m_anGlobalWordSortLUT.allocate(m_nTotRelevantPxCount*m_nCurrGlobalWords);
+        CV_Assert(bAllocated);
+        memset(m_aLocalWordArena.data(), 0, m_aLocalWordArena.bytes());
+        memset(m_anLocalWordDict.data(), 0xFF, m_anLocalWordDict.bytes()); // EMPTY_WORD_IDX
+        memset(m_anGlobalWordDict.data(), 0xFF, m_anGlobalWordDict.bytes()); // EMPTY_WORD_IDX
         if (m_nImgChannels == 1) {
           CV_DbgAssert(m_oLastColorFrame.step.p[0] == (size_t)m_oImgSize.width && m_oLastColorFrame.step.p[1] == 1);
           CV_DbgAssert(m_oLastDescFrame.step.p[0] == m_oLastColorFrame.step.p[0] * 2 && m_oLastDescFrame.step.p[1] == m_oLastColorFrame.step.p[1] * 2);
-          m_aLocalWordList_1ch = new LocalWord_1ch[m_nTotRelevantPxCount*m_nCurrLocalWords];
-          memset(m_aLocalWordList_1ch, 0, sizeof(LocalWord_1ch)*m_nTotRelevantPxCount*m_nCurrLocalWords);
-          m_pLocalWordListIter_1ch = m_aLocalWordList_1ch;
           m_aGlobalWordList_1ch = new GlobalWord_1ch[m_nCurrGlobalWords];
-          m_pGlobalWordListIter_1ch = m_aGlobalWordList_1ch;
           for (size_t t = 0; t <= UCHAR_MAX; ++t)
             m_anLBSPThreshold_8bitLUT[t] = cv::saturate_cast<uchar>((m_nLBSPThresholdOffset + t*m_fRelLBSPThreshold) / 3);
           for (size_t nPxIter = 0, nModelIter = 0; nPxIter < m_nTotPxCount; ++nPxIter) {
@@ -253,9 +251,8 @@ namespace bgslibrary
               m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_X = (int)nPxIter%m_oImgSize.width;
               m_aPxInfoLUT_PAWCS[nPxIter].nModelIdx = nModelIter;
               m_aPxInfoLUT_PAWCS[nPxIter].nGlobalWordMapLookupIdx = (size_t)((m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_Y / GWORD_LOOKUP_MAPS_DOWNSAMPLE_RATIO)*m_oDownSampledFrameSize_GlobalWordLookup.width + (m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_X / GWORD_LOOKUP_MAPS_DOWNSAMPLE_RATIO)) * 4;
-              m_aPxInfoLUT_PAWCS[nPxIter].apGlobalDictSortLUT = new GlobalWordBase*[m_nCurrGlobalWords];
               for (size_t nGlobalWordIdxIter = 0; nGlobalWordIdxIter < m_nCurrGlobalWords; ++nGlobalWordIdxIter)
-                m_aPxInfoLUT_PAWCS[nPxIter].apGlobalDictSortLUT[nGlobalWordIdxIter] = &(m_aGlobalWordList_1ch[nGlobalWordIdxIter]);
+                m_anGlobalWordSortLUT[nModelIter*m_nCurrGlobalWords + nGlobalWordIdxIter] = (uint32_t)nGlobalWordIdxIter;
               m_oLastColorFrame.data[nPxIter] = oInitImg.data[nPxIter];
               const size_t nDescIter = nPxIter * 2;
               LBSP_::computeGrayscaleDescriptor(oInitImg, oInitImg.data[nPxIter], m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_X, m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_Y, m_anLBSPThreshold_8bitLUT[oInitImg.data[nPxIter]], *((ushort*)(m_oLastDescFrame.data + nDescIter)));
@@ -266,11 +263,7 @@ namespace bgslibrary
         else { //m_nImgChannels==3
           CV_DbgAssert(m_oLastColorFrame.step.p[0] == (size_t)m_oImgSize.width * 3 && m_oLastColorFrame.step.p[1] == 3);
           CV_DbgAssert(m_oLastDescFrame.step.p[0] == m_oLastColorFrame.step.p[0] * 2 && m_oLastDescFrame.step.p[1] == m_oLastColorFrame.step.p[1] * 2);
-          m_aLocalWordList_3ch = new LocalWord_3ch[m_nTotRelevantPxCount*m_nCurrLocalWords];
-          memset(m_aLocalWordList_3ch, 0, sizeof(LocalWord_3ch)*m_nTotRelevantPxCount*m_nCurrLocalWords);
-          m_pLocalWordListIter_3ch = m_aLocalWordList_3ch;
           m_aGlobalWordList_3ch = new GlobalWord_3ch[m_nCurrGlobalWords];
-          m_pGlobalWordListIter_3ch = m_aGlobalWordList_3ch;
           for (size_t t = 0; t <= UCHAR_MAX; ++t)
             m_anLBSPThreshold_8bitLUT[t] = cv::saturate_cast<uchar>(m_nLBSPThresholdOffset + t*m_fRelLBSPThreshold);
           for (size_t nPxIter = 0, nModelIter = 0; nPxIter < m_nTotPxCount; ++nPxIter) {
@@ -280,9 +273,8 @@ namespace bgslibrary
               m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_X = (int)nPxIter%m_oImgSize.width;
               m_aPxInfoLUT_PAWCS[nPxIter].nModelIdx = nModelIter;
               m_aPxInfoLUT_PAWCS[nPxIter].nGlobalWordMapLookupIdx = (size_t)((m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_Y / GWORD_LOOKUP_MAPS_DOWNSAMPLE_RATIO)*m_oDownSampledFrameSize_GlobalWordLookup.width + (m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_X / GWORD_LOOKUP_MAPS_DOWNSAMPLE_RATIO)) * 4;
-              m_aPxInfoLUT_PAWCS[nPxIter].apGlobalDictSortLUT = new GlobalWordBase*[m_nCurrGlobalWords];
               for (size_t nGlobalWordIdxIter = 0; nGlobalWordIdxIter < m_nCurrGlobalWords; ++nGlobalWordIdxIter)
-                m_aPxInfoLUT_PAWCS[nPxIter].apGlobalDictSortLUT[nGlobalWordIdxIter] = &(m_aGlobalWordList_3ch[nGlobalWordIdxIter]);
+                m_anGlobalWordSortLUT[nModelIter*m_nCurrGlobalWords + nGlobalWordIdxIter] = (uint32_t)nGlobalWordIdxIter;
               const size_t nPxRGBIter = nPxIter * 3;
               const size_t nDescRGBIter = nPxRGBIter * 2;
               for (size_t c = 0; c < 3; ++c) {
@@ -314,7 +306,7 @@ namespace bgslibrary
               // == refresh: local decr
               if (fOccDecrFrac > 0.0f) {
                 for (size_t nLocalWordIdx = 0; nLocalWordIdx < m_nCurrLocalWords; ++nLocalWordIdx) {
-                  LocalWord_1ch* pCurrLocalWord = (LocalWord_1ch*)m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx];
+                  LocalWord_1ch* pCurrLocalWord = (LocalWord_1ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]);
                   if (pCurrLocalWord)
                     pCurrLocalWord->nOccurrences -= (size_t)(fOccDecrFrac*pCurrLocalWord->nOccurrences);
                 }
@@ -324,16 +316,16 @@ namespace bgslibrary
               for (size_t nLocalSamplingIter = 0; nLocalSamplingIter < nTotLocalSamplingIterCount; ++nLocalSamplingIter) {
                 // == refresh: local resampling
                 int nSampleImgCoord_Y, nSampleImgCoord_X;
-                getRandSamplePosition(nSampleImgCoord_X, nSampleImgCoord_Y, m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_X, m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_Y, LBSP_::PATCH_SIZE / 2, m_oImgSize);
+                getRandSamplePosition(m_oRNG, nSampleImgCoord_X, nSampleImgCoord_Y, m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_X, m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_Y, LBSP_::PATCH_SIZE / 2, m_oImgSize);
                 const size_t nSamplePxIdx = m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
                 if (bForceFGUpdate || !m_oLastFGMask_dilated.data[nSamplePxIdx]) {
                   const uchar nSampleColor = m_oLastColorFrame.data[nSamplePxIdx];
                   const size_t nSampleDescIdx = nSamplePxIdx * 2;
                   const ushort nSampleIntraDesc = *((ushort*)(m_oLastDescFrame.data + nSampleDescIdx));
-                  bool bFoundUninitd = false;
+                  size_t nUninitdLocalWords = 0;
                   size_t nLocalWordIdx;
                   for (nLocalWordIdx = 0; nLocalWordIdx < m_nCurrLocalWords; ++nLocalWordIdx) {
-                    LocalWord_1ch* pCurrLocalWord = (LocalWord_1ch*)m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx];
+                    LocalWord_1ch* pCurrLocalWord = (LocalWord_1ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]);
                     if (pCurrLocalWord
                       && L1dist(nSampleColor, pCurrLocalWord->oFeature.anColor[0]) <= nCurrColorDistThreshold
                       && hdist(nSampleIntraDesc, pCurrLocalWord->oFeature.anDesc[0]) <= nCurrDescDistThreshold) {
@@ -342,44 +334,45 @@ namespace bgslibrary
                       break;
                     }
                     else if (!pCurrLocalWord)
-                      bFoundUninitd = true;
+                      ++nUninitdLocalWords;
                   }
                   if (nLocalWordIdx == m_nCurrLocalWords) {
                     nLocalWordIdx = m_nCurrLocalWords - 1;
-                    LocalWord_1ch* pCurrLocalWord = bFoundUninitd ? m_pLocalWordListIter_1ch++ : (LocalWord_1ch*)m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx];
+                    if (nUninitdLocalWords) // takes the next unused word of the px slot
+                      m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx] = (uint32_t)(nLocalDictIdx + m_nCurrLocalWords - nUninitdLocalWords);
+                    LocalWord_1ch* pCurrLocalWord = (LocalWord_1ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]);
                     pCurrLocalWord->oFeature.anColor[0] = nSampleColor;
                     pCurrLocalWord->oFeature.anDesc[0] = nSampleIntraDesc;
                     pCurrLocalWord->nOccurrences = nBaseOccCount;
                     pCurrLocalWord->nFirstOcc = m_nFrameIndex;
                     pCurrLocalWord->nLastOcc = m_nFrameIndex;
-                    m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx] = pCurrLocalWord;
                   }
-                  while (nLocalWordIdx > 0 && (!m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1] || GetLocalWordWeight(m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx], m_nFrameIndex, m_nLocalWordWeightOffset) > GetLocalWordWeight(m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1], m_nFrameIndex, m_nLocalWordWeightOffset))) {
-                    std::swap(m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx], m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1]);
+                  while (nLocalWordIdx > 0 && (m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1] == EMPTY_WORD_IDX || GetLocalWordWeight(GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]), m_nFrameIndex, m_nLocalWordWeightOffset) > GetLocalWordWeight(GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1]), m_nFrameIndex, m_nLocalWordWeightOffset))) {
+                    std::swap(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx], m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1]);
                     --nLocalWordIdx;
                   }
                 }
               }
-              CV_Assert(m_apLocalWordDict[nLocalDictIdx]);
+              CV_Assert(m_anLocalWordDict[nLocalDictIdx] != EMPTY_WORD_IDX);
               for (size_t nLocalWordIdx = 1; nLocalWordIdx < m_nCurrLocalWords; ++nLocalWordIdx) {
                 // == refresh: local random resampling
-                LocalWord_1ch* pCurrLocalWord = (LocalWord_1ch*)m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx];
+                LocalWord_1ch* pCurrLocalWord = (LocalWord_1ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]);
                 if (!pCurrLocalWord) {
-                  const size_t nRandLocalWordIdx = (rand() % nLocalWordIdx);
-                  const LocalWord_1ch* pRefLocalWord = (LocalWord_1ch*)m_apLocalWordDict[nLocalDictIdx + nRandLocalWordIdx];
-                  const int nRandColorOffset = (rand() % (nCurrColorDistThreshold + 1)) - (int)nCurrColorDistThreshold / 2;
-                  pCurrLocalWord = m_pLocalWordListIter_1ch++;
+                  const size_t nRandLocalWordIdx = (m_oRNG() % nLocalWordIdx);
+                  const LocalWord_1ch* pRefLocalWord = (LocalWord_1ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nRandLocalWordIdx]);
+                  const int nRandColorOffset = (m_oRNG() % (nCurrColorDistThreshold + 1)) - (int)nCurrColorDistThreshold / 2;
+                  // the used entries always come first, so this is the next unused word of the px slot
+                  m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx] = (uint32_t)(nLocalDictIdx + nLocalWordIdx);
+                  pCurrLocalWord = (LocalWord_1ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]);
                   pCurrLocalWord->oFeature.anColor[0] = cv::saturate_cast<uchar>((int)pRefLocalWord->oFeature.anColor[0] + nRandColorOffset);
                   pCurrLocalWord->oFeature.anDesc[0] = pRefLocalWord->oFeature.anDesc[0];
                   pCurrLocalWord->nOccurrences = std::max((size_t)(pRefLocalWord->nOccurrences*((float)(m_nCurrLocalWords - nLocalWordIdx) / m_nCurrLocalWords)), (size_t)1);
                   pCurrLocalWord->nFirstOcc = m_nFrameIndex;
                   pCurrLocalWord->nLastOcc = m_nFrameIndex;
-                  m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx] = pCurrLocalWord;
                 }
               }
             }
           }
-          CV_Assert(m_aLocalWordList_1ch == (m_pLocalWordListIter_1ch - m_nTotRelevantPxCount*m_nCurrLocalWords));
           cv::Mat oGlobalDictPresenceLookupMap(m_oImgSize, CV_8UC1, cv::Scalar_<uchar>(0));
           size_t nPxIterIncr = std::max(m_nTotPxCount / m_nCurrGlobalWords, (size_t)1);
           for (size_t nSamplingPasses = 0; nSamplingPasses < GWORD_DEFAULT_NB_INIT_SAMPL_PASSES; ++nSamplingPasses) {
@@ -395,40 +388,41 @@ namespace bgslibrary
                   const float fCurrDistThresholdFactor = *(float*)(m_oDistThresholdFrame.data + nFloatIter);
                   const size_t nCurrColorDistThreshold = (size_t)(sqrt(fCurrDistThresholdFactor)*m_nMinColorDistThreshold) / 2;
                   const size_t nCurrDescDistThreshold = ((size_t)1 << ((size_t)floor(fCurrDistThresholdFactor + 0.5f))) + m_nDescDistThresholdOffset + (bCurrRegionIsUnstable*UNSTAB_DESC_DIST_OFFSET);
-                  CV_Assert(m_apLocalWordDict[nLocalDictIdx]);
-                  const LocalWord_1ch* pRefBestLocalWord = (LocalWord_1ch*)m_apLocalWordDict[nLocalDictIdx];
+                  CV_Assert(m_anLocalWordDict[nLocalDictIdx] != EMPTY_WORD_IDX);
+                  const LocalWord_1ch* pRefBestLocalWord = (LocalWord_1ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx]);
                   const float fRefBestLocalWordWeight = GetLocalWordWeight(pRefBestLocalWord, m_nFrameIndex, m_nLocalWordWeightOffset);
                   const uchar nRefBestLocalWordDescBITS = (uchar)popcount(pRefBestLocalWord->oFeature.anDesc[0]);
-                  bool bFoundUninitd = false;
+                  size_t nUninitdGlobalWords = 0;
                   size_t nGlobalWordIdx;
                   for (nGlobalWordIdx = 0; nGlobalWordIdx < m_nCurrGlobalWords; ++nGlobalWordIdx) {
-                    GlobalWord_1ch* pCurrGlobalWord = (GlobalWord_1ch*)m_apGlobalWordDict[nGlobalWordIdx];
+                    GlobalWord_1ch* pCurrGlobalWord = (GlobalWord_1ch*)GetGlobalWord(m_anGlobalWordDict[nGlobalWordIdx]);
                     if (pCurrGlobalWord
                       && L1dist(pCurrGlobalWord->oFeature.anColor[0], pRefBestLocalWord->oFeature.anColor[0]) <= nCurrColorDistThreshold
                       && L1dist(nRefBestLocalWordDescBITS, pCurrGlobalWord->nDescBITS) <= nCurrDescDistThreshold / GWORD_DESC_THRES_BITS_MATCH_FACTOR)
                       break;
                     else if (!pCurrGlobalWord)
-                      bFoundUninitd = true;
+                      ++nUninitdGlobalWords;
                   }
                   if (nGlobalWordIdx == m_nCurrGlobalWords) {
                     nGlobalWordIdx = m_nCurrGlobalWords - 1;
-                    GlobalWord_1ch* pCurrGlobalWord = bFoundUninitd ? m_pGlobalWordListIter_1ch++ : (GlobalWord_1ch*)m_apGlobalWordDict[nGlobalWordIdx];
+                    if (nUninitdGlobalWords) // takes the next unused word of the list
+                      m_anGlobalWordDict[nGlobalWordIdx] = (uint32_t)(m_nCurrGlobalWords - nUninitdGlobalWords);
+                    GlobalWord_1ch* pCurrGlobalWord = (GlobalWord_1ch*)GetGlobalWord(m_anGlobalWordDict[nGlobalWordIdx]);
                     pCurrGlobalWord->oFeature.anColor[0] = pRefBestLocalWord->oFeature.anColor[0];
                     pCurrGlobalWord->oFeature.anDesc[0] = pRefBestLocalWord->oFeature.anDesc[0];
                     pCurrGlobalWord->nDescBITS = nRefBestLocalWordDescBITS;
                     pCurrGlobalWord->oSpatioOccMap.create(m_oDownSampledFrameSize_GlobalWordLookup, CV_32FC1);
                     pCurrGlobalWord->oSpatioOccMap = cv::Scalar(0.0f);
                     pCurrGlobalWord->fLatestWeight = 0.0f;
-                    m_apGlobalWordDict[nGlobalWordIdx] = pCurrGlobalWord;
                   }
-                  float& fCurrGlobalWordLocalWeight = *(float*)(m_apGlobalWordDict[nGlobalWordIdx]->oSpatioOccMap.data + nGlobalWordMapLookupIdx);
+                  float& fCurrGlobalWordLocalWeight = *(float*)(GetGlobalWord(m_anGlobalWordDict[nGlobalWordIdx])->oSpatioOccMap.data + nGlobalWordMapLookupIdx);
                   if (fCurrGlobalWordLocalWeight < fRefBestLocalWordWeight) {
-                    m_apGlobalWordDict[nGlobalWordIdx]->fLatestWeight += fRefBestLocalWordWeight;
+                    GetGlobalWord(m_anGlobalWordDict[nGlobalWordIdx])->fLatestWeight += fRefBestLocalWordWeight;
                     fCurrGlobalWordLocalWeight += fRefBestLocalWordWeight;
                   }
                   oGlobalDictPresenceLookupMap.data[nPxIter] = UCHAR_MAX;
-                  while (nGlobalWordIdx > 0 && (!m_apGlobalWordDict[nGlobalWordIdx - 1] || m_apGlobalWordDict[nGlobalWordIdx]->fLatestWeight > m_apGlobalWordDict[nGlobalWordIdx - 1]->fLatestWeight)) {
-                    std::swap(m_apGlobalWordDict[nGlobalWordIdx], m_apGlobalWordDict[nGlobalWordIdx - 1]);
+                  while (nGlobalWordIdx > 0 && (m_anGlobalWordDict[nGlobalWordIdx - 1] == EMPTY_WORD_IDX || GetGlobalWord(m_anGlobalWordDict[nGlobalWordIdx])->fLatestWeight > GetGlobalWord(m_anGlobalWordDict[nGlobalWordIdx - 1])->fLatestWeight)) {
+                    std::swap(m_anGlobalWordDict[nGlobalWordIdx], m_anGlobalWordDict[nGlobalWordIdx - 1]);
                     --nGlobalWordIdx;
                   }
                 }
@@ -437,19 +431,18 @@ namespace bgslibrary
             nPxIterIncr = std::max(nPxIterIncr / 3, (size_t)1);
           }
           for (size_t nGlobalWordIdx = 0; nGlobalWordIdx < m_nCurrGlobalWords; ++nGlobalWordIdx) {
-            GlobalWord_1ch* pCurrGlobalWord = (GlobalWord_1ch*)m_apGlobalWordDict[nGlobalWordIdx];
+            GlobalWord_1ch* pCurrGlobalWord = (GlobalWord_1ch*)GetGlobalWord(m_anGlobalWordDict[nGlobalWordIdx]);
             if (!pCurrGlobalWord) {
-              pCurrGlobalWord = m_pGlobalWordListIter_1ch++;
+              m_anGlobalWordDict[nGlobalWordIdx] = (uint32_t)nGlobalWordIdx;
+              pCurrGlobalWord = (GlobalWord_1ch*)GetGlobalWord(m_anGlobalWordDict[nGlobalWordIdx]);
               pCurrGlobalWord->oFeature.anColor[0] = 0;
               pCurrGlobalWord->oFeature.anDesc[0] = 0;
               pCurrGlobalWord->nDescBITS = 0;
               pCurrGlobalWord->oSpatioOccMap.create(m_oDownSampledFrameSize_GlobalWordLookup, CV_32FC1);
               pCurrGlobalWord->oSpatioOccMap = cv::Scalar(0.0f);
               pCurrGlobalWord->fLatestWeight = 0.0f;
-              m_apGlobalWordDict[nGlobalWordIdx] = pCurrGlobalWord;
             }
           }
-          CV_Assert((size_t)(m_pGlobalWordListIter_1ch - m_aGlobalWordList_1ch) == m_nCurrGlobalWords && m_aGlobalWordList_1ch == (m_pGlobalWordListIter_1ch - m_nCurrGlobalWords));
         }
         else { //m_nImgChannels==3
           for (size_t nModelIter = 0; nModelIter < m_nTotRelevantPxCount; ++nModelIter) {
@@ -464,7 +457,7 @@ namespace bgslibrary
               // == refresh: local decr
               if (fOccDecrFrac > 0.0f) {
                 for (size_t nLocalWordIdx = 0; nLocalWordIdx < m_nCurrLocalWords; ++nLocalWordIdx) {
-                  LocalWord_3ch* pCurrLocalWord = (LocalWord_3ch*)m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx];
+                  LocalWord_3ch* pCurrLocalWord = (LocalWord_3ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]);
                   if (pCurrLocalWord)
                     pCurrLocalWord->nOccurrences -= (size_t)(fOccDecrFrac*pCurrLocalWord->nOccurrences);
                 }
@@ -474,17 +467,17 @@ namespace bgslibrary
               for (size_t nLocalSamplingIter = 0; nLocalSamplingIter < nTotLocalSamplingIterCount; ++nLocalSamplingIter) {
                 // == refresh: local resampling
                 int nSampleImgCoord_Y, nSampleImgCoord_X;
-                getRandSamplePosition(nSampleImgCoord_X, nSampleImgCoord_Y, m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_X, m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_Y, LBSP_::PATCH_SIZE / 2, m_oImgSize);
+                getRandSamplePosition(m_oRNG, nSampleImgCoord_X, nSampleImgCoord_Y, m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_X, m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_Y, LBSP_::PATCH_SIZE / 2, m_oImgSize);
                 const size_t nSamplePxIdx = m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
                 if (bForceFGUpdate || !m_oLastFGMask_dilated.data[nSamplePxIdx]) {
                   const size_t nSamplePxRGBIdx = nSamplePxIdx * 3;
                   const size_t nSampleDescRGBIdx = nSamplePxRGBIdx * 2;
                   const uchar* const anSampleColor = m_oLastColorFrame.data + nSamplePxRGBIdx;
                   const ushort* const anSampleIntraDesc = ((ushort*)(m_oLastDescFrame.data + nSampleDescRGBIdx));
-                  bool bFoundUninitd = false;
+                  size_t nUninitdLocalWords = 0;
                   size_t nLocalWordIdx;
                   for (nLocalWordIdx = 0; nLocalWordIdx < m_nCurrLocalWords; ++nLocalWordIdx) {
-                    LocalWord_3ch* pCurrLocalWord = (LocalWord_3ch*)m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx];
+                    LocalWord_3ch* pCurrLocalWord = (LocalWord_3ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]);
                     if (pCurrLocalWord
                       && cmixdist<3>(anSampleColor, pCurrLocalWord->oFeature.anColor) <= nCurrTotColorDistThreshold
                       && hdist<3>(anSampleIntraDesc, pCurrLocalWord->oFeature.anDesc) <= nCurrTotDescDistThreshold) {
@@ -493,11 +486,13 @@ namespace bgslibrary
                       break;
                     }
                     else if (!pCurrLocalWord)
-                      bFoundUninitd = true;
+                      ++nUninitdLocalWords;
                   }
                   if (nLocalWordIdx == m_nCurrLocalWords) {
                     nLocalWordIdx = m_nCurrLocalWords - 1;
-                    LocalWord_3ch* pCurrLocalWord = bFoundUninitd ? m_pLocalWordListIter_3ch++ : (LocalWord_3ch*)m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx];
+                    if (nUninitdLocalWords) // takes the next unused word of the px slot
+                      m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx] = (uint32_t)(nLocalDictIdx + m_nCurrLocalWords - nUninitdLocalWords);
+                    LocalWord_3ch* pCurrLocalWord = (LocalWord_3ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]);
                     for (size_t c = 0; c < 3; ++c) {
                       pCurrLocalWord->oFeature.anColor[c] = anSampleColor[c];
                       pCurrLocalWord->oFeature.anDesc[c] = anSampleIntraDesc[c];
@@ -505,23 +500,24 @@ namespace bgslibrary
                     pCurrLocalWord->nOccurrences = nBaseOccCount;
                     pCurrLocalWord->nFirstOcc = m_nFrameIndex;
                     pCurrLocalWord->nLastOcc = m_nFrameIndex;
-                    m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx] = pCurrLocalWord;
                   }
-                  while (nLocalWordIdx > 0 && (!m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1] || GetLocalWordWeight(m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx], m_nFrameIndex, m_nLocalWordWeightOffset) > GetLocalWordWeight(m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1], m_nFrameIndex, m_nLocalWordWeightOffset))) {
-                    std::swap(m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx], m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1]);
+                  while (nLocalWordIdx > 0 && (m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1] == EMPTY_WORD_IDX || GetLocalWordWeight(GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]), m_nFrameIndex, m_nLocalWordWeightOffset) > GetLocalWordWeight(GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1]), m_nFrameIndex, m_nLocalWordWeightOffset))) {
+                    std::swap(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx], m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1]);
                     --nLocalWordIdx;
                   }
                 }
               }
-              CV_Assert(m_apLocalWordDict[nLocalDictIdx]);
+              CV_Assert(m_anLocalWordDict[nLocalDictIdx] != EMPTY_WORD_IDX);
               for (size_t nLocalWordIdx = 1; nLocalWordIdx < m_nCurrLocalWords; ++nLocalWordIdx) {
                 // == refresh: local random resampling
-                LocalWord_3ch* pCurrLocalWord = (LocalWord_3ch*)m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx];
+                LocalWord_3ch* pCurrLocalWord = (LocalWord_3ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]);
                 if (!pCurrLocalWord) {
-                  const size_t nRandLocalWordIdx = (rand() % nLocalWordIdx);
-                  const LocalWord_3ch* pRefLocalWord = (LocalWord_3ch*)m_apLocalWordDict[nLocalDictIdx + nRandLocalWordIdx];
-                  const int nRandColorOffset = (rand() % (nCurrTotColorDistThreshold / 3 + 1)) - (int)(nCurrTotColorDistThreshold / 6);
-                  pCurrLocalWord = m_pLocalWordListIter_3ch++;
+                  const size_t nRandLocalWordIdx = (m_oRNG() % nLocalWordIdx);
+                  const LocalWord_3ch* pRefLocalWord = (LocalWord_3ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nRandLocalWordIdx]);
+                  const int nRandColorOffset = (m_oRNG() % (nCurrTotColorDistThreshold / 3 + 1)) - (int)(nCurrTotColorDistThreshold / 6);
+                  // the used entries always come first, so this is the next unused word of the px slot
+                  m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx] = (uint32_t)(nLocalDictIdx + nLocalWordIdx);
+                  pCurrLocalWord = (LocalWord_3ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]);
                   for (size_t c = 0; c < 3; ++c) {
                     pCurrLocalWord->oFeature.anColor[c] = cv::saturate_cast<uchar>((int)pRefLocalWord->oFeature.anColor[c] + nRandColorOffset);
                     pCurrLocalWord->oFeature.anDesc[c] = pRefLocalWord->oFeature.anDesc[c];
@@ -529,12 +525,10 @@ namespace bgslibrary
                   pCurrLocalWord->nOccurrences = std::max((size_t)(pRefLocalWord->nOccurrences*((float)(m_nCurrLocalWords - nLocalWordIdx) / m_nCurrLocalWords)), (size_t)1);
                   pCurrLocalWord->nFirstOcc = m_nFrameIndex;
                   pCurrLocalWord->nLastOcc = m_nFrameIndex;
-                  m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx] = pCurrLocalWord;
                 }
               }
             }
           }
-          CV_Assert(m_aLocalWordList_3ch == (m_pLocalWordListIter_3ch - m_nTotRelevantPxCount*m_nCurrLocalWords));
           cv::Mat oGlobalDictPresenceLookupMap(m_oImgSize, CV_8UC1, cv::Scalar_<uchar>(0));
           size_t nPxIterIncr = std::max(m_nTotPxCount / m_nCurrGlobalWords, (size_t)1);
           for (size_t nSamplingPasses = 0; nSamplingPasses < GWORD_DEFAULT_NB_INIT_SAMPL_PASSES; ++nSamplingPasses) {
@@ -550,24 +544,26 @@ namespace bgslibrary
                   const float fCurrDistThresholdFactor = *(float*)(m_oDistThresholdFrame.data + nFloatIter);
                   const size_t nCurrTotColorDistThreshold = (size_t)(sqrt(fCurrDistThresholdFactor)*m_nMinColorDistThreshold) * 3;
                   const size_t nCurrTotDescDistThreshold = (((size_t)1 << ((size_t)floor(fCurrDistThresholdFactor + 0.5f))) + m_nDescDistThresholdOffset + (bCurrRegionIsUnstable*UNSTAB_DESC_DIST_OFFSET)) * 3;
-                  CV_Assert(m_apLocalWordDict[nLocalDictIdx]);
-                  const LocalWord_3ch* pRefBestLocalWord = (LocalWord_3ch*)m_apLocalWordDict[nLocalDictIdx];
+                  CV_Assert(m_anLocalWordDict[nLocalDictIdx] != EMPTY_WORD_IDX);
+                  const LocalWord_3ch* pRefBestLocalWord = (LocalWord_3ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx]);
                   const float fRefBestLocalWordWeight = GetLocalWordWeight(pRefBestLocalWord, m_nFrameIndex, m_nLocalWordWeightOffset);
                   const uchar nRefBestLocalWordDescBITS = (uchar)popcount<3>(pRefBestLocalWord->oFeature.anDesc);
-                  bool bFoundUninitd = false;
+                  size_t nUninitdGlobalWords = 0;
                   size_t nGlobalWordIdx;
                   for (nGlobalWordIdx = 0; nGlobalWordIdx < m_nCurrGlobalWords; ++nGlobalWordIdx) {
-                    GlobalWord_3ch* pCurrGlobalWord = (GlobalWord_3ch*)m_apGlobalWordDict[nGlobalWordIdx];
+                    GlobalWord_3ch* pCurrGlobalWord = (GlobalWord_3ch*)GetGlobalWord(m_anGlobalWordDict[nGlobalWordIdx]);
                     if (pCurrGlobalWord
                       && L1dist(nRefBestLocalWordDescBITS, pCurrGlobalWord->nDescBITS) <= nCurrTotDescDistThreshold / GWORD_DESC_THRES_BITS_MATCH_FACTOR
                       && cmixdist<3>(pRefBestLocalWord->oFeature.anColor, pCurrGlobalWord->oFeature.anColor) <= nCurrTotColorDistThreshold)
                       break;
                     else if (!pCurrGlobalWord)
-                      bFoundUninitd = true;
+                      ++nUninitdGlobalWords;
                   }
                   if (nGlobalWordIdx == m_nCurrGlobalWords) {
                     nGlobalWordIdx = m_nCurrGlobalWords - 1;
-                    GlobalWord_3ch* pCurrGlobalWord = bFoundUninitd ? m_pGlobalWordListIter_3ch++ : (GlobalWord_3ch*)m_apGlobalWordDict[nGlobalWordIdx];
+                    if (nUninitdGlobalWords) // takes the next unused word of the list
+                      m_anGlobalWordDict[nGlobalWordIdx] = (uint32_t)(m_nCurrGlobalWords - nUninitdGlobalWords);
+                    GlobalWord_3ch* pCurrGlobalWord = (GlobalWord_3ch*)GetGlobalWord(m_anGlobalWordDict[nGlobalWordIdx]);
                     for (size_t c = 0; c < 3; ++c) {
                       pCurrGlobalWord->oFeature.anColor[c] = pRefBestLocalWord->oFeature.anColor[c];
                       pCurrGlobalWord->oFeature.anDesc[c] = pRefBestLocalWord->oFeature.anDesc[c];
@@ -576,16 +572,15 @@ namespace bgslibrary
                     pCurrGlobalWord->oSpatioOccMap.create(m_oDownSampledFrameSize_GlobalWordLookup, CV_32FC1);
                     pCurrGlobalWord->oSpatioOccMap = cv::Scalar(0.0f);
                     pCurrGlobalWord->fLatestWeight = 0.0f;
-                    m_apGlobalWordDict[nGlobalWordIdx] = pCurrGlobalWord;
                   }
-                  float& fCurrGlobalWordLocalWeight = *(float*)(m_apGlobalWordDict[nGlobalWordIdx]->oSpatioOccMap.data + nGlobalWordMapLookupIdx);
+                  float& fCurrGlobalWordLocalWeight = *(float*)(GetGlobalWord(m_anGlobalWordDict[nGlobalWordIdx])->oSpatioOccMap.data + nGlobalWordMapLookupIdx);
                   if (fCurrGlobalWordLocalWeight < fRefBestLocalWordWeight) {
-                    m_apGlobalWordDict[nGlobalWordIdx]->fLatestWeight += fRefBestLocalWordWeight;
+                    GetGlobalWord(m_anGlobalWordDict[nGlobalWordIdx])->fLatestWeight += fRefBestLocalWordWeight;
                     fCurrGlobalWordLocalWeight += fRefBestLocalWordWeight;
                   }
                   oGlobalDictPresenceLookupMap.data[nPxIter] = UCHAR_MAX;
-                  while (nGlobalWordIdx > 0 && (!m_apGlobalWordDict[nGlobalWordIdx - 1] || m_apGlobalWordDict[nGlobalWordIdx]->fLatestWeight > m_apGlobalWordDict[nGlobalWordIdx - 1]->fLatestWeight)) {
-                    std::swap(m_apGlobalWordDict[nGlobalWordIdx], m_apGlobalWordDict[nGlobalWordIdx - 1]);
+                  while (nGlobalWordIdx > 0 && (m_anGlobalWordDict[nGlobalWordIdx - 1] == EMPTY_WORD_IDX || GetGlobalWord(m_anGlobalWordDict[nGlobalWordIdx])->fLatestWeight > GetGlobalWord(m_anGlobalWordDict[nGlobalWordIdx - 1])->fLatestWeight)) {
+                    std::swap(m_anGlobalWordDict[nGlobalWordIdx], m_anGlobalWordDict[nGlobalWordIdx - 1]);
                     --nGlobalWordIdx;
                   }
                 }
@@ -594,9 +589,10 @@ namespace bgslibrary
             nPxIterIncr = std::max(nPxIterIncr / 3, (size_t)1);
           }
           for (size_t nGlobalWordIdx = 0; nGlobalWordIdx < m_nCurrGlobalWords; ++nGlobalWordIdx) {
-            GlobalWord_3ch* pCurrGlobalWord = (GlobalWord_3ch*)m_apGlobalWordDict[nGlobalWordIdx];
+            GlobalWord_3ch* pCurrGlobalWord = (GlobalWord_3ch*)GetGlobalWord(m_anGlobalWordDict[nGlobalWordIdx]);
             if (!pCurrGlobalWord) {
-              pCurrGlobalWord = m_pGlobalWordListIter_3ch++;
+              m_anGlobalWordDict[nGlobalWordIdx] = (uint32_t)nGlobalWordIdx;
+              pCurrGlobalWord = (GlobalWord_3ch*)GetGlobalWord(m_anGlobalWordDict[nGlobalWordIdx]);
               for (size_t c = 0; c < 3; ++c) {
                 pCurrGlobalWord->oFeature.anColor[c] = 0;
                 pCurrGlobalWord->oFeature.anDesc[c] = 0;
@@ -605,20 +601,18 @@ namespace bgslibrary
               pCurrGlobalWord->oSpatioOccMap.create(m_oDownSampledFrameSize_GlobalWordLookup, CV_32FC1);
               pCurrGlobalWord->oSpatioOccMap = cv::Scalar(0.0f);
               pCurrGlobalWord->fLatestWeight = 0.0f;
-              m_apGlobalWordDict[nGlobalWordIdx] = pCurrGlobalWord;
             }
           }
-          CV_Assert((size_t)(m_pGlobalWordListIter_3ch - m_aGlobalWordList_3ch) == m_nCurrGlobalWords && m_aGlobalWordList_3ch == (m_pGlobalWordListIter_3ch - m_nCurrGlobalWords));
         }
         for (size_t nModelIter = 0; nModelIter < m_nTotRelevantPxCount; ++nModelIter) {
           // == refresh: per-px global word sort
           const size_t nPxIter = m_aPxIdxLUT[nModelIter];
           const size_t nGlobalWordMapLookupIdx = m_aPxInfoLUT_PAWCS[nPxIter].nGlobalWordMapLookupIdx;
-          float fLastGlobalWordLocalWeight = *(float*)(m_aPxInfoLUT_PAWCS[nPxIter].apGlobalDictSortLUT[0]->oSpatioOccMap.data + nGlobalWordMapLookupIdx);
+          float fLastGlobalWordLocalWeight = *(float*)(GetGlobalWord(m_anGlobalWordSortLUT[nModelIter*m_nCurrGlobalWords])->oSpatioOccMap.data + nGlobalWordMapLookupIdx);
           for (size_t nGlobalWordLUTIdx = 1; nGlobalWordLUTIdx < m_nCurrGlobalWords; ++nGlobalWordLUTIdx) {
-            const float fCurrGlobalWordLocalWeight = *(float*)(m_aPxInfoLUT_PAWCS[nPxIter].apGlobalDictSortLUT[nGlobalWordLUTIdx]->oSpatioOccMap.data + nGlobalWordMapLookupIdx);
+            const float fCurrGlobalWordLocalWeight = *(float*)(GetGlobalWord(m_anGlobalWordSortLUT[nModelIter*m_nCurrGlobalWords + nGlobalWordLUTIdx])->oSpatioOccMap.data + nGlobalWordMapLookupIdx);
             if (fCurrGlobalWordLocalWeight > fLastGlobalWordLocalWeight)
-              std::swap(m_aPxInfoLUT_PAWCS[nPxIter].apGlobalDictSortLUT[nGlobalWordLUTIdx], m_aPxInfoLUT_PAWCS[nPxIter].apGlobalDictSortLUT[nGlobalWordLUTIdx - 1]);
+              std::swap(m_anGlobalWordSortLUT[nModelIter*m_nCurrGlobalWords + nGlobalWordLUTIdx], m_anGlobalWordSortLUT[nModelIter*m_nCurrGlobalWords + nGlobalWordLUTIdx - 1]);
             else
               fLastGlobalWordLocalWeight = fCurrGlobalWordLocalWeight;
           }
@@ -641,6 +635,9 @@ namespace bgslibrary
         const float fRollAvgFactor_ST = 1.0f / std::min(m_nFrameIndex, nCurrSamplesForMovingAvg_ST);
         const size_t nCurrGlobalWordUpdateRate = bBootstrapping ? DEFAULT_RESAMPLING_RATE / 2 : DEFAULT_RESAMPLING_RATE;
         size_t nFlatRegionCount = 0;
+        m_vnCurrIntraDescRow.resize((size_t)m_oImgSize.width*m_nImgChannels);
+        const int nDescRowBorder = (int)LBSP_::PATCH_SIZE / 2;
+        int nCurrIntraDescRow = -1;
         if (m_nImgChannels == 1) {
           for (size_t nModelIter = 0; nModelIter < m_nTotRelevantPxCount; ++nModelIter) {
             const size_t nPxIter = m_aPxIdxLUT[nModelIter];
@@ -662,7 +659,7 @@ namespace bgslibrary
             float& fCurrLearningRate = *(float*)(m_oUpdateRateFrame.data + nFloatIter);
             float& fCurrMeanMinDist_LT = *(float*)(m_oMeanMinDistFrame_LT.data + nFloatIter);
             float& fCurrMeanMinDist_ST = *(float*)(m_oMeanMinDistFrame_ST.data + nFloatIter);
-            const float fBestLocalWordWeight = GetLocalWordWeight(m_apLocalWordDict[nLocalDictIdx], m_nFrameIndex, m_nLocalWordWeightOffset);
+            const float fBestLocalWordWeight = GetLocalWordWeight(GetLocalWord(m_anLocalWordDict[nLocalDictIdx]), m_nFrameIndex, m_nLocalWordWeightOffset);
             const float fLocalWordsWeightSumThreshold = fBestLocalWordWeight / (fCurrDistThresholdFactor * 2);
             uchar& bCurrRegionIsUnstable = m_oUnstableRegionMask.data[nPxIter];
             uchar& nCurrRegionIllumUpdtVal = m_oIllumUpdtRegionMask.data[nPxIter];
@@ -670,8 +667,12 @@ namespace bgslibrary
             const bool bCurrRegionIsROIBorder = m_oROI.data[nPxIter] < UCHAR_MAX;
             const int nCurrImgCoord_X = m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_X;
             const int nCurrImgCoord_Y = m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_Y;
-            ushort nCurrInterDesc, nCurrIntraDesc;
-            LBSP_::computeGrayscaleDescriptor(oInputImg, nCurrColor, nCurrImgCoord_X, nCurrImgCoord_Y, m_anLBSPThreshold_8bitLUT[nCurrColor], nCurrIntraDesc);
+            if (nCurrImgCoord_Y != nCurrIntraDescRow) {
+              nCurrIntraDescRow = nCurrImgCoord_Y;
+              computeDescriptorRow(oInputImg, nCurrImgCoord_Y, nDescRowBorder, m_oImgSize.width - nDescRowBorder, m_anLBSPThreshold_8bitLUT, m_vnCurrIntraDescRow.data() + nDescRowBorder);
+            }
+            ushort nCurrInterDesc;
+            const ushort nCurrIntraDesc = m_vnCurrIntraDescRow[nCurrImgCoord_X];
             const uchar nCurrIntraDescBITS = (uchar)popcount(nCurrIntraDesc);
             const bool bCurrRegionIsFlat = nCurrIntraDescBITS < FLAT_REGION_BIT_COUNT;
             if (bCurrRegionIsFlat)
@@ -684,7 +685,7 @@ namespace bgslibrary
             float fPotentialLocalWordsWeightSum = 0.0f;
             float fLastLocalWordWeight = FLT_MAX;
             while (nLocalWordIdx < m_nCurrLocalWords && fPotentialLocalWordsWeightSum < fLocalWordsWeightSumThreshold) {
-              LocalWord_1ch* pCurrLocalWord = (LocalWord_1ch*)m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx];
+              LocalWord_1ch* pCurrLocalWord = (LocalWord_1ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]);
               const float fCurrLocalWordWeight = GetLocalWordWeight(pCurrLocalWord, m_nFrameIndex, m_nLocalWordWeightOffset);
               {
                 const size_t nColorDist = L1dist(nCurrColor, pCurrLocalWord->oFeature.anColor[0]);
@@ -696,7 +697,7 @@ namespace bgslibrary
                   && nColorDist <= nCurrColorDistThreshold
                   && nColorDist >= nCurrColorDistThreshold / 2
                   && nIntraDescDist <= nCurrDescDistThreshold / 2
-                  && (rand() % (nCurrRegionIllumUpdtVal ? (nCurrLocalWordUpdateRate / 2 + 1) : nCurrLocalWordUpdateRate)) == 0) {
+                  && (m_oRNG() % (nCurrRegionIllumUpdtVal ? (nCurrLocalWordUpdateRate / 2 + 1) : nCurrLocalWordUpdateRate)) == 0) {
                   // == illum updt
                   pCurrLocalWord->oFeature.anColor[0] = nCurrColor;
                   pCurrLocalWord->oFeature.anDesc[0] = nCurrIntraDesc;
@@ -714,16 +715,16 @@ namespace bgslibrary
                 }
               }
               if (fCurrLocalWordWeight > fLastLocalWordWeight) {
-                std::swap(m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx], m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1]);
+                std::swap(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx], m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1]);
               }
               else
                 fLastLocalWordWeight = fCurrLocalWordWeight;
               ++nLocalWordIdx;
             }
             while (nLocalWordIdx < m_nCurrLocalWords) {
-              const float fCurrLocalWordWeight = GetLocalWordWeight(m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx], m_nFrameIndex, m_nLocalWordWeightOffset);
+              const float fCurrLocalWordWeight = GetLocalWordWeight(GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]), m_nFrameIndex, m_nLocalWordWeightOffset);
               if (fCurrLocalWordWeight > fLastLocalWordWeight) {
-                std::swap(m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx], m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1]);
+                std::swap(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx], m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1]);
               }
               else
                 fLastLocalWordWeight = fCurrLocalWordWeight;
@@ -736,18 +737,18 @@ namespace bgslibrary
               fCurrMeanMinDist_ST = fCurrMeanMinDist_ST*(1.0f - fRollAvgFactor_ST) + fNormalizedMinDist*fRollAvgFactor_ST;
               fCurrMeanRawSegmRes_LT = fCurrMeanRawSegmRes_LT*(1.0f - fRollAvgFactor_LT);
               fCurrMeanRawSegmRes_ST = fCurrMeanRawSegmRes_ST*(1.0f - fRollAvgFactor_ST);
-              if ((rand() % nCurrLocalWordUpdateRate) == 0) {
+              if ((m_oRNG() % nCurrLocalWordUpdateRate) == 0) {
                 size_t nGlobalWordLUTIdx;
                 GlobalWord_1ch* pCurrGlobalWord = nullptr;
                 for (nGlobalWordLUTIdx = 0; nGlobalWordLUTIdx < m_nCurrGlobalWords; ++nGlobalWordLUTIdx) {
-                  pCurrGlobalWord = (GlobalWord_1ch*)m_aPxInfoLUT_PAWCS[nPxIter].apGlobalDictSortLUT[nGlobalWordLUTIdx];
+                  pCurrGlobalWord = (GlobalWord_1ch*)GetGlobalWord(m_anGlobalWordSortLUT[nModelIter*m_nCurrGlobalWords + nGlobalWordLUTIdx]);
                   if (L1dist(pCurrGlobalWord->oFeature.anColor[0], nCurrColor) <= nCurrColorDistThreshold
                     && L1dist(nCurrIntraDescBITS, pCurrGlobalWord->nDescBITS) <= nCurrDescDistThreshold / GWORD_DESC_THRES_BITS_MATCH_FACTOR)
                     break;
                 }
-                if (nGlobalWordLUTIdx != m_nCurrGlobalWords || (rand() % (nCurrLocalWordUpdateRate * 2)) == 0) {
+                if (nGlobalWordLUTIdx != m_nCurrGlobalWords || (m_oRNG() % (nCurrLocalWordUpdateRate * 2)) == 0) {
                   if (nGlobalWordLUTIdx == m_nCurrGlobalWords) {
-                    pCurrGlobalWord = (GlobalWord_1ch*)m_apGlobalWordDict[m_nCurrGlobalWords - 1];
+                    pCurrGlobalWord = (GlobalWord_1ch*)GetGlobalWord(m_anGlobalWordDict[m_nCurrGlobalWords - 1]);
                     pCurrGlobalWord->oFeature.anColor[0] = nCurrColor;
                     pCurrGlobalWord->oFeature.anDesc[0] = nCurrIntraDesc;
                     pCurrGlobalWord->nDescBITS = nCurrIntraDescBITS;
@@ -769,11 +770,11 @@ namespace bgslibrary
               fCurrMeanMinDist_ST = fCurrMeanMinDist_ST*(1.0f - fRollAvgFactor_ST) + fNormalizedMinDist*fRollAvgFactor_ST;
               fCurrMeanRawSegmRes_LT = fCurrMeanRawSegmRes_LT*(1.0f - fRollAvgFactor_LT) + fRollAvgFactor_LT;
               fCurrMeanRawSegmRes_ST = fCurrMeanRawSegmRes_ST*(1.0f - fRollAvgFactor_ST) + fRollAvgFactor_ST;
-              if (bCurrRegionIsFlat || (rand() % nCurrLocalWordUpdateRate) == 0) {
+              if (bCurrRegionIsFlat || (m_oRNG() % nCurrLocalWordUpdateRate) == 0) {
                 size_t nGlobalWordLUTIdx;
                 GlobalWord_1ch* pCurrGlobalWord;
                 for (nGlobalWordLUTIdx = 0; nGlobalWordLUTIdx < m_nCurrGlobalWords; ++nGlobalWordLUTIdx) {
-                  pCurrGlobalWord = (GlobalWord_1ch*)m_aPxInfoLUT_PAWCS[nPxIter].apGlobalDictSortLUT[nGlobalWordLUTIdx];
+                  pCurrGlobalWord = (GlobalWord_1ch*)GetGlobalWord(m_anGlobalWordSortLUT[nModelIter*m_nCurrGlobalWords + nGlobalWordLUTIdx]);
                   if (L1dist(pCurrGlobalWord->oFeature.anColor[0], nCurrColor) <= nCurrColorDistThreshold
                     && L1dist(nCurrIntraDescBITS, pCurrGlobalWord->nDescBITS) <= nCurrDescDistThreshold / GWORD_DESC_THRES_BITS_MATCH_FACTOR)
                     break;
@@ -790,7 +791,7 @@ namespace bgslibrary
                 nCurrRegionSegmVal = UCHAR_MAX;
               if (fPotentialLocalWordsWeightSum < DEFAULT_LWORD_INIT_WEIGHT) {
                 const size_t nNewLocalWordIdx = m_nCurrLocalWords - 1;
-                LocalWord_1ch* pNewLocalWord = (LocalWord_1ch*)m_apLocalWordDict[nLocalDictIdx + nNewLocalWordIdx];
+                LocalWord_1ch* pNewLocalWord = (LocalWord_1ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nNewLocalWordIdx]);
                 pNewLocalWord->oFeature.anColor[0] = nCurrColor;
                 pNewLocalWord->oFeature.anDesc[0] = nCurrIntraDesc;
                 pNewLocalWord->nOccurrences = nCurrWordOccIncr;
@@ -799,20 +800,20 @@ namespace bgslibrary
               }
             }
             // == neighb updt
-            if ((!nCurrRegionSegmVal && (rand() % nCurrLocalWordUpdateRate) == 0) || bCurrRegionIsROIBorder || m_bUsingMovingCamera) {
+            if ((!nCurrRegionSegmVal && (m_oRNG() % nCurrLocalWordUpdateRate) == 0) || bCurrRegionIsROIBorder || m_bUsingMovingCamera) {
               //if((!nCurrRegionSegmVal && (rand()%(nCurrRegionIllumUpdtVal?(nCurrLocalWordUpdateRate/2+1):nCurrLocalWordUpdateRate))==0) || bCurrRegionIsROIBorder) {
               int nSampleImgCoord_Y, nSampleImgCoord_X;
               if (bCurrRegionIsFlat || bCurrRegionIsROIBorder || m_bUsingMovingCamera)
-                getRandNeighborPosition_5x5(nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP_::PATCH_SIZE / 2, m_oImgSize);
+                getRandNeighborPosition_5x5(m_oRNG, nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP_::PATCH_SIZE / 2, m_oImgSize);
               else
-                getRandNeighborPosition_3x3(nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP_::PATCH_SIZE / 2, m_oImgSize);
+                getRandNeighborPosition_3x3(m_oRNG, nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP_::PATCH_SIZE / 2, m_oImgSize);
               const size_t nSamplePxIdx = m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
               if (m_oROI.data[nSamplePxIdx]) {
                 const size_t nNeighborLocalDictIdx = m_aPxInfoLUT_PAWCS[nSamplePxIdx].nModelIdx*m_nCurrLocalWords;
                 size_t nNeighborLocalWordIdx = 0;
                 float fNeighborPotentialLocalWordsWeightSum = 0.0f;
                 while (nNeighborLocalWordIdx < m_nCurrLocalWords && fNeighborPotentialLocalWordsWeightSum < fLocalWordsWeightSumThreshold) {
-                  LocalWord_1ch* pNeighborLocalWord = (LocalWord_1ch*)m_apLocalWordDict[nNeighborLocalDictIdx + nNeighborLocalWordIdx];
+                  LocalWord_1ch* pNeighborLocalWord = (LocalWord_1ch*)GetLocalWord(m_anLocalWordDict[nNeighborLocalDictIdx + nNeighborLocalWordIdx]);
                   const size_t nNeighborColorDist = L1dist(nCurrColor, pNeighborLocalWord->oFeature.anColor[0]);
                   const size_t nNeighborIntraDescDist = hdist(nCurrIntraDesc, pNeighborLocalWord->oFeature.anDesc[0]);
                   const bool bNeighborRegionIsFlat = popcount(pNeighborLocalWord->oFeature.anDesc[0]) < FLAT_REGION_BIT_COUNT;
@@ -824,7 +825,7 @@ namespace bgslibrary
                     if (fNeighborLocalWordWeight < DEFAULT_LWORD_MAX_WEIGHT)
                       pNeighborLocalWord->nOccurrences += nNeighborWordOccIncr;
                   }
-                  else if (!oCurrFGMask.data[nSamplePxIdx] && bCurrRegionIsFlat && (bBootstrapping || (rand() % nCurrLocalWordUpdateRate) == 0)) {
+                  else if (!oCurrFGMask.data[nSamplePxIdx] && bCurrRegionIsFlat && (bBootstrapping || (m_oRNG() % nCurrLocalWordUpdateRate) == 0)) {
                     const size_t nSampleDescIdx = nSamplePxIdx * 2;
                     ushort& nNeighborLastIntraDesc = *((ushort*)(m_oLastDescFrame.data + nSampleDescIdx));
                     const size_t nNeighborLastIntraDescDist = hdist(nCurrIntraDesc, nNeighborLastIntraDesc);
@@ -841,7 +842,7 @@ namespace bgslibrary
                 }
                 if (fNeighborPotentialLocalWordsWeightSum < DEFAULT_LWORD_INIT_WEIGHT) {
                   nNeighborLocalWordIdx = m_nCurrLocalWords - 1;
-                  LocalWord_1ch* pNeighborLocalWord = (LocalWord_1ch*)m_apLocalWordDict[nNeighborLocalDictIdx + nNeighborLocalWordIdx];
+                  LocalWord_1ch* pNeighborLocalWord = (LocalWord_1ch*)GetLocalWord(m_anLocalWordDict[nNeighborLocalDictIdx + nNeighborLocalWordIdx]);
                   pNeighborLocalWord->oFeature.anColor[0] = nCurrColor;
                   pNeighborLocalWord->oFeature.anDesc[0] = nCurrIntraDesc;
                   pNeighborLocalWord->nOccurrences = nCurrWordOccIncr;
@@ -892,7 +893,7 @@ namespace bgslibrary
             float& fCurrLearningRate = *(float*)(m_oUpdateRateFrame.data + nFloatIter);
             float& fCurrMeanMinDist_LT = *(float*)(m_oMeanMinDistFrame_LT.data + nFloatIter);
             float& fCurrMeanMinDist_ST = *(float*)(m_oMeanMinDistFrame_ST.data + nFloatIter);
-            const float fBestLocalWordWeight = GetLocalWordWeight(m_apLocalWordDict[nLocalDictIdx], m_nFrameIndex, m_nLocalWordWeightOffset);
+            const float fBestLocalWordWeight = GetLocalWordWeight(GetLocalWord(m_anLocalWordDict[nLocalDictIdx]), m_nFrameIndex, m_nLocalWordWeightOffset);
             const float fLocalWordsWeightSumThreshold = fBestLocalWordWeight / (fCurrDistThresholdFactor * 2);
             uchar& bCurrRegionIsUnstable = m_oUnstableRegionMask.data[nPxIter];
             uchar& nCurrRegionIllumUpdtVal = m_oIllumUpdtRegionMask.data[nPxIter];
@@ -900,9 +901,12 @@ namespace bgslibrary
             const bool bCurrRegionIsROIBorder = m_oROI.data[nPxIter] < UCHAR_MAX;
             const int nCurrImgCoord_X = m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_X;
             const int nCurrImgCoord_Y = m_aPxInfoLUT_PAWCS[nPxIter].nImgCoord_Y;
-            ushort anCurrInterDesc[3], anCurrIntraDesc[3];
-            const size_t anCurrIntraLBSPThresholds[3] = { m_anLBSPThreshold_8bitLUT[anCurrColor[0]],m_anLBSPThreshold_8bitLUT[anCurrColor[1]],m_anLBSPThreshold_8bitLUT[anCurrColor[2]] };
-            LBSP_::computeRGBDescriptor(oInputImg, anCurrColor, nCurrImgCoord_X, nCurrImgCoord_Y, anCurrIntraLBSPThresholds, anCurrIntraDesc);
+            if (nCurrImgCoord_Y != nCurrIntraDescRow) {
+              nCurrIntraDescRow = nCurrImgCoord_Y;
+              computeDescriptorRow(oInputImg, nCurrImgCoord_Y, nDescRowBorder, m_oImgSize.width - nDescRowBorder, m_anLBSPThreshold_8bitLUT, m_vnCurrIntraDescRow.data() + nDescRowBorder * 3);
+            }
+            ushort anCurrInterDesc[3];
+            const ushort* const anCurrIntraDesc = m_vnCurrIntraDescRow.data() + nCurrImgCoord_X * 3;
             const uchar nCurrIntraDescBITS = (uchar)popcount<3>(anCurrIntraDesc);
             const bool bCurrRegionIsFlat = nCurrIntraDescBITS < FLAT_REGION_BIT_COUNT * 2;
             if (bCurrRegionIsFlat)
@@ -915,7 +919,7 @@ namespace bgslibrary
             float fPotentialLocalWordsWeightSum = 0.0f;
             float fLastLocalWordWeight = FLT_MAX;
             while (nLocalWordIdx < m_nCurrLocalWords && fPotentialLocalWordsWeightSum < fLocalWordsWeightSumThreshold) {
-              LocalWord_3ch* pCurrLocalWord = (LocalWord_3ch*)m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx];
+              LocalWord_3ch* pCurrLocalWord = (LocalWord_3ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]);
               const float fCurrLocalWordWeight = GetLocalWordWeight(pCurrLocalWord, m_nFrameIndex, m_nLocalWordWeightOffset);
               {
                 const size_t nTotColorL1Dist = L1dist<3>(anCurrColor, pCurrLocalWord->oFeature.anColor);
@@ -930,7 +934,7 @@ namespace bgslibrary
                   && nTotColorMixDist <= nCurrTotColorDistThreshold
                   && nTotColorL1Dist >= nCurrTotColorDistThreshold / 2
                   && nTotIntraDescDist <= nCurrTotDescDistThreshold / 2
-                  && (rand() % (nCurrRegionIllumUpdtVal ? (nCurrLocalWordUpdateRate / 2 + 1) : nCurrLocalWordUpdateRate)) == 0) {
+                  && (m_oRNG() % (nCurrRegionIllumUpdtVal ? (nCurrLocalWordUpdateRate / 2 + 1) : nCurrLocalWordUpdateRate)) == 0) {
                   // == illum updt
                   for (size_t c = 0; c < 3; ++c) {
                     pCurrLocalWord->oFeature.anColor[c] = anCurrColor[c];
@@ -950,16 +954,16 @@ namespace bgslibrary
                 }
               }
               if (fCurrLocalWordWeight > fLastLocalWordWeight) {
-                std::swap(m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx], m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1]);
+                std::swap(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx], m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1]);
               }
               else
                 fLastLocalWordWeight = fCurrLocalWordWeight;
               ++nLocalWordIdx;
             }
             while (nLocalWordIdx < m_nCurrLocalWords) {
-              const float fCurrLocalWordWeight = GetLocalWordWeight(m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx], m_nFrameIndex, m_nLocalWordWeightOffset);
+              const float fCurrLocalWordWeight = GetLocalWordWeight(GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]), m_nFrameIndex, m_nLocalWordWeightOffset);
               if (fCurrLocalWordWeight > fLastLocalWordWeight) {
-                std::swap(m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx], m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1]);
+                std::swap(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx], m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx - 1]);
               }
               else
                 fLastLocalWordWeight = fCurrLocalWordWeight;
@@ -972,18 +976,18 @@ namespace bgslibrary
               fCurrMeanMinDist_ST = fCurrMeanMinDist_ST*(1.0f - fRollAvgFactor_ST) + fNormalizedMinDist*fRollAvgFactor_ST;
               fCurrMeanRawSegmRes_LT = fCurrMeanRawSegmRes_LT*(1.0f - fRollAvgFactor_LT);
               fCurrMeanRawSegmRes_ST = fCurrMeanRawSegmRes_ST*(1.0f - fRollAvgFactor_ST);
-              if ((rand() % nCurrLocalWordUpdateRate) == 0) {
+              if ((m_oRNG() % nCurrLocalWordUpdateRate) == 0) {
                 size_t nGlobalWordLUTIdx;
                 GlobalWord_3ch* pCurrGlobalWord = nullptr;
                 for (nGlobalWordLUTIdx = 0; nGlobalWordLUTIdx < m_nCurrGlobalWords; ++nGlobalWordLUTIdx) {
-                  pCurrGlobalWord = (GlobalWord_3ch*)m_aPxInfoLUT_PAWCS[nPxIter].apGlobalDictSortLUT[nGlobalWordLUTIdx];
+                  pCurrGlobalWord = (GlobalWord_3ch*)GetGlobalWord(m_anGlobalWordSortLUT[nModelIter*m_nCurrGlobalWords + nGlobalWordLUTIdx]);
                   if (L1dist(nCurrIntraDescBITS, pCurrGlobalWord->nDescBITS) <= nCurrTotDescDistThreshold / GWORD_DESC_THRES_BITS_MATCH_FACTOR
                     && cmixdist<3>(anCurrColor, pCurrGlobalWord->oFeature.anColor) <= nCurrTotColorDistThreshold)
                     break;
                 }
-                if (nGlobalWordLUTIdx != m_nCurrGlobalWords || (rand() % (nCurrLocalWordUpdateRate * 2)) == 0) {
+                if (nGlobalWordLUTIdx != m_nCurrGlobalWords || (m_oRNG() % (nCurrLocalWordUpdateRate * 2)) == 0) {
                   if (nGlobalWordLUTIdx == m_nCurrGlobalWords) {
-                    pCurrGlobalWord = (GlobalWord_3ch*)m_apGlobalWordDict[m_nCurrGlobalWords - 1];
+                    pCurrGlobalWord = (GlobalWord_3ch*)GetGlobalWord(m_anGlobalWordDict[m_nCurrGlobalWords - 1]);
                     for (size_t c = 0; c < 3; ++c) {
                       pCurrGlobalWord->oFeature.anColor[c] = anCurrColor[c];
                       pCurrGlobalWord->oFeature.anDesc[c] = anCurrIntraDesc[c];
@@ -1007,11 +1011,11 @@ namespace bgslibrary
               fCurrMeanMinDist_ST = fCurrMeanMinDist_ST*(1.0f - fRollAvgFactor_ST) + fNormalizedMinDist*fRollAvgFactor_ST;
               fCurrMeanRawSegmRes_LT = fCurrMeanRawSegmRes_LT*(1.0f - fRollAvgFactor_LT) + fRollAvgFactor_LT;
               fCurrMeanRawSegmRes_ST = fCurrMeanRawSegmRes_ST*(1.0f - fRollAvgFactor_ST) + fRollAvgFactor_ST;
-              if (bCurrRegionIsFlat || (rand() % nCurrLocalWordUpdateRate) == 0) {
+              if (bCurrRegionIsFlat || (m_oRNG() % nCurrLocalWordUpdateRate) == 0) {
                 size_t nGlobalWordLUTIdx;
                 GlobalWord_3ch* pCurrGlobalWord;
                 for (nGlobalWordLUTIdx = 0; nGlobalWordLUTIdx < m_nCurrGlobalWords; ++nGlobalWordLUTIdx) {
-                  pCurrGlobalWord = (GlobalWord_3ch*)m_aPxInfoLUT_PAWCS[nPxIter].apGlobalDictSortLUT[nGlobalWordLUTIdx];
+                  pCurrGlobalWord = (GlobalWord_3ch*)GetGlobalWord(m_anGlobalWordSortLUT[nModelIter*m_nCurrGlobalWords + nGlobalWordLUTIdx]);
                   if (L1dist(nCurrIntraDescBITS, pCurrGlobalWord->nDescBITS) <= nCurrTotDescDistThreshold / GWORD_DESC_THRES_BITS_MATCH_FACTOR
                     && cmixdist<3>(anCurrColor, pCurrGlobalWord->oFeature.anColor) <= nCurrTotColorDistThreshold)
                     break;
@@ -1028,7 +1032,7 @@ namespace bgslibrary
                 nCurrRegionSegmVal = UCHAR_MAX;
               if (fPotentialLocalWordsWeightSum < DEFAULT_LWORD_INIT_WEIGHT) {
                 const size_t nNewLocalWordIdx = m_nCurrLocalWords - 1;
-                LocalWord_3ch* pNewLocalWord = (LocalWord_3ch*)m_apLocalWordDict[nLocalDictIdx + nNewLocalWordIdx];
+                LocalWord_3ch* pNewLocalWord = (LocalWord_3ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nNewLocalWordIdx]);
                 for (size_t c = 0; c < 3; ++c) {
                   pNewLocalWord->oFeature.anColor[c] = anCurrColor[c];
                   pNewLocalWord->oFeature.anDesc[c] = anCurrIntraDesc[c];
@@ -1039,20 +1043,20 @@ namespace bgslibrary
               }
             }
             // == neighb updt
-            if ((!nCurrRegionSegmVal && (rand() % nCurrLocalWordUpdateRate) == 0) || bCurrRegionIsROIBorder || m_bUsingMovingCamera) {
+            if ((!nCurrRegionSegmVal && (m_oRNG() % nCurrLocalWordUpdateRate) == 0) || bCurrRegionIsROIBorder || m_bUsingMovingCamera) {
               //if((!nCurrRegionSegmVal && (rand()%(nCurrRegionIllumUpdtVal?(nCurrLocalWordUpdateRate/2+1):nCurrLocalWordUpdateRate))==0) || bCurrRegionIsROIBorder) {
               int nSampleImgCoord_Y, nSampleImgCoord_X;
               if (bCurrRegionIsFlat || bCurrRegionIsROIBorder || m_bUsingMovingCamera)
-                getRandNeighborPosition_5x5(nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP_::PATCH_SIZE / 2, m_oImgSize);
+                getRandNeighborPosition_5x5(m_oRNG, nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP_::PATCH_SIZE / 2, m_oImgSize);
               else
-                getRandNeighborPosition_3x3(nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP_::PATCH_SIZE / 2, m_oImgSize);
+                getRandNeighborPosition_3x3(m_oRNG, nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP_::PATCH_SIZE / 2, m_oImgSize);
               const size_t nSamplePxIdx = m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
               if (m_oROI.data[nSamplePxIdx]) {
                 const size_t nNeighborLocalDictIdx = m_aPxInfoLUT_PAWCS[nSamplePxIdx].nModelIdx*m_nCurrLocalWords;
                 size_t nNeighborLocalWordIdx = 0;
                 float fNeighborPotentialLocalWordsWeightSum = 0.0f;
                 while (nNeighborLocalWordIdx < m_nCurrLocalWords && fNeighborPotentialLocalWordsWeightSum < fLocalWordsWeightSumThreshold) {
-                  LocalWord_3ch* pNeighborLocalWord = (LocalWord_3ch*)m_apLocalWordDict[nNeighborLocalDictIdx + nNeighborLocalWordIdx];
+                  LocalWord_3ch* pNeighborLocalWord = (LocalWord_3ch*)GetLocalWord(m_anLocalWordDict[nNeighborLocalDictIdx + nNeighborLocalWordIdx]);
                   const size_t nNeighborTotColorL1Dist = L1dist<3>(anCurrColor, pNeighborLocalWord->oFeature.anColor);
                   const size_t nNeighborColorDistortion = cdist<3>(anCurrColor, pNeighborLocalWord->oFeature.anColor);
                   const size_t nNeighborTotColorMixDist = cmixdist(nNeighborTotColorL1Dist, nNeighborColorDistortion);
@@ -1066,7 +1070,7 @@ namespace bgslibrary
                     if (fNeighborLocalWordWeight < DEFAULT_LWORD_MAX_WEIGHT)
                       pNeighborLocalWord->nOccurrences += nNeighborWordOccIncr;
                   }
-                  else if (!oCurrFGMask.data[nSamplePxIdx] && bCurrRegionIsFlat && (bBootstrapping || (rand() % nCurrLocalWordUpdateRate) == 0)) {
+                  else if (!oCurrFGMask.data[nSamplePxIdx] && bCurrRegionIsFlat && (bBootstrapping || (m_oRNG() % nCurrLocalWordUpdateRate) == 0)) {
                     const size_t nSamplePxRGBIdx = nSamplePxIdx * 3;
                     const size_t nSampleDescRGBIdx = nSamplePxRGBIdx * 2;
                     ushort* anNeighborLastIntraDesc = ((ushort*)(m_oLastDescFrame.data + nSampleDescRGBIdx));
@@ -1099,7 +1103,7 @@ namespace bgslibrary
                 }
                 if (fNeighborPotentialLocalWordsWeightSum < DEFAULT_LWORD_INIT_WEIGHT) {
                   nNeighborLocalWordIdx = m_nCurrLocalWords - 1;
-                  LocalWord_3ch* pNeighborLocalWord = (LocalWord_3ch*)m_apLocalWordDict[nNeighborLocalDictIdx + nNeighborLocalWordIdx];
+                  LocalWord_3ch* pNeighborLocalWord = (LocalWord_3ch*)GetLocalWord(m_anLocalWordDict[nNeighborLocalDictIdx + nNeighborLocalWordIdx]);
                   for (size_t c = 0; c < 3; ++c) {
                     pNeighborLocalWord->oFeature.anColor[c] = anCurrColor[c];
                     pNeighborLocalWord->oFeature.anDesc[c] = anCurrIntraDesc[c];
@@ -1138,30 +1142,31 @@ namespace bgslibrary
         if (bUpdateGlobalWords)
           cv::resize(m_oLastFGMask_dilated_inverted, oLastFGMask_dilated_inverted_downscaled, m_oDownSampledFrameSize_GlobalWordLookup, 0, 0, cv::INTER_NEAREST);
         for (size_t nGlobalWordIdx = 0; nGlobalWordIdx < m_nCurrGlobalWords; ++nGlobalWordIdx) {
-          if (bRecalcGlobalWords && m_apGlobalWordDict[nGlobalWordIdx]->fLatestWeight > 0.0f) {
-            m_apGlobalWordDict[nGlobalWordIdx]->fLatestWeight = GetGlobalWordWeight(m_apGlobalWordDict[nGlobalWordIdx]);
-            if (m_apGlobalWordDict[nGlobalWordIdx]->fLatestWeight < 1.0f) {
-              m_apGlobalWordDict[nGlobalWordIdx]->fLatestWeight = 0.0f;
-              m_apGlobalWordDict[nGlobalWordIdx]->oSpatioOccMap = cv::Scalar(0.0f);
+          GlobalWordBase& oCurrGlobalWord = *GetGlobalWord(m_anGlobalWordDict[nGlobalWordIdx]);
+          if (bRecalcGlobalWords && oCurrGlobalWord.fLatestWeight > 0.0f) {
+            oCurrGlobalWord.fLatestWeight = GetGlobalWordWeight(&oCurrGlobalWord);
+            if (oCurrGlobalWord.fLatestWeight < 1.0f) {
+              oCurrGlobalWord.fLatestWeight = 0.0f;
+              oCurrGlobalWord.oSpatioOccMap = cv::Scalar(0.0f);
             }
           }
-          if (bUpdateGlobalWords && m_apGlobalWordDict[nGlobalWordIdx]->fLatestWeight > 0.0f) {
-            cv::accumulateProduct(m_apGlobalWordDict[nGlobalWordIdx]->oSpatioOccMap, m_oTempGlobalWordWeightDiffFactor, m_apGlobalWordDict[nGlobalWordIdx]->oSpatioOccMap, oLastFGMask_dilated_inverted_downscaled);
-            m_apGlobalWordDict[nGlobalWordIdx]->fLatestWeight *= 0.9f;
-            cv::blur(m_apGlobalWordDict[nGlobalWordIdx]->oSpatioOccMap, m_apGlobalWordDict[nGlobalWordIdx]->oSpatioOccMap, cv::Size(3, 3), cv::Point(-1, -1), cv::BORDER_REPLICATE);
+          if (bUpdateGlobalWords && oCurrGlobalWord.fLatestWeight > 0.0f) {
+            cv::accumulateProduct(oCurrGlobalWord.oSpatioOccMap, m_oTempGlobalWordWeightDiffFactor, oCurrGlobalWord.oSpatioOccMap, oLastFGMask_dilated_inverted_downscaled);
+            oCurrGlobalWord.fLatestWeight *= 0.9f;
+            cv::blur(oCurrGlobalWord.oSpatioOccMap, oCurrGlobalWord.oSpatioOccMap, cv::Size(3, 3), cv::Point(-1, -1), cv::BORDER_REPLICATE);
           }
-          if (nGlobalWordIdx > 0 && m_apGlobalWordDict[nGlobalWordIdx]->fLatestWeight > m_apGlobalWordDict[nGlobalWordIdx - 1]->fLatestWeight)
-            std::swap(m_apGlobalWordDict[nGlobalWordIdx], m_apGlobalWordDict[nGlobalWordIdx - 1]);
+          if (nGlobalWordIdx > 0 && oCurrGlobalWord.fLatestWeight > GetGlobalWord(m_anGlobalWordDict[nGlobalWordIdx - 1])->fLatestWeight)
+            std::swap(m_anGlobalWordDict[nGlobalWordIdx], m_anGlobalWordDict[nGlobalWordIdx - 1]);
         }
         if (bUpdateGlobalWords) {
           for (size_t nModelIter = 0; nModelIter < m_nTotRelevantPxCount; ++nModelIter) {
             const size_t nPxIter = m_aPxIdxLUT[nModelIter];
             const size_t nGlobalWordMapLookupIdx = m_aPxInfoLUT_PAWCS[nPxIter].nGlobalWordMapLookupIdx;
-            float fLastGlobalWordLocalWeight = *(float*)(m_aPxInfoLUT_PAWCS[nPxIter].apGlobalDictSortLUT[0]->oSpatioOccMap.data + nGlobalWordMapLookupIdx);
+            float fLastGlobalWordLocalWeight = *(float*)(GetGlobalWord(m_anGlobalWordSortLUT[nModelIter*m_nCurrGlobalWords])->oSpatioOccMap.data + nGlobalWordMapLookupIdx);
             for (size_t nGlobalWordLUTIdx = 1; nGlobalWordLUTIdx < m_nCurrGlobalWords; ++nGlobalWordLUTIdx) {
-              const float fCurrGlobalWordLocalWeight = *(float*)(m_aPxInfoLUT_PAWCS[nPxIter].apGlobalDictSortLUT[nGlobalWordLUTIdx]->oSpatioOccMap.data + nGlobalWordMapLookupIdx);
+              const float fCurrGlobalWordLocalWeight = *(float*)(GetGlobalWord(m_anGlobalWordSortLUT[nModelIter*m_nCurrGlobalWords + nGlobalWordLUTIdx])->oSpatioOccMap.data + nGlobalWordMapLookupIdx);
               if (fCurrGlobalWordLocalWeight > fLastGlobalWordLocalWeight)
-                std::swap(m_aPxInfoLUT_PAWCS[nPxIter].apGlobalDictSortLUT[nGlobalWordLUTIdx], m_aPxInfoLUT_PAWCS[nPxIter].apGlobalDictSortLUT[nGlobalWordLUTIdx - 1]);
+                std::swap(m_anGlobalWordSortLUT[nModelIter*m_nCurrGlobalWords + nGlobalWordLUTIdx], m_anGlobalWordSortLUT[nModelIter*m_nCurrGlobalWords + nGlobalWordLUTIdx - 1]);
               else
                 fLastGlobalWordLocalWeight = fCurrGlobalWordLocalWeight;
             }
@@ -1238,6 +1243,84 @@ namespace bgslibrary
           --m_nModelResetCooldown;
       }
 
+      bool BackgroundSubtractorPAWCS::isForegroundPixel(const cv::Mat& oInputImg, int nImgCoord_X, int nImgCoord_Y, const uchar* anColor) const {
+        // same tests as apply, but with the given color as the center of the LBSP patch & without any model update (the
+        // global words are always looked up here, whereas apply only does it for a random subset of the non-flat px)
+        CV_Assert(m_bInitialized);
+        CV_DbgAssert(oInputImg.type() == m_nImgType && oInputImg.size() == m_oImgSize);
+        CV_DbgAssert(nImgCoord_X >= 0 && nImgCoord_X < m_oImgSize.width && nImgCoord_Y >= 0 && nImgCoord_Y < m_oImgSize.height);
+        const size_t nPxIter = (size_t)m_oImgSize.width*nImgCoord_Y + nImgCoord_X;
+        if (m_oROI.data[nPxIter] < UCHAR_MAX)
+          return false;
+        const size_t nModelIter = m_aPxInfoLUT_PAWCS[nPxIter].nModelIdx;
+        const size_t nLocalDictIdx = nModelIter*m_nCurrLocalWords;
+        const size_t nGlobalWordMapLookupIdx = m_aPxInfoLUT_PAWCS[nPxIter].nGlobalWordMapLookupIdx;
+        const float fCurrDistThresholdFactor = *(float*)(m_oDistThresholdFrame.data + nPxIter * 4);
+        const uchar bCurrRegionIsUnstable = m_oUnstableRegionMask.data[nPxIter];
+        const float fBestLocalWordWeight = GetLocalWordWeight(GetLocalWord(m_anLocalWordDict[nLocalDictIdx]), m_nFrameIndex, m_nLocalWordWeightOffset);
+        const float fLocalWordsWeightSumThreshold = fBestLocalWordWeight / (fCurrDistThresholdFactor * 2);
+        float fPotentialLocalWordsWeightSum = 0.0f;
+        if (m_nImgChannels == 1) {
+          const size_t nCurrColorDistThreshold = (size_t)(sqrt(fCurrDistThresholdFactor)*m_nMinColorDistThreshold) / 2;
+          const size_t nCurrDescDistThreshold = ((size_t)1 << ((size_t)floor(fCurrDistThresholdFactor + 0.5f))) + m_nDescDistThresholdOffset + (bCurrRegionIsUnstable*UNSTAB_DESC_DIST_OFFSET);
+          ushort nCurrIntraDesc, nCurrInterDesc;
+          LBSP_::computeGrayscaleDescriptor(oInputImg, anColor[0], nImgCoord_X, nImgCoord_Y, m_anLBSPThreshold_8bitLUT[anColor[0]], nCurrIntraDesc);
+          for (size_t nLocalWordIdx = 0; nLocalWordIdx < m_nCurrLocalWords && fPotentialLocalWordsWeightSum < fLocalWordsWeightSumThreshold; ++nLocalWordIdx) {
+            const LocalWord_1ch* pCurrLocalWord = (const LocalWord_1ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]);
+            const size_t nColorDist = L1dist(anColor[0], pCurrLocalWord->oFeature.anColor[0]);
+            if (nColorDist > nCurrColorDistThreshold)
+              continue;
+            LBSP_::computeGrayscaleDescriptor(oInputImg, pCurrLocalWord->oFeature.anColor[0], nImgCoord_X, nImgCoord_Y, m_anLBSPThreshold_8bitLUT[pCurrLocalWord->oFeature.anColor[0]], nCurrInterDesc);
+            const size_t nDescDist = (hdist(nCurrIntraDesc, pCurrLocalWord->oFeature.anDesc[0]) + hdist(nCurrInterDesc, pCurrLocalWord->oFeature.anDesc[0])) / 2;
+            if (nDescDist <= nCurrDescDistThreshold)
+              fPotentialLocalWordsWeightSum += GetLocalWordWeight(pCurrLocalWord, m_nFrameIndex, m_nLocalWordWeightOffset);
+          }
+          if (fPotentialLocalWordsWeightSum >= fLocalWordsWeightSumThreshold)
+            return false;
+          const uchar nCurrIntraDescBITS = (uchar)popcount(nCurrIntraDesc);
+          const bool bCurrRegionIsFlat = nCurrIntraDescBITS < FLAT_REGION_BIT_COUNT;
+          for (size_t nGlobalWordLUTIdx = 0; nGlobalWordLUTIdx < m_nCurrGlobalWords; ++nGlobalWordLUTIdx) {
+            const GlobalWord_1ch* pCurrGlobalWord = (const GlobalWord_1ch*)GetGlobalWord(m_anGlobalWordSortLUT[nModelIter*m_nCurrGlobalWords + nGlobalWordLUTIdx]);
+            if (L1dist(pCurrGlobalWord->oFeature.anColor[0], anColor[0]) <= nCurrColorDistThreshold
+              && L1dist(nCurrIntraDescBITS, pCurrGlobalWord->nDescBITS) <= nCurrDescDistThreshold / GWORD_DESC_THRES_BITS_MATCH_FACTOR) {
+              const float fGlobalWordLocalizedWeight = *(float*)(pCurrGlobalWord->oSpatioOccMap.data + nGlobalWordMapLookupIdx);
+              return fPotentialLocalWordsWeightSum + fGlobalWordLocalizedWeight / (bCurrRegionIsFlat ? 2 : 4) < fLocalWordsWeightSumThreshold;
+            }
+          }
+        }
+        else { //m_nImgChannels==3
+          const size_t nCurrTotColorDistThreshold = (size_t)(sqrt(fCurrDistThresholdFactor)*m_nMinColorDistThreshold) * 3;
+          const size_t nCurrTotDescDistThreshold = (((size_t)1 << ((size_t)floor(fCurrDistThresholdFactor + 0.5f))) + m_nDescDistThresholdOffset + (bCurrRegionIsUnstable*UNSTAB_DESC_DIST_OFFSET)) * 3;
+          ushort anCurrIntraDesc[3], anCurrInterDesc[3];
+          const size_t anCurrIntraLBSPThresholds[3] = { m_anLBSPThreshold_8bitLUT[anColor[0]],m_anLBSPThreshold_8bitLUT[anColor[1]],m_anLBSPThreshold_8bitLUT[anColor[2]] };
+          LBSP_::computeRGBDescriptor(oInputImg, anColor, nImgCoord_X, nImgCoord_Y, anCurrIntraLBSPThresholds, anCurrIntraDesc);
+          for (size_t nLocalWordIdx = 0; nLocalWordIdx < m_nCurrLocalWords && fPotentialLocalWordsWeightSum < fLocalWordsWeightSumThreshold; ++nLocalWordIdx) {
+            const LocalWord_3ch* pCurrLocalWord = (const LocalWord_3ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]);
+            const size_t nTotColorMixDist = cmixdist(L1dist<3>(anColor, pCurrLocalWord->oFeature.anColor), cdist<3>(anColor, pCurrLocalWord->oFeature.anColor));
+            if (nTotColorMixDist > nCurrTotColorDistThreshold)
+              continue;
+            const size_t anCurrInterLBSPThresholds[3] = { m_anLBSPThreshold_8bitLUT[pCurrLocalWord->oFeature.anColor[0]],m_anLBSPThreshold_8bitLUT[pCurrLocalWord->oFeature.anColor[1]],m_anLBSPThreshold_8bitLUT[pCurrLocalWord->oFeature.anColor[2]] };
+            LBSP_::computeRGBDescriptor(oInputImg, pCurrLocalWord->oFeature.anColor, nImgCoord_X, nImgCoord_Y, anCurrInterLBSPThresholds, anCurrInterDesc);
+            const size_t nTotDescDist = (hdist<3>(anCurrIntraDesc, pCurrLocalWord->oFeature.anDesc) + hdist<3>(anCurrInterDesc, pCurrLocalWord->oFeature.anDesc)) / 2;
+            if (nTotDescDist <= nCurrTotDescDistThreshold)
+              fPotentialLocalWordsWeightSum += GetLocalWordWeight(pCurrLocalWord, m_nFrameIndex, m_nLocalWordWeightOffset);
+          }
+          if (fPotentialLocalWordsWeightSum >= fLocalWordsWeightSumThreshold)
+            return false;
+          const uchar nCurrIntraDescBITS = (uchar)popcount<3>(anCurrIntraDesc);
+          const bool bCurrRegionIsFlat = nCurrIntraDescBITS < FLAT_REGION_BIT_COUNT * 2;
+          for (size_t nGlobalWordLUTIdx = 0; nGlobalWordLUTIdx < m_nCurrGlobalWords; ++nGlobalWordLUTIdx) {
+            const GlobalWord_3ch* pCurrGlobalWord = (const GlobalWord_3ch*)GetGlobalWord(m_anGlobalWordSortLUT[nModelIter*m_nCurrGlobalWords + nGlobalWordLUTIdx]);
+            if (L1dist(nCurrIntraDescBITS, pCurrGlobalWord->nDescBITS) <= nCurrTotDescDistThreshold / GWORD_DESC_THRES_BITS_MATCH_FACTOR
+              && cmixdist<3>(anColor, pCurrGlobalWord->oFeature.anColor) <= nCurrTotColorDistThreshold) {
+              const float fGlobalWordLocalizedWeight = *(float*)(pCurrGlobalWord->oSpatioOccMap.data + nGlobalWordMapLookupIdx);
+              return fPotentialLocalWordsWeightSum + fGlobalWordLocalizedWeight / (bCurrRegionIsFlat ? 2 : 4) < fLocalWordsWeightSumThreshold;
+            }
+          }
+        }
+        return true;
+      }
+
       void BackgroundSubtractorPAWCS::getBackgroundImage(cv::OutputArray backgroundImage) const { // @@@ add option to reconstruct from gwords?
         CV_Assert(m_bInitialized);
         cv::Mat oAvgBGImg = cv::Mat::zeros(m_oImgSize, CV_32FC((int)m_nImgChannels));
@@ -1250,7 +1333,7 @@ namespace bgslibrary
             float fTotWeight = 0.0f;
             float fTotColor = 0.0f;
             for (size_t nLocalWordIdx = 0; nLocalWordIdx < m_nCurrLocalWords; ++nLocalWordIdx) {
-              LocalWord_1ch* pCurrLocalWord = (LocalWord_1ch*)m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx];
+              const LocalWord_1ch* pCurrLocalWord = (const LocalWord_1ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]);
               float fCurrWeight = GetLocalWordWeight(pCurrLocalWord, m_nFrameIndex, m_nLocalWordWeightOffset);
               fTotColor += (float)pCurrLocalWord->oFeature.anColor[0] * fCurrWeight;
               fTotWeight += fCurrWeight;
@@ -1261,7 +1344,7 @@ namespace bgslibrary
             float fTotWeight = 0.0f;
             float fTotColor[3] = { 0.0f,0.0f,0.0f };
             for (size_t nLocalWordIdx = 0; nLocalWordIdx < m_nCurrLocalWords; ++nLocalWordIdx) {
-              LocalWord_3ch* pCurrLocalWord = (LocalWord_3ch*)m_apLocalWordDict[nLocalDictIdx + nLocalWordIdx];
+              const LocalWord_3ch* pCurrLocalWord = (const LocalWord_3ch*)GetLocalWord(m_anLocalWordDict[nLocalDictIdx + nLocalWordIdx]);
               float fCurrWeight = GetLocalWordWeight(pCurrLocalWord, m_nFrameIndex, m_nLocalWordWeightOffset);
               for (size_t c = 0; c < 3; ++c)
                 fTotColor[c] += (float)pCurrLocalWord->oFeature.anColor[c] * fCurrWeight;
@@ -1294,37 +1377,19 @@ namespace bgslibrary
       }
 
       void BackgroundSubtractorPAWCS::CleanupDictionaries() {
-        if (m_aLocalWordList_1ch) {
-          delete[] m_aLocalWordList_1ch;
-          m_aLocalWordList_1ch = nullptr;
-          m_pLocalWordListIter_1ch = nullptr;
-        }
-        else if (m_aLocalWordList_3ch) {
-          delete[] m_aLocalWordList_3ch;
-          m_aLocalWordList_3ch = nullptr;
-          m_pLocalWordListIter_3ch = nullptr;
-        }
-        if (m_apLocalWordDict) {
-          delete[] m_apLocalWordDict;
-          m_apLocalWordDict = nullptr;
-        }
+        m_aLocalWordArena.release();
+        m_anLocalWordDict.release();
         if (m_aGlobalWordList_1ch) {
           delete[] m_aGlobalWordList_1ch;
           m_aGlobalWordList_1ch = nullptr;
-          m_pGlobalWordListIter_1ch = nullptr;
         }
         else if (m_aGlobalWordList_3ch) {
           delete[] m_aGlobalWordList_3ch;
           m_aGlobalWordList_3ch = nullptr;
-          m_pGlobalWordListIter_3ch = nullptr;
-        }
-        if (m_apGlobalWordDict) {
-          delete[] m_apGlobalWordDict;
-          m_apGlobalWordDict = nullptr;
         }
+        m_anGlobalWordDict.release();
+        m_anGlobalWordSortLUT.release();
         if (m_aPxInfoLUT_PAWCS) {
-          for (size_t nPxIter = 0; nPxIter < m_nTotPxCount; ++nPxIter)
-            delete[] m_aPxInfoLUT_PAWCS[nPxIter].apGlobalDictSortLUT;
           delete[] m_aPxInfoLUT_PAWCS;
           m_aPxInfoLUT = nullptr;
           m_aPxInfoLUT_PAWCS = nullptr;
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <stdint.h>
+#include <vector>
+
 #include "BackgroundSubtractorLBSP_.h"
+#include "../../utils/AlignedBuffer.h"
 
 namespace bgslibrary
 {
@@ -50,6 +54,9 @@ namespace bgslibrary
         virtual void getBackgroundImage(cv::OutputArray backgroundImage) const;
         //! returns a copy of the latest reconstructed background descriptors image
         virtual void getBackgroundDescriptorsImage(cv::OutputArray backgroundDescImage) const;
+        //! re-runs the per-pixel test of the last apply call at the given px, with anColor as its color (the rest of the LBSP
+        //! patch is read from oInputImg, the frame given to apply); the model is not updated, and the result is the raw label
+        bool isForegroundPixel(const cv::Mat& oInputImg, int nImgCoord_X, int nImgCoord_Y, const uchar* anColor) const;
 
       protected:
         template<size_t nChannels>
@@ -58,9 +65,9 @@ namespace bgslibrary
           ushort anDesc[nChannels];
         };
         struct LocalWordBase {
-          size_t nFirstOcc;
-          size_t nLastOcc;
-          size_t nOccurrences;
+          uint32_t nFirstOcc;
+          uint32_t nLastOcc;
+          uint32_t nOccurrences;
         };
         template<typename T>
         struct LocalWord : LocalWordBase {
@@ -81,7 +88,6 @@ namespace bgslibrary
         typedef GlobalWord<ColorLBSPFeature<3>> GlobalWord_3ch;
         struct PxInfo_PAWCS : PxInfoBase {
           size_t nGlobalWordMapLookupIdx;
-          GlobalWordBase** apGlobalDictSortLUT;
         };
         //! absolute minimal color distance threshold ('R' or 'radius' in the original ViBe paper, used as the default/initial 'R(x)' value here)
         const size_t m_nMinColorDistThreshold;
@@ -106,13 +112,17 @@ namespace bgslibrary
         //! current local word weight offset
         size_t m_nLocalWordWeightOffset;
 
-        //! word lists & dictionaries
-        LocalWordBase** m_apLocalWordDict;
-        LocalWord_1ch* m_aLocalWordList_1ch, *m_pLocalWordListIter_1ch;
-        LocalWord_3ch* m_aLocalWordList_3ch, *m_pLocalWordListIter_3ch;
-        GlobalWordBase** m_apGlobalWordDict;
-        GlobalWord_1ch* m_aGlobalWordList_1ch, *m_pGlobalWordListIter_1ch;
-        GlobalWord_3ch* m_aGlobalWordList_3ch, *m_pGlobalWordListIter_3ch;
+        //! local word arena; the words of a model px live in its own slot of m_nCurrLocalWords words (LocalWord_1ch or LocalWord_3ch, m_nLocalWordSize bytes each)
+        AlignedBuffer<uchar> m_aLocalWordArena;
+        size_t m_nLocalWordSize;
+        //! per-px local dictionaries (m_nCurrLocalWords arena indices per model px, sorted by weight)
+        AlignedBuffer<uint32_t> m_anLocalWordDict;
+        //! global word lists & dictionary (m_nCurrGlobalWords list indices, sorted by weight)
+        GlobalWord_1ch* m_aGlobalWordList_1ch;
+        GlobalWord_3ch* m_aGlobalWordList_3ch;
+        AlignedBuffer<uint32_t> m_anGlobalWordDict;
+        //! per-px global word lookup tables (m_nCurrGlobalWords list indices per model px, sorted by local weight)
+        AlignedBuffer<uint32_t> m_anGlobalWordSortLUT;
         PxInfo_PAWCS* m_aPxInfoLUT_PAWCS;
 
         //! a lookup map used to keep track of regions where illumination recently changed
@@ -149,7 +159,29 @@ namespace bgslibrary
         cv::Mat m_oLastRawFGBlinkMask;
         cv::Mat m_oTempGlobalWordWeightDiffFactor;
         cv::Mat m_oMorphExStructElement;
+        //! intra-frame LBSP descriptors of the row currently analyzed, computed one whole row at a time
+        std::vector<ushort> m_vnCurrIntraDescRow;
 
+        //! dictionary index value used for entries which do not hold a word yet
+        static const uint32_t EMPTY_WORD_IDX = UINT32_MAX;
+        //! returns the local word at the given arena index (nullptr for EMPTY_WORD_IDX)
+        inline LocalWordBase* GetLocalWord(uint32_t nWordIdx) {
+          return nWordIdx == EMPTY_WORD_IDX ? nullptr : (LocalWordBase*)(m_aLocalWordArena.data() + nWordIdx*m_nLocalWordSize);
+        }
+        inline const LocalWordBase* GetLocalWord(uint32_t nWordIdx) const {
+          return nWordIdx == EMPTY_WORD_IDX ? nullptr : (const LocalWordBase*)(m_aLocalWordArena.data() + nWordIdx*m_nLocalWordSize);
+        }
+        //! returns the global word at the given list index (nullptr for EMPTY_WORD_IDX)
+        inline GlobalWordBase* GetGlobalWord(uint32_t nWordIdx) {
+          if (nWordIdx == EMPTY_WORD_IDX)
+            return nullptr;
+          return m_nImgChannels == 1 ? (GlobalWordBase*)(m_aGlobalWordList_1ch + nWordIdx) : (GlobalWordBase*)(m_aGlobalWordList_3ch + nWordIdx);
+        }
+        inline const GlobalWordBase* GetGlobalWord(uint32_t nWordIdx) const {
+          if (nWordIdx == EMPTY_WORD_IDX)
+            return nullptr;
+          return m_nImgChannels == 1 ? (const GlobalWordBase*)(m_aGlobalWordList_1ch + nWordIdx) : (const GlobalWordBase*)(m_aGlobalWordList_3ch + nWordIdx);
+        }
         //! internal cleanup function for the dictionary structures
         void CleanupDictionaries();
         //! internal weight lookup function for local words
@@ -8,6 +8,7 @@
 
 #include "BackgroundSubtractorSuBSENSE.h"
 #include "RandUtils.h"
+#include "LBSPRows.h"
 
 //using namespace bgslibrary::algorithms::lbsp;
 
@@ -253,6 +254,7 @@ namespace bgslibrary
             }
           }
         }
+        initBands();
         m_bInitialized = true;
         refreshModel(1.0f);
       }
@@ -262,14 +264,14 @@ namespace bgslibrary
         CV_Assert(m_bInitialized);
         CV_Assert(fSamplesRefreshFrac > 0.0f && fSamplesRefreshFrac <= 1.0f);
         const size_t nModelsToRefresh = fSamplesRefreshFrac < 1.0f ? (size_t)(fSamplesRefreshFrac*m_nBGSamples) : m_nBGSamples;
-        const size_t nRefreshStartPos = fSamplesRefreshFrac < 1.0f ? rand() % m_nBGSamples : 0;
+        const size_t nRefreshStartPos = fSamplesRefreshFrac < 1.0f ? m_oRNG() % m_nBGSamples : 0;
         if (m_nImgChannels == 1) {
           for (size_t nModelIter = 0; nModelIter < m_nTotRelevantPxCount; ++nModelIter) {
             const size_t nPxIter = m_aPxIdxLUT[nModelIter];
             if (bForceFGUpdate || !m_oLastFGMask.data[nPxIter]) {
               for (size_t nCurrModelIdx = nRefreshStartPos; nCurrModelIdx < nRefreshStartPos + nModelsToRefresh; ++nCurrModelIdx) {
                 int nSampleImgCoord_Y, nSampleImgCoord_X;
-                getRandSamplePosition(nSampleImgCoord_X, nSampleImgCoord_Y, m_aPxInfoLUT[nPxIter].nImgCoord_X, m_aPxInfoLUT[nPxIter].nImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
+                getRandSamplePosition(m_oRNG, nSampleImgCoord_X, nSampleImgCoord_Y, m_aPxInfoLUT[nPxIter].nImgCoord_X, m_aPxInfoLUT[nPxIter].nImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
                 const size_t nSamplePxIdx = m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
                 if (bForceFGUpdate || !m_oLastFGMask.data[nSamplePxIdx]) {
                   const size_t nCurrRealModelIdx = nCurrModelIdx%m_nBGSamples;
@@ -286,7 +288,7 @@ namespace bgslibrary
             if (bForceFGUpdate || !m_oLastFGMask.data[nPxIter]) {
               for (size_t nCurrModelIdx = nRefreshStartPos; nCurrModelIdx < nRefreshStartPos + nModelsToRefresh; ++nCurrModelIdx) {
                 int nSampleImgCoord_Y, nSampleImgCoord_X;
-                getRandSamplePosition(nSampleImgCoord_X, nSampleImgCoord_Y, m_aPxInfoLUT[nPxIter].nImgCoord_X, m_aPxInfoLUT[nPxIter].nImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
+                getRandSamplePosition(m_oRNG, nSampleImgCoord_X, nSampleImgCoord_Y, m_aPxInfoLUT[nPxIter].nImgCoord_X, m_aPxInfoLUT[nPxIter].nImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
                 const size_t nSamplePxIdx = m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
                 if (bForceFGUpdate || !m_oLastFGMask.data[nSamplePxIdx]) {
                   const size_t nCurrRealModelIdx = nCurrModelIdx%m_nBGSamples;
@@ -301,20 +303,18 @@ namespace bgslibrary
         }
       }
 
-      void BackgroundSubtractorSuBSENSE::apply(cv::InputArray _image, cv::OutputArray _fgmask, double learningRateOverride) {
-        // == process
-        CV_Assert(m_bInitialized);
-        cv::Mat oInputImg = _image.getMat();
-        CV_Assert(oInputImg.type() == m_nImgType && oInputImg.size() == m_oImgSize);
-        CV_Assert(oInputImg.isContinuous());
-        _fgmask.create(m_oImgSize, CV_8UC1);
-        cv::Mat oCurrFGMask = _fgmask.getMat();
-        memset(oCurrFGMask.data, 0, oCurrFGMask.cols*oCurrFGMask.rows);
+      size_t BackgroundSubtractorSuBSENSE::applyBand(size_t nBandIdx, const cv::Mat& oInputImg, cv::Mat& oCurrFGMask, float fRollAvgFactor_LT, float fRollAvgFactor_ST, double learningRateOverride) {
+        const BandInfo& oBand = m_voBands[nBandIdx];
+        FastRNG& oRNG = getBandRNG(nBandIdx);
+        std::vector<DeferredUpdate>& vDeferredUpdates = m_vvBandDeferredUpdates[nBandIdx];
+        // the intra-frame descriptors are computed one whole row at a time, on the first ROI pixel of each row
+        std::vector<ushort>& vCurrIntraDescRow = m_vvBandIntraDescRows[nBandIdx];
+        vCurrIntraDescRow.resize((size_t)m_oImgSize.width*m_nImgChannels);
+        const int nDescRowBorder = (int)LBSP::PATCH_SIZE / 2;
+        int nCurrIntraDescRow = -1;
         size_t nNonZeroDescCount = 0;
-        const float fRollAvgFactor_LT = 1.0f / std::min(++m_nFrameIndex, m_nSamplesForMovingAvgs);
-        const float fRollAvgFactor_ST = 1.0f / std::min(m_nFrameIndex, m_nSamplesForMovingAvgs / 4);
         if (m_nImgChannels == 1) {
-          for (size_t nModelIter = 0; nModelIter < m_nTotRelevantPxCount; ++nModelIter) {
+          for (size_t nModelIter = oBand.nModelIterBegin; nModelIter < oBand.nModelIterEnd; ++nModelIter) {
             const size_t nPxIter = m_aPxIdxLUT[nModelIter];
             const size_t nDescIter = nPxIter * 2;
             const size_t nFloatIter = nPxIter * 4;
@@ -337,8 +337,12 @@ namespace bgslibrary
             uchar& nLastColor = m_oLastColorFrame.data[nPxIter];
             const size_t nCurrColorDistThreshold = (size_t)(((*pfCurrDistThresholdFactor)*m_nMinColorDistThreshold) - ((!m_oUnstableRegionMask.data[nPxIter])*STAB_COLOR_DIST_OFFSET)) / 2;
             const size_t nCurrDescDistThreshold = ((size_t)1 << ((size_t)floor(*pfCurrDistThresholdFactor + 0.5f))) + m_nDescDistThresholdOffset + (m_oUnstableRegionMask.data[nPxIter] * UNSTAB_DESC_DIST_OFFSET);
-            ushort nCurrInterDesc, nCurrIntraDesc;
-            LBSP::computeGrayscaleDescriptor(oInputImg, nCurrColor, nCurrImgCoord_X, nCurrImgCoord_Y, m_anLBSPThreshold_8bitLUT[nCurrColor], nCurrIntraDesc);
+            if (nCurrImgCoord_Y != nCurrIntraDescRow) {
+              nCurrIntraDescRow = nCurrImgCoord_Y;
+              computeDescriptorRow(oInputImg, nCurrImgCoord_Y, nDescRowBorder, m_oImgSize.width - nDescRowBorder, m_anLBSPThreshold_8bitLUT, vCurrIntraDescRow.data() + nDescRowBorder);
+            }
+            ushort nCurrInterDesc;
+            const ushort nCurrIntraDesc = vCurrIntraDescRow[nCurrImgCoord_X];
             m_oUnstableRegionMask.data[nPxIter] = ((*pfCurrDistThresholdFactor) > UNSTABLE_REG_RDIST_MIN || (*pfCurrMeanRawSegmRes_LT - *pfCurrMeanFinalSegmRes_LT) > UNSTABLE_REG_RATIO_MIN || (*pfCurrMeanRawSegmRes_ST - *pfCurrMeanFinalSegmRes_ST) > UNSTABLE_REG_RATIO_MIN) ? 1 : 0;
             size_t nGoodSamplesCount = 0, nSampleIdx = 0;
             while (nGoodSamplesCount < m_nRequiredBGSamples && nSampleIdx < m_nBGSamples) {
@@ -376,8 +380,8 @@ namespace bgslibrary
               *pfCurrMeanRawSegmRes_LT = (*pfCurrMeanRawSegmRes_LT)*(1.0f - fRollAvgFactor_LT) + fRollAvgFactor_LT;
               *pfCurrMeanRawSegmRes_ST = (*pfCurrMeanRawSegmRes_ST)*(1.0f - fRollAvgFactor_ST) + fRollAvgFactor_ST;
               oCurrFGMask.data[nPxIter] = UCHAR_MAX;
-              if (m_nModelResetCooldown && (rand() % (size_t)FEEDBACK_T_LOWER) == 0) {
-                const size_t s_rand = rand() % m_nBGSamples;
+              if (m_nModelResetCooldown && (oRNG() % (size_t)FEEDBACK_T_LOWER) == 0) {
+                const size_t s_rand = oRNG() % m_nBGSamples;
                 *((ushort*)(m_voBGDescSamples[s_rand].data + nDescIter)) = nCurrIntraDesc;
                 m_voBGColorSamples[s_rand].data[nPxIter] = nCurrColor;
               }
@@ -390,28 +394,35 @@ namespace bgslibrary
               *pfCurrMeanRawSegmRes_LT = (*pfCurrMeanRawSegmRes_LT)*(1.0f - fRollAvgFactor_LT);
               *pfCurrMeanRawSegmRes_ST = (*pfCurrMeanRawSegmRes_ST)*(1.0f - fRollAvgFactor_ST);
               const size_t nLearningRate = learningRateOverride > 0 ? (size_t)ceil(learningRateOverride) : (size_t)ceil(*pfCurrLearningRate);
-              if ((rand() % nLearningRate) == 0) {
-                const size_t s_rand = rand() % m_nBGSamples;
+              if ((oRNG() % nLearningRate) == 0) {
+                const size_t s_rand = oRNG() % m_nBGSamples;
                 *((ushort*)(m_voBGDescSamples[s_rand].data + nDescIter)) = nCurrIntraDesc;
                 m_voBGColorSamples[s_rand].data[nPxIter] = nCurrColor;
               }
               int nSampleImgCoord_Y, nSampleImgCoord_X;
               const bool bCurrUsing3x3Spread = m_bUse3x3Spread && !m_oUnstableRegionMask.data[nPxIter];
               if (bCurrUsing3x3Spread)
-                getRandNeighborPosition_3x3(nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
+                getRandNeighborPosition_3x3(oRNG, nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
               else
-                getRandNeighborPosition_5x5(nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
-              const size_t n_rand = rand();
+                getRandNeighborPosition_5x5(oRNG, nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
+              const size_t n_rand = oRNG();
               const size_t idx_rand_uchar = m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
-              const size_t idx_rand_flt32 = idx_rand_uchar * 4;
-              const float fRandMeanLastDist = *((float*)(m_oMeanLastDistFrame.data + idx_rand_flt32));
-              const float fRandMeanRawSegmRes = *((float*)(m_oMeanRawSegmResFrame_ST.data + idx_rand_flt32));
-              if ((n_rand % (bCurrUsing3x3Spread ? nLearningRate : (nLearningRate / 2 + 1))) == 0
-                || (fRandMeanRawSegmRes > GHOSTDET_S_MIN && fRandMeanLastDist < GHOSTDET_D_MAX && (n_rand % ((size_t)m_fCurrLearningRateLowerCap)) == 0)) {
-                const size_t idx_rand_ushrt = idx_rand_uchar * 2;
-                const size_t s_rand = rand() % m_nBGSamples;
-                *((ushort*)(m_voBGDescSamples[s_rand].data + idx_rand_ushrt)) = nCurrIntraDesc;
-                m_voBGColorSamples[s_rand].data[idx_rand_uchar] = nCurrColor;
+              if (nSampleImgCoord_Y < oBand.nRowBegin || nSampleImgCoord_Y >= oBand.nRowEnd) {
+                // the neighbour belongs to another band (which may be updating it): check & apply once all bands are done
+                const DeferredUpdate oUpdate = { idx_rand_uchar, n_rand, (size_t)(bCurrUsing3x3Spread ? nLearningRate : (nLearningRate / 2 + 1)), oRNG() % m_nBGSamples, { nCurrIntraDesc, 0, 0 }, { nCurrColor, 0, 0 } };
+                vDeferredUpdates.push_back(oUpdate);
+              }
+              else {
+                const size_t idx_rand_flt32 = idx_rand_uchar * 4;
+                const float fRandMeanLastDist = *((float*)(m_oMeanLastDistFrame.data + idx_rand_flt32));
+                const float fRandMeanRawSegmRes = *((float*)(m_oMeanRawSegmResFrame_ST.data + idx_rand_flt32));
+                if ((n_rand % (bCurrUsing3x3Spread ? nLearningRate : (nLearningRate / 2 + 1))) == 0
+                  || (fRandMeanRawSegmRes > GHOSTDET_S_MIN && fRandMeanLastDist < GHOSTDET_D_MAX && (n_rand % ((size_t)m_fCurrLearningRateLowerCap)) == 0)) {
+                  const size_t idx_rand_ushrt = idx_rand_uchar * 2;
+                  const size_t s_rand = oRNG() % m_nBGSamples;
+                  *((ushort*)(m_voBGDescSamples[s_rand].data + idx_rand_ushrt)) = nCurrIntraDesc;
+                  m_voBGColorSamples[s_rand].data[idx_rand_uchar] = nCurrColor;
+                }
               }
             }
             if (m_oLastFGMask.data[nPxIter] || (std::min(*pfCurrMeanMinDist_LT, *pfCurrMeanMinDist_ST) < UNSTABLE_REG_RATIO_MIN && oCurrFGMask.data[nPxIter])) {
@@ -445,7 +456,7 @@ namespace bgslibrary
           }
         }
         else { //m_nImgChannels==3
-          for (size_t nModelIter = 0; nModelIter < m_nTotRelevantPxCount; ++nModelIter) {
+          for (size_t nModelIter = oBand.nModelIterBegin; nModelIter < oBand.nModelIterEnd; ++nModelIter) {
             const size_t nPxIter = m_aPxIdxLUT[nModelIter];
             const int nCurrImgCoord_X = m_aPxInfoLUT[nPxIter].nImgCoord_X;
             const int nCurrImgCoord_Y = m_aPxInfoLUT[nPxIter].nImgCoord_Y;
@@ -472,9 +483,12 @@ namespace bgslibrary
             const size_t nCurrTotColorDistThreshold = nCurrColorDistThreshold * 3;
             const size_t nCurrTotDescDistThreshold = nCurrDescDistThreshold * 3;
             const size_t nCurrSCColorDistThreshold = nCurrTotColorDistThreshold / 2;
-            ushort anCurrInterDesc[3], anCurrIntraDesc[3];
-            const size_t anCurrIntraLBSPThresholds[3] = { m_anLBSPThreshold_8bitLUT[anCurrColor[0]],m_anLBSPThreshold_8bitLUT[anCurrColor[1]],m_anLBSPThreshold_8bitLUT[anCurrColor[2]] };
-            LBSP::computeRGBDescriptor(oInputImg, anCurrColor, nCurrImgCoord_X, nCurrImgCoord_Y, anCurrIntraLBSPThresholds, anCurrIntraDesc);
+            if (nCurrImgCoord_Y != nCurrIntraDescRow) {
+              nCurrIntraDescRow = nCurrImgCoord_Y;
+              computeDescriptorRow(oInputImg, nCurrImgCoord_Y, nDescRowBorder, m_oImgSize.width - nDescRowBorder, m_anLBSPThreshold_8bitLUT, vCurrIntraDescRow.data() + nDescRowBorder * 3);
+            }
+            ushort anCurrInterDesc[3];
+            const ushort* const anCurrIntraDesc = vCurrIntraDescRow.data() + nCurrImgCoord_X * 3;
             m_oUnstableRegionMask.data[nPxIter] = ((*pfCurrDistThresholdFactor) > UNSTABLE_REG_RDIST_MIN || (*pfCurrMeanRawSegmRes_LT - *pfCurrMeanFinalSegmRes_LT) > UNSTABLE_REG_RATIO_MIN || (*pfCurrMeanRawSegmRes_ST - *pfCurrMeanFinalSegmRes_ST) > UNSTABLE_REG_RATIO_MIN) ? 1 : 0;
             size_t nGoodSamplesCount = 0, nSampleIdx = 0;
             while (nGoodSamplesCount < m_nRequiredBGSamples && nSampleIdx < m_nBGSamples) {
@@ -516,8 +530,8 @@ namespace bgslibrary
               *pfCurrMeanRawSegmRes_LT = (*pfCurrMeanRawSegmRes_LT)*(1.0f - fRollAvgFactor_LT) + fRollAvgFactor_LT;
               *pfCurrMeanRawSegmRes_ST = (*pfCurrMeanRawSegmRes_ST)*(1.0f - fRollAvgFactor_ST) + fRollAvgFactor_ST;
               oCurrFGMask.data[nPxIter] = UCHAR_MAX;
-              if (m_nModelResetCooldown && (rand() % (size_t)FEEDBACK_T_LOWER) == 0) {
-                const size_t s_rand = rand() % m_nBGSamples;
+              if (m_nModelResetCooldown && (oRNG() % (size_t)FEEDBACK_T_LOWER) == 0) {
+                const size_t s_rand = oRNG() % m_nBGSamples;
                 for (size_t c = 0; c < 3; ++c) {
                   *((ushort*)(m_voBGDescSamples[s_rand].data + nDescIterRGB + 2 * c)) = anCurrIntraDesc[c];
                   *(m_voBGColorSamples[s_rand].data + nPxIterRGB + c) = anCurrColor[c];
@@ -532,8 +546,8 @@ namespace bgslibrary
               *pfCurrMeanRawSegmRes_LT = (*pfCurrMeanRawSegmRes_LT)*(1.0f - fRollAvgFactor_LT);
               *pfCurrMeanRawSegmRes_ST = (*pfCurrMeanRawSegmRes_ST)*(1.0f - fRollAvgFactor_ST);
               const size_t nLearningRate = learningRateOverride > 0 ? (size_t)ceil(learningRateOverride) : (size_t)ceil(*pfCurrLearningRate);
-              if ((rand() % nLearningRate) == 0) {
-                const size_t s_rand = rand() % m_nBGSamples;
+              if ((oRNG() % nLearningRate) == 0) {
+                const size_t s_rand = oRNG() % m_nBGSamples;
                 for (size_t c = 0; c < 3; ++c) {
                   *((ushort*)(m_voBGDescSamples[s_rand].data + nDescIterRGB + 2 * c)) = anCurrIntraDesc[c];
                   *(m_voBGColorSamples[s_rand].data + nPxIterRGB + c) = anCurrColor[c];
@@ -542,22 +556,29 @@ namespace bgslibrary
               int nSampleImgCoord_Y, nSampleImgCoord_X;
               const bool bCurrUsing3x3Spread = m_bUse3x3Spread && !m_oUnstableRegionMask.data[nPxIter];
               if (bCurrUsing3x3Spread)
-                getRandNeighborPosition_3x3(nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
+                getRandNeighborPosition_3x3(oRNG, nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
               else
-                getRandNeighborPosition_5x5(nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
-              const size_t n_rand = rand();
+                getRandNeighborPosition_5x5(oRNG, nSampleImgCoord_X, nSampleImgCoord_Y, nCurrImgCoord_X, nCurrImgCoord_Y, LBSP::PATCH_SIZE / 2, m_oImgSize);
+              const size_t n_rand = oRNG();
               const size_t idx_rand_uchar = m_oImgSize.width*nSampleImgCoord_Y + nSampleImgCoord_X;
-              const size_t idx_rand_flt32 = idx_rand_uchar * 4;
-              const float fRandMeanLastDist = *((float*)(m_oMeanLastDistFrame.data + idx_rand_flt32));
-              const float fRandMeanRawSegmRes = *((float*)(m_oMeanRawSegmResFrame_ST.data + idx_rand_flt32));
-              if ((n_rand % (bCurrUsing3x3Spread ? nLearningRate : (nLearningRate / 2 + 1))) == 0
-                || (fRandMeanRawSegmRes > GHOSTDET_S_MIN && fRandMeanLastDist < GHOSTDET_D_MAX && (n_rand % ((size_t)m_fCurrLearningRateLowerCap)) == 0)) {
-                const size_t idx_rand_uchar_rgb = idx_rand_uchar * 3;
-                const size_t idx_rand_ushrt_rgb = idx_rand_uchar_rgb * 2;
-                const size_t s_rand = rand() % m_nBGSamples;
-                for (size_t c = 0; c < 3; ++c) {
-                  *((ushort*)(m_voBGDescSamples[s_rand].data + idx_rand_ushrt_rgb + 2 * c)) = anCurrIntraDesc[c];
-                  *(m_voBGColorSamples[s_rand].data + idx_rand_uchar_rgb + c) = anCurrColor[c];
+              if (nSampleImgCoord_Y < oBand.nRowBegin || nSampleImgCoord_Y >= oBand.nRowEnd) {
+                // the neighbour belongs to another band (which may be updating it): check & apply once all bands are done
+                const DeferredUpdate oUpdate = { idx_rand_uchar, n_rand, (size_t)(bCurrUsing3x3Spread ? nLearningRate : (nLearningRate / 2 + 1)), oRNG() % m_nBGSamples, { anCurrIntraDesc[0], anCurrIntraDesc[1], anCurrIntraDesc[2] }, { anCurrColor[0], anCurrColor[1], anCurrColor[2] } };
+                vDeferredUpdates.push_back(oUpdate);
+              }
+              else {
+                const size_t idx_rand_flt32 = idx_rand_uchar * 4;
+                const float fRandMeanLastDist = *((float*)(m_oMeanLastDistFrame.data + idx_rand_flt32));
+                const float fRandMeanRawSegmRes = *((float*)(m_oMeanRawSegmResFrame_ST.data + idx_rand_flt32));
+                if ((n_rand % (bCurrUsing3x3Spread ? nLearningRate : (nLearningRate / 2 + 1))) == 0
+                  || (fRandMeanRawSegmRes > GHOSTDET_S_MIN && fRandMeanLastDist < GHOSTDET_D_MAX && (n_rand % ((size_t)m_fCurrLearningRateLowerCap)) == 0)) {
+                  const size_t idx_rand_uchar_rgb = idx_rand_uchar * 3;
+                  const size_t idx_rand_ushrt_rgb = idx_rand_uchar_rgb * 2;
+                  const size_t s_rand = oRNG() % m_nBGSamples;
+                  for (size_t c = 0; c < 3; ++c) {
+                    *((ushort*)(m_voBGDescSamples[s_rand].data + idx_rand_ushrt_rgb + 2 * c)) = anCurrIntraDesc[c];
+                    *(m_voBGColorSamples[s_rand].data + idx_rand_uchar_rgb + c) = anCurrColor[c];
+                  }
                 }
               }
             }
@@ -593,6 +614,120 @@ namespace bgslibrary
             }
           }
         }
+        return nNonZeroDescCount;
+      }
+
+      void BackgroundSubtractorSuBSENSE::applyDeferredUpdate(const DeferredUpdate& oUpdate) {
+        const size_t idx_rand_flt32 = oUpdate.nPxIter * 4;
+        const float fRandMeanLastDist = *((float*)(m_oMeanLastDistFrame.data + idx_rand_flt32));
+        const float fRandMeanRawSegmRes = *((float*)(m_oMeanRawSegmResFrame_ST.data + idx_rand_flt32));
+        if ((oUpdate.nRand % oUpdate.nRandModulo) == 0
+          || (fRandMeanRawSegmRes > GHOSTDET_S_MIN && fRandMeanLastDist < GHOSTDET_D_MAX && (oUpdate.nRand % ((size_t)m_fCurrLearningRateLowerCap)) == 0)) {
+          const size_t idx_rand_uchar = oUpdate.nPxIter * m_nImgChannels;
+          const size_t idx_rand_ushrt = idx_rand_uchar * 2;
+          for (size_t c = 0; c < m_nImgChannels; ++c) {
+            *((ushort*)(m_voBGDescSamples[oUpdate.nSampleIdx].data + idx_rand_ushrt + 2 * c)) = oUpdate.anDesc[c];
+            *(m_voBGColorSamples[oUpdate.nSampleIdx].data + idx_rand_uchar + c) = oUpdate.anColor[c];
+          }
+        }
+      }
+
+      bool BackgroundSubtractorSuBSENSE::isForegroundPixel(const cv::Mat& oInputImg, int nImgCoord_X, int nImgCoord_Y, const uchar* anColor) const {
+        // same tests as applyBand, but with the given color as the center of the LBSP patch & without any model update
+        CV_Assert(m_bInitialized);
+        CV_DbgAssert(oInputImg.type() == m_nImgType && oInputImg.size() == m_oImgSize);
+        CV_DbgAssert(nImgCoord_X >= 0 && nImgCoord_X < m_oImgSize.width && nImgCoord_Y >= 0 && nImgCoord_Y < m_oImgSize.height);
+        const size_t nPxIter = (size_t)m_oImgSize.width*nImgCoord_Y + nImgCoord_X;
+        if (!m_oROI.data[nPxIter])
+          return false;
+        const float fCurrDistThresholdFactor = *(float*)(m_oDistThresholdFrame.data + nPxIter * 4);
+        const uchar bCurrRegionIsUnstable = m_oUnstableRegionMask.data[nPxIter];
+        const size_t nCurrDescDistThreshold = ((size_t)1 << ((size_t)floor(fCurrDistThresholdFactor + 0.5f))) + m_nDescDistThresholdOffset + (bCurrRegionIsUnstable * UNSTAB_DESC_DIST_OFFSET);
+        size_t nGoodSamplesCount = 0, nSampleIdx = 0;
+        if (m_nImgChannels == 1) {
+          const size_t nDescIter = nPxIter * 2;
+          const size_t nCurrColorDistThreshold = (size_t)((fCurrDistThresholdFactor*m_nMinColorDistThreshold) - ((!bCurrRegionIsUnstable)*STAB_COLOR_DIST_OFFSET)) / 2;
+          ushort nCurrIntraDesc, nCurrInterDesc;
+          LBSP::computeGrayscaleDescriptor(oInputImg, anColor[0], nImgCoord_X, nImgCoord_Y, m_anLBSPThreshold_8bitLUT[anColor[0]], nCurrIntraDesc);
+          for (; nGoodSamplesCount < m_nRequiredBGSamples && nSampleIdx < m_nBGSamples; ++nSampleIdx) {
+            const uchar nBGColor = m_voBGColorSamples[nSampleIdx].data[nPxIter];
+            const size_t nColorDist = L1dist(anColor[0], nBGColor);
+            if (nColorDist > nCurrColorDistThreshold)
+              continue;
+            const ushort nBGIntraDesc = *((ushort*)(m_voBGDescSamples[nSampleIdx].data + nDescIter));
+            LBSP::computeGrayscaleDescriptor(oInputImg, nBGColor, nImgCoord_X, nImgCoord_Y, m_anLBSPThreshold_8bitLUT[nBGColor], nCurrInterDesc);
+            const size_t nDescDist = (hdist(nCurrIntraDesc, nBGIntraDesc) + hdist(nCurrInterDesc, nBGIntraDesc)) / 2;
+            if (nDescDist > nCurrDescDistThreshold)
+              continue;
+            const size_t nSumDist = std::min((nDescDist / 4)*(s_nColorMaxDataRange_1ch / s_nDescMaxDataRange_1ch) + nColorDist, s_nColorMaxDataRange_1ch);
+            if (nSumDist > nCurrColorDistThreshold)
+              continue;
+            nGoodSamplesCount++;
+          }
+        }
+        else { //m_nImgChannels==3
+          const size_t nPxIterRGB = nPxIter * 3;
+          const size_t nDescIterRGB = nPxIterRGB * 2;
+          const size_t nCurrColorDistThreshold = (size_t)((fCurrDistThresholdFactor*m_nMinColorDistThreshold) - ((!bCurrRegionIsUnstable)*STAB_COLOR_DIST_OFFSET));
+          const size_t nCurrTotColorDistThreshold = nCurrColorDistThreshold * 3;
+          const size_t nCurrTotDescDistThreshold = nCurrDescDistThreshold * 3;
+          const size_t nCurrSCColorDistThreshold = nCurrTotColorDistThreshold / 2;
+          ushort anCurrIntraDesc[3], anCurrInterDesc[3];
+          for (size_t c = 0; c < 3; ++c)
+            LBSP::computeSingleRGBDescriptor(oInputImg, anColor[c], nImgCoord_X, nImgCoord_Y, c, m_anLBSPThreshold_8bitLUT[anColor[c]], anCurrIntraDesc[c]);
+          for (; nGoodSamplesCount < m_nRequiredBGSamples && nSampleIdx < m_nBGSamples; ++nSampleIdx) {
+            const ushort* const anBGIntraDesc = (ushort*)(m_voBGDescSamples[nSampleIdx].data + nDescIterRGB);
+            const uchar* const anBGColor = m_voBGColorSamples[nSampleIdx].data + nPxIterRGB;
+            size_t nTotDescDist = 0;
+            size_t nTotSumDist = 0;
+            bool bMatch = true;
+            for (size_t c = 0; c < 3; ++c) {
+              const size_t nColorDist = L1dist(anColor[c], anBGColor[c]);
+              if (nColorDist > nCurrSCColorDistThreshold) {
+                bMatch = false;
+                break;
+              }
+              LBSP::computeSingleRGBDescriptor(oInputImg, anBGColor[c], nImgCoord_X, nImgCoord_Y, c, m_anLBSPThreshold_8bitLUT[anBGColor[c]], anCurrInterDesc[c]);
+              const size_t nDescDist = (hdist(anCurrIntraDesc[c], anBGIntraDesc[c]) + hdist(anCurrInterDesc[c], anBGIntraDesc[c])) / 2;
+              const size_t nSumDist = std::min((nDescDist / 2)*(s_nColorMaxDataRange_1ch / s_nDescMaxDataRange_1ch) + nColorDist, s_nColorMaxDataRange_1ch);
+              if (nSumDist > nCurrSCColorDistThreshold) {
+                bMatch = false;
+                break;
+              }
+              nTotDescDist += nDescDist;
+              nTotSumDist += nSumDist;
+            }
+            if (bMatch && nTotDescDist <= nCurrTotDescDistThreshold && nTotSumDist <= nCurrTotColorDistThreshold)
+              nGoodSamplesCount++;
+          }
+        }
+        return nGoodSamplesCount < m_nRequiredBGSamples;
+      }
+
+      void BackgroundSubtractorSuBSENSE::apply(cv::InputArray _image, cv::OutputArray _fgmask, double learningRateOverride) {
+        // == process
+        CV_Assert(m_bInitialized);
+        cv::Mat oInputImg = _image.getMat();
+        CV_Assert(oInputImg.type() == m_nImgType && oInputImg.size() == m_oImgSize);
+        CV_Assert(oInputImg.isContinuous());
+        _fgmask.create(m_oImgSize, CV_8UC1);
+        cv::Mat oCurrFGMask = _fgmask.getMat();
+        memset(oCurrFGMask.data, 0, oCurrFGMask.cols*oCurrFGMask.rows);
+        const float fRollAvgFactor_LT = 1.0f / std::min(++m_nFrameIndex, m_nSamplesForMovingAvgs);
+        const float fRollAvgFactor_ST = 1.0f / std::min(m_nFrameIndex, m_nSamplesForMovingAvgs / 4);
+        m_vvBandDeferredUpdates.resize(m_voBands.size());
+        m_vvBandIntraDescRows.resize(m_voBands.size());
+        std::vector<size_t> vnBandNonZeroDescCounts(m_voBands.size(), 0);
+        forEachBand([&](size_t nBandIdx) {
+          vnBandNonZeroDescCounts[nBandIdx] = applyBand(nBandIdx, oInputImg, oCurrFGMask, fRollAvgFactor_LT, fRollAvgFactor_ST, learningRateOverride);
+        });
+        size_t nNonZeroDescCount = 0;
+        for (size_t nBandIdx = 0; nBandIdx < m_voBands.size(); ++nBandIdx) {
+          nNonZeroDescCount += vnBandNonZeroDescCounts[nBandIdx];
+          for (const DeferredUpdate& oUpdate : m_vvBandDeferredUpdates[nBandIdx])
+            applyDeferredUpdate(oUpdate);
+          m_vvBandDeferredUpdates[nBandIdx].clear();
+        }
 #if DISPLAY_SUBSENSE_DEBUG_INFO
         std::cout << std::endl;
         cv::Point dbgpt(nDebugCoordX, nDebugCoordY);
@@ -30,7 +30,8 @@ namespace bgslibrary
         For more details on the different parameters or on the algorithm itself, see P.-L. St-Charles et al.,
         "Flexible Background Subtraction With Self-Balanced Local Sensitivity", in CVPRW 2014.
 
-        This algorithm is currently NOT thread-safe.
+        A single instance is NOT thread-safe, but apply can analyze the frame in several row bands concurrently
+        (see BackgroundSubtractorLBSP::setParallelBands).
       */
       class BackgroundSubtractorSuBSENSE : public BackgroundSubtractorLBSP {
       public:
@@ -53,8 +54,24 @@ namespace bgslibrary
         void getBackgroundImage(cv::OutputArray backgroundImage) const;
         //! returns a copy of the latest reconstructed background descriptors image
         void getBackgroundDescriptorsImage(cv::OutputArray backgroundDescImage) const;
+        //! re-runs the per-pixel test of the last apply call at the given px, with anColor as its color (the rest of the LBSP
+        //! patch is read from oInputImg, the frame given to apply); the model is not updated, and the result is the raw label
+        bool isForegroundPixel(const cv::Mat& oInputImg, int nImgCoord_X, int nImgCoord_Y, const uchar* anColor) const;
 
       protected:
+        //! model update of a neighbour owned by another row band, checked & applied after all bands are done
+        struct DeferredUpdate {
+          size_t nPxIter;
+          size_t nRand, nRandModulo;
+          size_t nSampleIdx;
+          ushort anDesc[3];
+          uchar anColor[3];
+        };
+        //! analyzes the pixels of a row band; returns its count of non-flat descriptors
+        size_t applyBand(size_t nBandIdx, const cv::Mat& oInputImg, cv::Mat& oCurrFGMask, float fRollAvgFactor_LT, float fRollAvgFactor_ST, double learningRateOverride);
+        //! applies a neighbour update deferred by applyBand
+        void applyDeferredUpdate(const DeferredUpdate& oUpdate);
+
         //! absolute minimal color distance threshold ('R' or 'radius' in the original ViBe paper, used as the default/initial 'R(x)' value here)
         const size_t m_nMinColorDistThreshold;
         //! absolute descriptor distance threshold offset
@@ -115,6 +132,11 @@ namespace bgslibrary
         cv::Mat m_oLastFGMask_dilated_inverted;
         cv::Mat m_oCurrRawFGBlinkMask;
         cv::Mat m_oLastRawFGBlinkMask;
+
+        //! neighbour updates deferred by each row band during the current frame
+        std::vector<std::vector<DeferredUpdate>> m_vvBandDeferredUpdates;
+        //! intra-frame LBSP descriptors of the row currently analyzed by each row band
+        std::vector<std::vector<ushort>> m_vvBandIntraDescRows;
       };
     }
   }
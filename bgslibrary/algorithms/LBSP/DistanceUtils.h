@@ -1,5 +1,11 @@
 #pragma once
 
+#include <stdint.h>
+#include <type_traits>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 // opencv legacy includes
 #include <opencv2/core/types_c.h>
 
@@ -260,56 +266,53 @@ namespace bgslibrary
 
       ///////////////////////////////////////////////////////////////////////////////////////////////////
 
-      //! popcount LUT for 8-bit vectors
-      static const uchar popcount_LUT8[256] = {
-        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
-        1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
-        1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
-        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-        1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
-        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-        3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
-        1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5,
-        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-        3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
-        2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-        3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
-        3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7,
-        4, 5, 5, 6, 5, 6, 6, 7, 5, 6, 6, 7, 6, 7, 7, 8,
-      };
-
-      //! computes the population count of an N-byte vector using an 8-bit popcount LUT
+      //! computes the population count of a 64-bit value (POPCNT when the target has it, e.g. with -mpopcnt or -march=native, bit-parallel count otherwise)
+      static inline size_t popcount64(uint64_t x) {
+#if defined(__POPCNT__) && (defined(__GNUC__) || defined(__clang__))
+        return (size_t)__builtin_popcountll(x);
+#elif defined(_MSC_VER) && defined(_M_X64) && defined(__AVX__)
+        return (size_t)__popcnt64(x);
+#else
+        x = x - ((x >> 1) & 0x5555555555555555ULL);
+        x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+        x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return (size_t)((x * 0x0101010101010101ULL) >> 56);
+#endif
+      }
+
+      //! computes the population count of an N-byte vector
       template<typename T> static inline size_t popcount(T x) {
-        size_t nBytes = sizeof(T);
-        size_t nResult = 0;
-        for(size_t l=0; l<nBytes; ++l)
-          nResult += popcount_LUT8[(uchar)(x>>l*8)];
-        return nResult;
+        static_assert(std::is_integral<T>::value && sizeof(T) <= sizeof(uint64_t), "popcount only supports integers of up to 64 bits");
+        return popcount64((uint64_t)(typename std::make_unsigned<T>::type)x);
       }
 
-      //! computes the hamming distance between two N-byte vectors using an 8-bit popcount LUT
+      //! computes the hamming distance between two N-byte vectors
       template<typename T> static inline size_t hdist(T a, T b) {
         return popcount(a^b);
       }
 
-      //! computes the gradient magnitude distance between two N-byte vectors using an 8-bit popcount LUT
+      //! computes the gradient magnitude distance between two N-byte vectors
       template<typename T> static inline size_t gdist(T a, T b) {
         return L1dist(popcount(a),popcount(b));
       }
 
-      //! computes the population count of a (nChannels*N)-byte vector using an 8-bit popcount LUT
+      //! computes the population count of a (nChannels*N)-byte vector
       template<size_t nChannels, typename T> static inline size_t popcount(const T* x) {
-        size_t nBytes = sizeof(T);
+        typedef typename std::make_unsigned<T>::type U;
+        if (sizeof(T)*nChannels <= sizeof(uint64_t)) {
+          // small vectors (e.g. the three 16-bit descriptors of a RGB pixel) are counted at once
+          uint64_t nPacked = 0;
+          for(size_t c=0; c<nChannels; ++c)
+            nPacked |= (uint64_t)(U)x[c] << (c*sizeof(T)*8);
+          return popcount64(nPacked);
+        }
         size_t nResult = 0;
         for(size_t c=0; c<nChannels; ++c)
-          for(size_t l=0; l<nBytes; ++l)
-            nResult += popcount_LUT8[(uchar)(*(x+c)>>l*8)];
+          nResult += popcount((U)x[c]);
         return nResult;
       }
 
-      //! computes the hamming distance between two (nChannels*N)-byte vectors using an 8-bit popcount LUT
+      //! computes the hamming distance between two (nChannels*N)-byte vectors
       template<size_t nChannels, typename T> static inline size_t hdist(const T* a, const T* b) {
         T xor_array[nChannels];
         for(size_t c=0; c<nChannels; ++c)
@@ -317,7 +320,7 @@ namespace bgslibrary
         return popcount<nChannels>(xor_array);
       }
 
-      //! computes the gradient magnitude distance between two (nChannels*N)-byte vectors using an 8-bit popcount LUT
+      //! computes the gradient magnitude distance between two (nChannels*N)-byte vectors
       template<size_t nChannels, typename T> static inline size_t gdist(const T* a, const T* b) {
         return L1dist(popcount<nChannels>(a),popcount<nChannels>(b));
       }
@@ -0,0 +1,165 @@
+#include <stddef.h>
+#include <stdlib.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+#endif
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+#include "LBSPRows.h"
+
+namespace bgslibrary
+{
+  namespace algorithms
+  {
+    namespace lbsp
+    {
+      // neighbour (x,y) offsets of the 16 bit double-cross pattern, bit 0 first (see LBSP_16bits_dbcross_1ch.i)
+      static const int s_anPatternOffsets[16][2] = {
+        {-2, 0}, { 2, 0}, { 0,-2}, { 0, 2}, {-2, 2}, { 2,-2}, { 2, 2}, {-2,-2},
+        { 0, 1}, {-1, 0}, { 0,-1}, { 1, 0}, {-1,-1}, { 1, 1}, { 1,-1}, {-1, 1},
+      };
+
+      // Row kernels: anData points to the first value of the row, the values [nBegin, nEnd) are described (a value
+      // of a CV_8UC3 row is one channel of a pixel, so the horizontal offsets are multiplied by the channel count).
+      // anOffsets are the byte offsets of the 16 neighbours and anThresholds8 the thresholds clamped to 8 bits.
+      // They return the index of the first value left to the scalar kernel.
+
+      static void computeDescriptorRow_scalar(const uchar* anData, const ptrdiff_t* anOffsets, const uchar* anThresholds8, size_t nBegin, size_t nEnd, ushort* anDesc) {
+        for (size_t i = nBegin; i < nEnd; ++i) {
+          const uchar* const p = anData + i;
+          const int nRef = p[0];
+          const int nThreshold = anThresholds8[nRef];
+          ushort nDesc = 0;
+          for (int k = 0; k < 16; ++k)
+            nDesc |= (ushort)((abs((int)p[anOffsets[k]] - nRef) > nThreshold) << k);
+          anDesc[i - nBegin] = nDesc;
+        }
+      }
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LBSP_ROWS_SIMD_SSE2
+      static size_t computeDescriptorRow_sse2(const uchar* anData, const ptrdiff_t* anOffsets, const uchar* anThresholds8, size_t nBegin, size_t nEnd, ushort* anDesc) {
+        const __m128i zero = _mm_setzero_si128();
+        size_t i = nBegin;
+        for (; i + 16 <= nEnd; i += 16) {
+          const uchar* const p = anData + i;
+          const __m128i ref = _mm_loadu_si128((const __m128i*)p);
+          uchar anThresholds[16];
+          for (int j = 0; j < 16; ++j)
+            anThresholds[j] = anThresholds8[p[j]];
+          const __m128i t = _mm_loadu_si128((const __m128i*)anThresholds);
+          __m128i desc_lo = zero, desc_hi = zero;
+          for (int k = 0; k < 16; ++k) {
+            const __m128i n = _mm_loadu_si128((const __m128i*)(p + anOffsets[k]));
+            const __m128i absdiff = _mm_or_si128(_mm_subs_epu8(n, ref), _mm_subs_epu8(ref, n));
+            // 0xff where |n-ref| <= t, widened to 16 bits and inverted into bit k
+            const __m128i within = _mm_cmpeq_epi8(_mm_subs_epu8(absdiff, t), zero);
+            const __m128i bit = _mm_set1_epi16((short)(1 << k));
+            desc_lo = _mm_or_si128(desc_lo, _mm_andnot_si128(_mm_unpacklo_epi8(within, within), bit));
+            desc_hi = _mm_or_si128(desc_hi, _mm_andnot_si128(_mm_unpackhi_epi8(within, within), bit));
+          }
+          _mm_storeu_si128((__m128i*)(anDesc + i - nBegin), desc_lo);
+          _mm_storeu_si128((__m128i*)(anDesc + i - nBegin + 8), desc_hi);
+        }
+        return i;
+      }
+#endif
+
+#if defined(LBSP_ROWS_SIMD_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define LBSP_ROWS_SIMD_AVX2
+      __attribute__((target("avx2")))
+      static size_t computeDescriptorRow_avx2(const uchar* anData, const ptrdiff_t* anOffsets, const uchar* anThresholds8, size_t nBegin, size_t nEnd, ushort* anDesc) {
+        const __m256i zero = _mm256_setzero_si256();
+        size_t i = nBegin;
+        for (; i + 32 <= nEnd; i += 32) {
+          const uchar* const p = anData + i;
+          const __m256i ref = _mm256_loadu_si256((const __m256i*)p);
+          uchar anThresholds[32];
+          for (int j = 0; j < 32; ++j)
+            anThresholds[j] = anThresholds8[p[j]];
+          const __m256i t = _mm256_loadu_si256((const __m256i*)anThresholds);
+          __m256i desc_lo = zero, desc_hi = zero;
+          for (int k = 0; k < 16; ++k) {
+            const __m256i n = _mm256_loadu_si256((const __m256i*)(p + anOffsets[k]));
+            const __m256i absdiff = _mm256_or_si256(_mm256_subs_epu8(n, ref), _mm256_subs_epu8(ref, n));
+            const __m256i within = _mm256_cmpeq_epi8(_mm256_subs_epu8(absdiff, t), zero);
+            const __m256i bit = _mm256_set1_epi16((short)(1 << k));
+            // sign extension keeps the values in order, unlike the per-lane unpacks
+            desc_lo = _mm256_or_si256(desc_lo, _mm256_andnot_si256(_mm256_cvtepi8_epi16(_mm256_castsi256_si128(within)), bit));
+            desc_hi = _mm256_or_si256(desc_hi, _mm256_andnot_si256(_mm256_cvtepi8_epi16(_mm256_extracti128_si256(within, 1)), bit));
+          }
+          _mm256_storeu_si256((__m256i*)(anDesc + i - nBegin), desc_lo);
+          _mm256_storeu_si256((__m256i*)(anDesc + i - nBegin + 16), desc_hi);
+        }
+        return i;
+      }
+
+      static bool cpuSupportsAVX2() {
+        static const bool bSupported = __builtin_cpu_supports("avx2");
+        return bSupported;
+      }
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define LBSP_ROWS_SIMD_NEON
+      static size_t computeDescriptorRow_neon(const uchar* anData, const ptrdiff_t* anOffsets, const uchar* anThresholds8, size_t nBegin, size_t nEnd, ushort* anDesc) {
+        size_t i = nBegin;
+        for (; i + 16 <= nEnd; i += 16) {
+          const uchar* const p = anData + i;
+          const uint8x16_t ref = vld1q_u8(p);
+          uchar anThresholds[16];
+          for (int j = 0; j < 16; ++j)
+            anThresholds[j] = anThresholds8[p[j]];
+          const uint8x16_t t = vld1q_u8(anThresholds);
+          uint16x8_t desc_lo = vdupq_n_u16(0), desc_hi = vdupq_n_u16(0);
+          for (int k = 0; k < 16; ++k) {
+            const uint8x16_t greater = vcgtq_u8(vabdq_u8(vld1q_u8(p + anOffsets[k]), ref), t);
+            const uint16x8_t bit = vdupq_n_u16((uint16_t)(1 << k));
+            desc_lo = vorrq_u16(desc_lo, vandq_u16(vreinterpretq_u16_s16(vmovl_s8(vreinterpret_s8_u8(vget_low_u8(greater)))), bit));
+            desc_hi = vorrq_u16(desc_hi, vandq_u16(vreinterpretq_u16_s16(vmovl_s8(vreinterpret_s8_u8(vget_high_u8(greater)))), bit));
+          }
+          vst1q_u16(anDesc + i - nBegin, desc_lo);
+          vst1q_u16(anDesc + i - nBegin + 8, desc_hi);
+        }
+        return i;
+      }
+#endif
+
+      void computeDescriptorRow(const cv::Mat& oInputImg, int nRow, int nColBegin, int nColEnd, const size_t* anThresholdLUT, ushort* anDesc) {
+        CV_Assert(oInputImg.type() == CV_8UC1 || oInputImg.type() == CV_8UC3);
+        CV_DbgAssert(nRow >= 2 && nRow < oInputImg.rows - 2 && nColBegin >= 2 && nColEnd <= oInputImg.cols - 2);
+        if (nColEnd <= nColBegin)
+          return;
+        const size_t nChannels = (size_t)oInputImg.channels();
+        const ptrdiff_t nStep = (ptrdiff_t)oInputImg.step.p[0];
+        ptrdiff_t anOffsets[16];
+        for (int k = 0; k < 16; ++k)
+          anOffsets[k] = s_anPatternOffsets[k][1] * nStep + s_anPatternOffsets[k][0] * (ptrdiff_t)nChannels;
+        // a difference of 8 bit values is never above 255, so larger thresholds behave the same
+        uchar anThresholds8[256];
+        for (int v = 0; v < 256; ++v)
+          anThresholds8[v] = (uchar)(anThresholdLUT[v] < 255 ? anThresholdLUT[v] : 255);
+        const uchar* const anData = oInputImg.data + nStep * nRow;
+        const size_t nBegin = (size_t)nColBegin * nChannels;
+        const size_t nEnd = (size_t)nColEnd * nChannels;
+        size_t nDone = nBegin;
+#if defined(LBSP_ROWS_SIMD_AVX2)
+        if (cpuSupportsAVX2())
+          nDone = computeDescriptorRow_avx2(anData, anOffsets, anThresholds8, nBegin, nEnd, anDesc);
+        nDone = computeDescriptorRow_sse2(anData, anOffsets, anThresholds8, nDone, nEnd, anDesc + (nDone - nBegin));
+#elif defined(LBSP_ROWS_SIMD_SSE2)
+        nDone = computeDescriptorRow_sse2(anData, anOffsets, anThresholds8, nBegin, nEnd, anDesc);
+#elif defined(LBSP_ROWS_SIMD_NEON)
+        nDone = computeDescriptorRow_neon(anData, anOffsets, anThresholds8, nBegin, nEnd, anDesc);
+#endif
+        computeDescriptorRow_scalar(anData, anOffsets, anThresholds8, nDone, nEnd, anDesc + (nDone - nBegin));
+      }
+    }
+  }
+}
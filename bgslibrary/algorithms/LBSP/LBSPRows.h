@@ -0,0 +1,26 @@
+#pragma once
+
+#include <opencv2/core/core.hpp>
+
+namespace bgslibrary
+{
+  namespace algorithms
+  {
+    namespace lbsp
+    {
+      /*!
+        Computes the intra-frame LBSP descriptors of the pixels [nColBegin, nColEnd) of row nRow, using the same 16 bit
+        double-cross pattern and bit order as LBSP(_)::computeGrayscaleDescriptor (CV_8UC1) or LBSP(_)::computeRGBDescriptor
+        with one threshold per channel (CV_8UC3). Each value is compared with its neighbours using anThresholdLUT[value]
+        as threshold, and the descriptors are written channel-interleaved in anDesc (anDesc[0] is the first channel of
+        pixel nColBegin).
+
+        A whole row is processed with SIMD compares (SSE2, AVX2 when the CPU supports it, or NEON), 16 or 32 values at a
+        time; the result is the same as calling the single-point functions on every pixel.
+
+        The pixels must be at least LBSP::PATCH_SIZE/2 away from the image borders.
+      */
+      void computeDescriptorRow(const cv::Mat& oInputImg, int nRow, int nColBegin, int nColEnd, const size_t* anThresholdLUT, ushort* anDesc);
+    }
+  }
+}
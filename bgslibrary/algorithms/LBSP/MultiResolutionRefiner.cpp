@@ -0,0 +1,67 @@
+#include <algorithm>
+
+#include <limits.h>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "MultiResolutionRefiner.h"
+
+namespace bgslibrary
+{
+  namespace algorithms
+  {
+    namespace lbsp
+    {
+      MultiResolutionRefiner::MultiResolutionRefiner(int nDownSampleFactor, const PixelClassifier& oClassifier)
+        : m_nDownSampleFactor(nDownSampleFactor)
+        , m_oClassifier(oClassifier) {
+        CV_Assert(m_nDownSampleFactor >= 1);
+        CV_Assert(m_oClassifier);
+      }
+
+      cv::Size MultiResolutionRefiner::getDownSampledSize(const cv::Size& oImgSize) const {
+        return cv::Size(oImgSize.width / m_nDownSampleFactor, oImgSize.height / m_nDownSampleFactor);
+      }
+
+      const cv::Mat& MultiResolutionRefiner::downSample(const cv::Mat& oInputImg) {
+        CV_Assert(oInputImg.cols >= m_nDownSampleFactor && oInputImg.rows >= m_nDownSampleFactor);
+        const cv::Size oDownSampledSize = getDownSampledSize(oInputImg.size());
+        // only the px covered by the low res grid are averaged, so that each low res px is an exact f x f block
+        const cv::Rect oAlignedRect(0, 0, oDownSampledSize.width*m_nDownSampleFactor, oDownSampledSize.height*m_nDownSampleFactor);
+        cv::resize(oInputImg(oAlignedRect), m_oDownSampledImg, oDownSampledSize, 0, 0, cv::INTER_AREA);
+        return m_oDownSampledImg;
+      }
+
+      void MultiResolutionRefiner::upSample(const cv::Mat& oInputImg, const cv::Mat& oDownSampledFGMask, const cv::Mat& oDownSampledBGImg, cv::Mat& oFGMask, cv::Mat& oBGImg) {
+        const cv::Size oImgSize = oInputImg.size();
+        const cv::Size oDownSampledSize = getDownSampledSize(oImgSize);
+        CV_Assert(oDownSampledFGMask.type() == CV_8UC1 && oDownSampledBGImg.type() == oInputImg.type());
+        CV_Assert(oDownSampledFGMask.size() == oDownSampledSize && oDownSampledBGImg.size() == oDownSampledSize && m_oDownSampledImg.size() == oDownSampledSize);
+        // with an integer scale, bilinear interpolation keeps the low res px centered on their f x f blocks; the leftover
+        // columns & rows are replicated from the last ones, like they are attached to the last low res px
+        cv::resize(oDownSampledBGImg, m_oAlignedBGImg, cv::Size(oDownSampledSize.width*m_nDownSampleFactor, oDownSampledSize.height*m_nDownSampleFactor), 0, 0, cv::INTER_LINEAR);
+        cv::copyMakeBorder(m_oAlignedBGImg, oBGImg, 0, oImgSize.height - m_oAlignedBGImg.rows, 0, oImgSize.width - m_oAlignedBGImg.cols, cv::BORDER_REPLICATE);
+        // the low res px with a neighbour of the other label are the ones which may be split by a blob boundary
+        cv::dilate(oDownSampledFGMask, m_oDilatedFGMask, cv::Mat());
+        cv::erode(oDownSampledFGMask, m_oErodedFGMask, cv::Mat());
+        cv::compare(m_oDilatedFGMask, m_oErodedFGMask, m_oDownSampledBoundaryMask, cv::CMP_NE);
+        oFGMask.create(oImgSize, CV_8UC1);
+        const int nChannels = oInputImg.channels();
+        for (int y = 0; y < oImgSize.height; ++y) {
+          const int nDownSampledY = std::min(y / m_nDownSampleFactor, oDownSampledSize.height - 1);
+          const uchar* const anDownSampledFGRow = oDownSampledFGMask.ptr<uchar>(nDownSampledY);
+          const uchar* const anBoundaryRow = m_oDownSampledBoundaryMask.ptr<uchar>(nDownSampledY);
+          const uchar* const anInputRow = oInputImg.ptr<uchar>(y);
+          uchar* const anFGRow = oFGMask.ptr<uchar>(y);
+          for (int x = 0; x < oImgSize.width; ++x) {
+            const int nDownSampledX = std::min(x / m_nDownSampleFactor, oDownSampledSize.width - 1);
+            if (anBoundaryRow[nDownSampledX])
+              anFGRow[x] = m_oClassifier(m_oDownSampledImg, nDownSampledX, nDownSampledY, anInputRow + x*nChannels) ? UCHAR_MAX : 0;
+            else
+              anFGRow[x] = anDownSampledFGRow[nDownSampledX];
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <functional>
+
+#include <opencv2/core/core.hpp>
+
+namespace bgslibrary
+{
+  namespace algorithms
+  {
+    namespace lbsp
+    {
+      /*!
+          Helper for running an LBSP-based background subtractor on downsampled frames.
+
+          The frames are downsampled by an integer factor (area interpolation) before being given to the model: the low
+          resolution px (x,y) covers the full resolution px [x*f,x*f+f)x[y*f,y*f+f), and the last f-1 (or fewer) columns
+          and rows of frames whose size is not a multiple of f are attached to the last low resolution column and row. The
+          resulting segmentation mask is mapped back to the full resolution through the same px correspondence. Only the
+          px close to the blob boundaries (within one low resolution px of a foreground/background transition) are then
+          re-decided, by running the model's own per-pixel test with their full resolution color; all other px keep the
+          label of their low resolution px. With a factor of 2 (or 4), the model does roughly 4x (or 16x) less work per
+          frame, at the price of coarser blob interiors.
+
+          The refinement is approximate: a boundary px is compared to the samples of its low resolution px, its LBSP
+          descriptor is computed around that px in the downsampled frame (only the color comes from the full resolution
+          frame), and the test runs on the mask the model already post-processed (morphology, median blur) at low
+          resolution, so the refined px are not filtered again. The masks are thus close to, but not the same as, those
+          the model would produce on the full resolution frames.
+
+          This class is NOT thread-safe (the scratch images are reused from one frame to the next).
+      */
+      class MultiResolutionRefiner {
+      public:
+        //! per-pixel test of the model: (last frame given to the model, low res px coords, full res px color) -> foreground
+        typedef std::function<bool(const cv::Mat&, int, int, const uchar*)> PixelClassifier;
+        //! full constructor
+        MultiResolutionRefiner(int nDownSampleFactor, const PixelClassifier& oClassifier);
+        //! returns the downsampling factor
+        int getDownSampleFactor() const { return m_nDownSampleFactor; }
+        //! returns the size of the frames given to the model for full resolution frames of the given size
+        cv::Size getDownSampledSize(const cv::Size& oImgSize) const;
+        //! downsamples a full resolution frame; the returned image is valid until the next call
+        const cv::Mat& downSample(const cv::Mat& oInputImg);
+        //! upsamples the model segmentation & background image to the size of oInputImg and refines the blob boundaries
+        //! (oInputImg must be the frame given to the last downSample call)
+        void upSample(const cv::Mat& oInputImg, const cv::Mat& oDownSampledFGMask, const cv::Mat& oDownSampledBGImg, cv::Mat& oFGMask, cv::Mat& oBGImg);
+
+      private:
+        const int m_nDownSampleFactor;
+        const PixelClassifier m_oClassifier;
+        //! downsampled input frame
+        cv::Mat m_oDownSampledImg;
+        //! scratch images used to find the blob boundaries at low resolution
+        cv::Mat m_oDilatedFGMask, m_oErodedFGMask, m_oDownSampledBoundaryMask;
+        //! background image upsampled over the full resolution px covered by the low resolution grid
+        cv::Mat m_oAlignedBGImg;
+      };
+    }
+  }
+}
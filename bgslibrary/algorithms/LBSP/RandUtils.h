@@ -31,8 +31,9 @@ namespace bgslibrary
       };
 
       //! returns a random init/sampling position for the specified pixel position; also guards against out-of-bounds values via image/border size check.
-      static inline void getRandSamplePosition(int& x_sample, int& y_sample, const int x_orig, const int y_orig, const int border, const cv::Size& imgsize) {
-        int r = 1+rand()%s_nSamplesInitPatternTot;
+      template<typename RNG>
+      static inline void getRandSamplePosition(RNG& rng, int& x_sample, int& y_sample, const int x_orig, const int y_orig, const int border, const cv::Size& imgsize) {
+        int r = 1+rng()%s_nSamplesInitPatternTot;
         for(x_sample=0; x_sample<s_nSamplesInitPatternWidth; ++x_sample) {
           for(y_sample=0; y_sample<s_nSamplesInitPatternHeight; ++y_sample) {
             r -= s_anSamplesInitPattern[y_sample][x_sample];
@@ -62,8 +63,9 @@ namespace bgslibrary
       };
 
       //! returns a random neighbor position for the specified pixel position; also guards against out-of-bounds values via image/border size check.
-      static inline void getRandNeighborPosition_3x3(int& x_neighbor, int& y_neighbor, const int x_orig, const int y_orig, const int border, const cv::Size& imgsize) {
-        int r = rand()%s_anNeighborPatternSize_3x3;
+      template<typename RNG>
+      static inline void getRandNeighborPosition_3x3(RNG& rng, int& x_neighbor, int& y_neighbor, const int x_orig, const int y_orig, const int border, const cv::Size& imgsize) {
+        int r = rng()%s_anNeighborPatternSize_3x3;
         x_neighbor = x_orig+s_anNeighborPattern_3x3[r][0];
         y_neighbor = y_orig+s_anNeighborPattern_3x3[r][1];
         if(x_neighbor<border)
@@ -87,8 +89,9 @@ namespace bgslibrary
       };
 
       //! returns a random neighbor position for the specified pixel position; also guards against out-of-bounds values via image/border size check.
-      static inline void getRandNeighborPosition_5x5(int& x_neighbor, int& y_neighbor, const int x_orig, const int y_orig, const int border, const cv::Size& imgsize) {
-        int r = rand()%s_anNeighborPatternSize_5x5;
+      template<typename RNG>
+      static inline void getRandNeighborPosition_5x5(RNG& rng, int& x_neighbor, int& y_neighbor, const int x_orig, const int y_orig, const int border, const cv::Size& imgsize) {
+        int r = rng()%s_anNeighborPatternSize_5x5;
         x_neighbor = x_orig+s_anNeighborPattern_5x5[r][0];
         y_neighbor = y_orig+s_anNeighborPattern_5x5[r][1];
         if(x_neighbor<border)
@@ -20,6 +20,7 @@ namespace bgslibrary
       ~LBSimpleGaussian();
 
       void process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img_bgmodel);
+      int getStripeHalo() const { return 0; }
 
     private:
       void save_config(cv::FileStorage &fs);
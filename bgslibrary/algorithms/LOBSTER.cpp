@@ -10,7 +10,8 @@ LOBSTER::LOBSTER() :
   nDescDistThreshold(lbsp::BGSLOBSTER_DEFAULT_DESC_DIST_THRESHOLD),
   nColorDistThreshold(lbsp::BGSLOBSTER_DEFAULT_COLOR_DIST_THRESHOLD),
   nBGSamples(lbsp::BGSLOBSTER_DEFAULT_NB_BG_SAMPLES),
-  nRequiredBGSamples(lbsp::BGSLOBSTER_DEFAULT_REQUIRED_NB_BG_SAMPLES)
+  nRequiredBGSamples(lbsp::BGSLOBSTER_DEFAULT_REQUIRED_NB_BG_SAMPLES),
+  nParallelBands(1)
 {
   debug_construction(LOBSTER);
   initLoadSaveConfig(algorithmName);
@@ -31,6 +32,8 @@ void LOBSTER::process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &im
       fRelLBSPThreshold, nLBSPThresholdOffset, nDescDistThreshold,
       nColorDistThreshold, nBGSamples, nRequiredBGSamples);
 
+    pLOBSTER->setRandomSeed(randomSeed);
+    pLOBSTER->setParallelBands((size_t)std::max(nParallelBands, 0));
     pLOBSTER->initialize(img_input, cv::Mat(img_input.size(), CV_8UC1, cv::Scalar_<uchar>(255)));
     firstTime = false;
   }
@@ -56,6 +59,7 @@ void LOBSTER::save_config(cv::FileStorage &fs) {
   fs << "nColorDistThreshold" << nColorDistThreshold;
   fs << "nBGSamples" << nBGSamples;
   fs << "nRequiredBGSamples" << nRequiredBGSamples;
+  fs << "nParallelBands" << nParallelBands;
   fs << "showOutput" << showOutput;
 }
 
@@ -66,5 +70,6 @@ void LOBSTER::load_config(cv::FileStorage &fs) {
   fs["nColorDistThreshold"] >> nColorDistThreshold;
   fs["nBGSamples"] >> nBGSamples;
   fs["nRequiredBGSamples"] >> nRequiredBGSamples;
+  fs["nParallelBands"] >> nParallelBands;
   fs["showOutput"] >> showOutput;
 }
@@ -19,6 +19,7 @@ namespace bgslibrary
       int nColorDistThreshold;
       int nBGSamples;
       int nRequiredBGSamples;
+      int nParallelBands;
 
     public:
       LOBSTER();
@@ -20,6 +20,15 @@ using namespace bgslibrary::algorithms;
 #define TRUE 1
 #endif
 
+//allocates a 2-D array as one block: the row pointers followed by the rows (released with free())
+template<typename T>
+static T** AllocateRows(int iHeight, int iWidth) {
+  T** aRows = (T**)malloc(sizeof(T*)*iHeight + sizeof(T)*iHeight*iWidth);
+  T* aData = (T*)(aRows + iHeight);
+  for (int i = 0; i < iHeight; i++) aRows[i] = aData + i*iWidth;
+  return aRows;
+}
+
 MultiCue::MultiCue() :
   IBGS(quote(MultiCue))
 {
@@ -41,6 +50,9 @@ MultiCue::MultiCue() :
 
   g_iRWidth = 160, g_iRHeight = 120;								//Frames are precessed after reduced in this size .
 
+  g_iParallelBands = 1;											//the row bands processed concurrently (0: one per hardware thread)
+  g_bPipelineEnable = FALSE;										//If TRUE, the model update overlaps with the pre-processing of the next frame
+
   //------------------------------------
   //	For codebook maintenance
   //------------------------------------
@@ -63,6 +75,16 @@ MultiCue::MultiCue() :
 
 MultiCue::~MultiCue() {
   debug_destruction(MultiCue);
+  //a failed model update must not leave the destructor
+  try {
+    WaitForModelUpdate();
+  }
+  catch (const std::exception& e) {
+    std::cerr << "MultiCue: model update failed: " << e.what() << std::endl;
+  }
+  catch (...) {
+    std::cerr << "MultiCue: model update failed" << std::endl;
+  }
   Destroy();
 }
 
@@ -90,13 +112,13 @@ void MultiCue::process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &i
     g_bForegroundMapEnable = FALSE;
 
     ForegroundExtraction(frame);
-    UpdateModel_Par();
+    StartModelUpdate();
 
     // Get BGS Results
     GetForegroundMap(result_image, NULL);
   }
 
-  img_background = cv::Mat::zeros(img_input.size(), img_input.type());
+  createZeros(img_background, img_input.size(), img_input.type());
   img_foreground = cv::cvarrToMat(result_image, TRUE);
   cvReleaseImage(&result_image);
   cvReleaseImage(&frame);
@@ -126,6 +148,8 @@ void MultiCue::save_config(cv::FileStorage &fs) {
   fs << "g_iTrainingPeriod" << g_iTrainingPeriod;
   fs << "g_iRWidth" << g_iRWidth;
   fs << "g_iRHeight" << g_iRHeight;
+  fs << "g_iParallelBands" << g_iParallelBands;
+  fs << "g_bPipelineEnable" << g_bPipelineEnable;
   fs << "showOutput" << showOutput;
 }
 
@@ -143,6 +167,8 @@ void MultiCue::load_config(cv::FileStorage &fs) {
   fs["g_iTrainingPeriod"] >> g_iTrainingPeriod;
   fs["g_iRWidth"] >> g_iRWidth;
   fs["g_iRHeight"] >> g_iRHeight;
+  fs["g_iParallelBands"] >> g_iParallelBands;
+  fs["g_bPipelineEnable"] >> g_bPipelineEnable;
   fs["showOutput"] >> showOutput;
 }
 
@@ -151,8 +177,6 @@ void MultiCue::load_config(cv::FileStorage &fs) {
 //-----------------------------------------------------------------------------------------------------------------------------------------//
 void MultiCue::Initialize(IplImage* frame)
 {
-  int i, j;
-
   g_iHeight = frame->height;
   g_iWidth = frame->width;
 
@@ -163,29 +187,15 @@ void MultiCue::Initialize(IplImage* frame)
   //--------------------------------------------------------
   g_ResizedFrame = cvCreateImage(cvSize(g_iRWidth, g_iRHeight), IPL_DEPTH_8U, 3);
 
-  g_aGaussFilteredFrame = (uchar***)malloc(sizeof(uchar**)*g_iRHeight);
-  for (i = 0; i < g_iRHeight; i++) {
-    g_aGaussFilteredFrame[i] = (uchar**)malloc(sizeof(uchar*)*g_iRWidth);
-    for (j = 0; j < g_iRWidth; j++) g_aGaussFilteredFrame[i][j] = (uchar*)malloc(sizeof(uchar) * 3);
-  }
-
-  g_aXYZFrame = (uchar***)malloc(sizeof(uchar**)*g_iRHeight);
-  for (i = 0; i < g_iRHeight; i++) {
-    g_aXYZFrame[i] = (uchar**)malloc(sizeof(uchar*)*g_iRWidth);
-    for (j = 0; j < g_iRWidth; j++) g_aXYZFrame[i][j] = (uchar*)malloc(sizeof(uchar) * 3);
-  }
-
-  g_aLandmarkArray = (uchar**)malloc(sizeof(uchar*)*g_iRHeight);
-  for (i = 0; i < g_iRHeight; i++) g_aLandmarkArray[i] = (uchar*)malloc(sizeof(uchar)*g_iRWidth);
-
-  g_aResizedForeMap = (uchar**)malloc(sizeof(uchar*)*g_iRHeight);
-  for (i = 0; i < g_iRHeight; i++) g_aResizedForeMap[i] = (uchar*)malloc(sizeof(uchar)*g_iRWidth);
+  g_aGaussFilteredFrame.allocate(g_iRHeight * g_iRWidth * 3);
+  g_aXYZFrame.allocate(g_iRHeight * g_iRWidth * 3);
+  g_aNextXYZFrame.allocate(g_iRHeight * g_iRWidth * 3);
 
-  g_aForegroundMap = (uchar**)malloc(sizeof(uchar*)*g_iHeight);
-  for (i = 0; i < g_iHeight; i++) g_aForegroundMap[i] = (uchar*)malloc(sizeof(uchar)*g_iWidth);
-
-  g_aUpdateMap = (BOOL**)malloc(sizeof(BOOL*)*g_iRHeight);
-  for (i = 0; i < g_iRHeight; i++) g_aUpdateMap[i] = (BOOL*)malloc(sizeof(BOOL)*g_iRWidth);
+  g_aLandmarkArray = AllocateRows<uchar>(g_iRHeight, g_iRWidth);
+  g_aResizedForeMap = AllocateRows<uchar>(g_iRHeight, g_iRWidth);
+  g_aForegroundMap = AllocateRows<uchar>(g_iHeight, g_iWidth);
+  g_aUpdateMap = AllocateRows<BOOL>(g_iRHeight, g_iRWidth);
+  g_aGhostMap = AllocateRows<BOOL>(g_iRHeight, g_iRWidth);
 
   //Bound Box Related..
   int iElementNum = 300;
@@ -211,6 +221,20 @@ void MultiCue::Initialize(IplImage* frame)
   //--------------------------------------------------------
   C_AllocateColorModelRelatedMemory();
 
+  //--------------------------------------------------------
+  // parallel processing related
+  //--------------------------------------------------------
+  int iBandNum = g_iParallelBands > 0 ? g_iParallelBands : (int)ThreadPool::defaultNumThreads();
+  if (iBandNum > 1) {
+    if (!g_pBandThreadPool || (int)g_pBandThreadPool->size() != iBandNum - 1) g_pBandThreadPool.reset(new ThreadPool(iBandNum - 1));
+  }
+  else g_pBandThreadPool.reset();
+
+  if (g_bPipelineEnable == TRUE) {
+    if (!g_pPipelineThread) g_pPipelineThread.reset(new ThreadPool(1));
+  }
+  else g_pPipelineThread.reset();
+
   g_bModelMemAllocated = TRUE;
   g_bNonModelMemAllocated = TRUE;
 
@@ -223,6 +247,9 @@ void MultiCue::Destroy()
 {
   if (g_bModelMemAllocated == FALSE && g_bNonModelMemAllocated == FALSE) return;
 
+  //the pending model update still uses the models
+  WaitForModelUpdate();
+
   //short nNeighborNum = g_nNeighborNum;
 
   if (g_bModelMemAllocated == TRUE) {
@@ -236,29 +263,15 @@ void MultiCue::Destroy()
 
     cvReleaseImage(&g_ResizedFrame);
 
-    for (int i = 0; i < g_iRHeight; i++) {
-      for (int j = 0; j < g_iRWidth; j++) free(g_aGaussFilteredFrame[i][j]);
-      free(g_aGaussFilteredFrame[i]);
-    }
-    free(g_aGaussFilteredFrame);
+    g_aGaussFilteredFrame.release();
+    g_aXYZFrame.release();
+    g_aNextXYZFrame.release();
 
-    for (int i = 0; i < g_iRHeight; i++) {
-      for (int j = 0; j < g_iRWidth; j++) free(g_aXYZFrame[i][j]);
-      free(g_aXYZFrame[i]);
-    }
-    free(g_aXYZFrame);
-
-    for (int i = 0; i < g_iRHeight; i++) free(g_aLandmarkArray[i]);
     free(g_aLandmarkArray);
-
-    for (int i = 0; i < g_iRHeight; i++) free(g_aResizedForeMap[i]);
     free(g_aResizedForeMap);
-
-    for (int i = 0; i < g_iHeight; i++) free(g_aForegroundMap[i]);
     free(g_aForegroundMap);
-
-    for (int i = 0; i < g_iRHeight; i++) free(g_aUpdateMap[i]);
     free(g_aUpdateMap);
+    free(g_aGhostMap);
 
     free(g_BoundBoxInfo->m_aLeft); free(g_BoundBoxInfo->m_aRight); free(g_BoundBoxInfo->m_aBottom); free(g_BoundBoxInfo->m_aUpper);
     free(g_BoundBoxInfo->m_aRLeft); free(g_BoundBoxInfo->m_aRRight); free(g_BoundBoxInfo->m_aRBottom); free(g_BoundBoxInfo->m_aRUpper);
@@ -278,10 +291,10 @@ void MultiCue::PreProcessing(IplImage* frame) {
   ReduceImageSize(frame, g_ResizedFrame);
 
   //Gaussian filtering
-  GaussianFiltering(g_ResizedFrame, g_aGaussFilteredFrame);
+  GaussianFiltering(g_ResizedFrame, g_aGaussFilteredFrame.data());
 
-  //color space conversion
-  BGR2HSVxyz_Par(g_aGaussFilteredFrame, g_aXYZFrame);
+  //color space conversion (g_aXYZFrame may still be read by the model update of the previous frame)
+  BGR2HSVxyz_Par(g_aGaussFilteredFrame.data(), g_aNextXYZFrame.data());
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------------------//
@@ -294,33 +307,42 @@ void MultiCue::BackgroundModeling_Par(IplImage* frame) {
 
   //Step1: pre-processing
   PreProcessing(frame);
+  std::swap(g_aXYZFrame, g_aNextXYZFrame);
 
   int iH_Start = g_nRadius, iH_end = g_iRHeight - g_nRadius;
   int iW_Start = g_nRadius, iW_end = g_iRWidth - g_nRadius;
 
   float fLearningRate = g_fLearningRate * 4;
 
-  //Step2: background modeling
-  for (int i = iH_Start; i < iH_end; i++) {
-    for (int j = iW_Start; j < iW_end; j++) {
-      point center;
-      center.m_nX = j;
-      center.m_nY = i;
+  //Step2: background modeling (the codebooks of a pixel and their overflow arena only belong to its row)
+  ForEachBand(iH_Start, iH_end, [&](int iRowBegin, int iRowEnd) {
+    for (int i = iRowBegin; i < iRowEnd; i++) {
+      for (int j = iW_Start; j < iW_end; j++) {
+        point center;
+        center.m_nX = j;
+        center.m_nY = i;
 
-      T_ModelConstruction(g_nTextureTrainVolRange, fLearningRate, g_aXYZFrame, center, g_aNeighborDirection[i][j], g_TextureModel[i][j]);
-      C_CodebookConstruction(g_aXYZFrame[i][j], j, i, g_nColorTrainVolRange, fLearningRate, g_ColorModel[i][j]);
+        T_ModelConstruction(g_nTextureTrainVolRange, fLearningRate, g_aXYZFrame.data(), center, &g_aNeighborDirection[(i * g_iRWidth + j) * g_nNeighborNum], g_TextureModel);
+        C_CodebookConstruction(&g_aXYZFrame[(i * g_iRWidth + j) * 3], j, i, g_nColorTrainVolRange, fLearningRate, g_ColorModel);
+      }
     }
-  }
+  });
 
   //Step3: Clear non-essential codewords
   if (g_iFrameCount == g_iTrainingPeriod) {
-    for (int i = 0; i < g_iRHeight; i++) {
-      for (int j = 0; j < g_iRWidth; j++) {
-        T_ClearNonEssentialEntries(g_iTrainingPeriod, g_TextureModel[i][j]);
+    ForEachBand(0, g_iRHeight, [&](int iRowBegin, int iRowEnd) {
+      for (int i = iRowBegin; i < iRowEnd; i++) {
+        for (int j = 0; j < g_iRWidth; j++) {
+          point pos;
+          pos.m_nX = j;
+          pos.m_nY = i;
 
-        C_ClearNonEssentialEntries(g_iTrainingPeriod, g_ColorModel[i][j]);
+          T_ClearNonEssentialEntries(g_iTrainingPeriod, pos, g_TextureModel);
+
+          C_ClearNonEssentialEntries(g_iTrainingPeriod, pos, g_ColorModel);
+        }
       }
-    }
+    });
     g_iFrameCount++;
   }
 }
@@ -330,14 +352,16 @@ void MultiCue::BackgroundModeling_Par(IplImage* frame) {
 //-----------------------------------------------------------------------------------------------------------------------------------------//
 void MultiCue::ForegroundExtraction(IplImage* frame) {
 
-  //Step1:pre-processing
+  //Step1:pre-processing (overlapping with the model update of the previous frame)
   PreProcessing(frame);
+  WaitForModelUpdate();
+  std::swap(g_aXYZFrame, g_aNextXYZFrame);
 
   //Step3: texture-model based process
-  T_GetConfidenceMap_Par(g_aXYZFrame, g_aTextureConfMap, g_aNeighborDirection, g_TextureModel);
+  T_GetConfidenceMap_Par(g_aXYZFrame.data(), g_aTextureConfMap, g_aNeighborDirection.data(), g_TextureModel);
 
   //Step2: color-model based verification
-  CreateLandmarkArray_Par(g_fConfidenceThre, g_nColorTrainVolRange, g_aTextureConfMap, g_nNeighborNum, g_aXYZFrame, g_aNeighborDirection,
+  CreateLandmarkArray_Par(g_fConfidenceThre, g_nColorTrainVolRange, g_aTextureConfMap, g_nNeighborNum, g_aXYZFrame.data(), g_aNeighborDirection.data(),
     g_TextureModel, g_ColorModel, g_aLandmarkArray);
 
   //Step3: verification procedures
@@ -355,8 +379,7 @@ void MultiCue::PostProcessing(IplImage* frame) {
   g_bForegroundMapEnable = TRUE;
 
   //Step2: labeling
-  int** aLabelTable = (int**)malloc(sizeof(int*)*g_iRHeight);
-  for (int i = 0; i < g_iRHeight; i++)  aLabelTable[i] = (int*)malloc(sizeof(int)*g_iRWidth);
+  int** aLabelTable = AllocateRows<int>(g_iRHeight, g_iRWidth);
 
   int iLabelCount;
   Labeling(g_aResizedForeMap, &iLabelCount, aLabelTable);
@@ -370,7 +393,6 @@ void MultiCue::PostProcessing(IplImage* frame) {
   //Step5: Foreground Region
   RemovingInvalidForeRegions(g_aResizedForeMap, g_BoundBoxInfo);
 
-  for (int i = 0; i < g_iRHeight; i++) free(aLabelTable[i]);
   free(aLabelTable);
 }
 
@@ -403,135 +425,187 @@ void MultiCue::UpdateModel_Par() {
 
   float fLearningRate = (float)g_fLearningRate;
 
-  for (int i = iH_Start; i < iH_End; i++) {
-    for (int j = iW_Start; j < iW_End; j++) {
+  //each pixel only touches its own codebooks, so the bands are independent
+  ForEachBand(0, g_iRHeight, [&](int iRowBegin, int iRowEnd) {
 
-      point center;
+    //Adding information of ghost region pixels (found by EvaluateGhostRegion) to background model
+    for (int i = iRowBegin; i < iRowEnd; i++) {
+      for (int j = 0; j < g_iRWidth; j++) {
+        if (g_aGhostMap[i][j] == TRUE) {
+          point center;
+          center.m_nX = j; center.m_nY = i;
 
-      center.m_nX = j;
-      center.m_nY = i;
+          int iPixel = i * g_iRWidth + j;
+          T_ModelConstruction(g_nTextureTrainVolRange, fLearningRate, g_aXYZFrame.data(), center, &g_aNeighborDirection[iPixel * g_nNeighborNum], g_TextureModel);
+          C_CodebookConstruction(&g_aXYZFrame[iPixel * 3], j, i, g_nColorTrainVolRange, fLearningRate, g_ColorModel);
 
-      if (g_aUpdateMap[i][j] == TRUE) {
-        //model update
-        T_ModelConstruction(g_nTextureTrainVolRange, fLearningRate, g_aXYZFrame, center, g_aNeighborDirection[i][j], g_TextureModel[i][j]);
-        C_CodebookConstruction(g_aXYZFrame[i][j], j, i, g_nColorTrainVolRange, fLearningRate, g_ColorModel[i][j]);
+          T_ClearNonEssentialEntries(g_iBackClearPeriod, center, g_TextureModel);
+          C_ClearNonEssentialEntries(g_iBackClearPeriod, center, g_ColorModel);
+        }
+      }
+    }
 
-        //clearing non-essential codewords
-        T_ClearNonEssentialEntries(g_iBackClearPeriod, g_TextureModel[i][j]);
-        C_ClearNonEssentialEntries(g_iBackClearPeriod, g_ColorModel[i][j]);
+    for (int i = std::max(iRowBegin, iH_Start); i < std::min(iRowEnd, iH_End); i++) {
+      for (int j = iW_Start; j < iW_End; j++) {
 
-      }
-      else {
-        if (g_bAbsorptionEnable == TRUE) {
+        point center;
+
+        center.m_nX = j;
+        center.m_nY = i;
+
+        int iPixel = i * g_iRWidth + j;
+        const point* aNei = &g_aNeighborDirection[iPixel * g_nNeighborNum];
+        const uchar* aP = &g_aXYZFrame[iPixel * 3];
+
+        if (g_aUpdateMap[i][j] == TRUE) {
           //model update
-          T_ModelConstruction(g_nTextureTrainVolRange, fLearningRate, g_aXYZFrame, center, g_aNeighborDirection[i][j], g_TCacheBook[i][j]);
-          C_CodebookConstruction(g_aXYZFrame[i][j], j, i, g_nColorTrainVolRange, fLearningRate, g_CCacheBook[i][j]);
+          T_ModelConstruction(g_nTextureTrainVolRange, fLearningRate, g_aXYZFrame.data(), center, aNei, g_TextureModel);
+          C_CodebookConstruction(aP, j, i, g_nColorTrainVolRange, fLearningRate, g_ColorModel);
 
           //clearing non-essential codewords
-          T_Absorption(g_iAbsortionPeriod, center, g_aTContinuousCnt, g_aTReferredIndex, g_TextureModel[i][j], g_TCacheBook[i][j]);
-          C_Absorption(g_iAbsortionPeriod, center, g_aCContinuousCnt, g_aCReferredIndex, g_ColorModel[i][j], g_CCacheBook[i][j]);
+          T_ClearNonEssentialEntries(g_iBackClearPeriod, center, g_TextureModel);
+          C_ClearNonEssentialEntries(g_iBackClearPeriod, center, g_ColorModel);
 
         }
-      }
+        else {
+          if (g_bAbsorptionEnable == TRUE) {
+            //model update
+            T_ModelConstruction(g_nTextureTrainVolRange, fLearningRate, g_aXYZFrame.data(), center, aNei, g_TCacheBook);
+            C_CodebookConstruction(aP, j, i, g_nColorTrainVolRange, fLearningRate, g_CCacheBook);
+
+            //clearing non-essential codewords
+            T_Absorption(g_iAbsortionPeriod, center, g_aTContinuousCnt.data(), g_aTReferredIndex.data(), g_TextureModel, g_TCacheBook);
+            C_Absorption(g_iAbsortionPeriod, center, g_aCContinuousCnt.data(), g_aCReferredIndex.data(), g_ColorModel, g_CCacheBook);
 
-      //clearing non-essential codewords for cache-books
-      if (g_bAbsorptionEnable == TRUE) {
-        T_ClearNonEssentialEntriesForCachebook(g_aLandmarkArray[i][j], g_aTReferredIndex[i][j], 10, g_TCacheBook[i][j]);
-        C_ClearNonEssentialEntriesForCachebook(g_aLandmarkArray[i][j], g_aCReferredIndex[i][j], 10, g_CCacheBook[i][j]);
+          }
+        }
+
+        //clearing non-essential codewords for cache-books
+        if (g_bAbsorptionEnable == TRUE) {
+          T_ClearNonEssentialEntriesForCachebook(g_aLandmarkArray[i][j], &g_aTReferredIndex[iPixel * g_nNeighborNum], 10, center, g_TCacheBook);
+          C_ClearNonEssentialEntriesForCachebook(g_aLandmarkArray[i][j], g_aCReferredIndex[iPixel], 10, center, g_CCacheBook);
+        }
       }
     }
-  }
+  });
 
 }
 
+//-----------------------------------------------------------------------------------------------------------------------------------------//
+//								the functions to run the model update in the background, during the next pre-processing				       //
+//-----------------------------------------------------------------------------------------------------------------------------------------//
+void MultiCue::StartModelUpdate() {
+  //The update only reads g_aXYZFrame, g_aLandmarkArray, g_aGhostMap and g_BoundBoxInfo, which are not written again
+  //before the next frame calls WaitForModelUpdate(), and the foreground map is already final.
+  if (g_pPipelineThread) g_ModelUpdate = g_pPipelineThread->enqueue([this]() { UpdateModel_Par(); });
+  else UpdateModel_Par();
+}
+
+void MultiCue::WaitForModelUpdate() {
+  if (g_ModelUpdate.valid()) g_ModelUpdate.get();
+}
+
+//-----------------------------------------------------------------------------------------------------------------------------------------//
+//									the function to run oBandFunc(iBandBegin, iBandEnd) on bands of rows									   //
+//-----------------------------------------------------------------------------------------------------------------------------------------//
+void MultiCue::ForEachBand(int iRowBegin, int iRowEnd, const std::function<void(int, int)>& oBandFunc) {
+  parallelBands(g_pBandThreadPool.get(), iRowEnd - iRowBegin, [&](int iBandBegin, int iBandEnd) { oBandFunc(iRowBegin + iBandBegin, iRowBegin + iBandEnd); });
+}
+
 //-----------------------------------------------------------------------------------------------------------------------------------------//
 //														the color based verification function											   //
 //-----------------------------------------------------------------------------------------------------------------------------------------//
-void MultiCue::CreateLandmarkArray_Par(float fConfThre, short nTrainVolRange, float**aConfMap, int iNehborNum, uchar*** aXYZ,
-  point*** aNeiDir, TextureModel**** TModel, ColorModel*** CModel, uchar**aLandmarkArr) {
+void MultiCue::CreateLandmarkArray_Par(float fConfThre, short nTrainVolRange, float**aConfMap, int iNehborNum, const uchar* aXYZ,
+  const point* aNeiDir, TextureModelStore& TModel, ColorModelStore& CModel, uchar**aLandmarkArr) {
 
   int iBound_w = g_iRWidth - g_nRadius;
   int iBound_h = g_iRHeight - g_nRadius;
 
-  for (int i = 0; i < g_iRHeight; i++) {
-    for (int j = 0; j < g_iRWidth; j++) {
+  ForEachBand(0, g_iRHeight, [&](int iRowBegin, int iRowEnd) {
+    for (int i = iRowBegin; i < iRowEnd; i++) {
+      for (int j = 0; j < g_iRWidth; j++) {
 
-      if (i < g_nRadius || i >= iBound_h || j < g_nRadius || j >= iBound_w) {
-        aLandmarkArr[i][j] = 0;
-        continue;
-      }
+        if (i < g_nRadius || i >= iBound_h || j < g_nRadius || j >= iBound_w) {
+          aLandmarkArr[i][j] = 0;
+          continue;
+        }
 
-      double tmp = aConfMap[i][j];
+        double tmp = aConfMap[i][j];
 
-      if (tmp > fConfThre) aLandmarkArr[i][j] = 255;
-      else {
-        aLandmarkArr[i][j] = 0;
-        //Calculating texture amount in the background
-        double dBackAmt, dCnt;
-        dBackAmt = dCnt = 0;
-
-        for (int m = 0; m < iNehborNum; m++) {
-          for (int n = 0; n < TModel[i][j][m]->m_iNumEntries; n++) {
-            dBackAmt += TModel[i][j][m]->m_Codewords[n]->m_fMean;
-            dCnt++;
+        if (tmp > fConfThre) aLandmarkArr[i][j] = 255;
+        else {
+          aLandmarkArr[i][j] = 0;
+          int iPixel = i * g_iRWidth + j;
+          const uchar* aP = aXYZ + iPixel * 3;
+          const point* aNei = aNeiDir + iPixel * iNehborNum;
+
+          //Calculating texture amount in the background
+          double dBackAmt, dCnt;
+          dBackAmt = dCnt = 0;
+
+          for (int m = 0; m < iNehborNum; m++) {
+            const TextureModel* pT = TModel.GetBook(iPixel * iNehborNum + m);
+            const TextureCodeword* aCodewords = TModel.GetCodewords(pT);
+            for (int n = 0; n < pT->m_iNumEntries; n++) {
+              dBackAmt += aCodewords[n].m_fMean;
+              dCnt++;
+            }
           }
-        }
-        dBackAmt /= dCnt;
+          dBackAmt /= dCnt;
 
-        //Calculating texture amount in the input image
-        double dTemp, dInputAmt = 0;
-        for (int m = 0; m < iNehborNum; m++) {
-          dTemp = aXYZ[i][j][2] - aXYZ[aNeiDir[i][j][m].m_nY][aNeiDir[i][j][m].m_nX][2];
+          //Calculating texture amount in the input image
+          double dTemp, dInputAmt = 0;
+          for (int m = 0; m < iNehborNum; m++) {
+            dTemp = aP[2] - aXYZ[(aNei[m].m_nY * g_iRWidth + aNei[m].m_nX) * 3 + 2];
 
-          if (dTemp >= 0) dInputAmt += dTemp;
-          else dInputAmt -= dTemp;
+            if (dTemp >= 0) dInputAmt += dTemp;
+            else dInputAmt -= dTemp;
 
-        }
+          }
 
-        //If there are only few textures in both background and input image
-        if (dBackAmt < 50 && dInputAmt < 50) {
-          //Conduct color codebook matching
-          BOOL bMatched = FALSE;
-          for (int m = 0; m < CModel[i][j]->m_iNumEntries; m++) {
+          //If there are only few textures in both background and input image
+          if (dBackAmt < 50 && dInputAmt < 50) {
+            //Conduct color codebook matching
+            BOOL bMatched = FALSE;
+            const ColorModel* pC = CModel.GetBook(iPixel);
+            const ColorCodeword* aCodewords = CModel.GetCodewords(pC);
+            for (int m = 0; m < pC->m_iNumEntries; m++) {
 
-            int iMatchedCount = 0;
-            for (int n = 0; n < 3; n++) {
-              double dLowThre = CModel[i][j]->m_Codewords[m]->m_dMean[n] - nTrainVolRange - 10;
-              double dHighThre = CModel[i][j]->m_Codewords[m]->m_dMean[n] + nTrainVolRange + 10;
+              int iMatchedCount = 0;
+              for (int n = 0; n < 3; n++) {
+                double dLowThre = aCodewords[m].m_dMean[n] - nTrainVolRange - 10;
+                double dHighThre = aCodewords[m].m_dMean[n] + nTrainVolRange + 10;
 
-              if (dLowThre <= aXYZ[i][j][n] && aXYZ[i][j][n] <= dHighThre) iMatchedCount++;
-            }
+                if (dLowThre <= aP[n] && aP[n] <= dHighThre) iMatchedCount++;
+              }
+
+              if (iMatchedCount == 3) {
+                bMatched = TRUE;
+                break;
+              }
 
-            if (iMatchedCount == 3) {
-              bMatched = TRUE;
-              break;
             }
+            if (bMatched == TRUE) aLandmarkArr[i][j] = 125;
+            else aLandmarkArr[i][j] = 255;
 
           }
-          if (bMatched == TRUE) aLandmarkArr[i][j] = 125;
-          else aLandmarkArr[i][j] = 255;
 
         }
-
       }
     }
-  }
+  });
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------------------//
 //													the Gaussian filtering function								                           //
 //-----------------------------------------------------------------------------------------------------------------------------------------//
-void MultiCue::GaussianFiltering(IplImage* frame, uchar*** aFilteredFrame) {
+void MultiCue::GaussianFiltering(IplImage* frame, uchar* aFilteredFrame) {
 
   double dSigma = 0.7;
 
   if (dSigma == 0) {
     for (int i = 0; i < g_iRHeight; i++) {
-      for (int j = 0; j < g_iRWidth; j++) {
-        aFilteredFrame[i][j][0] = frame->imageData[i*frame->widthStep + j * 3];
-        aFilteredFrame[i][j][1] = frame->imageData[i*frame->widthStep + j * 3 + 1];
-        aFilteredFrame[i][j][2] = frame->imageData[i*frame->widthStep + j * 3 + 2];
-      }
+      memcpy(aFilteredFrame + i * g_iRWidth * 3, frame->imageData + i*frame->widthStep, g_iRWidth * 3);
     }
   }
   else
@@ -539,21 +613,10 @@ void MultiCue::GaussianFiltering(IplImage* frame, uchar*** aFilteredFrame) {
     cv::Mat temp_img = cv::cvarrToMat(frame, TRUE);
     cv::GaussianBlur(temp_img, temp_img, cv::Size(7, 7), dSigma);
 
-    //Store results into aFilteredFrame[][][]
-    IplImage _img = cvIplImage(temp_img);
-    IplImage* img = cvCloneImage(&_img);
-
-    //int iWidthStep = img->widthStep;
-
+    //Store results into aFilteredFrame[]
     for (int i = 0; i < g_iRHeight; i++) {
-      for (int j = 0; j < g_iRWidth; j++) {
-        aFilteredFrame[i][j][0] = img->imageData[i*img->widthStep + j * 3];
-        aFilteredFrame[i][j][1] = img->imageData[i*img->widthStep + j * 3 + 1];
-        aFilteredFrame[i][j][2] = img->imageData[i*img->widthStep + j * 3 + 2];
-      }
+      memcpy(aFilteredFrame + i * g_iRWidth * 3, temp_img.ptr<uchar>(i), g_iRWidth * 3);
     }
-
-    cvReleaseImage(&img);
   }
 }
 
@@ -583,58 +646,63 @@ void MultiCue::ReduceImageSize(IplImage* SrcImage, IplImage* DstImage) {
 //------------------------------------------------------------------------------------------------------------------------------------//
 //											    the color space conversion function                                                   //
 //------------------------------------------------------------------------------------------------------------------------------------//
-void MultiCue::BGR2HSVxyz_Par(uchar*** aBGR, uchar*** aXYZ) {
+void MultiCue::BGR2HSVxyz_Par(const uchar* aBGR, uchar* aXYZ) {
 
   double dH_ratio = (2 * PI) / 360;
 
-  for (int i = 0; i < g_iRHeight; i++) {
-
-    double dR, dG, dB;
-    double dMax, dMin;
+  ForEachBand(0, g_iRHeight, [&](int iRowBegin, int iRowEnd) {
+    for (int i = iRowBegin; i < iRowEnd; i++) {
 
-    double dH, dS, dV;
+      double dR, dG, dB;
+      double dMax, dMin;
 
-    for (int j = 0; j < g_iRWidth; j++) {
+      double dH, dS, dV;
 
-      dB = (double)(aBGR[i][j][0]) / 255;
-      dG = (double)(aBGR[i][j][1]) / 255;
-      dR = (double)(aBGR[i][j][2]) / 255;
+      for (int j = 0; j < g_iRWidth; j++) {
 
+        const uchar* pBGR = aBGR + (i * g_iRWidth + j) * 3;
+        uchar* pXYZ = aXYZ + (i * g_iRWidth + j) * 3;
 
-      //Find max, min
-      dMin = MIN3(dR, dG, dB);
-      dMax = MAX3(dR, dG, dB);
+        dB = (double)(pBGR[0]) / 255;
+        dG = (double)(pBGR[1]) / 255;
+        dR = (double)(pBGR[2]) / 255;
 
 
-      //Get V
-      dV = dMax;
+        //Find max, min
+        dMin = MIN3(dR, dG, dB);
+        dMax = MAX3(dR, dG, dB);
 
-      //Get S, H
-      if (dV == 0) dS = dH = 0;
-      else {
 
-        //S value
-        dS = (dMax - dMin) / dMax;
+        //Get V
+        dV = dMax;
 
-        if (dS == 0) dH = 0;
+        //Get S, H
+        if (dV == 0) dS = dH = 0;
         else {
-          //H value
-          if (dMax == dR) {
-            dH = 60 * (dG - dB) / dS;
-            if (dH < 0) dH = 360 + dH;
+
+          //S value
+          dS = (dMax - dMin) / dMax;
+
+          if (dS == 0) dH = 0;
+          else {
+            //H value
+            if (dMax == dR) {
+              dH = 60 * (dG - dB) / dS;
+              if (dH < 0) dH = 360 + dH;
+            }
+            else if (dMax == dG) dH = 120 + 60 * (dB - dR) / dS;
+            else dH = 240 + 60 * (dR - dG) / dS;
           }
-          else if (dMax == dG) dH = 120 + 60 * (dB - dR) / dS;
-          else dH = 240 + 60 * (dR - dG) / dS;
         }
-      }
-      dH = dH * dH_ratio;
+        dH = dH * dH_ratio;
 
-      aXYZ[i][j][0] = (uchar)((dV * dS * cos(dH) * 127.5) + 127.5);		//X  --> 0~255
-      aXYZ[i][j][1] = (uchar)((dV * dS * sin(dH) * 127.5) + 127.5);		//Y  --> 0~255
-      aXYZ[i][j][2] = (uchar)(dV * 255);							    //Z  --> 0~255
+        pXYZ[0] = (uchar)((dV * dS * cos(dH) * 127.5) + 127.5);		//X  --> 0~255
+        pXYZ[1] = (uchar)((dV * dS * sin(dH) * 127.5) + 127.5);		//Y  --> 0~255
+        pXYZ[2] = (uchar)(dV * 255);							    //Z  --> 0~255
 
+      }
     }
-  }
+  });
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------------------//
@@ -693,10 +761,7 @@ void MultiCue::MorphologicalOpearions(uchar** aInput, uchar** aOutput, double dT
   int iBound_w = iWidth - iOffset;
   int iBound_h = iHeight - iOffset;
 
-  uchar** aTemp = (uchar**)malloc(sizeof(uchar*)*iHeight);
-  for (int i = 0; i < iHeight; i++) {
-    aTemp[i] = (uchar*)malloc(sizeof(uchar)*iWidth);
-  }
+  uchar** aTemp = AllocateRows<uchar>(iHeight, iWidth);
 
   for (int i = 0; i < iHeight; i++) {
     for (int j = 0; j < iWidth; j++) {
@@ -726,9 +791,6 @@ void MultiCue::MorphologicalOpearions(uchar** aInput, uchar** aOutput, double dT
   }
 
 
-  for (int i = 0; i < iHeight; i++) {
-    free(aTemp[i]);
-  }
   free(aTemp);
 
 }
@@ -990,9 +1052,8 @@ void MultiCue::EvaluateGhostRegion(IplImage* frame, uchar** aResForeMap, Boundin
 
   double dThreshold = 10;
 
-  BOOL** aUpdateMap = (BOOL**)malloc(sizeof(BOOL*)*g_iRHeight);
+  BOOL** aUpdateMap = g_aGhostMap;
   for (int i = 0; i < g_iRHeight; i++) {
-    aUpdateMap[i] = (BOOL*)malloc(sizeof(BOOL)*g_iRWidth);
     for (int j = 0; j < g_iRWidth; j++) aUpdateMap[i][j] = FALSE;
   }
 
@@ -1044,27 +1105,7 @@ void MultiCue::EvaluateGhostRegion(IplImage* frame, uchar** aResForeMap, Boundin
     }
   }
 
-  //Step2: Adding information fo ghost region pixels to background model
-  float fLearningRate = g_fLearningRate;
-
-  for (int i = 0; i < g_iRHeight; i++) {
-    for (int j = 0; j < g_iRWidth; j++) {
-      if (aUpdateMap[i][j] == TRUE) {
-        point center;
-        center.m_nX = j; center.m_nY = i;
-
-        T_ModelConstruction(g_nTextureTrainVolRange, fLearningRate, g_aXYZFrame, center, g_aNeighborDirection[i][j], g_TextureModel[i][j]);
-        C_CodebookConstruction(g_aXYZFrame[i][j], j, i, g_nColorTrainVolRange, fLearningRate, g_ColorModel[i][j]);
-
-        T_ClearNonEssentialEntries(g_iBackClearPeriod, g_TextureModel[i][j]);
-        C_ClearNonEssentialEntries(g_iBackClearPeriod, g_ColorModel[i][j]);
-
-      }
-    }
-  }
-
-  for (int i = 0; i < g_iRHeight; i++) free(aUpdateMap[i]);
-  free(aUpdateMap);
+  //Step2: the ghost region pixels are added to the background model by UpdateModel_Par()
 }
 
 
@@ -1206,74 +1247,28 @@ void MultiCue::GetForegroundMap(IplImage* return_image, IplImage* input_frame) {
 //												the	initialization function for the texture-models									       //
 //-----------------------------------------------------------------------------------------------------------------------------------------//
 void MultiCue::T_AllocateTextureModelRelatedMemory() {
-  int i, j, k;
+  int iPixelNum = g_iRWidth * g_iRHeight;
 
   //neighborhood system related
-  int iMaxNeighborArraySize = 8;
-  g_aNeighborDirection = (point***)malloc(sizeof(point**)*g_iRHeight);
-  for (i = 0; i < g_iRHeight; i++) {
-    g_aNeighborDirection[i] = (point**)malloc(sizeof(point*)*g_iRWidth);
-    for (j = 0; j < g_iRWidth; j++) {
-      g_aNeighborDirection[i][j] = (point*)malloc(sizeof(point)*iMaxNeighborArraySize);
-    }
-  }
-  T_SetNeighborDirection(g_aNeighborDirection);
+  g_aNeighborDirection.allocate(iPixelNum * g_nNeighborNum);
+  T_SetNeighborDirection(g_aNeighborDirection.data());
 
   //texture-model related
-  int iElementArraySize = 6;
-  g_TextureModel = (TextureModel****)malloc(sizeof(TextureModel***)*g_iRHeight);
-  for (i = 0; i < g_iRHeight; i++) {
-    g_TextureModel[i] = (TextureModel***)malloc(sizeof(TextureModel**)*g_iRWidth);
-    for (j = 0; j < g_iRWidth; j++) {
-      g_TextureModel[i][j] = (TextureModel**)malloc(sizeof(TextureModel*)*g_nNeighborNum);
-      for (k = 0; k < g_nNeighborNum; k++) {
-        g_TextureModel[i][j][k] = (TextureModel*)malloc(sizeof(TextureModel));
-        g_TextureModel[i][j][k]->m_Codewords = (TextureCodeword**)malloc(sizeof(TextureCodeword*)*iElementArraySize);
-        g_TextureModel[i][j][k]->m_iElementArraySize = iElementArraySize;
-        g_TextureModel[i][j][k]->m_iNumEntries = 0;
-        g_TextureModel[i][j][k]->m_iTotal = 0;
-        g_TextureModel[i][j][k]->m_bID = 1;
-      }
-    }
-  }
+  int iSlabSize = 4;
+  g_TextureModel.Allocate(g_iRHeight, g_iRWidth * g_nNeighborNum, iSlabSize, 1);
 
-  g_aTextureConfMap = (float**)malloc(sizeof(float*)*g_iRHeight);
-  for (i = 0; i < g_iRHeight; i++) g_aTextureConfMap[i] = (float*)malloc(sizeof(float)*g_iRWidth);
+  g_aTextureConfMap = AllocateRows<float>(g_iRHeight, g_iRWidth);
 
   //cache-book related
   if (g_bAbsorptionEnable == TRUE) {
-    iElementArraySize = iElementArraySize / 2;
-    if (iElementArraySize < 3)iElementArraySize = 3;
-
-    g_TCacheBook = (TextureModel****)malloc(sizeof(TextureModel***)*g_iRHeight);
-    for (i = 0; i < g_iRHeight; i++) {
-      g_TCacheBook[i] = (TextureModel***)malloc(sizeof(TextureModel**)*g_iRWidth);
-      for (j = 0; j < g_iRWidth; j++) {
-        g_TCacheBook[i][j] = (TextureModel**)malloc(sizeof(TextureModel*)*g_nNeighborNum);
-        for (k = 0; k < g_nNeighborNum; k++) {
-          g_TCacheBook[i][j][k] = (TextureModel*)malloc(sizeof(TextureModel));
-          g_TCacheBook[i][j][k]->m_Codewords = (TextureCodeword**)malloc(sizeof(TextureCodeword*)*iElementArraySize);
-          g_TCacheBook[i][j][k]->m_iElementArraySize = iElementArraySize;
-          g_TCacheBook[i][j][k]->m_iNumEntries = 0;
-          g_TCacheBook[i][j][k]->m_iTotal = 0;
-          g_TCacheBook[i][j][k]->m_bID = 0;
-        }
-      }
-    }
+    iSlabSize = 2;
+    g_TCacheBook.Allocate(g_iRHeight, g_iRWidth * g_nNeighborNum, iSlabSize, 0);
 
-    g_aTReferredIndex = (short***)malloc(sizeof(short**)*g_iRHeight);
-    g_aTContinuousCnt = (short***)malloc(sizeof(short**)*g_iRHeight);
-    for (i = 0; i < g_iRHeight; i++) {
-      g_aTReferredIndex[i] = (short**)malloc(sizeof(short*)*g_iRWidth);
-      g_aTContinuousCnt[i] = (short**)malloc(sizeof(short*)*g_iRWidth);
-      for (j = 0; j < g_iRWidth; j++) {
-        g_aTReferredIndex[i][j] = (short*)malloc(sizeof(short)*g_nNeighborNum);
-        g_aTContinuousCnt[i][j] = (short*)malloc(sizeof(short)*g_nNeighborNum);
-        for (k = 0; k < g_nNeighborNum; k++) {
-          g_aTReferredIndex[i][j][k] = -1;
-          g_aTContinuousCnt[i][j][k] = 0;
-        }
-      }
+    g_aTReferredIndex.allocate(iPixelNum * g_nNeighborNum);
+    g_aTContinuousCnt.allocate(iPixelNum * g_nNeighborNum);
+    for (int i = 0; i < iPixelNum * g_nNeighborNum; i++) {
+      g_aTReferredIndex[i] = -1;
+      g_aTContinuousCnt[i] = 0;
     }
   }
 }
@@ -1281,66 +1276,29 @@ void MultiCue::T_AllocateTextureModelRelatedMemory() {
 //															the memory release function											           //
 //-----------------------------------------------------------------------------------------------------------------------------------------//
 void MultiCue::T_ReleaseTextureModelRelatedMemory() {
-  int i, j, k, m;
-  short nNeighborNum = g_nNeighborNum;
-
-  for (i = 0; i < g_iRHeight; i++) {
-    for (j = 0; j < g_iRWidth; j++) {
-      for (k = 0; k < nNeighborNum; k++) {
-        for (m = 0; m < g_TextureModel[i][j][k]->m_iNumEntries; m++) free(g_TextureModel[i][j][k]->m_Codewords[m]);
-        free(g_TextureModel[i][j][k]->m_Codewords);
-        free(g_TextureModel[i][j][k]);
-      }
-      free(g_TextureModel[i][j]);
-    }free(g_TextureModel[i]);
-  }
-  free(g_TextureModel);
+  g_TextureModel.Release();
+  g_aNeighborDirection.release();
 
-  for (i = 0; i < g_iRHeight; i++) {
-    for (j = 0; j < g_iRWidth; j++) free(g_aNeighborDirection[i][j]);
-    free(g_aNeighborDirection[i]);
-  }
-  free(g_aNeighborDirection);
-
-  for (i = 0; i < g_iRHeight; i++) free(g_aTextureConfMap[i]);
   free(g_aTextureConfMap);
 
   if (g_bAbsorptionEnable == TRUE) {
-    for (i = 0; i < g_iRHeight; i++) {
-      for (j = 0; j < g_iRWidth; j++) {
-        for (k = 0; k < nNeighborNum; k++) {
-          for (m = 0; m < g_TCacheBook[i][j][k]->m_iNumEntries; m++) free(g_TCacheBook[i][j][k]->m_Codewords[m]);
-          free(g_TCacheBook[i][j][k]->m_Codewords);
-          free(g_TCacheBook[i][j][k]);
-        }
-        free(g_TCacheBook[i][j]);
-      }free(g_TCacheBook[i]);
-    }
-    free(g_TCacheBook);
-
-    for (i = 0; i < g_iRHeight; i++) {
-      for (j = 0; j < g_iRWidth; j++) {
-        free(g_aTReferredIndex[i][j]);
-        free(g_aTContinuousCnt[i][j]);
-      }
-      free(g_aTReferredIndex[i]);
-      free(g_aTContinuousCnt[i]);
-    }
-    free(g_aTReferredIndex);
-    free(g_aTContinuousCnt);
+    g_TCacheBook.Release();
 
+    g_aTReferredIndex.release();
+    g_aTContinuousCnt.release();
   }
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------------------//
 //														the codebook construction function				                                   //
 //-----------------------------------------------------------------------------------------------------------------------------------------//
-void MultiCue::T_ModelConstruction(short nTrainVolRange, float fLearningRate, uchar*** aXYZ, point center, point* aNei, TextureModel** aModel) {
+void MultiCue::T_ModelConstruction(short nTrainVolRange, float fLearningRate, const uchar* aXYZ, point center, const point* aNei, TextureModelStore& aModel) {
 
   int i, j;
   int iMatchedIndex;
 
   short nNeighborNum = g_nNeighborNum;
+  int iPixel = center.m_nY * g_iRWidth + center.m_nX;
 
   float fDifference;
   float fDiffMean;
@@ -1350,83 +1308,77 @@ void MultiCue::T_ModelConstruction(short nTrainVolRange, float fLearningRate, uc
   //for all neighboring pairs
   for (i = 0; i < nNeighborNum; i++) {
 
-    fDifference = (float)(aXYZ[center.m_nY][center.m_nX][2] - aXYZ[aNei[i].m_nY][aNei[i].m_nX][2]);
+    TextureModel* c = aModel.GetBook(iPixel * nNeighborNum + i);
+    TextureCodeword* aCodewords = aModel.GetCodewords(c);
+
+    fDifference = (float)(aXYZ[iPixel * 3 + 2] - aXYZ[(aNei[i].m_nY * g_iRWidth + aNei[i].m_nX) * 3 + 2]);
 
     //Step1: matching
     iMatchedIndex = -1;
-    for (j = 0; j < aModel[i]->m_iNumEntries; j++) {
-      if (aModel[i]->m_Codewords[j]->m_fLowThre <= fDifference && fDifference <= aModel[i]->m_Codewords[j]->m_fHighThre) {
+    for (j = 0; j < c->m_iNumEntries; j++) {
+      if (aCodewords[j].m_fLowThre <= fDifference && fDifference <= aCodewords[j].m_fHighThre) {
         iMatchedIndex = j;
         break;
       }
     }
 
-    aModel[i]->m_iTotal++;
+    c->m_iTotal++;
     //Step2: adding a new element
     if (iMatchedIndex == -1) {
-      //element array
-      if (aModel[i]->m_iElementArraySize == aModel[i]->m_iNumEntries) {
-        aModel[i]->m_iElementArraySize += 5;
-        TextureCodeword **temp = (TextureCodeword**)malloc(sizeof(TextureCodeword*)*aModel[i]->m_iElementArraySize);
-        for (j = 0; j < aModel[i]->m_iNumEntries; j++) {
-          temp[j] = aModel[i]->m_Codewords[j];
-          aModel[i]->m_Codewords[j] = NULL;
-        }
-        free(aModel[i]->m_Codewords);
-        aModel[i]->m_Codewords = temp;
-      }
-      aModel[i]->m_Codewords[aModel[i]->m_iNumEntries] = (TextureCodeword*)malloc(sizeof(TextureCodeword));
+      //the codewords move to the overflow arena when the slab is full
+      aCodewords = aModel.Reserve(c);
+      TextureCodeword* pNew = &aCodewords[c->m_iNumEntries];
 
-      aModel[i]->m_Codewords[aModel[i]->m_iNumEntries]->m_fMean = fDifference;
-      aModel[i]->m_Codewords[aModel[i]->m_iNumEntries]->m_fLowThre = aModel[i]->m_Codewords[aModel[i]->m_iNumEntries]->m_fMean - nTrainVolRange;
-      aModel[i]->m_Codewords[aModel[i]->m_iNumEntries]->m_fHighThre = aModel[i]->m_Codewords[aModel[i]->m_iNumEntries]->m_fMean + nTrainVolRange;
+      pNew->m_fMean = fDifference;
+      pNew->m_fLowThre = pNew->m_fMean - nTrainVolRange;
+      pNew->m_fHighThre = pNew->m_fMean + nTrainVolRange;
 
-      aModel[i]->m_Codewords[aModel[i]->m_iNumEntries]->m_iT_first_time = aModel[i]->m_iTotal;
-      aModel[i]->m_Codewords[aModel[i]->m_iNumEntries]->m_iT_last_time = aModel[i]->m_iTotal;
-      aModel[i]->m_Codewords[aModel[i]->m_iNumEntries]->m_iMNRL = aModel[i]->m_iTotal - 1;
-      aModel[i]->m_iNumEntries++;
+      pNew->m_iT_first_time = c->m_iTotal;
+      pNew->m_iT_last_time = c->m_iTotal;
+      pNew->m_iMNRL = c->m_iTotal - 1;
+      c->m_iNumEntries++;
     }
 
     //Step3: update
     else {
-      fDiffMean = aModel[i]->m_Codewords[iMatchedIndex]->m_fMean;
-      aModel[i]->m_Codewords[iMatchedIndex]->m_fMean = fLearningRate*fDifference + fNegLearningRate*fDiffMean;
+      fDiffMean = aCodewords[iMatchedIndex].m_fMean;
+      aCodewords[iMatchedIndex].m_fMean = fLearningRate*fDifference + fNegLearningRate*fDiffMean;
 
-      aModel[i]->m_Codewords[iMatchedIndex]->m_fLowThre = aModel[i]->m_Codewords[iMatchedIndex]->m_fMean - nTrainVolRange;
-      aModel[i]->m_Codewords[iMatchedIndex]->m_fHighThre = aModel[i]->m_Codewords[iMatchedIndex]->m_fMean + nTrainVolRange;
+      aCodewords[iMatchedIndex].m_fLowThre = aCodewords[iMatchedIndex].m_fMean - nTrainVolRange;
+      aCodewords[iMatchedIndex].m_fHighThre = aCodewords[iMatchedIndex].m_fMean + nTrainVolRange;
 
-      aModel[i]->m_Codewords[iMatchedIndex]->m_iT_last_time = aModel[i]->m_iTotal;
+      aCodewords[iMatchedIndex].m_iT_last_time = c->m_iTotal;
     }
 
     //cache-book handling
-    if (aModel[i]->m_bID == 1) {
+    if (c->m_bID == 1) {
       //1. m_iMNRL update
       int negTime;
-      for (j = 0; j < aModel[i]->m_iNumEntries; j++) {
+      for (j = 0; j < c->m_iNumEntries; j++) {
         //m_iMNRL update
-        negTime = aModel[i]->m_iTotal - aModel[i]->m_Codewords[j]->m_iT_last_time + aModel[i]->m_Codewords[j]->m_iT_first_time - 1;
-        if (aModel[i]->m_Codewords[j]->m_iMNRL < negTime) aModel[i]->m_Codewords[j]->m_iMNRL = negTime;
+        negTime = c->m_iTotal - aCodewords[j].m_iT_last_time + aCodewords[j].m_iT_first_time - 1;
+        if (aCodewords[j].m_iMNRL < negTime) aCodewords[j].m_iMNRL = negTime;
       }
 
 
-      //2. g_aTReferredIndex[center.m_nY][center.m_nX][i] update
-      if (g_bAbsorptionEnable == TRUE) g_aTReferredIndex[center.m_nY][center.m_nX][i] = -1;
+      //2. g_aTReferredIndex[center][i] update
+      if (g_bAbsorptionEnable == TRUE) g_aTReferredIndex[iPixel * nNeighborNum + i] = -1;
     }
 
     else {
       //1. m_iMNRL update
-      if (iMatchedIndex == -1) aModel[i]->m_Codewords[aModel[i]->m_iNumEntries - 1]->m_iMNRL = 0;
+      if (iMatchedIndex == -1) aCodewords[c->m_iNumEntries - 1].m_iMNRL = 0;
 
-      //2. g_aTReferredIndex[center.m_nY][center.m_nX][i] update
+      //2. g_aTReferredIndex[center][i] update
       if (iMatchedIndex == -1) {
-        g_aTReferredIndex[center.m_nY][center.m_nX][i] = aModel[i]->m_iNumEntries - 1;
-        g_aTContinuousCnt[center.m_nY][center.m_nX][i] = 1;
+        g_aTReferredIndex[iPixel * nNeighborNum + i] = c->m_iNumEntries - 1;
+        g_aTContinuousCnt[iPixel * nNeighborNum + i] = 1;
       }
       else {
-        if (iMatchedIndex == g_aTReferredIndex[center.m_nY][center.m_nX][i]) g_aTContinuousCnt[center.m_nY][center.m_nX][i]++;
+        if (iMatchedIndex == g_aTReferredIndex[iPixel * nNeighborNum + i]) g_aTContinuousCnt[iPixel * nNeighborNum + i]++;
         else {
-          g_aTReferredIndex[center.m_nY][center.m_nX][i] = iMatchedIndex;
-          g_aTContinuousCnt[center.m_nY][center.m_nX][i] = 1;
+          g_aTReferredIndex[iPixel * nNeighborNum + i] = iMatchedIndex;
+          g_aTContinuousCnt[iPixel * nNeighborNum + i] = 1;
         }
       }
     }
@@ -1438,69 +1390,56 @@ void MultiCue::T_ModelConstruction(short nTrainVolRange, float fLearningRate, uc
 //-----------------------------------------------------------------------------------------------------------------------------------------//
 //												Clear non-essential codewords of the given codebook						                   //																									   //
 //-----------------------------------------------------------------------------------------------------------------------------------------//
-void MultiCue::T_ClearNonEssentialEntries(short nClearNum, TextureModel** aModel) {
+void MultiCue::T_ClearNonEssentialEntries(short nClearNum, point pos, TextureModelStore& aModel) {
   int i, n;
   int iStaleThresh = (int)(nClearNum*0.5);
   int iKeepCnt;
-  int* aKeep;
 
   short nNeighborNum = g_nNeighborNum;
+  int iPixel = pos.m_nY * g_iRWidth + pos.m_nX;
 
   TextureModel* c;
 
   for (n = 0; n < nNeighborNum; n++) {
-    c = aModel[n];
+    c = aModel.GetBook(iPixel * nNeighborNum + n);
 
     if (c->m_iTotal < nClearNum) continue; //(being operated only when c[w][h]->m_iTotal == nClearNum)
 
-    //Step1: initialization
-    aKeep = (int*)malloc(sizeof(int)*c->m_iNumEntries);
+    TextureCodeword* aCodewords = aModel.GetCodewords(c);
 
+    //Step1: Find non-essential code-words
     iKeepCnt = 0;
-
-    //Step2: Find non-essential code-words
     for (i = 0; i < c->m_iNumEntries; i++) {
-      if (c->m_Codewords[i]->m_iMNRL > iStaleThresh) {
-        aKeep[i] = 0; //removal candidate
-      }
-      else {
-        aKeep[i] = 1;
-        iKeepCnt++;
-      }
+      if (aCodewords[i].m_iMNRL <= iStaleThresh) iKeepCnt++;
     }
 
-    //Step3: Perform removal
+    //Step2: Perform removal (the kept codewords are compacted in place, in order)
     if (iKeepCnt == 0 || iKeepCnt == c->m_iNumEntries) {
       for (i = 0; i < c->m_iNumEntries; i++) {
-        c->m_Codewords[i]->m_iT_first_time = 1;
-        c->m_Codewords[i]->m_iT_last_time = 1;
-        c->m_Codewords[i]->m_iMNRL = 0;
+        aCodewords[i].m_iT_first_time = 1;
+        aCodewords[i].m_iT_last_time = 1;
+        aCodewords[i].m_iMNRL = 0;
       }
     }
 
     else {
       iKeepCnt = 0;
-      TextureCodeword** temp = (TextureCodeword**)malloc(sizeof(TextureCodeword*)*c->m_iNumEntries);
 
       for (i = 0; i < c->m_iNumEntries; i++) {
-        if (aKeep[i] == 1) {
-          temp[iKeepCnt] = c->m_Codewords[i];
-          temp[iKeepCnt]->m_iT_first_time = 1;
-          temp[iKeepCnt]->m_iT_last_time = 1;
-          temp[iKeepCnt]->m_iMNRL = 0;
+        if (aCodewords[i].m_iMNRL <= iStaleThresh) {
+          aCodewords[iKeepCnt] = aCodewords[i];
+          aCodewords[iKeepCnt].m_iT_first_time = 1;
+          aCodewords[iKeepCnt].m_iT_last_time = 1;
+          aCodewords[iKeepCnt].m_iMNRL = 0;
           iKeepCnt++;
         }
-        else free(c->m_Codewords[i]);
       }
 
       //ending..
-      free(c->m_Codewords);
-      c->m_Codewords = temp;
-      c->m_iElementArraySize = c->m_iNumEntries;
       c->m_iNumEntries = iKeepCnt;
+      aModel.Shrink(c);
     }
     c->m_iTotal = 0;
-    free(aKeep);
 
   }
 
@@ -1509,23 +1448,26 @@ void MultiCue::T_ClearNonEssentialEntries(short nClearNum, TextureModel** aModel
 //-----------------------------------------------------------------------------------------------------------------------------------------//
 //								Clear non-essential codewords of the given codebook (only for the cache-book)			                   //
 //-----------------------------------------------------------------------------------------------------------------------------------------//
-void MultiCue::T_ClearNonEssentialEntriesForCachebook(uchar bLandmark, short* nReferredIdxArr, short nClearNum, TextureModel** pCachebook) {
+void MultiCue::T_ClearNonEssentialEntriesForCachebook(uchar bLandmark, const short* nReferredIdxArr, short nClearNum, point pos, TextureModelStore& pCachebook) {
   int i, n;
   short nNeighborNum = g_nNeighborNum;
+  int iPixel = pos.m_nY * g_iRWidth + pos.m_nX;
 
   TextureModel* c;
   short nReferredIdx;
 
   for (n = 0; n < nNeighborNum; n++) {
 
-    c = pCachebook[n];
+    c = pCachebook.GetBook(iPixel * nNeighborNum + n);
     nReferredIdx = nReferredIdxArr[n];
 
+    TextureCodeword* aCodewords = pCachebook.GetCodewords(c);
+
     //pCachebook->m_iTotal < nClearNum? --> MNRL update
     if (c->m_iTotal < nClearNum) {
       for (i = 0; i < c->m_iNumEntries; i++) {
-        if (bLandmark == 255 && i == nReferredIdx) c->m_Codewords[i]->m_iMNRL = 0;
-        else c->m_Codewords[i]->m_iMNRL++;
+        if (bLandmark == 255 && i == nReferredIdx) aCodewords[i].m_iMNRL = 0;
+        else aCodewords[i].m_iMNRL++;
       }
 
       c->m_iTotal++;
@@ -1534,46 +1476,20 @@ void MultiCue::T_ClearNonEssentialEntriesForCachebook(uchar bLandmark, short* nR
     //Perform clearing
     else {
       int iStaleThreshold = 5;
-
-      int* aKeep;
-      short nKeepCnt;
-
-      aKeep = (int*)malloc(sizeof(int)*c->m_iNumEntries);
-      nKeepCnt = 0;
-
-      for (i = 0; i < c->m_iNumEntries; i++) {
-        if (c->m_Codewords[i]->m_iMNRL < iStaleThreshold) {
-          aKeep[i] = 1;
-          nKeepCnt++;
-        }
-        else aKeep[i] = 0;
-      }
-
-      c->m_iElementArraySize = nKeepCnt + 2;
-      if (c->m_iElementArraySize < 3) c->m_iElementArraySize = 3;
-
-      TextureCodeword** temp = (TextureCodeword**)malloc(sizeof(TextureCodeword*)*c->m_iElementArraySize);
-      nKeepCnt = 0;
+      short nKeepCnt = 0;
 
       for (i = 0; i < c->m_iNumEntries; i++) {
-        if (aKeep[i] == 1) {
-          temp[nKeepCnt] = c->m_Codewords[i];
-          temp[nKeepCnt]->m_iMNRL = 0;
+        if (aCodewords[i].m_iMNRL < iStaleThreshold) {
+          aCodewords[nKeepCnt] = aCodewords[i];
+          aCodewords[nKeepCnt].m_iMNRL = 0;
           nKeepCnt++;
         }
-        else {
-          free(c->m_Codewords[i]);
-        }
-
       }
 
       //ending..
-      free(c->m_Codewords);
-      c->m_Codewords = temp;
       c->m_iNumEntries = nKeepCnt;
       c->m_iTotal = 0;
-
-      free(aKeep);
+      pCachebook.Shrink(c);
     }
   }
 
@@ -1582,7 +1498,7 @@ void MultiCue::T_ClearNonEssentialEntriesForCachebook(uchar bLandmark, short* nR
 //-----------------------------------------------------------------------------------------------------------------------------------------//
 //											the function to generate texture confidence maps				                               //
 //-----------------------------------------------------------------------------------------------------------------------------------------//
-void MultiCue::T_GetConfidenceMap_Par(uchar*** aXYZ, float** aTextureMap, point*** aNeiDirArr, TextureModel**** aModel) {
+void MultiCue::T_GetConfidenceMap_Par(const uchar* aXYZ, float** aTextureMap, const point* aNeiDirArr, TextureModelStore& aModel) {
 
   int iBound_w = g_iRWidth - g_nRadius;
   int iBound_h = g_iRHeight - g_nRadius;
@@ -1590,94 +1506,86 @@ void MultiCue::T_GetConfidenceMap_Par(uchar*** aXYZ, float** aTextureMap, point*
   short nNeighborNum = g_nNeighborNum;
   float fPadding = 5;
 
-  for (int h = 0; h < g_iRHeight; h++) {
-    for (int w = 0; w < g_iRWidth; w++) {
+  ForEachBand(0, g_iRHeight, [&](int iRowBegin, int iRowEnd) {
+    for (int h = iRowBegin; h < iRowEnd; h++) {
+      for (int w = 0; w < g_iRWidth; w++) {
 
-      if (h < g_nRadius || h >= iBound_h || w < g_nRadius || w >= iBound_w) {
-        aTextureMap[h][w] = 0;
-        continue;
-      }
-
-      int nMatchedCount = 0;
-      float fDiffSum = 0;
-      float fDifference;
-      point nei;
+        if (h < g_nRadius || h >= iBound_h || w < g_nRadius || w >= iBound_w) {
+          aTextureMap[h][w] = 0;
+          continue;
+        }
 
-      for (int i = 0; i < nNeighborNum; i++) {
+        int nMatchedCount = 0;
+        float fDiffSum = 0;
+        float fDifference;
+        int iPixel = h * g_iRWidth + w;
+        const point* aNei = aNeiDirArr + iPixel * nNeighborNum;
 
-        nei.m_nX = aNeiDirArr[h][w][i].m_nX;
-        nei.m_nY = aNeiDirArr[h][w][i].m_nY;
+        for (int i = 0; i < nNeighborNum; i++) {
 
-        fDifference = (float)(aXYZ[h][w][2] - aXYZ[nei.m_nY][nei.m_nX][2]);
-        if (fDifference < 0) fDiffSum -= fDifference;
-        else fDiffSum += fDifference;
+          fDifference = (float)(aXYZ[iPixel * 3 + 2] - aXYZ[(aNei[i].m_nY * g_iRWidth + aNei[i].m_nX) * 3 + 2]);
+          if (fDifference < 0) fDiffSum -= fDifference;
+          else fDiffSum += fDifference;
 
-        for (int j = 0; j < aModel[h][w][i]->m_iNumEntries; j++) {
-          if (aModel[h][w][i]->m_Codewords[j]->m_fLowThre - fPadding <= fDifference && fDifference <= aModel[h][w][i]->m_Codewords[j]->m_fHighThre + fPadding) {
-            nMatchedCount++;
-            break;
+          const TextureModel* c = aModel.GetBook(iPixel * nNeighborNum + i);
+          const TextureCodeword* aCodewords = aModel.GetCodewords(c);
+          for (int j = 0; j < c->m_iNumEntries; j++) {
+            if (aCodewords[j].m_fLowThre - fPadding <= fDifference && fDifference <= aCodewords[j].m_fHighThre + fPadding) {
+              nMatchedCount++;
+              break;
+            }
           }
-        }
 
+        }
+        aTextureMap[h][w] = 1 - (float)nMatchedCount / nNeighborNum;
       }
-      aTextureMap[h][w] = 1 - (float)nMatchedCount / nNeighborNum;
     }
-  }
+  });
 }
 //-----------------------------------------------------------------------------------------------------------------------------------------//
 //											Absorbing Ghost Non-background Region Update					                               //
 //-----------------------------------------------------------------------------------------------------------------------------------------//
-void MultiCue::T_Absorption(int iAbsorbCnt, point pos, short*** aContinuCnt, short*** aRefferedIndex, TextureModel** pModel, TextureModel** pCache) {
-  int i, j, k;
+void MultiCue::T_Absorption(int iAbsorbCnt, point pos, short* aContinuCnt, short* aRefferedIndex, TextureModelStore& pModel, TextureModelStore& pCache) {
+  int i, j;
   int iLeavingIndex;
 
   //short g_nRadius = 2;
   short nNeighborNum = g_nNeighborNum;
+  int iPixel = pos.m_nY * g_iRWidth + pos.m_nX;
 
   for (i = 0; i < nNeighborNum; i++) {
     //set iLeavingIndex
-    if (aContinuCnt[pos.m_nY][pos.m_nX][i] < iAbsorbCnt) continue;
+    if (aContinuCnt[iPixel * nNeighborNum + i] < iAbsorbCnt) continue;
+
+    iLeavingIndex = aRefferedIndex[iPixel * nNeighborNum + i];
 
-    iLeavingIndex = aRefferedIndex[pos.m_nY][pos.m_nX][i];
+    TextureModel* m = pModel.GetBook(iPixel * nNeighborNum + i);
+    TextureModel* c = pCache.GetBook(iPixel * nNeighborNum + i);
 
     //array expansion
-    if (pModel[i]->m_iElementArraySize == pModel[i]->m_iNumEntries) {
-      pModel[i]->m_iElementArraySize = pModel[i]->m_iElementArraySize + 5;
-      TextureCodeword** temp = (TextureCodeword**)malloc(sizeof(TextureCodeword*)*pModel[i]->m_iElementArraySize);
-      for (j = 0; j < pModel[i]->m_iNumEntries; j++) temp[j] = pModel[i]->m_Codewords[j];
-      free(pModel[i]->m_Codewords);
-      pModel[i]->m_Codewords = temp;
-    }
+    TextureCodeword* aModelCodewords = pModel.Reserve(m);
+    TextureCodeword* aCacheCodewords = pCache.GetCodewords(c);
 
     //movement from the cache-book to the codebook
-    pModel[i]->m_Codewords[pModel[i]->m_iNumEntries] = pCache[i]->m_Codewords[iLeavingIndex];
+    aModelCodewords[m->m_iNumEntries] = aCacheCodewords[iLeavingIndex];
 
-    pModel[i]->m_iTotal = pModel[i]->m_iTotal + 1;
+    m->m_iTotal = m->m_iTotal + 1;
 
-    pModel[i]->m_Codewords[pModel[i]->m_iNumEntries]->m_iT_first_time = pModel[i]->m_iTotal;
-    pModel[i]->m_Codewords[pModel[i]->m_iNumEntries]->m_iT_last_time = pModel[i]->m_iTotal;
-    pModel[i]->m_Codewords[pModel[i]->m_iNumEntries]->m_iMNRL = pModel[i]->m_iTotal - 1;
-    pModel[i]->m_iNumEntries = pModel[i]->m_iNumEntries + 1;
+    aModelCodewords[m->m_iNumEntries].m_iT_first_time = m->m_iTotal;
+    aModelCodewords[m->m_iNumEntries].m_iT_last_time = m->m_iTotal;
+    aModelCodewords[m->m_iNumEntries].m_iMNRL = m->m_iTotal - 1;
+    m->m_iNumEntries = m->m_iNumEntries + 1;
 
-    k = 0;
-    TextureCodeword **temp_Cache = (TextureCodeword**)malloc(sizeof(TextureCodeword*)*pCache[i]->m_iElementArraySize);
-    for (j = 0; j < pCache[i]->m_iNumEntries; j++) {
-      if (j == iLeavingIndex) continue;
-      else {
-        temp_Cache[k] = pCache[i]->m_Codewords[j];
-        k++;
-      }
-    }
-    free(pCache[i]->m_Codewords);
-    pCache[i]->m_Codewords = temp_Cache;
-    pCache[i]->m_iNumEntries = k;
+    for (j = iLeavingIndex + 1; j < c->m_iNumEntries; j++) aCacheCodewords[j - 1] = aCacheCodewords[j];
+    c->m_iNumEntries = c->m_iNumEntries - 1;
+    pCache.Shrink(c);
   }
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------------------//
 //													the function to set neighborhood system												   //
 //-----------------------------------------------------------------------------------------------------------------------------------------//
-void MultiCue::T_SetNeighborDirection(point*** aNeighborPos) {
+void MultiCue::T_SetNeighborDirection(point* aNeighborPos) {
   int i, j, k;
   point* aSearchDirection = (point*)malloc(sizeof(point)*g_nNeighborNum);
 
@@ -1703,18 +1611,19 @@ void MultiCue::T_SetNeighborDirection(point*** aNeighborPos) {
 
   for (i = 0; i < g_iRHeight; i++) {
     for (j = 0; j < g_iRWidth; j++) {
+      point* aNei = aNeighborPos + (i * g_iRWidth + j) * g_nNeighborNum;
       for (k = 0; k < g_nNeighborNum; k++) {
         temp_pos.m_nX = j + aSearchDirection[k].m_nX;
         temp_pos.m_nY = i + aSearchDirection[k].m_nY;
 
         if (temp_pos.m_nX < 0 || temp_pos.m_nX >= g_iRWidth || temp_pos.m_nY < 0 || temp_pos.m_nY >= g_iRHeight) {
-          aNeighborPos[i][j][k].m_nX = -1;
-          aNeighborPos[i][j][k].m_nY = -1;
+          aNei[k].m_nX = -1;
+          aNei[k].m_nY = -1;
         }
 
         else {
-          aNeighborPos[i][j][k].m_nX = temp_pos.m_nX;
-          aNeighborPos[i][j][k].m_nY = temp_pos.m_nY;
+          aNei[k].m_nX = temp_pos.m_nX;
+          aNei[k].m_nY = temp_pos.m_nY;
         }
       }
     }
@@ -1726,52 +1635,23 @@ void MultiCue::T_SetNeighborDirection(point*** aNeighborPos) {
 //													the color-model initialization function												   //
 //-----------------------------------------------------------------------------------------------------------------------------------------//
 void MultiCue::C_AllocateColorModelRelatedMemory() {
-  int i, j;
+  int iPixelNum = g_iRWidth * g_iRHeight;
 
-  int iElementArraySize = 10;
+  int iSlabSize = 4;
 
   //codebook initialization
-  g_ColorModel = (ColorModel***)malloc(sizeof(ColorModel**)*g_iRHeight);
-  for (i = 0; i < g_iRHeight; i++) {
-    g_ColorModel[i] = (ColorModel**)malloc(sizeof(ColorModel*)*g_iRWidth);
-    for (j = 0; j < g_iRWidth; j++) {
-      //initialization of each CodeBookArray.
-      g_ColorModel[i][j] = (ColorModel*)malloc(sizeof(ColorModel));
-      g_ColorModel[i][j]->m_Codewords = (ColorCodeword**)malloc(sizeof(ColorCodeword*)*iElementArraySize);
-      g_ColorModel[i][j]->m_iNumEntries = 0;
-      g_ColorModel[i][j]->m_iElementArraySize = iElementArraySize;
-      g_ColorModel[i][j]->m_iTotal = 0;
-      g_ColorModel[i][j]->m_bID = 1;
-    }
-  }
+  g_ColorModel.Allocate(g_iRHeight, g_iRWidth, iSlabSize, 1);
 
   //cache-book initialization
   if (g_bAbsorptionEnable == TRUE) {
-    iElementArraySize = 3;
-
-    g_CCacheBook = (ColorModel***)malloc(sizeof(ColorModel**)*g_iRHeight);
-    for (i = 0; i < g_iRHeight; i++) {
-      g_CCacheBook[i] = (ColorModel**)malloc(sizeof(ColorModel*)*g_iRWidth);
-      for (j = 0; j < g_iRWidth; j++) {
-        //initialization of each CodeBookArray.
-        g_CCacheBook[i][j] = (ColorModel*)malloc(sizeof(ColorModel));
-        g_CCacheBook[i][j]->m_Codewords = (ColorCodeword**)malloc(sizeof(ColorCodeword*)*iElementArraySize);
-        g_CCacheBook[i][j]->m_iNumEntries = 0;
-        g_CCacheBook[i][j]->m_iElementArraySize = iElementArraySize;
-        g_CCacheBook[i][j]->m_iTotal = 0;
-        g_CCacheBook[i][j]->m_bID = 0;
-      }
-    }
+    iSlabSize = 2;
+    g_CCacheBook.Allocate(g_iRHeight, g_iRWidth, iSlabSize, 0);
 
-    g_aCReferredIndex = (short**)malloc(sizeof(short*)*g_iRHeight);
-    g_aCContinuousCnt = (short**)malloc(sizeof(short*)*g_iRHeight);
-    for (i = 0; i < g_iRHeight; i++) {
-      g_aCReferredIndex[i] = (short*)malloc(sizeof(short)*g_iRWidth);
-      g_aCContinuousCnt[i] = (short*)malloc(sizeof(short)*g_iRWidth);
-      for (j = 0; j < g_iRWidth; j++) {
-        g_aCReferredIndex[i][j] = -1;
-        g_aCContinuousCnt[i][j] = 0;
-      }
+    g_aCReferredIndex.allocate(iPixelNum);
+    g_aCContinuousCnt.allocate(iPixelNum);
+    for (int i = 0; i < iPixelNum; i++) {
+      g_aCReferredIndex[i] = -1;
+      g_aCContinuousCnt[i] = 0;
     }
   }
 }
@@ -1780,62 +1660,40 @@ void MultiCue::C_AllocateColorModelRelatedMemory() {
 //															the memory release function											           //
 //-----------------------------------------------------------------------------------------------------------------------------------------//
 void MultiCue::C_ReleaseColorModelRelatedMemory() {
-  int i, j, k;
-
-  for (i = 0; i < g_iRHeight; i++) {
-    for (j = 0; j < g_iRWidth; j++) {
-      for (k = 0; k < g_ColorModel[i][j]->m_iNumEntries; k++) {
-        free(g_ColorModel[i][j]->m_Codewords[k]);
-      }
-      free(g_ColorModel[i][j]->m_Codewords);
-      free(g_ColorModel[i][j]);
-    }
-    free(g_ColorModel[i]);
-  }
-  free(g_ColorModel);
+  g_ColorModel.Release();
 
   if (g_bAbsorptionEnable == TRUE) {
-    for (i = 0; i < g_iRHeight; i++) {
-      for (j = 0; j < g_iRWidth; j++) {
-        for (k = 0; k < g_CCacheBook[i][j]->m_iNumEntries; k++) {
-          free(g_CCacheBook[i][j]->m_Codewords[k]);
-        }
-        free(g_CCacheBook[i][j]->m_Codewords);
-        free(g_CCacheBook[i][j]);
-      }
-      free(g_CCacheBook[i]);
-    }
-    free(g_CCacheBook);
+    g_CCacheBook.Release();
 
-    for (i = 0; i < g_iRHeight; i++) {
-      free(g_aCReferredIndex[i]);
-      free(g_aCContinuousCnt[i]);
-    }
-    free(g_aCReferredIndex);
-    free(g_aCContinuousCnt);
+    g_aCReferredIndex.release();
+    g_aCContinuousCnt.release();
   }
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------------------//
 //														the codebook construction function								                   //
 //-----------------------------------------------------------------------------------------------------------------------------------------//
-void MultiCue::C_CodebookConstruction(uchar* aP, int iPosX, int iPosY, short nTrainVolRange, float fLearningRate, ColorModel* pC) {
+void MultiCue::C_CodebookConstruction(const uchar* aP, int iPosX, int iPosY, short nTrainVolRange, float fLearningRate, ColorModelStore& pC) {
 
   //Step1: matching
   short nMatchedIndex;
 
   float fNegLearningRate = 1 - fLearningRate;
 
+  int iPixel = iPosY * g_iRWidth + iPosX;
+  ColorModel* c = pC.GetBook(iPixel);
+  ColorCodeword* aCodewords = pC.GetCodewords(c);
+
   nMatchedIndex = -1;
 
-  for (int i = 0; i < pC->m_iNumEntries; i++) {
+  for (int i = 0; i < c->m_iNumEntries; i++) {
 
     //Checking X
-    if (pC->m_Codewords[i]->m_dMean[0] - nTrainVolRange <= aP[0] && aP[0] <= pC->m_Codewords[i]->m_dMean[0] + nTrainVolRange) {
+    if (aCodewords[i].m_dMean[0] - nTrainVolRange <= aP[0] && aP[0] <= aCodewords[i].m_dMean[0] + nTrainVolRange) {
       //Checking Y
-      if (pC->m_Codewords[i]->m_dMean[1] - nTrainVolRange <= aP[1] && aP[1] <= pC->m_Codewords[i]->m_dMean[1] + nTrainVolRange) {
+      if (aCodewords[i].m_dMean[1] - nTrainVolRange <= aP[1] && aP[1] <= aCodewords[i].m_dMean[1] + nTrainVolRange) {
         //Checking Z
-        if (pC->m_Codewords[i]->m_dMean[2] - nTrainVolRange <= aP[2] && aP[2] <= pC->m_Codewords[i]->m_dMean[2] + nTrainVolRange) {
+        if (aCodewords[i].m_dMean[2] - nTrainVolRange <= aP[2] && aP[2] <= aCodewords[i].m_dMean[2] + nTrainVolRange) {
           nMatchedIndex = i;
           break;
         }
@@ -1843,71 +1701,62 @@ void MultiCue::C_CodebookConstruction(uchar* aP, int iPosX, int iPosY, short nTr
     }
   }
 
-  pC->m_iTotal = pC->m_iTotal + 1;
+  c->m_iTotal = c->m_iTotal + 1;
 
   //Step2 : adding a new element
   if (nMatchedIndex == -1) {
-    if (pC->m_iElementArraySize == pC->m_iNumEntries) {
-      pC->m_iElementArraySize = pC->m_iElementArraySize + 5;
-      ColorCodeword **temp = (ColorCodeword**)malloc(sizeof(ColorCodeword*)*pC->m_iElementArraySize);
-      for (int j = 0; j < pC->m_iNumEntries; j++) {
-        temp[j] = pC->m_Codewords[j];
-        pC->m_Codewords[j] = NULL;
-      }
-      free(pC->m_Codewords);
-      pC->m_Codewords = temp;
+    //the codewords move to the overflow arena when the slab is full
+    aCodewords = pC.Reserve(c);
+    ColorCodeword* pNew = &aCodewords[c->m_iNumEntries];
 
-    }
-    pC->m_Codewords[pC->m_iNumEntries] = (ColorCodeword*)malloc(sizeof(ColorCodeword));
+    pNew->m_dMean[0] = aP[0];//X
+    pNew->m_dMean[1] = aP[1];//Y
+    pNew->m_dMean[2] = aP[2];//Z
 
-    pC->m_Codewords[pC->m_iNumEntries]->m_dMean[0] = aP[0];//X
-    pC->m_Codewords[pC->m_iNumEntries]->m_dMean[1] = aP[1];//Y
-    pC->m_Codewords[pC->m_iNumEntries]->m_dMean[2] = aP[2];//Z
-
-    pC->m_Codewords[pC->m_iNumEntries]->m_iT_first_time = pC->m_iTotal;
-    pC->m_Codewords[pC->m_iNumEntries]->m_iT_last_time = pC->m_iTotal;
-    pC->m_Codewords[pC->m_iNumEntries]->m_iMNRL = pC->m_iTotal - 1;
-    pC->m_iNumEntries = pC->m_iNumEntries + 1;
+    pNew->m_iT_first_time = c->m_iTotal;
+    pNew->m_iT_last_time = c->m_iTotal;
+    pNew->m_iMNRL = c->m_iTotal - 1;
+    c->m_iNumEntries = c->m_iNumEntries + 1;
   }
 
   //Step3 : update
   else {
     //m_dMean update
-    pC->m_Codewords[nMatchedIndex]->m_dMean[0] = (fLearningRate*aP[0]) + fNegLearningRate*pC->m_Codewords[nMatchedIndex]->m_dMean[0];//X
-    pC->m_Codewords[nMatchedIndex]->m_dMean[1] = (fLearningRate*aP[1]) + fNegLearningRate*pC->m_Codewords[nMatchedIndex]->m_dMean[1];//Y
-    pC->m_Codewords[nMatchedIndex]->m_dMean[2] = (fLearningRate*aP[2]) + fNegLearningRate*pC->m_Codewords[nMatchedIndex]->m_dMean[2];//Z
+    aCodewords[nMatchedIndex].m_dMean[0] = (fLearningRate*aP[0]) + fNegLearningRate*aCodewords[nMatchedIndex].m_dMean[0];//X
+    aCodewords[nMatchedIndex].m_dMean[1] = (fLearningRate*aP[1]) + fNegLearningRate*aCodewords[nMatchedIndex].m_dMean[1];//Y
+    aCodewords[nMatchedIndex].m_dMean[2] = (fLearningRate*aP[2]) + fNegLearningRate*aCodewords[nMatchedIndex].m_dMean[2];//Z
 
-    pC->m_Codewords[nMatchedIndex]->m_iT_last_time = pC->m_iTotal;
+    aCodewords[nMatchedIndex].m_iT_last_time = c->m_iTotal;
   }
 
   //cache-book handling
-  if (pC->m_bID == 1) {
+  if (c->m_bID == 1) {
     //1. m_iMNRL update
     int iNegTime;
-    for (int i = 0; i < pC->m_iNumEntries; i++) {
+    for (int i = 0; i < c->m_iNumEntries; i++) {
       //m_iMNRL update
-      iNegTime = pC->m_iTotal - pC->m_Codewords[i]->m_iT_last_time + pC->m_Codewords[i]->m_iT_first_time - 1;
-      if (pC->m_Codewords[i]->m_iMNRL < iNegTime) pC->m_Codewords[i]->m_iMNRL = iNegTime;
+      iNegTime = c->m_iTotal - aCodewords[i].m_iT_last_time + aCodewords[i].m_iT_first_time - 1;
+      if (aCodewords[i].m_iMNRL < iNegTime) aCodewords[i].m_iMNRL = iNegTime;
     }
 
     //2. g_aCReferredIndex[iPosY][iPosX] update
-    if (g_bAbsorptionEnable == TRUE) g_aCReferredIndex[iPosY][iPosX] = -1;
+    if (g_bAbsorptionEnable == TRUE) g_aCReferredIndex[iPixel] = -1;
   }
 
   else {
     //1. m_iMNRL update:
-    if (nMatchedIndex == -1) pC->m_Codewords[pC->m_iNumEntries - 1]->m_iMNRL = 0;
+    if (nMatchedIndex == -1) aCodewords[c->m_iNumEntries - 1].m_iMNRL = 0;
 
     //2. g_aCReferredIndex[iPosY][iPosX] update
     if (nMatchedIndex == -1) {
-      g_aCReferredIndex[iPosY][iPosX] = pC->m_iNumEntries - 1;
-      g_aCContinuousCnt[iPosY][iPosX] = 1;
+      g_aCReferredIndex[iPixel] = c->m_iNumEntries - 1;
+      g_aCContinuousCnt[iPixel] = 1;
     }
     else {
-      if (nMatchedIndex == g_aCReferredIndex[iPosY][iPosX]) g_aCContinuousCnt[iPosY][iPosX]++;
+      if (nMatchedIndex == g_aCReferredIndex[iPixel]) g_aCContinuousCnt[iPixel]++;
       else {
-        g_aCReferredIndex[iPosY][iPosX] = nMatchedIndex;
-        g_aCContinuousCnt[iPosY][iPosX] = 1;
+        g_aCReferredIndex[iPixel] = nMatchedIndex;
+        g_aCContinuousCnt[iPixel] = 1;
       }
     }
   }
@@ -1916,169 +1765,123 @@ void MultiCue::C_CodebookConstruction(uchar* aP, int iPosX, int iPosY, short nTr
 //-----------------------------------------------------------------------------------------------------------------------------------------//
 //												Clear non-essential codewords of the given codebook							               //																													   //
 //-----------------------------------------------------------------------------------------------------------------------------------------//
-void MultiCue::C_ClearNonEssentialEntries(short nClearNum, ColorModel* pModel) {
+void MultiCue::C_ClearNonEssentialEntries(short nClearNum, point pos, ColorModelStore& pModel) {
   int i;
   short nStaleThresh = (int)(nClearNum*0.5);
   short nKeepCnt;
-  int* aKeep;
 
-  ColorModel* pC = pModel;
+  ColorModel* pC = pModel.GetBook(pos.m_nY * g_iRWidth + pos.m_nX);
 
   if (pC->m_iTotal < nClearNum) return; //(Being operated only when pC->t >= nClearNum)
 
-  //Step1:initialization
-  aKeep = (int*)malloc(sizeof(int)*pC->m_iNumEntries);
+  ColorCodeword* aCodewords = pModel.GetCodewords(pC);
 
+  //Step1: Find non-essential codewords
   nKeepCnt = 0;
-
-  //Step2: Find non-essential codewords
   for (i = 0; i < pC->m_iNumEntries; i++) {
-    if (pC->m_Codewords[i]->m_iMNRL > nStaleThresh) {
-      aKeep[i] = 0; //removal
-    }
-    else {
-      aKeep[i] = 1; //keep
-      nKeepCnt++;
-    }
+    if (aCodewords[i].m_iMNRL <= nStaleThresh) nKeepCnt++; //keep
   }
 
-  //Step3: Perform removal
+  //Step2: Perform removal (the kept codewords are compacted in place, in order)
   if (nKeepCnt == 0 || nKeepCnt == pC->m_iNumEntries) {
     for (i = 0; i < pC->m_iNumEntries; i++) {
-      pC->m_Codewords[i]->m_iT_first_time = 1;
-      pC->m_Codewords[i]->m_iT_last_time = 1;
-      pC->m_Codewords[i]->m_iMNRL = 0;
+      aCodewords[i].m_iT_first_time = 1;
+      aCodewords[i].m_iT_last_time = 1;
+      aCodewords[i].m_iMNRL = 0;
     }
   }
   else {
     nKeepCnt = 0;
-    ColorCodeword** temp = (ColorCodeword**)malloc(sizeof(ColorCodeword*)*pC->m_iNumEntries);
 
     for (i = 0; i < pC->m_iNumEntries; i++) {
-      if (aKeep[i] == 1) {
-        temp[nKeepCnt] = pC->m_Codewords[i];
-        temp[nKeepCnt]->m_iT_first_time = 1;
-        temp[nKeepCnt]->m_iT_last_time = 1;
-        temp[nKeepCnt]->m_iMNRL = 0;
+      if (aCodewords[i].m_iMNRL <= nStaleThresh) {
+        aCodewords[nKeepCnt] = aCodewords[i];
+        aCodewords[nKeepCnt].m_iT_first_time = 1;
+        aCodewords[nKeepCnt].m_iT_last_time = 1;
+        aCodewords[nKeepCnt].m_iMNRL = 0;
         nKeepCnt++;
       }
-      else free(pC->m_Codewords[i]);
     }
 
     //ending..
-    free(pC->m_Codewords);
-    pC->m_Codewords = temp;
-    pC->m_iElementArraySize = pC->m_iNumEntries;
     pC->m_iNumEntries = nKeepCnt;
+    pModel.Shrink(pC);
   }
 
   pC->m_iTotal = 0;
-  free(aKeep);
 
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------------------//
 //										Clear non-essential codewords of the given codebook (for cache-book)				               //
 //-----------------------------------------------------------------------------------------------------------------------------------------//
-void MultiCue::C_ClearNonEssentialEntriesForCachebook(uchar bLandmark, short nReferredIdx, short nClearNum, ColorModel* pCachebook) {
+void MultiCue::C_ClearNonEssentialEntriesForCachebook(uchar bLandmark, short nReferredIdx, short nClearNum, point pos, ColorModelStore& pCachebook) {
   int i;
 
-  if (pCachebook->m_iTotal < nClearNum) {
-    for (i = 0; i < pCachebook->m_iNumEntries; i++) {
-      if (bLandmark == 255 && i == nReferredIdx) pCachebook->m_Codewords[i]->m_iMNRL = 0;
-      else pCachebook->m_Codewords[i]->m_iMNRL++;
+  ColorModel* c = pCachebook.GetBook(pos.m_nY * g_iRWidth + pos.m_nX);
+  ColorCodeword* aCodewords = pCachebook.GetCodewords(c);
+
+  if (c->m_iTotal < nClearNum) {
+    for (i = 0; i < c->m_iNumEntries; i++) {
+      if (bLandmark == 255 && i == nReferredIdx) aCodewords[i].m_iMNRL = 0;
+      else aCodewords[i].m_iMNRL++;
     }
 
-    pCachebook->m_iTotal++;
+    c->m_iTotal++;
   }
 
   else {
     int iStaleThreshold = 5;
+    short nKeepCnt = 0;
 
-    int* aKeep;
-    short nKeepCnt;
-
-    aKeep = (int*)malloc(sizeof(int)*pCachebook->m_iNumEntries);
-    nKeepCnt = 0;
-
-    for (i = 0; i < pCachebook->m_iNumEntries; i++) {
-      if (pCachebook->m_Codewords[i]->m_iMNRL < iStaleThreshold) {
-        aKeep[i] = 1;
-        nKeepCnt++;
-      }
-      else aKeep[i] = 0;
-    }
-
-    pCachebook->m_iElementArraySize = nKeepCnt + 2;
-    if (pCachebook->m_iElementArraySize < 3) pCachebook->m_iElementArraySize = 3;
-
-    ColorCodeword** temp = (ColorCodeword**)malloc(sizeof(ColorCodeword*)*pCachebook->m_iElementArraySize);
-    nKeepCnt = 0;
-
-    for (i = 0; i < pCachebook->m_iNumEntries; i++) {
-      if (aKeep[i] == 1) {
-        temp[nKeepCnt] = pCachebook->m_Codewords[i];
-        temp[nKeepCnt]->m_iMNRL = 0;
+    for (i = 0; i < c->m_iNumEntries; i++) {
+      if (aCodewords[i].m_iMNRL < iStaleThreshold) {
+        aCodewords[nKeepCnt] = aCodewords[i];
+        aCodewords[nKeepCnt].m_iMNRL = 0;
         nKeepCnt++;
       }
-      else {
-        free(pCachebook->m_Codewords[i]);
-      }
-
     }
 
     //ending..
-    free(pCachebook->m_Codewords);
-    pCachebook->m_Codewords = temp;
-    pCachebook->m_iNumEntries = nKeepCnt;
-    pCachebook->m_iTotal = 0;
-
-    free(aKeep);
+    c->m_iNumEntries = nKeepCnt;
+    c->m_iTotal = 0;
+    pCachebook.Shrink(c);
   }
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------------------//
 //														the ghost-region absorption function										       //
 //-----------------------------------------------------------------------------------------------------------------------------------------//
-void MultiCue::C_Absorption(int iAbsorbCnt, point pos, short** aContinuCnt, short** aRefferedIndex, ColorModel* pModel, ColorModel* pCache) {
+void MultiCue::C_Absorption(int iAbsorbCnt, point pos, short* aContinuCnt, short* aRefferedIndex, ColorModelStore& pModel, ColorModelStore& pCache) {
+
+  int iPixel = pos.m_nY * g_iRWidth + pos.m_nX;
 
   //set iLeavingIndex
-  if (aContinuCnt[pos.m_nY][pos.m_nX] < iAbsorbCnt) return;
+  if (aContinuCnt[iPixel] < iAbsorbCnt) return;
 
-  int iLeavingIndex = aRefferedIndex[pos.m_nY][pos.m_nX];
+  int iLeavingIndex = aRefferedIndex[iPixel];
+
+  ColorModel* m = pModel.GetBook(iPixel);
+  ColorModel* c = pCache.GetBook(iPixel);
 
   //array expansion
-  if (pModel->m_iElementArraySize == pModel->m_iNumEntries) {
-    pModel->m_iElementArraySize = pModel->m_iElementArraySize + 5;
-    ColorCodeword** temp = (ColorCodeword**)malloc(sizeof(ColorCodeword*)*pModel->m_iElementArraySize);
-    for (int i = 0; i < pModel->m_iNumEntries; i++) temp[i] = pModel->m_Codewords[i];
-    free(pModel->m_Codewords);
-    pModel->m_Codewords = temp;
-  }
+  ColorCodeword* aModelCodewords = pModel.Reserve(m);
+  ColorCodeword* aCacheCodewords = pCache.GetCodewords(c);
 
   //movement from the cache-book to the codebook
-  pModel->m_Codewords[pModel->m_iNumEntries] = pCache->m_Codewords[iLeavingIndex];
+  aModelCodewords[m->m_iNumEntries] = aCacheCodewords[iLeavingIndex];
 
-  pModel->m_iTotal = pModel->m_iTotal + 1;
+  m->m_iTotal = m->m_iTotal + 1;
 
-  pModel->m_Codewords[pModel->m_iNumEntries]->m_iT_first_time = pModel->m_iTotal;
-  pModel->m_Codewords[pModel->m_iNumEntries]->m_iT_last_time = pModel->m_iTotal;
-  pModel->m_Codewords[pModel->m_iNumEntries]->m_iMNRL = pModel->m_iTotal - 1;
+  aModelCodewords[m->m_iNumEntries].m_iT_first_time = m->m_iTotal;
+  aModelCodewords[m->m_iNumEntries].m_iT_last_time = m->m_iTotal;
+  aModelCodewords[m->m_iNumEntries].m_iMNRL = m->m_iTotal - 1;
 
-  pModel->m_iNumEntries = pModel->m_iNumEntries + 1;
+  m->m_iNumEntries = m->m_iNumEntries + 1;
 
-  int k = 0;
-  ColorCodeword **pTempCache = (ColorCodeword**)malloc(sizeof(ColorCodeword*)*pCache->m_iElementArraySize);
-  for (int i = 0; i < pCache->m_iNumEntries; i++) {
-    if (i == iLeavingIndex) continue;
-    else {
-      pTempCache[k] = pCache->m_Codewords[i];
-      k++;
-    }
-  }
-  free(pCache->m_Codewords);
-  pCache->m_Codewords = pTempCache;
-  pCache->m_iNumEntries = k;
+  for (int i = iLeavingIndex + 1; i < c->m_iNumEntries; i++) aCacheCodewords[i - 1] = aCacheCodewords[i];
+  c->m_iNumEntries = c->m_iNumEntries - 1;
+  pCache.Shrink(c);
 }
 
 #endif
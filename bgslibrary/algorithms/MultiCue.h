@@ -13,6 +13,8 @@
 #include <opencv2/opencv.hpp>
 
 #include "IBGS.h"
+#include "../utils/AlignedBuffer.h"
+#include "../utils/ThreadPool.h"
 
 //------------------------------------Structure Lists-------------------------------------//
 namespace bgslibrary
@@ -54,16 +56,6 @@ namespace bgslibrary
         float m_fMean;											//mean of the codeword
       };
 
-      struct TextureModel {
-        TextureCodeword** m_Codewords;							//the texture-codeword Array
-
-        int m_iTotal;											//# of learned samples after the last clear process
-        int m_iElementArraySize;								//the array size of m_Codewords
-        int m_iNumEntries;										//# of codewords
-
-        BOOL m_bID;												//id=1 --> background model, id=0 --> cachebook
-      };
-
       //3) Color Model Structure
       struct ColorCodeword {
         int m_iMNRL;											//the maximum negative run-length
@@ -74,14 +66,129 @@ namespace bgslibrary
 
       };
 
-      struct ColorModel {
-        ColorCodeword** m_Codewords;							//the color-codeword Array
-
+      //4) Codebook Structure (the texture and color models share it)
+      struct Codebook {
         int m_iTotal;											//# of learned samples after the last clear process
-        int m_iElementArraySize;								//the array size of m_Codewords
         int m_iNumEntries;										//# of codewords
+        int m_iCapacity;										//# of codewords fitting in the current storage
+        int m_iOverflow;										//offset of the codewords in the overflow arena, -1 while they are in the slab
+
+        BOOL m_bID;												//id=1 --> background model, id=0 --> cachebook
+      };
 
-        BOOL m_bID;												//id=1 --> background model, id=0 --> cachebookk
+      typedef Codebook TextureModel;
+      typedef Codebook ColorModel;
+
+      //5) Codebook Store
+      //The codebooks of a model (one per pixel, or per pixel and neighbor for the texture model) are stored in one
+      //flat array, and their codewords by value in fixed-size slabs, one per codebook. A codebook outgrowing its
+      //slab moves to a block of the overflow arena of its image row (twice, four times... the slab size), and moves
+      //back once a clear leaves it small enough. Freed blocks are recycled per size class. The codewords keep the
+      //order they had in the original per-codeword allocations.
+      template<typename Codeword>
+      class CodebookStore {
+      public:
+        CodebookStore() : m_iBooksPerRow(0), m_iSlabSize(0) {}
+
+        void Allocate(int iRows, int iBooksPerRow, int iSlabSize, BOOL bID) {
+          m_iBooksPerRow = iBooksPerRow;
+          m_iSlabSize = iSlabSize;
+
+          size_t nBooks = (size_t)iRows * iBooksPerRow;
+          m_aBooks.allocate(nBooks);
+          m_aSlabs.allocate(nBooks * iSlabSize);
+          for (size_t n = 0; n < nBooks; n++) {
+            m_aBooks[n].m_iTotal = 0;
+            m_aBooks[n].m_iNumEntries = 0;
+            m_aBooks[n].m_iCapacity = iSlabSize;
+            m_aBooks[n].m_iOverflow = -1;
+            m_aBooks[n].m_bID = bID;
+          }
+          m_aArenas.assign(iRows, OverflowArena());
+        }
+
+        void Release() {
+          m_aBooks.release();
+          m_aSlabs.release();
+          std::vector<OverflowArena>().swap(m_aArenas);
+        }
+
+        Codebook* GetBook(size_t nIndex) { return &m_aBooks[nIndex]; }
+
+        Codeword* GetCodewords(const Codebook* pBook) {
+          size_t nIndex = pBook - m_aBooks.data();
+          if (pBook->m_iOverflow < 0) return m_aSlabs.data() + nIndex * m_iSlabSize;
+          return &m_aArenas[nIndex / m_iBooksPerRow].m_aCodewords[pBook->m_iOverflow];
+        }
+
+        //returns the codewords of pBook, with room for one more
+        Codeword* Reserve(Codebook* pBook) {
+          if (pBook->m_iNumEntries < pBook->m_iCapacity) return GetCodewords(pBook);
+
+          OverflowArena& arena = m_aArenas[(pBook - m_aBooks.data()) / m_iBooksPerRow];
+          int iCapacity = pBook->m_iCapacity * 2;
+          int iOffset = AcquireBlock(arena, iCapacity);
+
+          //the arena may have moved, so the old codewords are looked up after the acquisition
+          const Codeword* pOld = GetCodewords(pBook);
+          std::copy(pOld, pOld + pBook->m_iNumEntries, arena.m_aCodewords.begin() + iOffset);
+          if (pBook->m_iOverflow >= 0) ReleaseBlock(arena, pBook->m_iOverflow, pBook->m_iCapacity);
+
+          pBook->m_iOverflow = iOffset;
+          pBook->m_iCapacity = iCapacity;
+          return &arena.m_aCodewords[iOffset];
+        }
+
+        //moves pBook back to its slab when its codewords fit in it
+        void Shrink(Codebook* pBook) {
+          if (pBook->m_iOverflow < 0 || pBook->m_iNumEntries > m_iSlabSize) return;
+
+          size_t nIndex = pBook - m_aBooks.data();
+          OverflowArena& arena = m_aArenas[nIndex / m_iBooksPerRow];
+          typename std::vector<Codeword>::const_iterator it = arena.m_aCodewords.begin() + pBook->m_iOverflow;
+          std::copy(it, it + pBook->m_iNumEntries, m_aSlabs.data() + nIndex * m_iSlabSize);
+          ReleaseBlock(arena, pBook->m_iOverflow, pBook->m_iCapacity);
+
+          pBook->m_iOverflow = -1;
+          pBook->m_iCapacity = m_iSlabSize;
+        }
+
+      private:
+        struct OverflowArena {
+          std::vector<Codeword> m_aCodewords;
+          std::vector<std::vector<int> > m_aFreeBlocks;		//offsets of the free blocks, per size class
+        };
+
+        //blocks of class c hold (m_iSlabSize << (c + 1)) codewords
+        size_t GetSizeClass(int iCapacity) const {
+          size_t c = 0;
+          while ((m_iSlabSize << (c + 1)) < iCapacity) c++;
+          return c;
+        }
+
+        int AcquireBlock(OverflowArena& arena, int iCapacity) {
+          size_t c = GetSizeClass(iCapacity);
+          if (c < arena.m_aFreeBlocks.size() && !arena.m_aFreeBlocks[c].empty()) {
+            int iOffset = arena.m_aFreeBlocks[c].back();
+            arena.m_aFreeBlocks[c].pop_back();
+            return iOffset;
+          }
+          int iOffset = (int)arena.m_aCodewords.size();
+          arena.m_aCodewords.resize(iOffset + iCapacity);
+          return iOffset;
+        }
+
+        void ReleaseBlock(OverflowArena& arena, int iOffset, int iCapacity) {
+          size_t c = GetSizeClass(iCapacity);
+          if (c >= arena.m_aFreeBlocks.size()) arena.m_aFreeBlocks.resize(c + 1);
+          arena.m_aFreeBlocks[c].push_back(iOffset);
+        }
+
+        int m_iBooksPerRow;
+        int m_iSlabSize;
+        AlignedBuffer<Codebook> m_aBooks;
+        AlignedBuffer<Codeword> m_aSlabs;
+        std::vector<OverflowArena> m_aArenas;
       };
     }
   }
@@ -104,6 +211,8 @@ namespace bgslibrary
       typedef bgslibrary::algorithms::multiCue::TextureModel TextureModel;
       typedef bgslibrary::algorithms::multiCue::BoundingBoxInfo BoundingBoxInfo;
       typedef bgslibrary::algorithms::multiCue::ColorModel ColorModel;
+      typedef bgslibrary::algorithms::multiCue::CodebookStore<bgslibrary::algorithms::multiCue::TextureCodeword> TextureModelStore;
+      typedef bgslibrary::algorithms::multiCue::CodebookStore<bgslibrary::algorithms::multiCue::ColorCodeword> ColorModelStore;
       typedef bgslibrary::algorithms::multiCue::BOOL BOOL;
 
       MultiCue();
@@ -125,6 +234,10 @@ namespace bgslibrary
       short g_nTextureTrainVolRange;								//the codebook size factor for texture models.		(The parameter k in the paper)
       short g_nColorTrainVolRange;								//the codebook size factor for color models.		(The parameter eta_1 in the paper)
 
+      int g_iParallelBands;										//# of row bands processed concurrently by the _Par stages (0: one per hardware thread)
+      BOOL g_bPipelineEnable;										//If TRUE, the model update of a frame overlaps with the pre-processing of the next one
+      //(the update then finishes after process() returns: the stats record the part of it that the next frame waits for)
+
       //----------------------------------------------------
       //	Implemented Function Lists
       //----------------------------------------------------
@@ -134,13 +247,13 @@ namespace bgslibrary
 
       void PreProcessing(IplImage* frame);
       void ReduceImageSize(IplImage* SrcImage, IplImage* DstImage);
-      void GaussianFiltering(IplImage* frame, uchar*** aFilteredFrame);
-      void BGR2HSVxyz_Par(uchar*** aBGR, uchar*** aXYZ);
+      void GaussianFiltering(IplImage* frame, uchar* aFilteredFrame);
+      void BGR2HSVxyz_Par(const uchar* aBGR, uchar* aXYZ);
 
       void BackgroundModeling_Par(IplImage* frame);
       void ForegroundExtraction(IplImage* frame);
-      void CreateLandmarkArray_Par(float fConfThre, short nTrainVolRange, float**aConfMap, int iNehborNum, uchar*** aXYZ,
-        point*** aNeiDir, TextureModel**** TModel, ColorModel*** CModel, uchar**aLandmarkArr);
+      void CreateLandmarkArray_Par(float fConfThre, short nTrainVolRange, float**aConfMap, int iNehborNum, const uchar* aXYZ,
+        const point* aNeiDir, TextureModelStore& TModel, ColorModelStore& CModel, uchar**aLandmarkArr);
 
       void PostProcessing(IplImage* frame);
       void MorphologicalOpearions(uchar** aInput, uchar** aOutput, double dThresholdRatio, int iMaskSize, int iWidth, int iHeight);
@@ -154,25 +267,28 @@ namespace bgslibrary
       void RemovingInvalidForeRegions(uchar** aResForeMap, BoundingBoxInfo* BoundBoxInfo);
 
       void UpdateModel_Par();
+      void StartModelUpdate();
+      void WaitForModelUpdate();
+      void ForEachBand(int iRowBegin, int iRowEnd, const std::function<void(int, int)>& oBandFunc);
       void GetEnlargedMap(float** aOriginMap, float** aEnlargedMap);
 
       //--2) Texture Model Related Functions
       void T_AllocateTextureModelRelatedMemory();
       void T_ReleaseTextureModelRelatedMemory();
-      void T_SetNeighborDirection(point*** aNeighborPos);
-      void T_ModelConstruction(short nTrainVolRange, float fLearningRate, uchar*** aXYZ, point center, point* aNei, TextureModel** aModel);
-      void T_ClearNonEssentialEntries(short nClearNum, TextureModel** aModel);
-      void T_ClearNonEssentialEntriesForCachebook(uchar bLandmark, short* nReferredIdxArr, short nClearNum, TextureModel** pCachebook);
-      void T_GetConfidenceMap_Par(uchar*** aXYZ, float** aTextureMap, point*** aNeiDirArr, TextureModel**** aModel);
-      void T_Absorption(int iAbsorbCnt, point pos, short*** aContinuCnt, short*** aRefferedIndex, TextureModel** pModel, TextureModel** pCache);
+      void T_SetNeighborDirection(point* aNeighborPos);
+      void T_ModelConstruction(short nTrainVolRange, float fLearningRate, const uchar* aXYZ, point center, const point* aNei, TextureModelStore& aModel);
+      void T_ClearNonEssentialEntries(short nClearNum, point pos, TextureModelStore& aModel);
+      void T_ClearNonEssentialEntriesForCachebook(uchar bLandmark, const short* nReferredIdxArr, short nClearNum, point pos, TextureModelStore& pCachebook);
+      void T_GetConfidenceMap_Par(const uchar* aXYZ, float** aTextureMap, const point* aNeiDirArr, TextureModelStore& aModel);
+      void T_Absorption(int iAbsorbCnt, point pos, short* aContinuCnt, short* aRefferedIndex, TextureModelStore& pModel, TextureModelStore& pCache);
 
       //--3) Color Model Related Functions
       void C_AllocateColorModelRelatedMemory();
       void C_ReleaseColorModelRelatedMemory();
-      void C_CodebookConstruction(uchar* aP, int iPosX, int iPosY, short nTrainVolRange, float fLearningRate, ColorModel* pC);
-      void C_ClearNonEssentialEntries(short nClearNum, ColorModel* pModel);
-      void C_ClearNonEssentialEntriesForCachebook(uchar bLandmark, short nReferredIdx, short nClearNum, ColorModel* pCachebook);
-      void C_Absorption(int iAbsorbCnt, point pos, short** aContinuCnt, short** aRefferedIndex, ColorModel* pModel, ColorModel* pCache);
+      void C_CodebookConstruction(const uchar* aP, int iPosX, int iPosY, short nTrainVolRange, float fLearningRate, ColorModelStore& pC);
+      void C_ClearNonEssentialEntries(short nClearNum, point pos, ColorModelStore& pModel);
+      void C_ClearNonEssentialEntriesForCachebook(uchar bLandmark, short nReferredIdx, short nClearNum, point pos, ColorModelStore& pCachebook);
+      void C_Absorption(int iAbsorbCnt, point pos, short* aContinuCnt, short* aRefferedIndex, ColorModelStore& pModel, ColorModelStore& pCache);
 
       //----------------------------------------------------
       //	Implemented Variable Lists
@@ -198,21 +314,23 @@ namespace bgslibrary
       BOOL g_bForegroundMapEnable;				//TRUE only when BGS is successful
 
       IplImage* g_ResizedFrame;					//reduced size of frame (For efficiency, the reduced size of frames are processed)
-      uchar*** g_aGaussFilteredFrame;
-      uchar*** g_aXYZFrame;
+      AlignedBuffer<uchar> g_aGaussFilteredFrame;	//BGR, 3 bytes per pixel, row after row
+      AlignedBuffer<uchar> g_aXYZFrame;			//XYZ, 3 bytes per pixel, row after row
+      AlignedBuffer<uchar> g_aNextXYZFrame;		//the pre-processing output, swapped with g_aXYZFrame once the model update is done
       uchar** g_aLandmarkArray;					//the landmark map
       uchar** g_aResizedForeMap;					//the resized foreground map
       uchar** g_aForegroundMap;					//the final foreground map
       BOOL** g_aUpdateMap;						//the location map of update candidate pixels
+      BOOL** g_aGhostMap;							//the location map of ghost-region pixels to add to the background model
 
       BoundingBoxInfo* g_BoundBoxInfo;			//the array of bounding boxes of each foreground blob
 
                                             //--2) Texture Model Related
-      TextureModel**** g_TextureModel;			//the texture background model
-      TextureModel**** g_TCacheBook;				//the texture cache-book
-      short*** g_aTReferredIndex;					//To handle cache-book
-      short*** g_aTContinuousCnt;					//To handle cache-book
-      point*** g_aNeighborDirection;
+      TextureModelStore g_TextureModel;			//the texture background model (g_nNeighborNum codebooks per pixel)
+      TextureModelStore g_TCacheBook;				//the texture cache-book
+      AlignedBuffer<short> g_aTReferredIndex;		//To handle cache-book (g_nNeighborNum values per pixel)
+      AlignedBuffer<short> g_aTContinuousCnt;		//To handle cache-book (g_nNeighborNum values per pixel)
+      AlignedBuffer<point> g_aNeighborDirection;	//g_nNeighborNum neighbors per pixel
       float**g_aTextureConfMap;					//the texture confidence map
 
       short g_nNeighborNum;						//# of neighborhoods
@@ -220,10 +338,15 @@ namespace bgslibrary
       short g_nBoundarySize;
 
       //--3) Texture Model Related
-      ColorModel*** g_ColorModel;					//the color background model
-      ColorModel*** g_CCacheBook;					//the color cache-book
-      short** g_aCReferredIndex;					//To handle cache-book
-      short** g_aCContinuousCnt;					//To handle cache-book
+      ColorModelStore g_ColorModel;				//the color background model
+      ColorModelStore g_CCacheBook;				//the color cache-book
+      AlignedBuffer<short> g_aCReferredIndex;		//To handle cache-book
+      AlignedBuffer<short> g_aCContinuousCnt;		//To handle cache-book
+
+      //--4) Parallel Processing Related
+      std::unique_ptr<ThreadPool> g_pBandThreadPool;		//runs all the row bands but the first one
+      std::unique_ptr<ThreadPool> g_pPipelineThread;		//runs the model update of the last frame
+      std::future<void> g_ModelUpdate;					//valid while that update is pending
     };
 
     bgs_register(MultiCue);
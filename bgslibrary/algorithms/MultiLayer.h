@@ -76,6 +76,7 @@ namespace bgslibrary
 
       void setStatus(Status status);
       void process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img_bgmodel);
+      bool usesSharedRandom() const { return true; }
 
     private:
       void finish();
@@ -9,7 +9,8 @@ PAWCS::PAWCS() :
   nDescDistThresholdOffset(lbsp::BGSPAWCS_DEFAULT_DESC_DIST_THRESHOLD_OFFSET),
   nMinColorDistThreshold(lbsp::BGSPAWCS_DEFAULT_MIN_COLOR_DIST_THRESHOLD),
   nMaxNbWords(lbsp::BGSPAWCS_DEFAULT_MAX_NB_WORDS),
-  nSamplesForMovingAvgs(lbsp::BGSPAWCS_DEFAULT_N_SAMPLES_FOR_MV_AVGS)
+  nSamplesForMovingAvgs(lbsp::BGSPAWCS_DEFAULT_N_SAMPLES_FOR_MV_AVGS),
+  nDownSampleFactor(1)
 {
   debug_construction(PAWCS);
   initLoadSaveConfig(algorithmName);
@@ -30,12 +31,27 @@ void PAWCS::process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img_
       fRelLBSPThreshold, nDescDistThresholdOffset, nMinColorDistThreshold,
       nMaxNbWords, nSamplesForMovingAvgs);
 
-    pPAWCS->initialize(img_input, cv::Mat(img_input.size(), CV_8UC1, cv::Scalar_<uchar>(255)));
+    pPAWCS->setRandomSeed(randomSeed);
+    if (nDownSampleFactor > 1) {
+      pRefiner.reset(new lbsp::MultiResolutionRefiner(nDownSampleFactor,
+        [this](const cv::Mat &img_model_input, int x, int y, const uchar *color) { return pPAWCS->isForegroundPixel(img_model_input, x, y, color); }));
+      const cv::Mat &img_model_input = pRefiner->downSample(img_input);
+      pPAWCS->initialize(img_model_input, cv::Mat(img_model_input.size(), CV_8UC1, cv::Scalar_<uchar>(255)));
+    }
+    else
+      pPAWCS->initialize(img_input, cv::Mat(img_input.size(), CV_8UC1, cv::Scalar_<uchar>(255)));
     firstTime = false;
   }
 
-  pPAWCS->apply(img_input, img_foreground);
-  pPAWCS->getBackgroundImage(img_background);
+  if (pRefiner) {
+    pPAWCS->apply(pRefiner->downSample(img_input), img_model_foreground);
+    pPAWCS->getBackgroundImage(img_model_background);
+    pRefiner->upSample(img_input, img_model_foreground, img_model_background, img_foreground, img_background);
+  }
+  else {
+    pPAWCS->apply(img_input, img_foreground);
+    pPAWCS->getBackgroundImage(img_background);
+  }
 
 #ifndef MEX_COMPILE_FLAG
   if (showOutput) {
@@ -54,6 +70,7 @@ void PAWCS::save_config(cv::FileStorage &fs) {
   fs << "nMinColorDistThreshold" << nMinColorDistThreshold;
   fs << "nMaxNbWords" << nMaxNbWords;
   fs << "nSamplesForMovingAvgs" << nSamplesForMovingAvgs;
+  fs << "nDownSampleFactor" << nDownSampleFactor;
   fs << "showOutput" << showOutput;
 }
 
@@ -63,5 +80,6 @@ void PAWCS::load_config(cv::FileStorage &fs) {
   fs["nMinColorDistThreshold"] >> nMinColorDistThreshold;
   fs["nMaxNbWords"] >> nMaxNbWords;
   fs["nSamplesForMovingAvgs"] >> nSamplesForMovingAvgs;
+  fs["nDownSampleFactor"] >> nDownSampleFactor;
   fs["showOutput"] >> showOutput;
 }
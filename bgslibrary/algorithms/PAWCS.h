@@ -1,7 +1,10 @@
 #pragma once
 
+#include <memory>
+
 #include "IBGS.h"
 #include "LBSP/BackgroundSubtractorPAWCS.h"
+#include "LBSP/MultiResolutionRefiner.h"
 
 namespace bgslibrary
 {
@@ -11,12 +14,19 @@ namespace bgslibrary
     {
     private:
       lbsp::BackgroundSubtractorPAWCS* pPAWCS;
+      std::unique_ptr<lbsp::MultiResolutionRefiner> pRefiner;
 
       float fRelLBSPThreshold;
       int nDescDistThresholdOffset;
       int nMinColorDistThreshold;
       int nMaxNbWords;
       int nSamplesForMovingAvgs;
+      // the model runs on frames downsampled by this factor (1 = full resolution),
+      // the blob boundaries being refined approximately (see MultiResolutionRefiner)
+      int nDownSampleFactor;
+
+      cv::Mat img_model_foreground;
+      cv::Mat img_model_background;
 
     public:
       PAWCS();
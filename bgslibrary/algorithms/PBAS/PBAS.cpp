@@ -1,5 +1,12 @@
 #include "PBAS.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+
 using namespace bgslibrary::algorithms::pbas;
 
 PBAS::PBAS() : 
@@ -11,7 +18,9 @@ PBAS::PBAS() :
   alpha = 7.0;
   beta = 1.0;
   formerMeanNorm = 0;
+  formerMeanMag = 20;
   width = 0;
+  samplesStride = 0;
 
   //result image
   foregroundValue = 255;
@@ -64,41 +73,52 @@ void PBAS::newInitialization()
 
 PBAS::~PBAS(void)
 {
-  randomN.clear();
-  randomX.clear();
-  randomY.clear();
-  randomMinDist.clear();
-  randomT.clear();
-  randomTN.clear();
-
-  for (int k = 0; k < backgroundModel.size(); ++k)
+}
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+// distances of the current pixel to the samples [0, 4) of the record
+static inline void sampleDistances(const float* magnitudes, const uchar* colors, int stride, int chans,
+  const float* featureM, const float* featureC, float magScale, float beta, float* norm, float* dist)
+{
+  const __m128i zero = _mm_setzero_si128();
+  __m128 normSq = _mm_setzero_ps();
+  __m128 colorSq = _mm_setzero_ps();
+  for (int z = 0; z < chans; ++z)
   {
-    if (chans == 1)
-    {
-      backgroundModel.at(k).at(0).release();
-      backgroundModel.at(k).at(1).release();
-    }
-    else
+    __m128 d = _mm_sub_ps(_mm_load_ps(magnitudes + z * stride), _mm_set1_ps(featureM[z]));
+    normSq = _mm_add_ps(normSq, _mm_mul_ps(d, d));
+
+    int bytes;
+    memcpy(&bytes, colors + z * stride, sizeof(bytes));
+    __m128i c = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+    d = _mm_sub_ps(_mm_cvtepi32_ps(c), _mm_set1_ps(featureC[z]));
+    colorSq = _mm_add_ps(colorSq, _mm_mul_ps(d, d));
+  }
+  // with one channel, the original distance uses the squared magnitude difference
+  __m128 n = (chans == 3) ? _mm_sqrt_ps(normSq) : normSq;
+  __m128 distance = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(magScale), n), _mm_mul_ps(_mm_set1_ps(beta), _mm_sqrt_ps(colorSq)));
+  _mm_storeu_ps(norm, n);
+  _mm_storeu_ps(dist, distance);
+}
+#else
+static inline void sampleDistances(const float* magnitudes, const uchar* colors, int stride, int chans,
+  const float* featureM, const float* featureC, float magScale, float beta, float* norm, float* dist)
+{
+  for (int k = 0; k < 4; ++k)
+  {
+    float normSq = 0, colorSq = 0;
+    for (int z = 0; z < chans; ++z)
     {
-      backgroundModel.at(k).at(0).release();
-      backgroundModel.at(k).at(1).release();
-      backgroundModel.at(k).at(2).release();
-
-      backgroundModel.at(k).at(3).release();
-      backgroundModel.at(k).at(4).release();
-      backgroundModel.at(k).at(5).release();
+      float d = magnitudes[z * stride + k] - featureM[z];
+      normSq += d * d;
+      d = (float)colors[z * stride + k] - featureC[z];
+      colorSq += d * d;
     }
+    norm[k] = (chans == 3) ? std::sqrt(normSq) : normSq;
+    dist[k] = magScale * norm[k] + beta * std::sqrt(colorSq);
   }
-
-  backgroundModel.clear();
-  meanMinDist.release();
-
-  actualR.release();
-  actualT.release();
-
-  sobelX.release();
-  sobelY.release();
 }
+#endif
 
 bool PBAS::process(cv::Mat* input, cv::Mat* output)
 {
@@ -115,102 +135,88 @@ bool PBAS::process(cv::Mat* input, cv::Mat* output)
     }
   }
 
-  //iniate the background model
-  init(input);
+  //calculate features
+  calculateFeatures(input);
 
-  resultMap = new cv::Mat(input->rows, input->cols, CV_8UC1);
+  //iniate the background model
+  init();
 
-  //calculate features
-  calculateFeatures(&currentFeatures, input);
+  output->create(input->rows, input->cols, CV_8UC1);
 
   //set sumMagnitude to zero at beginning and then sum up in the loop
   sumMagnitude = 0;
   long glCounterFore = 0;
   isMove = false;
 
+  const int* randN = randomN.data();
+  const int* randX = randomX.data();
+  const int* randY = randomY.data();
+  const int* randT = randomT.data();
+  const int* randTN = randomTN.data();
+  float* samplesM = modelMagnitudes.data();
+  uchar* samplesC = modelColors.data();
+  const size_t recordSize = (size_t)chans * samplesStride;
+  const float magScale = (float)(alpha / formerMeanMag);
+  const float colorScale = (float)beta;
+
   //Here starts the whole processing of each pixel of the image
   // for each pixel
-  for (int j = 0; j < resultMap->rows; ++j)
+  for (int j = 0; j < height; ++j)
   {
-    resultMap_Pt = resultMap->ptr<uchar>(j);
-    currentFeaturesM_Pt.clear();
-    currentFeaturesC_Pt.clear();
-    std::vector<float*> fT;
-    std::vector<uchar*> uT;
-    B_Mag_Pts.clear();
-    B_Col_Pts.clear();
-
+    uchar* resultMap_Pt = output->ptr<uchar>(j);
+    const float* currentFeaturesM_Pt[3];
+    const uchar* currentFeaturesC_Pt[3];
     for (int z = 0; z < chans; ++z)
     {
-      currentFeaturesM_Pt.push_back(currentFeatures.at(z).ptr<float>(j));
-      currentFeaturesC_Pt.push_back(currentFeatures.at(z + chans).ptr<uchar>(j));
-
-      B_Mag_Pts.push_back(fT);
-
-      B_Col_Pts.push_back(uT);
+      currentFeaturesM_Pt[z] = currentFeatures[z].ptr<float>(j);
+      currentFeaturesC_Pt[z] = currentFeatures[z + chans].ptr<uchar>(j);
     }
 
     meanMinDist_Pt = meanMinDist.ptr<float>(j);
     actualR_Pt = actualR.ptr<float>(j);
     actualT_Pt = actualT.ptr<float>(j);
 
-    for (int k = 0; k < runs; ++k)
+    for (int i = 0; i < width; ++i)
     {
+      float* B_Mag = samplesM + ((size_t)j * width + i) * recordSize;
+      uchar* B_Col = samplesC + ((size_t)j * width + i) * recordSize;
+      float featureM[3], featureC[3];
       for (int z = 0; z < chans; ++z)
       {
-        B_Mag_Pts.at(z).push_back(backgroundModel.at(k).at(z).ptr<float>(j));
-        B_Col_Pts.at(z).push_back(backgroundModel.at(k).at(z + chans).ptr<uchar>(j));
+        featureM[z] = currentFeaturesM_Pt[z][i];
+        featureC[z] = (float)currentFeaturesC_Pt[z][i];
       }
-    }
 
-    for (int i = 0; i < resultMap->cols; ++i)
-    {
       //Compare each pixel to in the worst runtime-case each background model
+      //the distances are computed 4 samples at a time, then used in the same order
       int count = 0;
       int index = 0;
 
-      double norm = 0.0;
-      double dist = 0.0;
       double minDist = 1000.0;
       int entry = randomGenerator.uniform(3, countOfRandomNumb - 4);
 
       do
       {
-        if (chans == 3)
-        {
-          norm = sqrt(
-            (((double)B_Mag_Pts.at(0).at(index)[i] - ((double)*currentFeaturesM_Pt.at(0)))*((double)B_Mag_Pts.at(0).at(index)[i] - ((double)*currentFeaturesM_Pt.at(0)))) +
-            (((double)B_Mag_Pts.at(1).at(index)[i] - ((double)*currentFeaturesM_Pt.at(1)))*((double)B_Mag_Pts.at(1).at(index)[i] - ((double)*currentFeaturesM_Pt.at(1)))) +
-            (((double)B_Mag_Pts.at(2).at(index)[i] - ((double)*currentFeaturesM_Pt.at(2)))*((double)B_Mag_Pts.at(2).at(index)[i] - ((double)*currentFeaturesM_Pt.at(2))))
-          );
-
-          dist = sqrt(
-            (((double)B_Col_Pts.at(0).at(index)[i] - ((double)*currentFeaturesC_Pt.at(0)))*((double)B_Col_Pts.at(0).at(index)[i] - ((double)*currentFeaturesC_Pt.at(0)))) +
-            (((double)B_Col_Pts.at(1).at(index)[i] - ((double)*currentFeaturesC_Pt.at(1)))*((double)B_Col_Pts.at(1).at(index)[i] - ((double)*currentFeaturesC_Pt.at(1)))) +
-            (((double)B_Col_Pts.at(2).at(index)[i] - ((double)*currentFeaturesC_Pt.at(2)))*((double)B_Col_Pts.at(2).at(index)[i] - ((double)*currentFeaturesC_Pt.at(2))))
-          );
-        }
-        else
-        {
-          norm = abs((((double)B_Mag_Pts.at(0).at(index)[i] -
-            ((double)*currentFeaturesM_Pt.at(0)))*((double)B_Mag_Pts.at(0).at(index)[i] - ((double)*currentFeaturesM_Pt.at(0)))));
+        float norm[4], dist[4];
+        sampleDistances(B_Mag + index, B_Col + index, samplesStride, chans, featureM, featureC, magScale, colorScale, norm, dist);
 
-          dist = abs(((double)B_Col_Pts.at(0).at(index)[i] - ((double)*currentFeaturesC_Pt.at(0))));
-        }
-        dist = ((double)alpha*(norm / formerMeanMag) + beta*dist);
-
-        if ((dist < *actualR_Pt))
-        {
-          ++count;
-          if (minDist > dist)
-            minDist = dist;
-        }
-        else
+        for (int k = 0, last = std::min(index + 4, runs); index < last; ++k)
         {
-          sumMagnitude += (double)(norm);
-          ++glCounterFore;
+          if ((dist[k] < *actualR_Pt))
+          {
+            ++count;
+            if (minDist > dist[k])
+              minDist = dist[k];
+          }
+          else
+          {
+            sumMagnitude += (double)(norm[k]);
+            ++glCounterFore;
+          }
+          ++index;
+          if (count >= Raute_min)
+            break;
         }
-        ++index;
       } while ((count < Raute_min) && (index < runs));
 
 
@@ -238,34 +244,34 @@ bool PBAS::process(cv::Mat* input, cv::Mat* output)
         {
           //Update current pixel
           //check if random numer is smaller than ratio
-          if (randomT.at(entry) < ratio)
+          if (randT[entry] < ratio)
           {
             // replace randomly chosen sample
-            int rand = randomN.at(entry + 1); //randomGenerator.uniform((int)0,(int)N-1);
+            int rand = randN[entry + 1]; //randomGenerator.uniform((int)0,(int)N-1);
             for (int z = 0; z < chans; ++z)
             {
-              B_Mag_Pts.at(z).at(rand)[i] = (float)*currentFeaturesM_Pt.at(z);
-              B_Col_Pts.at(z).at(rand)[i] = (uchar)*currentFeaturesC_Pt.at(z);
-
+              B_Mag[z * samplesStride + rand] = featureM[z];
+              B_Col[z * samplesStride + rand] = currentFeaturesC_Pt[z][i];
             }
 
             *meanMinDist_Pt = ((((float)(N - 1)) * (*meanMinDist_Pt)) + (float)minDist) / ((float)N);
           }
 
           //Update neighboring pixel model
-          if (randomTN.at(entry) < ratio)
+          if (randTN[entry] < ratio)
           {
             //choose neighboring pixel randomly
-            int xNeigh = randomX.at(entry) + i;
-            int yNeigh = randomY.at(entry) + j;
+            int xNeigh = randX[entry] + i;
+            int yNeigh = randY[entry] + j;
             checkValid(&xNeigh, &yNeigh);
 
             // replace randomly chosen sample
-            int rand = randomN.at(entry - 1);
+            int rand = randN[entry - 1];
+            size_t neighbor = ((size_t)yNeigh * width + xNeigh) * recordSize + rand;
             for (int z = 0; z < chans; ++z)
             {
-              (backgroundModel.at(rand)).at(z).at<float>(yNeigh, xNeigh) = currentFeatures.at(z).at<float>(yNeigh, xNeigh);
-              (backgroundModel.at(rand)).at(z + chans).at<uchar>(yNeigh, xNeigh) = currentFeatures.at(z + chans).at<uchar>(yNeigh, xNeigh);
+              samplesM[neighbor + z * samplesStride] = currentFeatures[z].ptr<float>(yNeigh)[xNeigh];
+              samplesC[neighbor + z * samplesStride] = currentFeatures[z + chans].ptr<uchar>(yNeigh)[xNeigh];
             }
           }
         }
@@ -293,20 +299,12 @@ bool PBAS::process(cv::Mat* input, cv::Mat* output)
 
       //jump to next pixel
       ++resultMap_Pt;
-      for (int z = 0; z < chans; ++z)
-      {
-        ++currentFeaturesM_Pt.at(z);
-        ++currentFeaturesC_Pt.at(z);
-      }
-
       ++meanMinDist_Pt;
       ++actualR_Pt;
       ++actualT_Pt;
     }
   }
 
-  resultMap->copyTo(*output);
-
   //if there is no foreground -> no magnitudes fount
   //-> initiate some low value to prevent diving through zero
   double meanMag = sumMagnitude / (double)(glCounterFore + 1); //height*width);
@@ -316,17 +314,17 @@ bool PBAS::process(cv::Mat* input, cv::Mat* output)
   else
     formerMeanMag = 20;
 
-  delete resultMap;
-
-  for (int z = 0; z < chans; ++z)
-  {
-    currentFeatures.at(z + chans).release();
-    currentFeatures.at(z).release();
-  }
-
   return true;
 }
 
+size_t PBAS::getModelSize() const
+{
+  return modelMagnitudes.bytes() + modelColors.bytes()
+    + meanMinDist.total() * meanMinDist.elemSize()
+    + actualR.total() * actualR.elemSize()
+    + actualT.total() * actualT.elemSize();
+}
+
 void PBAS::decisionThresholdRegulator(float* pt, float* meanDist)
 {
   //update R
@@ -387,49 +385,41 @@ void PBAS::checkValid(int *x, int *y)
   }
 }
 
-void PBAS::init(cv::Mat* input)
+void PBAS::init()
 {
   if (runs < N)
   {
-    std::vector<cv::Mat> init;
-    calculateFeatures(&init, input);
-    backgroundModel.push_back(init);
-
-    if (chans == 1)
-    {
-      init.at(0).release();
-      init.at(1).release();
-    }
-    else
+    if (runs == 0)
     {
-      init.at(0).release();
-      init.at(1).release();
-      init.at(2).release();
-      init.at(3).release();
-      init.at(4).release();
-      init.at(5).release();
+      // the N samples are allocated at once, and filled by the first N images
+      samplesStride = (N + 3) / 4 * 4;
+      size_t modelSize = (size_t)width * height * chans * samplesStride;
+      modelMagnitudes.allocate(modelSize);
+      modelColors.allocate(modelSize);
+      std::fill(modelMagnitudes.data(), modelMagnitudes.data() + modelSize, 0.0f);
+      std::fill(modelColors.data(), modelColors.data() + modelSize, (uchar)0);
+
+      meanMinDist.create(height, width, CV_32FC1);
+      meanMinDist.setTo(cv::Scalar::all(0));
+
+      actualR.create(height, width, CV_32FC1);
+      actualT.create(height, width, CV_32FC1);
+      actualR.setTo(cv::Scalar::all(R_lower));
+      actualT.setTo(cv::Scalar::all(T_init));
     }
 
-    init.clear();
-
-    if (runs == 0)
+    // the current features become sample number runs
+    for (int j = 0; j < height; ++j)
     {
-      meanMinDist.create(input->size(), CV_32FC1);
-      meanMinDist = meanMinDist.zeros(input->rows, input->cols, CV_32FC1);
-
-      actualR.create(input->rows, input->cols, CV_32FC1);
-      actualT.create(input->rows, input->cols, CV_32FC1);
-
-      float* ptRs, *ptTs; //, *ptM;
-      for (int rows = 0; rows < actualR.rows; ++rows)
+      for (int z = 0; z < chans; ++z)
       {
-        ptRs = actualR.ptr<float>(rows);
-        ptTs = actualT.ptr<float>(rows);
-
-        for (int cols = 0; cols < actualR.cols; ++cols)
+        const float* magnitudes = currentFeatures[z].ptr<float>(j);
+        const uchar* colors = currentFeatures[z + chans].ptr<uchar>(j);
+        size_t sample = (size_t)j * width * chans * samplesStride + z * samplesStride + runs;
+        for (int i = 0; i < width; ++i, sample += chans * samplesStride)
         {
-          ptRs[cols] = (float)R_lower;
-          ptTs[cols] = (float)T_init;
+          modelMagnitudes[sample] = magnitudes[i];
+          modelColors[sample] = colors[i];
         }
       }
     }
@@ -438,56 +428,35 @@ void PBAS::init(cv::Mat* input)
   }
 }
 
-void PBAS::calculateFeatures(std::vector<cv::Mat>* feature, cv::Mat* inputImage)
+void PBAS::calculateFeatures(cv::Mat* inputImage)
 {
-  if (!feature->empty())
-    feature->clear();
-
-  cv::Mat mag[3], dir;
+  // the buffers are kept from one image to the next, nothing is allocated
+  // once the first image is done
+  currentFeatures.resize(2 * chans);
 
   if (inputImage->channels() == 3)
   {
-    std::vector<cv::Mat> rgbChannels(3);
-    cv::split(*inputImage, rgbChannels);
+    cv::split(*inputImage, &currentFeatures[3]);
 
     for (int l = 0; l < 3; ++l)
     {
-      cv::Sobel(rgbChannels.at(l), sobelX, CV_32F, 1, 0, 3, 1, 0.0);
-      cv::Sobel(rgbChannels.at(l), sobelY, CV_32F, 0, 1, 3, 1, 0.0);
-
-      // Compute the L2 norm and direction of the gradient
-      cv::cartToPolar(sobelX, sobelY, mag[l], dir, true);
-      feature->push_back(mag[l]);
-      sobelX.release();
-      sobelY.release();
-    }
+      cv::Sobel(currentFeatures[3 + l], sobelX, CV_32F, 1, 0, 3, 1, 0.0);
+      cv::Sobel(currentFeatures[3 + l], sobelY, CV_32F, 0, 1, 3, 1, 0.0);
 
-    feature->push_back(rgbChannels.at(0));
-    feature->push_back(rgbChannels.at(1));
-    feature->push_back(rgbChannels.at(2));
-    rgbChannels.at(0).release();
-    rgbChannels.at(1).release();
-    rgbChannels.at(2).release();
+      // Compute the L2 norm of the gradient (its direction is not used)
+      cv::magnitude(sobelX, sobelY, currentFeatures[l]);
+    }
   }
   else
   {
     cv::Sobel(*inputImage, sobelX, CV_32F, 1, 0, 3, 1, 0.0);
     cv::Sobel(*inputImage, sobelY, CV_32F, 0, 1, 3, 1, 0.0);
 
-    // Compute the L2 norm and direction of the gradient
-    cv::cartToPolar(sobelX, sobelY, mag[0], dir, true);
-    feature->push_back(mag[0]);
+    // Compute the L2 norm of the gradient (its direction is not used)
+    cv::magnitude(sobelX, sobelY, currentFeatures[0]);
 
-    cv::Mat temp;
-    inputImage->copyTo(temp);
-    feature->push_back(temp);
-    temp.release();
+    inputImage->copyTo(currentFeatures[1]);
   }
-
-  mag[0].release();
-  mag[1].release();
-  mag[2].release();
-  dir.release();
 }
 
 void PBAS::setN(int temp)
@@ -4,6 +4,8 @@
 #include <opencv2/opencv.hpp>
 //#include <highgui.h>
 
+#include "../../utils/AlignedBuffer.h"
+
 namespace bgslibrary
 {
   namespace algorithms
@@ -31,13 +33,15 @@ namespace bgslibrary
         void setBeta(double);
 
         bool isMovement();
+        // bytes used by the background model and the per-pixel thresholds
+        size_t getModelSize() const;
 
       private:
-        void calculateFeatures(std::vector<cv::Mat>* feature, cv::Mat* inputImage);
+        void calculateFeatures(cv::Mat* inputImage);
         void checkValid(int *x, int *y);
         void decisionThresholdRegulator(float* pt, float* meanDistArr);
         void learningRateRegulator(float* pt, float* meanDist, uchar* isFore);
-        void init(cv::Mat*);
+        void init();
         void newInitialization();
 
         cv::Mat meanMinDist;
@@ -75,16 +79,9 @@ namespace bgslibrary
         //for init, count number of runs
         int runs;
 
-        cv::Mat* resultMap;
+        //gradient magnitudes (0 .. chans-1) and colors (chans .. 2*chans-1) of the current image
         std::vector<cv::Mat> currentFeatures;
 
-        std::vector<float*> currentFeaturesM_Pt;
-        std::vector<uchar*> currentFeaturesC_Pt;
-        uchar* resultMap_Pt;
-
-        std::vector<std::vector<float*>>B_Mag_Pts;
-        std::vector<std::vector<uchar*>>B_Col_Pts;
-
         double sumMagnitude;
         double formerMeanMag;
         //float formerDistanceBack;
@@ -94,8 +91,12 @@ namespace bgslibrary
         // number of samples per pixel
         //size of background history B(x_i)
         int N;
-        // background model
-        std::vector<std::vector<cv::Mat>> backgroundModel;
+        // background model, one record per pixel: the samples of the gradient magnitude
+        // of channel 0, then of channel 1..., and likewise for the colors.
+        // Sample k of channel z of pixel p is at (p * chans + z) * samplesStride + k
+        int samplesStride; // N rounded up to a multiple of 4 (one SSE register of floats)
+        AlignedBuffer<float> modelMagnitudes;
+        AlignedBuffer<uchar> modelColors;
         //####################################################################################
         //####################################################################################
         //R-Threshhold - Variables
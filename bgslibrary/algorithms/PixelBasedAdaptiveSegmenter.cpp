@@ -35,17 +35,19 @@ void PixelBasedAdaptiveSegmenter::process(const cv::Mat &img_input, cv::Mat &img
     pbas.setT_upper(T_upper);
   }
 
-  cv::Mat img_input_new;
   if (enableInputBlur)
-    cv::GaussianBlur(img_input, img_input_new, cv::Size(5, 5), 1.5);
+    cv::GaussianBlur(img_input, img_input_blur, cv::Size(5, 5), 1.5);
   else
-    img_input.copyTo(img_input_new);
+    img_input.copyTo(img_input_blur);
 
-  pbas.process(&img_input_new, &img_foreground);
-  img_background = cv::Mat::zeros(img_input.size(), img_input.type());
+  pbas.process(&img_input_blur, &img_foreground);
+  createZeros(img_background, img_input.size(), img_input.type());
 
-  if (enableOutputBlur)
-    cv::medianBlur(img_foreground, img_foreground, 5);
+  if (enableOutputBlur) {
+    // into a second buffer and swap, so both are reused on the next frame
+    cv::medianBlur(img_foreground, img_foreground_blur, 5);
+    std::swap(img_foreground, img_foreground_blur);
+  }
 
 #ifndef MEX_COMPILE_FLAG
   if (showOutput)
@@ -58,6 +60,10 @@ void PixelBasedAdaptiveSegmenter::process(const cv::Mat &img_input, cv::Mat &img
   firstTime = false;
 }
 
+size_t PixelBasedAdaptiveSegmenter::getModelMemory() const {
+  return IBGS::getModelMemory() + pbas.getModelSize();
+}
+
 void PixelBasedAdaptiveSegmenter::save_config(cv::FileStorage &fs) {
   fs << "enableInputBlur" << enableInputBlur;
   fs << "enableOutputBlur" << enableOutputBlur;
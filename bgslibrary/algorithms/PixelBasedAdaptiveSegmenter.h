@@ -11,6 +11,8 @@ namespace bgslibrary
     {
     private:
       pbas::PBAS pbas;
+      cv::Mat img_input_blur;
+      cv::Mat img_foreground_blur;
 
       bool enableInputBlur;
       bool enableOutputBlur;
@@ -33,6 +35,8 @@ namespace bgslibrary
       ~PixelBasedAdaptiveSegmenter();
 
       void process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img_bgmodel);
+      int getStripeHalo() const { return -1; } // updates the samples of neighbours
+      size_t getModelMemory() const;
 
     private:
       void save_config(cv::FileStorage &fs);
@@ -50,6 +50,42 @@ void SigmaDelta::process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat
   img_background.copyTo(img_bgmodel);
 }
 
+void SigmaDelta::processBatch(const std::vector<cv::Mat> &imgs_input, std::vector<cv::Mat> &imgs_foreground)
+{
+  setShowOutput(false);
+  imgs_foreground.resize(imgs_input.size());
+
+  // the first frame initializes the model
+  size_t first = 0;
+  if (firstTime && !imgs_input.empty()) {
+    cv::Mat img_bgmodel;
+    process(imgs_input[0], imgs_foreground[0], img_bgmodel);
+    first = 1;
+  }
+  if (first == imgs_input.size())
+    return;
+
+  std::vector<const uint8_t*> images_data;
+  std::vector<uint8_t*> segmentation_maps;
+  for (size_t i = first; i < imgs_input.size(); ++i) {
+    imgs_foreground[i].create(imgs_input[i].size(), CV_8UC1);
+    if (!imgs_foreground[i].isContinuous())
+      imgs_foreground[i] = cv::Mat(imgs_input[i].size(), CV_8UC1);
+    images_data.push_back(imgs_input[i].data);
+    segmentation_maps.push_back(imgs_foreground[i].data);
+  }
+
+  sigmadelta::sdLaMa091UpdateBatch_8u_C3R(algorithm, images_data.data(), segmentation_maps.data(),
+    static_cast<uint32_t>(imgs_input[first].cols), static_cast<uint32_t>(images_data.size()));
+
+  imgs_foreground.back().copyTo(img_foreground);
+}
+
+size_t SigmaDelta::getModelMemory() const
+{
+  return IBGS::getModelMemory() + sigmadelta::sdLaMa091GetModelSize(algorithm);
+}
+
 void SigmaDelta::save_config(cv::FileStorage &fs) {
   fs << "ampFactor" << ampFactor;
   fs << "minVar" << minVar;
@@ -1,3 +1,13 @@
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+#endif
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #include "sdLaMa091.h"
 
 //using namespace bgslibrary::algorithms::sigmadelta;
@@ -14,7 +24,7 @@ namespace bgslibrary
       const char* LIB = "sdLaMa091 - ";
       //const int RED = 0;
       //const int GREEN = 1;
-      const int BLUE = 2;
+      //const int BLUE = 2;
       const int CHANNELS = 3;
 
       typedef enum {
@@ -73,6 +83,200 @@ namespace bgslibrary
         return (a > b) ? a : b;
       }
 
+      /* Updates Mt, Ot and Vt for one value and returns its label
+       * (FOREGROUND when Ot >= Vt). */
+      static inline uint8_t updateValue(uint8_t* workMt, uint8_t* workOt,
+        uint8_t* workVt, const uint8_t image, const uint32_t N,
+        const uint32_t Vmin, const uint32_t Vmax) {
+        if (*workMt < image)
+          ++(*workMt);
+        else if (*workMt > image)
+          --(*workMt);
+
+        *workOt = absVal(*workMt - image);
+
+        uint32_t ampOt = N * *workOt;
+
+        if (*workVt < ampOt)
+          ++(*workVt);
+        else if (*workVt > ampOt)
+          --(*workVt);
+
+        *workVt = max(min(*workVt, Vmax), Vmin);
+
+        return (*workOt < *workVt) ? BACKGROUND : FOREGROUND;
+      }
+
+      /* Row kernels: update the count values of a row of Mt, Ot and Vt
+       * with the same steps as updateValue and write their labels, 16 or
+       * 32 values at a time. They need N <= 256; Ot is at most 128, so
+       * N * Ot fits 16 bits and is above 255 exactly when Ot > 255 / N.
+       * They return the number of values left to updateValue. */
+      typedef struct {
+        uint16_t N;
+        uint8_t overThreshold;
+        uint8_t Vmin;
+        uint8_t Vmax;
+      } kernel_params_t;
+
+      #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+      #define SDLAMA091_SIMD_SSE2
+      static uint32_t updateRow_sse2(uint8_t* workMt, uint8_t* workOt,
+        uint8_t* workVt, const uint8_t* workImage, uint8_t* labels,
+        const uint32_t count, const kernel_params_t* params) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i ones = _mm_set1_epi8((char)0xff);
+        const __m128i one = _mm_set1_epi8(1);
+        const __m128i N = _mm_set1_epi16((short)params->N);
+        const __m128i overThreshold = _mm_set1_epi8((char)params->overThreshold);
+        const __m128i Vmin = _mm_set1_epi8((char)params->Vmin);
+        const __m128i Vmax = _mm_set1_epi8((char)params->Vmax);
+        uint32_t j = 0;
+        for (; j + 16 <= count; j += 16) {
+          const __m128i image = _mm_loadu_si128((const __m128i*)(workImage + j));
+          __m128i Mt = _mm_loadu_si128((const __m128i*)(workMt + j));
+          const __m128i up = _mm_min_epu8(_mm_subs_epu8(image, Mt), one);
+          const __m128i down = _mm_min_epu8(_mm_subs_epu8(Mt, image), one);
+          Mt = _mm_sub_epi8(_mm_add_epi8(Mt, up), down);
+          /* absVal((int8_t)(Mt - image)) */
+          const __m128i diff = _mm_sub_epi8(Mt, image);
+          const __m128i Ot = _mm_min_epu8(diff, _mm_sub_epi8(zero, diff));
+          const __m128i over = _mm_xor_si128(_mm_cmpeq_epi8(_mm_subs_epu8(Ot, overThreshold), zero), ones);
+          const __m128i ampOt = _mm_packus_epi16(
+            _mm_mullo_epi16(_mm_unpacklo_epi8(Ot, zero), N),
+            _mm_mullo_epi16(_mm_unpackhi_epi8(Ot, zero), N));
+          __m128i Vt = _mm_loadu_si128((const __m128i*)(workVt + j));
+          /* ++Vt wraps at 255 like the scalar code, a decrement needs N * Ot <= 255 */
+          const __m128i inc = _mm_or_si128(over, _mm_xor_si128(_mm_cmpeq_epi8(_mm_subs_epu8(ampOt, Vt), zero), ones));
+          const __m128i dec = _mm_andnot_si128(over, _mm_xor_si128(_mm_cmpeq_epi8(_mm_subs_epu8(Vt, ampOt), zero), ones));
+          Vt = _mm_add_epi8(_mm_sub_epi8(Vt, inc), dec);
+          Vt = _mm_max_epu8(_mm_min_epu8(Vt, Vmax), Vmin);
+          _mm_storeu_si128((__m128i*)(workMt + j), Mt);
+          _mm_storeu_si128((__m128i*)(workOt + j), Ot);
+          _mm_storeu_si128((__m128i*)(workVt + j), Vt);
+          _mm_storeu_si128((__m128i*)(labels + j), _mm_cmpeq_epi8(_mm_subs_epu8(Vt, Ot), zero));
+        }
+        return j;
+      }
+      #endif
+
+      #if defined(SDLAMA091_SIMD_SSE2) && (defined(__GNUC__) || defined(__clang__))
+      #define SDLAMA091_SIMD_AVX2
+      __attribute__((target("avx2")))
+      static uint32_t updateRow_avx2(uint8_t* workMt, uint8_t* workOt,
+        uint8_t* workVt, const uint8_t* workImage, uint8_t* labels,
+        const uint32_t count, const kernel_params_t* params) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i ones = _mm256_set1_epi8((char)0xff);
+        const __m256i one = _mm256_set1_epi8(1);
+        const __m256i N = _mm256_set1_epi16((short)params->N);
+        const __m256i overThreshold = _mm256_set1_epi8((char)params->overThreshold);
+        const __m256i Vmin = _mm256_set1_epi8((char)params->Vmin);
+        const __m256i Vmax = _mm256_set1_epi8((char)params->Vmax);
+        uint32_t j = 0;
+        for (; j + 32 <= count; j += 32) {
+          const __m256i image = _mm256_loadu_si256((const __m256i*)(workImage + j));
+          __m256i Mt = _mm256_loadu_si256((const __m256i*)(workMt + j));
+          const __m256i up = _mm256_min_epu8(_mm256_subs_epu8(image, Mt), one);
+          const __m256i down = _mm256_min_epu8(_mm256_subs_epu8(Mt, image), one);
+          Mt = _mm256_sub_epi8(_mm256_add_epi8(Mt, up), down);
+          const __m256i diff = _mm256_sub_epi8(Mt, image);
+          const __m256i Ot = _mm256_min_epu8(diff, _mm256_sub_epi8(zero, diff));
+          const __m256i over = _mm256_xor_si256(_mm256_cmpeq_epi8(_mm256_subs_epu8(Ot, overThreshold), zero), ones);
+          /* the per-lane unpacks and pack keep the values in order */
+          const __m256i ampOt = _mm256_packus_epi16(
+            _mm256_mullo_epi16(_mm256_unpacklo_epi8(Ot, zero), N),
+            _mm256_mullo_epi16(_mm256_unpackhi_epi8(Ot, zero), N));
+          __m256i Vt = _mm256_loadu_si256((const __m256i*)(workVt + j));
+          const __m256i inc = _mm256_or_si256(over, _mm256_xor_si256(_mm256_cmpeq_epi8(_mm256_subs_epu8(ampOt, Vt), zero), ones));
+          const __m256i dec = _mm256_andnot_si256(over, _mm256_xor_si256(_mm256_cmpeq_epi8(_mm256_subs_epu8(Vt, ampOt), zero), ones));
+          Vt = _mm256_add_epi8(_mm256_sub_epi8(Vt, inc), dec);
+          Vt = _mm256_max_epu8(_mm256_min_epu8(Vt, Vmax), Vmin);
+          _mm256_storeu_si256((__m256i*)(workMt + j), Mt);
+          _mm256_storeu_si256((__m256i*)(workOt + j), Ot);
+          _mm256_storeu_si256((__m256i*)(workVt + j), Vt);
+          _mm256_storeu_si256((__m256i*)(labels + j), _mm256_cmpeq_epi8(_mm256_subs_epu8(Vt, Ot), zero));
+        }
+        return j;
+      }
+
+      static bool cpuSupportsAVX2() {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+      }
+      #endif
+
+      #if defined(__ARM_NEON) || defined(__ARM_NEON__)
+      #define SDLAMA091_SIMD_NEON
+      static uint32_t updateRow_neon(uint8_t* workMt, uint8_t* workOt,
+        uint8_t* workVt, const uint8_t* workImage, uint8_t* labels,
+        const uint32_t count, const kernel_params_t* params) {
+        const uint8x16_t zero = vdupq_n_u8(0);
+        const uint8x16_t one = vdupq_n_u8(1);
+        const uint8x16_t overThreshold = vdupq_n_u8(params->overThreshold);
+        const uint8x16_t Vmin = vdupq_n_u8(params->Vmin);
+        const uint8x16_t Vmax = vdupq_n_u8(params->Vmax);
+        uint32_t j = 0;
+        for (; j + 16 <= count; j += 16) {
+          const uint8x16_t image = vld1q_u8(workImage + j);
+          uint8x16_t Mt = vld1q_u8(workMt + j);
+          const uint8x16_t up = vminq_u8(vqsubq_u8(image, Mt), one);
+          const uint8x16_t down = vminq_u8(vqsubq_u8(Mt, image), one);
+          Mt = vsubq_u8(vaddq_u8(Mt, up), down);
+          const uint8x16_t diff = vsubq_u8(Mt, image);
+          const uint8x16_t Ot = vminq_u8(diff, vsubq_u8(zero, diff));
+          const uint8x16_t over = vcgtq_u8(Ot, overThreshold);
+          const uint8x16_t ampOt = vcombine_u8(
+            vqmovn_u16(vmulq_n_u16(vmovl_u8(vget_low_u8(Ot)), params->N)),
+            vqmovn_u16(vmulq_n_u16(vmovl_u8(vget_high_u8(Ot)), params->N)));
+          uint8x16_t Vt = vld1q_u8(workVt + j);
+          const uint8x16_t inc = vorrq_u8(over, vcltq_u8(Vt, ampOt));
+          const uint8x16_t dec = vbicq_u8(vcgtq_u8(Vt, ampOt), over);
+          Vt = vaddq_u8(vsubq_u8(Vt, inc), dec);
+          Vt = vmaxq_u8(vminq_u8(Vt, Vmax), Vmin);
+          vst1q_u8(workMt + j, Mt);
+          vst1q_u8(workOt + j, Ot);
+          vst1q_u8(workVt + j, Vt);
+          vst1q_u8(labels + j, vcgeq_u8(Ot, Vt));
+        }
+        return j;
+      }
+      #endif
+
+      /* Updates the count values of Mt, Ot and Vt starting at offset in a
+       * single pass and writes their labels. */
+      static void updateRow(sdLaMa091_t* sdLaMa091, const uint32_t offset,
+        const uint32_t count, const uint8_t* workImage, uint8_t* labels) {
+        uint8_t* workMt = sdLaMa091->Mt + offset;
+        uint8_t* workOt = sdLaMa091->Ot + offset;
+        uint8_t* workVt = sdLaMa091->Vt + offset;
+        uint32_t j = 0;
+
+      #if defined(SDLAMA091_SIMD_SSE2) || defined(SDLAMA091_SIMD_NEON)
+        if (sdLaMa091->N <= 256) {
+          kernel_params_t params;
+          params.N = (uint16_t)sdLaMa091->N;
+          params.overThreshold = (uint8_t)(sdLaMa091->N == 0 ? 255 : 255 / sdLaMa091->N);
+          /* the scalar clamp converts Vmin and Vmax to uint8_t too */
+          params.Vmin = (uint8_t)sdLaMa091->Vmin;
+          params.Vmax = (uint8_t)sdLaMa091->Vmax;
+      #if defined(SDLAMA091_SIMD_AVX2)
+          if (cpuSupportsAVX2())
+            j = updateRow_avx2(workMt, workOt, workVt, workImage, labels, count, &params);
+          j += updateRow_sse2(workMt + j, workOt + j, workVt + j, workImage + j, labels + j, count - j, &params);
+      #elif defined(SDLAMA091_SIMD_SSE2)
+          j = updateRow_sse2(workMt, workOt, workVt, workImage, labels, count, &params);
+      #else
+          j = updateRow_neon(workMt, workOt, workVt, workImage, labels, count, &params);
+      #endif
+        }
+      #endif
+
+        for (; j < count; ++j)
+          labels[j] = updateValue(workMt + j, workOt + j, workVt + j, workImage[j],
+            sdLaMa091->N, sdLaMa091->Vmin, sdLaMa091->Vmax);
+      }
+
       sdLaMa091_t* sdLaMa091New(void) {
         sdLaMa091_t* sdLaMa091 = (sdLaMa091_t*)malloc(sizeof(*sdLaMa091));
 
@@ -306,6 +510,20 @@ namespace bgslibrary
         return sdLaMa091->Vmin;
       }
 
+      uint32_t sdLaMa091GetModelSize(const sdLaMa091_t* sdLaMa091) {
+      #ifdef DEFENSIVE_POINTER
+        if (sdLaMa091 == NULL) {
+          outputError("Cannot get a parameter of a NULL structure");
+          errno = ERROR_OCCURED;
+
+          return 0;
+        }
+      #endif
+
+        /* Mt, Ot and Vt */
+        return 3 * sdLaMa091->numBytes;
+      }
+
 
       int32_t sdLaMa091Update_8u_C1R(sdLaMa091_t* sdLaMa091,
         const uint8_t* image_data,
@@ -366,93 +584,9 @@ namespace bgslibrary
       #endif 
 
 
-        const uint8_t* workImage = image_data;
-        uint8_t* workMt = sdLaMa091->Mt;
-
-
-        for (uint32_t i = 0; i < sdLaMa091->numBytes; i += sdLaMa091->stride) {
-
-          for (uint32_t j = 0; j < sdLaMa091->width; ++j, ++workImage, ++workMt) {
-            if (*workMt < *workImage)
-              ++(*workMt);
-            else if (*workMt > *workImage)
-              --(*workMt);
-          }
-
-
-          if (sdLaMa091->unusedBytes > 0) {
-            workImage += sdLaMa091->unusedBytes;
-            workMt += sdLaMa091->unusedBytes;
-          }
-        }
-
-        workImage = image_data;
-        workMt = sdLaMa091->Mt;
-        uint8_t* workOt = sdLaMa091->Ot;
-
-
-        for (uint32_t i = 0; i < sdLaMa091->numBytes; i += sdLaMa091->stride) {
-
-          for (uint32_t j = 0; j < sdLaMa091->width; ++j, ++workImage, ++workMt,
-            ++workOt)
-            *workOt = absVal(*workMt - *workImage);
-
-
-          if (sdLaMa091->unusedBytes > 0) {
-            workImage += sdLaMa091->unusedBytes;
-            workMt += sdLaMa091->unusedBytes;
-            workOt += sdLaMa091->unusedBytes;
-          }
-        }
-
-
-        workOt = sdLaMa091->Ot;
-        uint8_t* workVt = sdLaMa091->Vt;
-
-
-        for (uint32_t i = 0; i < sdLaMa091->numBytes; i += sdLaMa091->stride) {
-
-          for (uint32_t j = 0; j < sdLaMa091->width; ++j, ++workOt, ++workVt) {
-            uint32_t ampOt = sdLaMa091->N * *workOt;
-
-            if (*workVt < ampOt)
-              ++(*workVt);
-            else if (*workVt > ampOt)
-              --(*workVt);
-
-            *workVt = max(min(*workVt, sdLaMa091->Vmax), sdLaMa091->Vmin);
-          }
-
-
-          if (sdLaMa091->unusedBytes > 0) {
-            workOt += sdLaMa091->unusedBytes;
-            workVt += sdLaMa091->unusedBytes;
-          }
-        }
-
-
-        workOt = sdLaMa091->Ot;
-        workVt = sdLaMa091->Vt;
-
-
-        for (uint32_t i = 0; i < sdLaMa091->numBytes; i += sdLaMa091->stride) {
-
-          for (uint32_t j = 0; j < sdLaMa091->width; ++j, ++segmentation_map,
-            ++workOt, ++workVt) {
-
-            if (*workOt < *workVt)
-              *segmentation_map = BACKGROUND;
-            else
-              *segmentation_map = FOREGROUND;
-          }
-
-
-          if (sdLaMa091->unusedBytes > 0) {
-            segmentation_map += sdLaMa091->unusedBytes;
-            workOt += sdLaMa091->unusedBytes;
-            workVt += sdLaMa091->unusedBytes;
-          }
-        }
+        for (uint32_t i = 0; i < sdLaMa091->numBytes; i += sdLaMa091->stride)
+          updateRow(sdLaMa091, i, sdLaMa091->width, image_data + i,
+            segmentation_map + i);
 
         return EXIT_SUCCESS;
       }
@@ -516,111 +650,108 @@ namespace bgslibrary
       #endif 
 
 
-        const uint8_t* workImage = image_data;
-        uint8_t* workMt = sdLaMa091->Mt;
-
-
         for (uint32_t i = 0; i < sdLaMa091->numBytes; i += sdLaMa091->stride) {
+          uint8_t* labels = segmentation_map + i;
 
-          for (uint32_t j = 0; j < sdLaMa091->rgbWidth; ++j, ++workImage, ++workMt) {
-            if (*workMt < *workImage)
-              ++(*workMt);
-            else if (*workMt > *workImage)
-              --(*workMt);
-          }
-
+          updateRow(sdLaMa091, i, sdLaMa091->rgbWidth, image_data + i, labels);
 
-          if (sdLaMa091->rgbUnusedBytes > 0) {
-            workImage += sdLaMa091->rgbUnusedBytes;
-            workMt += sdLaMa091->rgbUnusedBytes;
+          /* a pixel is foreground when one of its channels is */
+          for (uint32_t j = 0; j < sdLaMa091->rgbWidth; j += CHANNELS) {
+            const uint8_t label = labels[j] | labels[j + 1] | labels[j + 2];
+            labels[j] = label;
+            labels[j + 1] = label;
+            labels[j + 2] = label;
           }
         }
 
+        return EXIT_SUCCESS;
+      }
 
-        workImage = image_data;
-        workMt = sdLaMa091->Mt;
-        uint8_t* workOt = sdLaMa091->Ot;
-
-
-        for (uint32_t i = 0; i < sdLaMa091->numBytes; i += sdLaMa091->stride) {
-
-          for (uint32_t j = 0; j < sdLaMa091->rgbWidth; ++j, ++workImage, ++workMt,
-            ++workOt)
-            *workOt = absVal(*workMt - *workImage);
-
-
-          if (sdLaMa091->rgbUnusedBytes > 0) {
-            workImage += sdLaMa091->rgbUnusedBytes;
-            workMt += sdLaMa091->rgbUnusedBytes;
-            workOt += sdLaMa091->rgbUnusedBytes;
-          }
+      int32_t sdLaMa091UpdateBatch_8u_C3R(sdLaMa091_t* sdLaMa091,
+        const uint8_t* const* images_data,
+        uint8_t* const* segmentation_maps,
+        const uint32_t mask_stride,
+        const uint32_t count) {
+      #ifdef DEFENSIVE_POINTER
+        if (sdLaMa091 == NULL) {
+          outputError("Cannot update a NULL structure");
+          return EXIT_FAILURE;
         }
 
-        workOt = sdLaMa091->Ot;
-        uint8_t* workVt = sdLaMa091->Vt;
-
-
-        for (uint32_t i = 0; i < sdLaMa091->numBytes; i += sdLaMa091->stride) {
+        if (images_data == NULL) {
+          outputError("Cannot update a structure with a NULL image");
+          return EXIT_FAILURE;
+        }
 
-          for (uint32_t j = 0; j < sdLaMa091->rgbWidth; ++j, ++workOt, ++workVt) {
-            uint32_t ampOt = sdLaMa091->N * *workOt;
+        if (segmentation_maps == NULL) {
+          outputError("Cannot update a structure with a NULL segmentation map");
+          return EXIT_FAILURE;
+        }
+      #endif
 
-            if (*workVt < ampOt)
-              ++(*workVt);
-            else if (*workVt > ampOt)
-              --(*workVt);
+      #ifdef DEFENSIVE_PARAM
+        if (sdLaMa091->imageType != C3R) {
+          outputError("Cannot update a structure which is not C3R");
+          return EXIT_FAILURE;
+        }
 
-            *workVt = max(min(*workVt, sdLaMa091->Vmax), sdLaMa091->Vmin);
-          }
+        if (sdLaMa091->Vmax < sdLaMa091->Vmin) {
+          outputError("Cannot update a structure with Vmax inferior to Vmin");
+          return EXIT_FAILURE;
+        }
+      #endif
 
+        const uint32_t pixels = sdLaMa091->rgbWidth / CHANNELS;
 
-          if (sdLaMa091->rgbUnusedBytes > 0) {
-            workOt += sdLaMa091->rgbUnusedBytes;
-            workVt += sdLaMa091->rgbUnusedBytes;
-          }
-        }
+        for (uint32_t row = 0, i = 0; i < sdLaMa091->numBytes; ++row, i += sdLaMa091->stride) {
 
-        workOt = sdLaMa091->Ot;
-        workVt = sdLaMa091->Vt;
+          for (uint32_t p = 0; p < pixels; ++p) {
+            const uint32_t offset = i + p * CHANNELS;
+            uint8_t* workMt = sdLaMa091->Mt + offset;
+            uint8_t* workOt = sdLaMa091->Ot + offset;
+            uint8_t* workVt = sdLaMa091->Vt + offset;
 
+            uint8_t Mt[CHANNELS], Ot[CHANNELS], Vt[CHANNELS];
+            for (int c = 0; c < CHANNELS; ++c) {
+              Mt[c] = workMt[c];
+              Ot[c] = workOt[c];
+              Vt[c] = workVt[c];
+            }
 
-        for (uint32_t i = 0; i < sdLaMa091->numBytes; i += sdLaMa091->stride) {
+            for (uint32_t k = 0; k < count; ++k) {
+              const uint8_t* workImage = images_data[k] + offset;
+              bool isForeground = false;
 
-          uint32_t numColor = 0;
+              for (int c = 0; c < CHANNELS; ++c) {
+                if (Mt[c] < workImage[c])
+                  ++Mt[c];
+                else if (Mt[c] > workImage[c])
+                  --Mt[c];
 
-          bool isForeground = false;
+                Ot[c] = absVal(Mt[c] - workImage[c]);
 
+                uint32_t ampOt = sdLaMa091->N * Ot[c];
 
-          for (uint32_t j = 0; j < sdLaMa091->rgbWidth; ++j, ++workOt, ++workVt) {
-            if (*workOt >= *workVt)
-              isForeground = true;
+                if (Vt[c] < ampOt)
+                  ++Vt[c];
+                else if (Vt[c] > ampOt)
+                  --Vt[c];
 
+                Vt[c] = max(min(Vt[c], sdLaMa091->Vmax), sdLaMa091->Vmin);
 
-            if (numColor == BLUE) {
-              if (isForeground) {
-                *segmentation_map = FOREGROUND;
-                *(++segmentation_map) = FOREGROUND;
-                *(++segmentation_map) = FOREGROUND;
-                ++segmentation_map;
-              }
-              else {
-                *segmentation_map = BACKGROUND;
-                *(++segmentation_map) = BACKGROUND;
-                *(++segmentation_map) = BACKGROUND;
-                ++segmentation_map;
+                if (Ot[c] >= Vt[c])
+                  isForeground = true;
               }
 
-              isForeground = false;
+              segmentation_maps[k][row * mask_stride + p] =
+                isForeground ? FOREGROUND : BACKGROUND;
             }
 
-            numColor = (numColor + 1) % CHANNELS;
-          }
-
-
-          if (sdLaMa091->rgbUnusedBytes > 0) {
-            segmentation_map += sdLaMa091->rgbUnusedBytes;
-            workOt += sdLaMa091->rgbUnusedBytes;
-            workVt += sdLaMa091->rgbUnusedBytes;
+            for (int c = 0; c < CHANNELS; ++c) {
+              workMt[c] = Mt[c];
+              workOt[c] = Ot[c];
+              workVt[c] = Vt[c];
+            }
           }
         }
 
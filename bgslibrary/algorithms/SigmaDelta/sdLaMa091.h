@@ -47,6 +47,8 @@ namespace bgslibrary
 
       uint32_t sdLaMa091GetMinimalVariance(const sdLaMa091_t* sdLaMa091);
 
+      uint32_t sdLaMa091GetModelSize(const sdLaMa091_t* sdLaMa091);
+
       int32_t sdLaMa091Update_8u_C1R(sdLaMa091_t* sdLaMa091,
         const uint8_t* image_data,
         uint8_t* segmentation_map);
@@ -55,6 +57,16 @@ namespace bgslibrary
         const uint8_t* image_data,
         uint8_t* segmentation_map);
 
+      /* Updates the model with count frames in a single pass over Mt, Ot and
+       * Vt. Each segmentation map receives one byte per pixel (mask_stride
+       * bytes per row), the result is the same as count successive calls
+       * to sdLaMa091Update_8u_C3R. */
+      int32_t sdLaMa091UpdateBatch_8u_C3R(sdLaMa091_t* sdLaMa091,
+        const uint8_t* const* images_data,
+        uint8_t* const* segmentation_maps,
+        const uint32_t mask_stride,
+        const uint32_t count);
+
       int32_t sdLaMa091Free(sdLaMa091_t* sdLaMa091);
     }
   }
@@ -10,7 +10,9 @@ SuBSENSE::SuBSENSE() :
   nMinColorDistThreshold(lbsp::BGSSUBSENSE_DEFAULT_MIN_COLOR_DIST_THRESHOLD),
   nBGSamples(lbsp::BGSSUBSENSE_DEFAULT_NB_BG_SAMPLES),
   nRequiredBGSamples(lbsp::BGSSUBSENSE_DEFAULT_REQUIRED_NB_BG_SAMPLES),
-  nSamplesForMovingAvgs(lbsp::BGSSUBSENSE_DEFAULT_N_SAMPLES_FOR_MV_AVGS)
+  nSamplesForMovingAvgs(lbsp::BGSSUBSENSE_DEFAULT_N_SAMPLES_FOR_MV_AVGS),
+  nParallelBands(1),
+  nDownSampleFactor(1)
 {
   debug_construction(SuBSENSE);
   initLoadSaveConfig(algorithmName);
@@ -31,12 +33,28 @@ void SuBSENSE::process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &i
       fRelLBSPThreshold, nDescDistThresholdOffset, nMinColorDistThreshold,
       nBGSamples, nRequiredBGSamples, nSamplesForMovingAvgs);
 
-    pSubsense->initialize(img_input, cv::Mat(img_input.size(), CV_8UC1, cv::Scalar_<uchar>(255)));
+    pSubsense->setRandomSeed(randomSeed);
+    pSubsense->setParallelBands((size_t)std::max(nParallelBands, 0));
+    if (nDownSampleFactor > 1) {
+      pRefiner.reset(new lbsp::MultiResolutionRefiner(nDownSampleFactor,
+        [this](const cv::Mat &img_model_input, int x, int y, const uchar *color) { return pSubsense->isForegroundPixel(img_model_input, x, y, color); }));
+      const cv::Mat &img_model_input = pRefiner->downSample(img_input);
+      pSubsense->initialize(img_model_input, cv::Mat(img_model_input.size(), CV_8UC1, cv::Scalar_<uchar>(255)));
+    }
+    else
+      pSubsense->initialize(img_input, cv::Mat(img_input.size(), CV_8UC1, cv::Scalar_<uchar>(255)));
     firstTime = false;
   }
 
-  pSubsense->apply(img_input, img_foreground);
-  pSubsense->getBackgroundImage(img_background);
+  if (pRefiner) {
+    pSubsense->apply(pRefiner->downSample(img_input), img_model_foreground);
+    pSubsense->getBackgroundImage(img_model_background);
+    pRefiner->upSample(img_input, img_model_foreground, img_model_background, img_foreground, img_background);
+  }
+  else {
+    pSubsense->apply(img_input, img_foreground);
+    pSubsense->getBackgroundImage(img_background);
+  }
 
 #ifndef MEX_COMPILE_FLAG
   if (showOutput) {
@@ -56,6 +74,8 @@ void SuBSENSE::save_config(cv::FileStorage &fs) {
   fs << "nBGSamples" << nBGSamples;
   fs << "nRequiredBGSamples" << nRequiredBGSamples;
   fs << "nSamplesForMovingAvgs" << nSamplesForMovingAvgs;
+  fs << "nParallelBands" << nParallelBands;
+  fs << "nDownSampleFactor" << nDownSampleFactor;
   fs << "showOutput" << showOutput;
 }
 
@@ -66,5 +86,7 @@ void SuBSENSE::load_config(cv::FileStorage &fs) {
   fs["nBGSamples"] >> nBGSamples;
   fs["nRequiredBGSamples"] >> nRequiredBGSamples;
   fs["nSamplesForMovingAvgs"] >> nSamplesForMovingAvgs;
+  fs["nParallelBands"] >> nParallelBands;
+  fs["nDownSampleFactor"] >> nDownSampleFactor;
   fs["showOutput"] >> showOutput;
 }
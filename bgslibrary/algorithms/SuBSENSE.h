@@ -1,7 +1,10 @@
 #pragma once
 
+#include <memory>
+
 #include "IBGS.h"
 #include "LBSP/BackgroundSubtractorSuBSENSE.h"
+#include "LBSP/MultiResolutionRefiner.h"
 
 namespace bgslibrary
 {
@@ -11,6 +14,7 @@ namespace bgslibrary
     {
     private:
       lbsp::BackgroundSubtractorSuBSENSE* pSubsense;
+      std::unique_ptr<lbsp::MultiResolutionRefiner> pRefiner;
 
       float fRelLBSPThreshold;
       int nDescDistThresholdOffset;
@@ -18,6 +22,13 @@ namespace bgslibrary
       int nBGSamples;
       int nRequiredBGSamples;
       int nSamplesForMovingAvgs;
+      int nParallelBands;
+      // the model runs on frames downsampled by this factor (1 = full resolution),
+      // the blob boundaries being refined approximately (see MultiResolutionRefiner)
+      int nDownSampleFactor;
+
+      cv::Mat img_model_foreground;
+      cv::Mat img_model_background;
 
     public:
       SuBSENSE();
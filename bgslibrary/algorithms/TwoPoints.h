@@ -21,6 +21,7 @@ namespace bgslibrary
       ~TwoPoints();
 
       void process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img_bgmodel);
+      bool usesSharedRandom() const { return true; }
 
     private:
       void save_config(cv::FileStorage &fs);
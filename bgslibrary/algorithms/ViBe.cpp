@@ -9,6 +9,7 @@ ViBe::ViBe() :
   matchingThreshold(DEFAULT_MATCH_THRESH),
   matchingNumber(DEFAULT_MATCH_NUM),
   updateFactor(DEFAULT_UPDATE_FACTOR),
+  planarModel(false),
   model(nullptr)
 {
   debug_construction(ViBe);
@@ -28,11 +29,25 @@ void ViBe::process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img_b
   if (img_input.empty())
     return;
 
-  if (firstTime) {
+  if (firstTime && planarModel) {
+    /* Same model with the samples stored plane by plane, see vibe-background-planar.h. */
+    planar.reset(new vibe::PlanarModel_8u_C3R<vibe::PLANAR_NUMBER_OF_SAMPLES>());
+    planar->setSeed(randomSeed);
+    planar->setMatchingThreshold(matchingThreshold);
+    planar->setMatchingNumber(matchingNumber);
+    planar->setUpdateFactor(updateFactor);
+    if (planar->allocInit(img_input.data, img_input.cols, img_input.rows) != 0) {
+      std::cerr << algorithmName + " could not allocate the planar model" << std::endl;
+      planar.reset();
+      return;
+    }
+  }
+  else if (firstTime) {
     /* Create a buffer for the output image. */
     //img_output = cv::Mat(img_input.rows, img_input.cols, CV_8UC1);
 
     /* Initialization of the ViBe model. */
+    vibe::libvibeModel_Sequential_SetSeed(model, randomSeed);
     vibe::libvibeModel_Sequential_AllocInit_8u_C3R(model, img_input.data, img_input.cols, img_input.rows);
 
     /* Sets default model values. */
@@ -42,9 +57,15 @@ void ViBe::process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img_b
     vibe::libvibeModel_Sequential_SetUpdateFactor(model, updateFactor);
   }
 
-  vibe::libvibeModel_Sequential_Segmentation_8u_C3R(model, img_input.data, img_output.data);
-  //vibe::libvibeModel_Sequential_Update_8u_C3R(model, model_img_input.data, img_output.data);
-  vibe::libvibeModel_Sequential_Update_8u_C3R(model, img_input.data, img_output.data);
+  if (planar) {
+    planar->segmentation(img_input.data, img_output.data);
+    planar->update(img_input.data, img_output.data);
+  }
+  else {
+    vibe::libvibeModel_Sequential_Segmentation_8u_C3R(model, img_input.data, img_output.data);
+    //vibe::libvibeModel_Sequential_Update_8u_C3R(model, model_img_input.data, img_output.data);
+    vibe::libvibeModel_Sequential_Update_8u_C3R(model, img_input.data, img_output.data);
+  }
 
 #ifndef MEX_COMPILE_FLAG
   if (showOutput)
@@ -54,11 +75,20 @@ void ViBe::process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img_b
   firstTime = false;
 }
 
+size_t ViBe::getModelMemory() const
+{
+  size_t bytes = IBGS::getModelMemory();
+  if (planar)
+    bytes += planar->getModelSize();
+  return bytes;
+}
+
 void ViBe::save_config(cv::FileStorage &fs) {
   //fs << "numberOfSamples" << numberOfSamples;
   fs << "matchingThreshold" << matchingThreshold;
   fs << "matchingNumber" << matchingNumber;
   fs << "updateFactor" << updateFactor;
+  fs << "planarModel" << planarModel;
   fs << "showOutput" << showOutput;
 }
 
@@ -67,5 +97,6 @@ void ViBe::load_config(cv::FileStorage &fs) {
   fs["matchingThreshold"] >> matchingThreshold;
   fs["matchingNumber"] >> matchingNumber;
   fs["updateFactor"] >> updateFactor;
+  fs["planarModel"] >> planarModel;
   fs["showOutput"] >> showOutput;
 }
@@ -2,6 +2,7 @@
 
 #include "IBGS.h"
 #include "ViBe/vibe-background-sequential.h"
+#include "ViBe/vibe-background-planar.h"
 
 namespace bgslibrary
 {
@@ -20,13 +21,17 @@ namespace bgslibrary
       int matchingThreshold;
       int matchingNumber;
       int updateFactor;
+      bool planarModel;
       vibe::vibeModel_Sequential_t* model;
+      std::unique_ptr<vibe::PlanarModel_8u_C3R<vibe::PLANAR_NUMBER_OF_SAMPLES>> planar;
 
     public:
       ViBe();
       ~ViBe();
 
       void process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img_bgmodel);
+      int getStripeHalo() const { return -1; } // updates the samples of neighbours
+      size_t getModelMemory() const;
 
     private:
       void save_config(cv::FileStorage &fs);
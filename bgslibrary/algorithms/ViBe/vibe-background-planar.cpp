@@ -0,0 +1,358 @@
+#include <assert.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VIBE_PLANAR_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define VIBE_PLANAR_NEON
+#endif
+
+#include "vibe-background-planar.h"
+
+namespace bgslibrary
+{
+  namespace algorithms
+  {
+    namespace vibe
+    {
+      // Same test as distance_is_close_8u_C3R: the sum of the absolute
+      // differences is compared with 4.5 * threshold, i.e. floor(9 * threshold / 2).
+      static uint16_t planar_distance_limit(uint32_t threshold)
+      {
+        uint64_t limit = (9 * (uint64_t)threshold) / 2;
+        return (uint16_t)((limit > 3 * 255) ? 3 * 255 : limit);
+      }
+
+      static inline int planar_abs(int i)
+      {
+        return (i >= 0) ? i : -i;
+      }
+
+      static_assert(PLANAR_BLOCK == 16, "one block per SSE2/NEON register");
+
+      // Offset of channel 0 of a pixel in a sample; channels 1 and 2 follow
+      // at + PLANAR_BLOCK and + 2 * PLANAR_BLOCK.
+      static inline size_t planar_offset(uint32_t index)
+      {
+        return (size_t)(index / PLANAR_BLOCK) * 3 * PLANAR_BLOCK + index % PLANAR_BLOCK;
+      }
+
+      // -----------------------------------------------------------------------------
+      // Segmentation of pixels [begin, end), one pixel at a time
+      // -----------------------------------------------------------------------------
+      template<int NUMBER_OF_SAMPLES>
+      static void planar_segmentation_scalar(const uint8_t *image_data, const uint8_t *samples, size_t sampleStride,
+        uint32_t begin, uint32_t end, uint32_t matchingNumber, uint16_t limit, uint8_t *segmentation_map)
+      {
+        for (uint32_t index = begin; index < end; ++index) {
+          const uint8_t *pixel = image_data + 3 * index;
+          uint32_t matches = 0;
+          for (int s = 0; s < NUMBER_OF_SAMPLES && matches < matchingNumber; ++s) {
+            const uint8_t *sample = samples + s * sampleStride + planar_offset(index);
+            int distance = planar_abs(pixel[0] - sample[0])
+              + planar_abs(pixel[1] - sample[PLANAR_BLOCK])
+              + planar_abs(pixel[2] - sample[2 * PLANAR_BLOCK]);
+            if (distance <= limit)
+              ++matches;
+          }
+          segmentation_map[index] = (matches >= matchingNumber) ? COLOR_BACKGROUND : COLOR_FOREGROUND;
+        }
+      }
+
+#if defined(VIBE_PLANAR_SSE2)
+      // a = bytes 0, 3, 6..., b = bytes 1, 4, 7..., c = bytes 2, 5, 8... of the 48 bytes t0 t1 t2
+      static inline void planar_deinterleave_8u_C3(__m128i t00, __m128i t01, __m128i t02, __m128i &a, __m128i &b, __m128i &c)
+      {
+        __m128i t10 = _mm_unpacklo_epi8(t00, _mm_unpackhi_epi64(t01, t01));
+        __m128i t11 = _mm_unpacklo_epi8(_mm_unpackhi_epi64(t00, t00), t02);
+        __m128i t12 = _mm_unpacklo_epi8(t01, _mm_unpackhi_epi64(t02, t02));
+
+        __m128i t20 = _mm_unpacklo_epi8(t10, _mm_unpackhi_epi64(t11, t11));
+        __m128i t21 = _mm_unpacklo_epi8(_mm_unpackhi_epi64(t10, t10), t12);
+        __m128i t22 = _mm_unpacklo_epi8(t11, _mm_unpackhi_epi64(t12, t12));
+
+        __m128i t30 = _mm_unpacklo_epi8(t20, _mm_unpackhi_epi64(t21, t21));
+        __m128i t31 = _mm_unpacklo_epi8(_mm_unpackhi_epi64(t20, t20), t22);
+        __m128i t32 = _mm_unpacklo_epi8(t21, _mm_unpackhi_epi64(t22, t22));
+
+        a = _mm_unpacklo_epi8(t30, _mm_unpackhi_epi64(t31, t31));
+        b = _mm_unpacklo_epi8(_mm_unpackhi_epi64(t30, t30), t32);
+        c = _mm_unpacklo_epi8(t31, _mm_unpackhi_epi64(t32, t32));
+      }
+
+      static inline __m128i planar_absdiff_8u(__m128i a, __m128i b)
+      {
+        return _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+      }
+
+      // one block at a time, returns the number of pixels done
+      template<int NUMBER_OF_SAMPLES>
+      static uint32_t planar_segmentation_simd(const uint8_t *image_data, const uint8_t *samples, size_t sampleStride,
+        uint32_t numPixels, uint32_t matchingNumber, uint16_t limit, uint8_t *segmentation_map)
+      {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i ones = _mm_set1_epi8(-1);
+        const __m128i vlimit = _mm_set1_epi16((short)limit);
+        const __m128i vnumber = _mm_set1_epi8((char)(uint8_t)(matchingNumber > 255 ? 255 : matchingNumber));
+
+        uint32_t index = 0;
+        for (; index + 16 <= numPixels; index += 16) {
+          const uint8_t *pixels = image_data + 3 * index;
+          __m128i p0, p1, p2;
+          planar_deinterleave_8u_C3(
+            _mm_loadu_si128((const __m128i*)pixels),
+            _mm_loadu_si128((const __m128i*)(pixels + 16)),
+            _mm_loadu_si128((const __m128i*)(pixels + 32)), p0, p1, p2);
+
+          __m128i matches = zero;
+          __m128i done = zero;
+          for (int s = 0; s < NUMBER_OF_SAMPLES; ++s) {
+            // the block of the pixels starts at 3 * index, as the pixels in image_data
+            const uint8_t *sample = samples + s * sampleStride + 3 * index;
+            __m128i a = planar_absdiff_8u(p0, _mm_load_si128((const __m128i*)sample));
+            __m128i b = planar_absdiff_8u(p1, _mm_load_si128((const __m128i*)(sample + 16)));
+            __m128i c = planar_absdiff_8u(p2, _mm_load_si128((const __m128i*)(sample + 32)));
+
+            __m128i sum_lo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)), _mm_unpacklo_epi8(c, zero));
+            __m128i sum_hi = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)), _mm_unpackhi_epi8(c, zero));
+            __m128i far = _mm_packs_epi16(_mm_cmpgt_epi16(sum_lo, vlimit), _mm_cmpgt_epi16(sum_hi, vlimit));
+            matches = _mm_sub_epi8(matches, _mm_andnot_si128(far, ones));
+
+            // stop as soon as all the 16 pixels are background
+            done = _mm_cmpeq_epi8(_mm_min_epu8(matches, vnumber), vnumber);
+            if (s + 1 >= (int)matchingNumber && _mm_movemask_epi8(done) == 0xFFFF)
+              break;
+          }
+          _mm_storeu_si128((__m128i*)(segmentation_map + index), _mm_andnot_si128(done, ones));
+        }
+        return index;
+      }
+#elif defined(VIBE_PLANAR_NEON)
+      // one block at a time, returns the number of pixels done
+      template<int NUMBER_OF_SAMPLES>
+      static uint32_t planar_segmentation_simd(const uint8_t *image_data, const uint8_t *samples, size_t sampleStride,
+        uint32_t numPixels, uint32_t matchingNumber, uint16_t limit, uint8_t *segmentation_map)
+      {
+        const uint16x8_t vlimit = vdupq_n_u16(limit);
+        const uint8x16_t vnumber = vdupq_n_u8((uint8_t)(matchingNumber > 255 ? 255 : matchingNumber));
+
+        uint32_t index = 0;
+        for (; index + 16 <= numPixels; index += 16) {
+          uint8x16x3_t pixels = vld3q_u8(image_data + 3 * index);
+          uint8x16_t matches = vdupq_n_u8(0);
+          uint8x16_t done = vdupq_n_u8(0);
+
+          for (int s = 0; s < NUMBER_OF_SAMPLES; ++s) {
+            const uint8_t *sample = samples + s * sampleStride + 3 * index;
+            uint8x16_t a = vabdq_u8(pixels.val[0], vld1q_u8(sample));
+            uint8x16_t b = vabdq_u8(pixels.val[1], vld1q_u8(sample + 16));
+            uint8x16_t c = vabdq_u8(pixels.val[2], vld1q_u8(sample + 32));
+
+            uint16x8_t sum_lo = vaddw_u8(vaddl_u8(vget_low_u8(a), vget_low_u8(b)), vget_low_u8(c));
+            uint16x8_t sum_hi = vaddw_u8(vaddl_u8(vget_high_u8(a), vget_high_u8(b)), vget_high_u8(c));
+            uint8x16_t close = vcombine_u8(vmovn_u16(vcleq_u16(sum_lo, vlimit)), vmovn_u16(vcleq_u16(sum_hi, vlimit)));
+            matches = vsubq_u8(matches, close);
+
+            // stop as soon as all the 16 pixels are background
+            done = vcgeq_u8(matches, vnumber);
+            uint8x8_t all = vand_u8(vget_low_u8(done), vget_high_u8(done));
+            if (s + 1 >= (int)matchingNumber && vget_lane_u64(vreinterpret_u64_u8(all), 0) == ~0ULL)
+              break;
+          }
+          vst1q_u8(segmentation_map + index, vmvnq_u8(done));
+        }
+        return index;
+      }
+#endif
+
+      // -----------------------------------------------------------------------------
+      // Creates the model, with the same defaults as libvibeModel_Sequential_New
+      // -----------------------------------------------------------------------------
+      template<int NUMBER_OF_SAMPLES>
+      PlanarModel_8u_C3R<NUMBER_OF_SAMPLES>::PlanarModel_8u_C3R() :
+        width(0), height(0), matchingThreshold(20), matchingNumber(2), updateFactor(16), sampleStride(0)
+      {
+      }
+
+      template<int NUMBER_OF_SAMPLES>
+      void PlanarModel_8u_C3R<NUMBER_OF_SAMPLES>::setSeed(uint64_t seed)
+      {
+        rng.seed(seed);
+      }
+
+      template<int NUMBER_OF_SAMPLES>
+      void PlanarModel_8u_C3R<NUMBER_OF_SAMPLES>::setMatchingThreshold(uint32_t _matchingThreshold)
+      {
+        assert(_matchingThreshold > 0);
+        matchingThreshold = _matchingThreshold;
+      }
+
+      template<int NUMBER_OF_SAMPLES>
+      void PlanarModel_8u_C3R<NUMBER_OF_SAMPLES>::setMatchingNumber(uint32_t _matchingNumber)
+      {
+        assert(_matchingNumber > 0);
+        matchingNumber = _matchingNumber;
+      }
+
+      template<int NUMBER_OF_SAMPLES>
+      void PlanarModel_8u_C3R<NUMBER_OF_SAMPLES>::setUpdateFactor(uint32_t _updateFactor)
+      {
+        assert(_updateFactor > 0);
+        updateFactor = _updateFactor;
+        if (!jump.empty())
+          fillJump();
+      }
+
+      template<int NUMBER_OF_SAMPLES>
+      void PlanarModel_8u_C3R<NUMBER_OF_SAMPLES>::fillJump()
+      {
+        for (size_t i = 0; i < jump.size(); ++i)
+          jump[i] = (updateFactor == 1) ? 1 : (rng() % (2 * updateFactor)) + 1; // 1 or values between 1 and 2 * updateFactor.
+      }
+
+      template<int NUMBER_OF_SAMPLES>
+      size_t PlanarModel_8u_C3R<NUMBER_OF_SAMPLES>::getModelSize() const
+      {
+        return samples.bytes();
+      }
+
+      // -----------------------------------------------------------------------------
+      // Allocates and initializes the model
+      // -----------------------------------------------------------------------------
+      template<int NUMBER_OF_SAMPLES>
+      int32_t PlanarModel_8u_C3R<NUMBER_OF_SAMPLES>::allocInit(const uint8_t *image_data, uint32_t _width, uint32_t _height)
+      {
+        assert(image_data != NULL);
+        assert((_width > 0) && (_height > 0));
+
+        width = _width;
+        height = _height;
+        uint32_t numPixels = width * height;
+        uint32_t numBlocks = (numPixels + PLANAR_BLOCK - 1) / PLANAR_BLOCK;
+        sampleStride = AlignedBuffer<uint8_t>::padded(3 * PLANAR_BLOCK * numBlocks);
+        if (!samples.allocate(NUMBER_OF_SAMPLES * sampleStride))
+          return(-1);
+
+        for (int s = 0; s < NUMBER_OF_SAMPLES; ++s) {
+          for (uint32_t index = 0; index < numPixels; ++index) {
+            uint8_t *sample = samples.data() + s * sampleStride + planar_offset(index);
+            for (int c = 0; c < 3; ++c) {
+              int value = image_data[3 * index + c];
+              if (s >= NUMBER_OF_HISTORY_IMAGES) {
+                value += rng() % 20 - 10;
+                if (value < 0) { value = 0; }
+                if (value > 255) { value = 255; }
+              }
+              sample[c * PLANAR_BLOCK] = (uint8_t)value;
+            }
+          }
+        }
+
+        /* Fills the buffers with random values. */
+        int size = (width > height) ? 2 * width + 1 : 2 * height + 1;
+        jump.resize(size);
+        neighbor.resize(size);
+        position.resize(size);
+
+        fillJump();
+        for (int i = 0; i < size; ++i) {
+          neighbor[i] = ((rng() % 3) - 1) + ((rng() % 3) - 1) * (int)width; // Values between { width - 1, ... , width + 1 }.
+          position[i] = rng() % NUMBER_OF_SAMPLES;                          // Values between 0 and NUMBER_OF_SAMPLES - 1.
+        }
+
+        return(0);
+      }
+
+      // -----------------------------------------------------------------------------
+      // Segmentation
+      // -----------------------------------------------------------------------------
+      template<int NUMBER_OF_SAMPLES>
+      void PlanarModel_8u_C3R<NUMBER_OF_SAMPLES>::segmentation(const uint8_t *image_data, uint8_t *segmentation_map) const
+      {
+        assert((image_data != NULL) && (segmentation_map != NULL));
+        assert(!samples.empty());
+
+        uint32_t numPixels = width * height;
+        uint16_t limit = planar_distance_limit(matchingThreshold);
+        uint32_t done = 0;
+#if defined(VIBE_PLANAR_SSE2) || defined(VIBE_PLANAR_NEON)
+        done = planar_segmentation_simd<NUMBER_OF_SAMPLES>(image_data, samples.data(), sampleStride, numPixels, matchingNumber, limit, segmentation_map);
+#endif
+        planar_segmentation_scalar<NUMBER_OF_SAMPLES>(image_data, samples.data(), sampleStride, done, numPixels, matchingNumber, limit, segmentation_map);
+      }
+
+      // -----------------------------------------------------------------------------
+      // Update
+      // -----------------------------------------------------------------------------
+      template<int NUMBER_OF_SAMPLES>
+      void PlanarModel_8u_C3R<NUMBER_OF_SAMPLES>::setSample(uint32_t sample, uint32_t index, const uint8_t *pixel)
+      {
+        uint8_t *value = samples.data() + sample * sampleStride + planar_offset(index);
+        value[0] = pixel[0];
+        value[PLANAR_BLOCK] = pixel[1];
+        value[2 * PLANAR_BLOCK] = pixel[2];
+      }
+
+      // Pixels start + i * step, 0 < i < length, of the first/last row or column.
+      template<int NUMBER_OF_SAMPLES>
+      void PlanarModel_8u_C3R<NUMBER_OF_SAMPLES>::updateBorder(uint32_t start, uint32_t step, uint32_t length,
+        const uint8_t *image_data, const uint8_t *updating_mask)
+      {
+        uint32_t shift = rng() % length;
+        uint32_t ind = jump[shift]; // index_jump should never be zero (> 1).
+
+        while (ind <= length - 1) {
+          uint32_t index = start + ind * step;
+          if (updating_mask[index] == COLOR_BACKGROUND)
+            setSample(position[shift], index, image_data + 3 * index);
+
+          ++shift;
+          ind += jump[shift];
+        }
+      }
+
+      template<int NUMBER_OF_SAMPLES>
+      void PlanarModel_8u_C3R<NUMBER_OF_SAMPLES>::update(const uint8_t *image_data, const uint8_t *updating_mask)
+      {
+        assert((image_data != NULL) && (updating_mask != NULL));
+        assert(!samples.empty());
+
+        /* All the frame, except the border. */
+        for (uint32_t y = 1; y + 1 < height; ++y) {
+          uint32_t shift = rng() % width;
+          uint32_t indX = jump[shift]; // index_jump should never be zero (> 1).
+
+          while (indX < width - 1) {
+            uint32_t index = indX + y * width;
+
+            if (updating_mask[index] == COLOR_BACKGROUND) {
+              /* In-place substitution, in the pixel and in one of its neighbors. */
+              const uint8_t *pixel = image_data + 3 * index;
+              setSample(position[shift], index, pixel);
+              setSample(position[shift], index + neighbor[shift], pixel);
+            }
+
+            ++shift;
+            indX += jump[shift];
+          }
+        }
+
+        /* First and last rows, first and last columns. */
+        updateBorder(0, 1, width, image_data, updating_mask);
+        updateBorder((height - 1) * width, 1, width, image_data, updating_mask);
+        updateBorder(0, width, height, image_data, updating_mask);
+        updateBorder(width - 1, width, height, image_data, updating_mask);
+
+        /* The first pixel! */
+        if (rng() % updateFactor == 0) {
+          if (updating_mask[0] == COLOR_BACKGROUND)
+            setSample(rng() % NUMBER_OF_SAMPLES, 0, image_data);
+        }
+      }
+
+      // Sample counts available to the users of PlanarModel_8u_C3R.
+      template class PlanarModel_8u_C3R<PLANAR_NUMBER_OF_SAMPLES>;
+    }
+  }
+}
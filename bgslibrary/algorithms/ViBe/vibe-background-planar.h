@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "vibe-background-sequential.h"
+#include "../../utils/AlignedBuffer.h"
+#include "../../utils/FastRNG.h"
+
+namespace bgslibrary
+{
+  namespace algorithms
+  {
+    namespace vibe
+    {
+      /**
+       * \brief ViBe model of a C3R image with planar, sample-major storage.
+       *
+       * The samples are stored one after the other (sample-major), each one
+       * starting on a 64-byte boundary. Inside a sample, the pixels are
+       * grouped in blocks of PLANAR_BLOCK pixels whose channels are planar:
+       * the PLANAR_BLOCK values of channel 0, then of channel 1, then of
+       * channel 2. The segmentation compares a block with one sample at a
+       * time with aligned loads, and stops reading the samples of the block
+       * as soon as all its pixels have matchingNumber matches, so most
+       * background regions only touch the first few samples. Keeping the
+       * three channels of a pixel within 48 bytes keeps the random updates
+       * to one cache line, as in the interleaved layout.
+       *
+       * Unlike \ref vibeModel_Sequential_t, the number of samples is a
+       * template parameter. Only the counts explicitly instantiated in
+       * vibe-background-planar.cpp can be used.
+       */
+      template<int NUMBER_OF_SAMPLES>
+      class PlanarModel_8u_C3R
+      {
+        static_assert(NUMBER_OF_SAMPLES > NUMBER_OF_HISTORY_IMAGES && NUMBER_OF_SAMPLES < 256,
+          "the match counters are 8-bit");
+
+      public:
+        PlanarModel_8u_C3R();
+
+        /* Setters, to be called before allocInit. */
+        void setSeed(uint64_t seed);
+        void setMatchingThreshold(uint32_t matchingThreshold);
+        void setMatchingNumber(uint32_t matchingNumber);
+        void setUpdateFactor(uint32_t updateFactor);
+
+        /**
+         * Allocates the model and fills it with the first image (plus some
+         * noise for all the samples but the first NUMBER_OF_HISTORY_IMAGES).
+         * Returns 0, or -1 when the samples cannot be allocated (the model
+         * must then not be used).
+         */
+        int32_t allocInit(const uint8_t *image_data, uint32_t width, uint32_t height);
+
+        /**
+         * Writes COLOR_FOREGROUND in segmentation_map for the pixels with
+         * less than matchingNumber samples close to them, COLOR_BACKGROUND
+         * otherwise.
+         */
+        void segmentation(const uint8_t *image_data, uint8_t *segmentation_map) const;
+
+        /**
+         * Same random, conservative update as
+         * \ref libvibeModel_Sequential_Update_8u_C3R.
+         */
+        void update(const uint8_t *image_data, const uint8_t *updating_mask);
+
+        /* Bytes used by the samples. */
+        size_t getModelSize() const;
+
+      private:
+        uint32_t width;
+        uint32_t height;
+        uint32_t matchingThreshold;
+        uint32_t matchingNumber;
+        uint32_t updateFactor;
+
+        /* Channel c of pixel i in sample s is at
+         * s * sampleStride + (i / PLANAR_BLOCK) * 3 * PLANAR_BLOCK + c * PLANAR_BLOCK + i % PLANAR_BLOCK. */
+        size_t sampleStride;
+        AlignedBuffer<uint8_t> samples;
+
+        /* Buffers with random values. */
+        std::vector<uint32_t> jump;
+        std::vector<int> neighbor;
+        std::vector<uint32_t> position;
+
+        FastRNG rng;
+
+        void fillJump();
+        void setSample(uint32_t sample, uint32_t index, const uint8_t *pixel);
+        void updateBorder(uint32_t start, uint32_t step, uint32_t length,
+          const uint8_t *image_data, const uint8_t *updating_mask);
+      };
+
+      /* Pixels per block of the planar model (one SSE2/NEON register). */
+      const uint32_t PLANAR_BLOCK = 16;
+
+      /* Number of samples of the ViBe model in planar mode. */
+      const int PLANAR_NUMBER_OF_SAMPLES = 20;
+    }
+  }
+}
@@ -1,7 +1,19 @@
 #include <assert.h>
 #include <time.h>
+#include <new>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+#endif
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
 
 #include "vibe-background-sequential.h"
+#include "../../utils/FastRNG.h"
 
 //using namespace bgslibrary::algorithms::vibe;
 namespace bgslibrary
@@ -53,6 +65,9 @@ namespace bgslibrary
         uint32_t *jump;
         int *neighbor;
         uint32_t *position;
+
+        /* Random generator of this model (instead of the shared rand()). */
+        FastRNG rng;
       };
 
       // -----------------------------------------------------------------------------
@@ -96,6 +111,10 @@ namespace bgslibrary
         model->historyBuffer = NULL;
         model->lastHistoryImageSwapped = 0;
 
+        /* Random generator, see libvibeModel_Sequential_SetSeed. calloc does
+         * not construct it (it is trivially destructible, free is enough). */
+        new (&model->rng) FastRNG(FastRNG::DEFAULT_SEED);
+
         /* Buffers with random values. */
         model->jump = NULL;
         model->neighbor = NULL;
@@ -172,7 +191,19 @@ namespace bgslibrary
         int size = (model->width > model->height) ? 2 * model->width + 1 : 2 * model->height + 1;
 
         for (int i = 0; i < size; ++i)
-          model->jump[i] = (updateFactor == 1) ? 1 : (rand() % (2 * model->updateFactor)) + 1; // 1 or values between 1 and 2 * updateFactor.
+          model->jump[i] = (updateFactor == 1) ? 1 : (model->rng() % (2 * model->updateFactor)) + 1; // 1 or values between 1 and 2 * updateFactor.
+
+        return(0);
+      }
+
+      // -----------------------------------------------------------------------------
+      int32_t libvibeModel_Sequential_SetSeed(
+        vibeModel_Sequential_t *model,
+        const uint64_t seed
+      ) {
+        assert(model != NULL);
+
+        model->rng.seed(seed);
 
         return(0);
       }
@@ -236,7 +267,7 @@ namespace bgslibrary
           uint8_t value = image_data[index];
 
           for (int x = 0; x < model->numberOfSamples - NUMBER_OF_HISTORY_IMAGES; ++x) {
-            int value_plus_noise = value + rand() % 20 - 10;
+            int value_plus_noise = value + model->rng() % 20 - 10;
 
             if (value_plus_noise < 0) { value_plus_noise = 0; }
             if (value_plus_noise > 255) { value_plus_noise = 255; }
@@ -258,9 +289,9 @@ namespace bgslibrary
         assert(model->position != NULL);
 
         for (int i = 0; i < size; ++i) {
-          model->jump[i] = (rand() % (2 * model->updateFactor)) + 1;            // Values between 1 and 2 * updateFactor.
-          model->neighbor[i] = ((rand() % 3) - 1) + ((rand() % 3) - 1) * width; // Values between { -width - 1, ... , width + 1 }.
-          model->position[i] = rand() % (model->numberOfSamples);               // Values between 0 and numberOfSamples - 1.
+          model->jump[i] = (model->rng() % (2 * model->updateFactor)) + 1;            // Values between 1 and 2 * updateFactor.
+          model->neighbor[i] = ((model->rng() % 3) - 1) + ((model->rng() % 3) - 1) * width; // Values between { -width - 1, ... , width + 1 }.
+          model->position[i] = model->rng() % (model->numberOfSamples);               // Values between 0 and numberOfSamples - 1.
         }
 
         return(0);
@@ -383,7 +414,7 @@ namespace bgslibrary
         unsigned int x, y;
 
         for (y = 1; y < height - 1; ++y) {
-          shift = rand() % width;
+          shift = model->rng() % width;
           indX = jump[shift]; // index_jump should never be zero (> 1).
 
           while (indX < width - 1) {
@@ -412,7 +443,7 @@ namespace bgslibrary
 
         /* First row. */
         y = 0;
-        shift = rand() % width;
+        shift = model->rng() % width;
         indX = jump[shift]; // index_jump should never be zero (> 1).
 
         while (indX <= width - 1) {
@@ -433,7 +464,7 @@ namespace bgslibrary
 
         /* Last row. */
         y = height - 1;
-        shift = rand() % width;
+        shift = model->rng() % width;
         indX = jump[shift]; // index_jump should never be zero (> 1).
 
         while (indX <= width - 1) {
@@ -454,7 +485,7 @@ namespace bgslibrary
 
         /* First column. */
         x = 0;
-        shift = rand() % height;
+        shift = model->rng() % height;
         indY = jump[shift]; // index_jump should never be zero (> 1).
 
         while (indY <= height - 1) {
@@ -475,7 +506,7 @@ namespace bgslibrary
 
         /* Last column. */
         x = width - 1;
-        shift = rand() % height;
+        shift = model->rng() % height;
         indY = jump[shift]; // index_jump should never be zero (> 1).
 
         while (indY <= height - 1) {
@@ -495,9 +526,9 @@ namespace bgslibrary
         }
 
         /* The first pixel! */
-        if (rand() % model->updateFactor == 0) {
+        if (model->rng() % model->updateFactor == 0) {
           if (updating_mask[0] == 0) {
-            int position = rand() % model->numberOfSamples;
+            int position = model->rng() % model->numberOfSamples;
 
             if (position < NUMBER_OF_HISTORY_IMAGES)
               historyImage[position * width * height] = image_data[0];
@@ -548,7 +579,7 @@ namespace bgslibrary
         model->historyBuffer = (uint8_t *)malloc((3 * width) * height * (model->numberOfSamples - NUMBER_OF_HISTORY_IMAGES) * sizeof(uint8_t));
         assert(model->historyBuffer != NULL);
 
-        auto plus_noise = [](uint8_t value) -> int {int value_plus_noise = value + rand() % 20 - 10;
+        auto plus_noise = [model](uint8_t value) -> int {int value_plus_noise = value + model->rng() % 20 - 10;
           if (value_plus_noise < 0) { value_plus_noise = 0; }
           if (value_plus_noise > 255) { value_plus_noise = 255; }
           return value_plus_noise;};
@@ -579,14 +610,237 @@ namespace bgslibrary
         assert(model->position != NULL);
 
         for (int i = 0; i < size; ++i) {
-          model->jump[i] = (rand() % (2 * model->updateFactor)) + 1;            // Values between 1 and 2 * updateFactor.
-          model->neighbor[i] = ((rand() % 3) - 1) + ((rand() % 3) - 1) * width; // Values between { width - 1, ... , width + 1 }.
-          model->position[i] = rand() % (model->numberOfSamples);               // Values between 0 and numberOfSamples - 1.
+          model->jump[i] = (model->rng() % (2 * model->updateFactor)) + 1;            // Values between 1 and 2 * updateFactor.
+          model->neighbor[i] = ((model->rng() % 3) - 1) + ((model->rng() % 3) - 1) * width; // Values between { width - 1, ... , width + 1 }.
+          model->position[i] = model->rng() % (model->numberOfSamples);               // Values between 0 and numberOfSamples - 1.
         }
 
         return(0);
       }
 
+      // -----------------------------------------------------------------------------
+      // History images part of the C3R segmentation, 16 (SSE2, NEON) or 32 (AVX2)
+      // pixels at a time. For each pixel, segmentation_map receives
+      // matchingNumber minus the number of history images close to the pixel
+      // (modulo 256, as the scalar code). distance_is_close_8u_C3R compares
+      // the sum of the absolute differences with 4.5 * threshold, which for
+      // integers is the same as comparing it with floor(9 * threshold / 2).
+      // -----------------------------------------------------------------------------
+      static uint16_t history_distance_limit_8u_C3R(uint32_t threshold)
+      {
+        uint64_t limit = (9 * (uint64_t)threshold) / 2;
+        return (uint16_t)((limit > 3 * 255) ? 3 * 255 : limit);
+      }
+
+      static void history_segmentation_8u_C3R_scalar(const uint8_t *image_data, const uint8_t *historyImage,
+        uint32_t begin, uint32_t end, uint32_t imageSize, uint32_t matchingNumber, uint32_t matchingThreshold,
+        uint8_t *segmentation_map)
+      {
+        for (uint32_t index = begin; index < end; ++index) {
+          uint8_t value = (uint8_t)matchingNumber;
+          for (int i = 0; i < NUMBER_OF_HISTORY_IMAGES; ++i) {
+            const uint8_t *pels = historyImage + i * imageSize;
+            if (distance_is_close_8u_C3R(
+              image_data[3 * index], image_data[3 * index + 1], image_data[3 * index + 2],
+              pels[3 * index], pels[3 * index + 1], pels[3 * index + 2], matchingThreshold))
+              --value;
+          }
+          segmentation_map[index] = value;
+        }
+      }
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VIBE_SIMD_SSE2
+      // a = bytes 0, 3, 6..., b = bytes 1, 4, 7..., c = bytes 2, 5, 8... of the 48 bytes t0 t1 t2
+      static inline void deinterleave_8u_C3(__m128i t00, __m128i t01, __m128i t02, __m128i &a, __m128i &b, __m128i &c)
+      {
+        __m128i t10 = _mm_unpacklo_epi8(t00, _mm_unpackhi_epi64(t01, t01));
+        __m128i t11 = _mm_unpacklo_epi8(_mm_unpackhi_epi64(t00, t00), t02);
+        __m128i t12 = _mm_unpacklo_epi8(t01, _mm_unpackhi_epi64(t02, t02));
+
+        __m128i t20 = _mm_unpacklo_epi8(t10, _mm_unpackhi_epi64(t11, t11));
+        __m128i t21 = _mm_unpacklo_epi8(_mm_unpackhi_epi64(t10, t10), t12);
+        __m128i t22 = _mm_unpacklo_epi8(t11, _mm_unpackhi_epi64(t12, t12));
+
+        __m128i t30 = _mm_unpacklo_epi8(t20, _mm_unpackhi_epi64(t21, t21));
+        __m128i t31 = _mm_unpacklo_epi8(_mm_unpackhi_epi64(t20, t20), t22);
+        __m128i t32 = _mm_unpacklo_epi8(t21, _mm_unpackhi_epi64(t22, t22));
+
+        a = _mm_unpacklo_epi8(t30, _mm_unpackhi_epi64(t31, t31));
+        b = _mm_unpacklo_epi8(_mm_unpackhi_epi64(t30, t30), t32);
+        c = _mm_unpacklo_epi8(t31, _mm_unpackhi_epi64(t32, t32));
+      }
+
+      static inline __m128i absdiff_8u(__m128i a, __m128i b)
+      {
+        return _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+      }
+
+      static uint32_t history_segmentation_8u_C3R_sse2(const uint8_t *image_data, const uint8_t *historyImage,
+        uint32_t numPixels, uint32_t imageSize, uint32_t matchingNumber, uint32_t matchingThreshold,
+        uint8_t *segmentation_map)
+      {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i limit = _mm_set1_epi16((short)history_distance_limit_8u_C3R(matchingThreshold));
+        // counts up from matchingNumber - NUMBER_OF_HISTORY_IMAGES for each history image that is not close
+        const __m128i initial = _mm_set1_epi8((char)(uint8_t)(matchingNumber - NUMBER_OF_HISTORY_IMAGES));
+
+        uint32_t index = 0;
+        for (; index + 16 <= numPixels; index += 16) {
+          const uint8_t *pixels = image_data + 3 * index;
+          __m128i p0 = _mm_loadu_si128((const __m128i*)pixels);
+          __m128i p1 = _mm_loadu_si128((const __m128i*)(pixels + 16));
+          __m128i p2 = _mm_loadu_si128((const __m128i*)(pixels + 32));
+          __m128i value = initial;
+
+          for (int i = 0; i < NUMBER_OF_HISTORY_IMAGES; ++i) {
+            const uint8_t *pels = historyImage + i * imageSize + 3 * index;
+            __m128i a, b, c;
+            deinterleave_8u_C3(
+              absdiff_8u(p0, _mm_loadu_si128((const __m128i*)pels)),
+              absdiff_8u(p1, _mm_loadu_si128((const __m128i*)(pels + 16))),
+              absdiff_8u(p2, _mm_loadu_si128((const __m128i*)(pels + 32))), a, b, c);
+
+            __m128i sum_lo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)), _mm_unpacklo_epi8(c, zero));
+            __m128i sum_hi = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)), _mm_unpackhi_epi8(c, zero));
+            __m128i far = _mm_packs_epi16(_mm_cmpgt_epi16(sum_lo, limit), _mm_cmpgt_epi16(sum_hi, limit));
+            value = _mm_sub_epi8(value, far);
+          }
+          _mm_storeu_si128((__m128i*)(segmentation_map + index), value);
+        }
+        return index;
+      }
+#endif
+
+#if defined(VIBE_SIMD_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define VIBE_SIMD_AVX2
+      // Same as the SSE2 version, each 128-bit lane holds 16 of the 32 pixels.
+      __attribute__((target("avx2")))
+      static inline void deinterleave_8u_C3(__m256i t00, __m256i t01, __m256i t02, __m256i &a, __m256i &b, __m256i &c)
+      {
+        __m256i t10 = _mm256_unpacklo_epi8(t00, _mm256_unpackhi_epi64(t01, t01));
+        __m256i t11 = _mm256_unpacklo_epi8(_mm256_unpackhi_epi64(t00, t00), t02);
+        __m256i t12 = _mm256_unpacklo_epi8(t01, _mm256_unpackhi_epi64(t02, t02));
+
+        __m256i t20 = _mm256_unpacklo_epi8(t10, _mm256_unpackhi_epi64(t11, t11));
+        __m256i t21 = _mm256_unpacklo_epi8(_mm256_unpackhi_epi64(t10, t10), t12);
+        __m256i t22 = _mm256_unpacklo_epi8(t11, _mm256_unpackhi_epi64(t12, t12));
+
+        __m256i t30 = _mm256_unpacklo_epi8(t20, _mm256_unpackhi_epi64(t21, t21));
+        __m256i t31 = _mm256_unpacklo_epi8(_mm256_unpackhi_epi64(t20, t20), t22);
+        __m256i t32 = _mm256_unpacklo_epi8(t21, _mm256_unpackhi_epi64(t22, t22));
+
+        a = _mm256_unpacklo_epi8(t30, _mm256_unpackhi_epi64(t31, t31));
+        b = _mm256_unpacklo_epi8(_mm256_unpackhi_epi64(t30, t30), t32);
+        c = _mm256_unpacklo_epi8(t31, _mm256_unpackhi_epi64(t32, t32));
+      }
+
+      __attribute__((target("avx2")))
+      static inline __m256i absdiff_8u(__m256i a, __m256i b)
+      {
+        return _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a));
+      }
+
+      // bytes [0, 48) of ptr in the low lane and [48, 96) in the high lane, 16 bytes each
+      __attribute__((target("avx2")))
+      static inline __m256i load_lanes(const uint8_t *ptr)
+      {
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)ptr)),
+          _mm_loadu_si128((const __m128i*)(ptr + 48)), 1);
+      }
+
+      __attribute__((target("avx2")))
+      static uint32_t history_segmentation_8u_C3R_avx2(const uint8_t *image_data, const uint8_t *historyImage,
+        uint32_t numPixels, uint32_t imageSize, uint32_t matchingNumber, uint32_t matchingThreshold,
+        uint8_t *segmentation_map)
+      {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i limit = _mm256_set1_epi16((short)history_distance_limit_8u_C3R(matchingThreshold));
+        const __m256i initial = _mm256_set1_epi8((char)(uint8_t)(matchingNumber - NUMBER_OF_HISTORY_IMAGES));
+
+        uint32_t index = 0;
+        for (; index + 32 <= numPixels; index += 32) {
+          const uint8_t *pixels = image_data + 3 * index;
+          __m256i p0 = load_lanes(pixels);
+          __m256i p1 = load_lanes(pixels + 16);
+          __m256i p2 = load_lanes(pixels + 32);
+          __m256i value = initial;
+
+          for (int i = 0; i < NUMBER_OF_HISTORY_IMAGES; ++i) {
+            const uint8_t *pels = historyImage + i * imageSize + 3 * index;
+            __m256i a, b, c;
+            deinterleave_8u_C3(
+              absdiff_8u(p0, load_lanes(pels)),
+              absdiff_8u(p1, load_lanes(pels + 16)),
+              absdiff_8u(p2, load_lanes(pels + 32)), a, b, c);
+
+            __m256i sum_lo = _mm256_add_epi16(_mm256_add_epi16(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero)), _mm256_unpacklo_epi8(c, zero));
+            __m256i sum_hi = _mm256_add_epi16(_mm256_add_epi16(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero)), _mm256_unpackhi_epi8(c, zero));
+            // packs works per lane, so the pixels are back in order
+            __m256i far = _mm256_packs_epi16(_mm256_cmpgt_epi16(sum_lo, limit), _mm256_cmpgt_epi16(sum_hi, limit));
+            value = _mm256_sub_epi8(value, far);
+          }
+          _mm256_storeu_si256((__m256i*)(segmentation_map + index), value);
+        }
+        return index;
+      }
+
+      static bool cpu_supports_avx2()
+      {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+      }
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define VIBE_SIMD_NEON
+      static uint32_t history_segmentation_8u_C3R_neon(const uint8_t *image_data, const uint8_t *historyImage,
+        uint32_t numPixels, uint32_t imageSize, uint32_t matchingNumber, uint32_t matchingThreshold,
+        uint8_t *segmentation_map)
+      {
+        const uint16x8_t limit = vdupq_n_u16(history_distance_limit_8u_C3R(matchingThreshold));
+        const uint8x16_t initial = vdupq_n_u8((uint8_t)(matchingNumber - NUMBER_OF_HISTORY_IMAGES));
+
+        uint32_t index = 0;
+        for (; index + 16 <= numPixels; index += 16) {
+          uint8x16x3_t pixels = vld3q_u8(image_data + 3 * index);
+          uint8x16_t value = initial;
+
+          for (int i = 0; i < NUMBER_OF_HISTORY_IMAGES; ++i) {
+            uint8x16x3_t pels = vld3q_u8(historyImage + i * imageSize + 3 * index);
+            uint8x16_t a = vabdq_u8(pixels.val[0], pels.val[0]);
+            uint8x16_t b = vabdq_u8(pixels.val[1], pels.val[1]);
+            uint8x16_t c = vabdq_u8(pixels.val[2], pels.val[2]);
+
+            uint16x8_t sum_lo = vaddw_u8(vaddl_u8(vget_low_u8(a), vget_low_u8(b)), vget_low_u8(c));
+            uint16x8_t sum_hi = vaddw_u8(vaddl_u8(vget_high_u8(a), vget_high_u8(b)), vget_high_u8(c));
+            uint8x16_t far = vcombine_u8(vmovn_u16(vcgtq_u16(sum_lo, limit)), vmovn_u16(vcgtq_u16(sum_hi, limit)));
+            value = vsubq_u8(value, far);
+          }
+          vst1q_u8(segmentation_map + index, value);
+        }
+        return index;
+      }
+#endif
+
+      static void history_segmentation_8u_C3R(const uint8_t *image_data, const uint8_t *historyImage,
+        uint32_t numPixels, uint32_t matchingNumber, uint32_t matchingThreshold, uint8_t *segmentation_map)
+      {
+        uint32_t imageSize = 3 * numPixels;
+        uint32_t done = 0;
+#if defined(VIBE_SIMD_AVX2)
+        if (cpu_supports_avx2())
+          done = history_segmentation_8u_C3R_avx2(image_data, historyImage, numPixels, imageSize, matchingNumber, matchingThreshold, segmentation_map);
+        else
+          done = history_segmentation_8u_C3R_sse2(image_data, historyImage, numPixels, imageSize, matchingNumber, matchingThreshold, segmentation_map);
+#elif defined(VIBE_SIMD_SSE2)
+        done = history_segmentation_8u_C3R_sse2(image_data, historyImage, numPixels, imageSize, matchingNumber, matchingThreshold, segmentation_map);
+#elif defined(VIBE_SIMD_NEON)
+        done = history_segmentation_8u_C3R_neon(image_data, historyImage, numPixels, imageSize, matchingNumber, matchingThreshold, segmentation_map);
+#endif
+        history_segmentation_8u_C3R_scalar(image_data, historyImage, done, numPixels, imageSize, matchingNumber, matchingThreshold, segmentation_map);
+      }
+
       // -----------------------------------------------------------------------------
       // Segmentation of a C3R model
       // -----------------------------------------------------------------------------
@@ -610,36 +864,8 @@ namespace bgslibrary
         uint8_t *historyImage = model->historyImage;
         uint8_t *historyBuffer = model->historyBuffer;
 
-        /* Segmentation. */
-        memset(segmentation_map, matchingNumber - 1, width * height);
-
-        /* First history Image structure. */
-        uint8_t *first = historyImage;
-
-        for (int index = width * height - 1; index >= 0; --index) {
-          if (
-            !distance_is_close_8u_C3R(
-              image_data[3 * index], image_data[3 * index + 1], image_data[3 * index + 2],
-              first[3 * index], first[3 * index + 1], first[3 * index + 2], matchingThreshold
-            )
-            )
-            segmentation_map[index] = matchingNumber;
-        }
-
-        /* Next historyImages. */
-        for (int i = 1; i < NUMBER_OF_HISTORY_IMAGES; ++i) {
-          uint8_t *pels = historyImage + i * (3 * width) * height;
-
-          for (int index = width * height - 1; index >= 0; --index) {
-            if (
-              distance_is_close_8u_C3R(
-                image_data[3 * index], image_data[3 * index + 1], image_data[3 * index + 2],
-                pels[3 * index], pels[3 * index + 1], pels[3 * index + 2], matchingThreshold
-              )
-              )
-              --segmentation_map[index];
-          }
-        }
+        /* Segmentation against the history images. */
+        history_segmentation_8u_C3R(image_data, historyImage, width * height, matchingNumber, matchingThreshold, segmentation_map);
 
         // For swapping
         model->lastHistoryImageSwapped = (model->lastHistoryImageSwapped + 1) % NUMBER_OF_HISTORY_IMAGES;
@@ -725,7 +951,7 @@ namespace bgslibrary
         int x, y;
 
         for (y = 1; y < height - 1; ++y) {
-          shift = rand() % width;
+          shift = model->rng() % width;
           indX = jump[shift]; // index_jump should never be zero (> 1).
 
           while (indX < width - 1) {
@@ -768,7 +994,7 @@ namespace bgslibrary
 
         /* First row. */
         y = 0;
-        shift = rand() % width;
+        shift = model->rng() % width;
         indX = jump[shift]; // index_jump should never be zero (> 1).
 
         while (indX <= width - 1) {
@@ -799,7 +1025,7 @@ namespace bgslibrary
 
         /* Last row. */
         y = height - 1;
-        shift = rand() % width;
+        shift = model->rng() % width;
         indX = jump[shift]; // index_jump should never be zero (> 1).
 
         while (indX <= width - 1) {
@@ -830,7 +1056,7 @@ namespace bgslibrary
 
         /* First column. */
         x = 0;
-        shift = rand() % height;
+        shift = model->rng() % height;
         indY = jump[shift]; // index_jump should never be zero (> 1).
 
         while (indY <= height - 1) {
@@ -860,7 +1086,7 @@ namespace bgslibrary
 
         /* Last column. */
         x = width - 1;
-        shift = rand() % height;
+        shift = model->rng() % height;
         indY = jump[shift]; // index_jump should never be zero (> 1).
 
         while (indY <= height - 1) {
@@ -890,9 +1116,9 @@ namespace bgslibrary
         }
 
         /* The first pixel! */
-        if (rand() % model->updateFactor == 0) {
+        if (model->rng() % model->updateFactor == 0) {
           if (updating_mask[0] == 0) {
-            int position = rand() % model->numberOfSamples;
+            int position = model->rng() % model->numberOfSamples;
 
             uint8_t r = image_data[0];
             uint8_t g = image_data[1];
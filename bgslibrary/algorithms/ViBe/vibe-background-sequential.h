@@ -108,6 +108,18 @@ namespace bgslibrary
         const uint32_t updateFactor
       );
 
+      /**
+       * Setter.
+       *
+       * @param model The data structure with ViBe's background subtraction model and parameters.
+       * @param seed Seed of the random generator of the model. Call it before libvibeModel_Sequential_AllocInit_8u_C1R or libvibeModel_Sequential_AllocInit_8u_C3R to replay the same sequence.
+       * @return
+       */
+      int32_t libvibeModel_Sequential_SetSeed(
+        vibeModel_Sequential_t *model,
+        const uint64_t seed
+      );
+
       /**
        * Getter.
        *
@@ -73,6 +73,76 @@ void WeightedMovingMean::process(const cv::Mat &img_input, cv::Mat &img_output,
   firstTime = false;
 }
 
+void WeightedMovingMean::processBatch(const std::vector<cv::Mat> &imgs_input, std::vector<cv::Mat> &imgs_foreground)
+{
+  setShowOutput(false);
+  imgs_foreground.resize(imgs_input.size());
+
+  // the first two frames only fill the history
+  size_t first = 0;
+  while (first < imgs_input.size() && img_input_prev_2.empty()) {
+    cv::Mat img_bgmodel;
+    process(imgs_input[first], imgs_foreground[first], img_bgmodel);
+    first++;
+  }
+  if (first == imgs_input.size())
+    return;
+
+  // every frame is converted to float once instead of three times
+  cv::Mat img_input_prev_2_f;
+  img_input_prev_2.convertTo(img_input_prev_2_f, CV_32F, 1. / 255.);
+  cv::Mat img_input_prev_1_f;
+  img_input_prev_1.convertTo(img_input_prev_1_f, CV_32F, 1. / 255.);
+  cv::Mat img_input_f;
+  cv::Mat img_background_f;
+
+  for (size_t i = first; i < imgs_input.size(); ++i) {
+    const cv::Mat &img_input = imgs_input[i];
+    cv::Mat &img_output = imgs_foreground[i];
+
+    img_input.convertTo(img_input_f, CV_32F, 1. / 255.);
+
+    if (enableWeight)
+      img_background_f = ((img_input_f * 0.5) + (img_input_prev_1_f * 0.3) + (img_input_prev_2_f * 0.2));
+    else
+      img_background_f = ((img_input_f)+(img_input_prev_1_f)+(img_input_prev_2_f)) / 3.0;
+
+    double minVal, maxVal;
+    minVal = 0.; maxVal = 1.;
+    img_background_f.convertTo(img_background, CV_8U, 255.0 / (maxVal - minVal), -minVal);
+
+    cv::absdiff(img_input, img_background, img_output);
+
+    if (img_output.channels() == 3)
+      cv::cvtColor(img_output, img_output, CV_BGR2GRAY);
+
+    if (enableThreshold)
+      cv::threshold(img_output, img_output, threshold, 255, cv::THRESH_BINARY);
+
+    // rotate the float history, the oldest buffer is reused for the next frame
+    cv::Mat img_oldest_f = img_input_prev_2_f;
+    img_input_prev_2_f = img_input_prev_1_f;
+    img_input_prev_1_f = img_input_f;
+    img_input_f = img_oldest_f;
+  }
+
+  imgs_foreground.back().copyTo(img_foreground);
+  if (imgs_input.size() - first >= 2)
+    imgs_input[imgs_input.size() - 2].copyTo(img_input_prev_2);
+  else
+    img_input_prev_1.copyTo(img_input_prev_2);
+  imgs_input.back().copyTo(img_input_prev_1);
+
+  firstTime = false;
+}
+
+size_t WeightedMovingMean::getModelMemory() const
+{
+  return IBGS::getModelMemory() +
+    img_input_prev_1.total() * img_input_prev_1.elemSize() +
+    img_input_prev_2.total() * img_input_prev_2.elemSize();
+}
+
 void WeightedMovingMean::save_config(cv::FileStorage &fs) {
   fs << "enableWeight" << enableWeight;
   fs << "enableThreshold" << enableThreshold;
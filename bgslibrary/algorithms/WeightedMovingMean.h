@@ -20,6 +20,9 @@ namespace bgslibrary
       ~WeightedMovingMean();
 
       void process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img_bgmodel);
+      void processBatch(const std::vector<cv::Mat> &imgs_input, std::vector<cv::Mat> &imgs_foreground);
+      int getStripeHalo() const { return 0; }
+      size_t getModelMemory() const;
 
     private:
       void save_config(cv::FileStorage &fs);
@@ -89,7 +89,7 @@ void WeightedMovingVariance::process(const cv::Mat &img_input, cv::Mat &img_outp
 
   img_foreground.copyTo(img_output);
 
-  img_background = cv::Mat::zeros(img_input.size(), img_input.type());
+  createZeros(img_background, img_input.size(), img_input.type());
   img_background.copyTo(img_bgmodel);
 
   img_input_prev_1.copyTo(img_input_prev_2);
@@ -111,6 +111,13 @@ cv::Mat WeightedMovingVariance::computeWeightedVariance(const cv::Mat &img_input
   return img_f;
 }
 
+size_t WeightedMovingVariance::getModelMemory() const
+{
+  return IBGS::getModelMemory() +
+    img_input_prev_1.total() * img_input_prev_1.elemSize() +
+    img_input_prev_2.total() * img_input_prev_2.elemSize();
+}
+
 void WeightedMovingVariance::save_config(cv::FileStorage &fs) {
   fs << "enableWeight" << enableWeight;
   fs << "enableThreshold" << enableThreshold;
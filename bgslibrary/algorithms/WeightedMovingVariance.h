@@ -20,6 +20,7 @@ namespace bgslibrary
       ~WeightedMovingVariance();
 
       void process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img_bgmodel);
+      size_t getModelMemory() const;
       cv::Mat computeWeightedVariance(const cv::Mat &img_input_f, const cv::Mat &img_mean_f, const double weight);
 
     private:
@@ -49,6 +49,44 @@ void MeanBGS::Update(int frame_num, const RgbImage& data, const BwImage& update_
   }
 }
 
+void MeanBGS::SubtractUpdate(const std::vector<const IplImage*>& data,
+  const std::vector<IplImage*>& high_threshold_masks)
+{
+  const float alpha = m_params.Alpha();
+  float mean[NUM_CHANNELS];
+
+  for (unsigned int r = 0; r < m_params.Height(); ++r)
+  {
+    for (unsigned int c = 0; c < m_params.Width(); ++c)
+    {
+      for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+        mean[ch] = m_mean(r, c, ch);
+
+      for (size_t i = 0; i < data.size(); ++i)
+      {
+        const unsigned char* pixel = (const unsigned char*)&data[i]->imageData[r*data[i]->widthStep + c*data[i]->nChannels];
+
+        // same arithmetic as SubtractPixel() followed by Update()
+        float dist = 0;
+        for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+          dist += (pixel[ch] - mean[ch])*(pixel[ch] - mean[ch]);
+
+        high_threshold_masks[i]->imageData[r*high_threshold_masks[i]->widthStep + c] =
+          (char)((dist > m_params.HighThreshold()) ? FOREGROUND : BACKGROUND);
+
+        for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+          mean[ch] = alpha * mean[ch] + (1.0f - alpha) * pixel[ch];
+      }
+
+      for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+      {
+        m_mean(r, c, ch) = mean[ch];
+        m_background(r, c, ch) = (unsigned char)(mean[ch] + 0.5);
+      }
+    }
+  }
+}
+
 void MeanBGS::SubtractPixel(int r, int c, const RgbPixel& pixel,
   unsigned char& low_threshold,
   unsigned char& high_threshold)
@@ -44,6 +44,11 @@ namespace bgslibrary
         BwImage& low_threshold_mask, BwImage& high_threshold_mask);
       void Update(int frame_num, const RgbImage& data, const BwImage& update_mask);
 
+      // Subtract and update a sequence of frames visiting each pixel of the model once.
+      // Every pixel is updated, i.e. the update mask is all background.
+      void SubtractUpdate(const std::vector<const IplImage*>& data,
+        const std::vector<IplImage*>& high_threshold_masks);
+
       RgbImage* Background() { return &m_background; }
 
     private:
@@ -3,7 +3,7 @@
 using namespace bgslibrary::tools;
 
 ForegroundMaskAnalysis::ForegroundMaskAnalysis() :
-  firstTime(true), showOutput(true),
+  firstTime(true), showOutput(true), headless(false),
   stopAt(0), img_ref_path("")
 {
   debug_construction(ForegroundMaskAnalysis);
@@ -14,6 +14,22 @@ ForegroundMaskAnalysis::~ForegroundMaskAnalysis() {
   debug_destruction(ForegroundMaskAnalysis);
 }
 
+void ForegroundMaskAnalysis::setHeadless(const std::string &similarity_path)
+{
+  headless = true;
+  showOutput = false;
+  similarityFile.open(similarity_path.c_str());
+  if (similarityFile.is_open())
+    similarityFile << "frame,algorithm,similarity" << std::endl;
+  else
+    std::cerr << "Cannot write " << similarity_path << std::endl;
+}
+
+void ForegroundMaskAnalysis::setShowOutput(bool value)
+{
+  showOutput = value;
+}
+
 void ForegroundMaskAnalysis::process(const long &frameNumber, const std::string &name, const cv::Mat &img_input)
 {
   if (img_input.empty())
@@ -49,9 +65,18 @@ void ForegroundMaskAnalysis::process(const long &frameNumber, const std::string
       cv::imshow("AvB", u);
     }
 
-    std::cout << name << " - Similarity Measure: " << s << " press ENTER to continue" << std::endl;
+    if (headless) {
+      std::cout << name << " - Similarity Measure: " << s << std::endl;
+      if (similarityFile.is_open())
+        similarityFile << frameNumber << "," << name << "," << s << std::endl;
+    }
+    else if (showOutput) {
+      std::cout << name << " - Similarity Measure: " << s << " press ENTER to continue" << std::endl;
 
-    cv::waitKey(0);
+      cv::waitKey(0);
+    }
+    else
+      std::cout << name << " - Similarity Measure: " << s << std::endl;
   }
 
   firstTime = false;
@@ -23,6 +23,8 @@ namespace bgslibrary
     private:
       bool firstTime;
       bool showOutput;
+      bool headless;
+      std::ofstream similarityFile;
 
     public:
       ForegroundMaskAnalysis();
@@ -31,6 +33,8 @@ namespace bgslibrary
       int stopAt;
       std::string img_ref_path;
 
+      void setHeadless(const std::string &similarity_path);
+      void setShowOutput(bool value);
       void process(const long &frameNumber, const std::string &name, const cv::Mat &img_input);
 
     private:
@@ -0,0 +1,221 @@
+#include "StreamManager.h"
+
+using namespace bgslibrary::tools;
+
+StreamManager::StreamManager(size_t numThreads, size_t _maxQueuedFrames,
+  bool _dropFrames, size_t _framesPerSlice) :
+  maxQueuedFrames(std::max<size_t>(1, _maxQueuedFrames)),
+  dropFrames(_dropFrames),
+  framesPerSlice(std::max<size_t>(1, _framesPerSlice)),
+  nextStreamId(0), inFlight(0), pool(numThreads)
+{
+  debug_construction(StreamManager);
+}
+
+StreamManager::~StreamManager() {
+  debug_destruction(StreamManager);
+  waitIdle();
+}
+
+int StreamManager::addStream(const std::string &algorithmName, FrameCallback callback)
+{
+  // algorithms load their config file in the constructor, so they are
+  // created here and not on the workers
+  auto bgs = algorithms::BGS_Factory::Instance()->Acquire(algorithmName);
+  if (!bgs) {
+    std::cerr << "Unknown algorithm " << algorithmName << std::endl;
+    return -1;
+  }
+  bgs->setShowOutput(false);
+
+  auto stream = std::make_shared<Stream>();
+  stream->bgs = bgs;
+  stream->callback = callback;
+
+  std::unique_lock<std::mutex> lock(streamsMutex);
+  stream->id = nextStreamId++;
+  streams[stream->id] = stream;
+  return stream->id;
+}
+
+bool StreamManager::removeStream(int streamId)
+{
+  std::shared_ptr<Stream> stream;
+  {
+    std::unique_lock<std::mutex> lock(streamsMutex);
+    auto it = streams.find(streamId);
+    if (it == streams.end())
+      return false;
+    stream = it->second;
+    streams.erase(it);
+  }
+
+  long discarded;
+  {
+    std::unique_lock<std::mutex> lock(stream->mutex);
+    stream->removed = true;
+    discarded = static_cast<long>(stream->pending.size());
+    stream->stats.dropped += discarded;
+    stream->pending.clear();
+  }
+  finishFrames(discarded);
+  return true;
+}
+
+bool StreamManager::submit(int streamId, const cv::Mat &img_input)
+{
+  auto stream = findStream(streamId);
+  if (!stream || img_input.empty())
+    return false;
+
+  // the copy is made outside of the stream lock
+  PendingFrame frame;
+  frame.img_input = img_input.clone();
+
+  // counted before it can be processed, so waitIdle() never sees it missing
+  {
+    std::unique_lock<std::mutex> lock(idleMutex);
+    inFlight++;
+  }
+
+  bool accepted = false, schedule = false;
+  long dropped = 0;
+  {
+    std::unique_lock<std::mutex> lock(stream->mutex);
+    if (!stream->removed && !stream->stats.failed &&
+      (dropFrames || stream->pending.size() < maxQueuedFrames)) {
+      if (stream->pending.size() >= maxQueuedFrames) {
+        stream->pending.pop_front();
+        stream->stats.dropped++;
+        dropped = 1;
+      }
+      frame.frameNumber = stream->nextFrameNumber++;
+      stream->pending.push_back(std::move(frame));
+      stream->stats.submitted++;
+      accepted = true;
+      if (!stream->scheduled)
+        schedule = stream->scheduled = true;
+    }
+  }
+  finishFrames(accepted ? dropped : 1);
+  if (!accepted)
+    return false;
+
+  if (schedule)
+    pool.submit([this, stream]() { runStream(stream); });
+  return true;
+}
+
+void StreamManager::waitIdle()
+{
+  std::unique_lock<std::mutex> lock(idleMutex);
+  idleCondition.wait(lock, [this] { return inFlight == 0; });
+}
+
+std::shared_ptr<bgslibrary::algorithms::IBGS> StreamManager::getAlgorithm(int streamId)
+{
+  auto stream = findStream(streamId);
+  return stream ? stream->bgs : nullptr;
+}
+
+StreamManager::StreamStats StreamManager::getStats(int streamId)
+{
+  auto stream = findStream(streamId);
+  if (!stream)
+    return StreamStats();
+  std::unique_lock<std::mutex> lock(stream->mutex);
+  return stream->stats;
+}
+
+std::vector<int> StreamManager::getStreamIds()
+{
+  std::unique_lock<std::mutex> lock(streamsMutex);
+  std::vector<int> ids;
+  ids.reserve(streams.size());
+  for (auto it = streams.begin(); it != streams.end(); ++it)
+    ids.push_back(it->first);
+  return ids;
+}
+
+size_t StreamManager::numThreads() const {
+  return pool.size();
+}
+
+std::shared_ptr<StreamManager::Stream> StreamManager::findStream(int streamId)
+{
+  std::unique_lock<std::mutex> lock(streamsMutex);
+  auto it = streams.find(streamId);
+  return it != streams.end() ? it->second : nullptr;
+}
+
+void StreamManager::runStream(const std::shared_ptr<Stream> &stream)
+{
+  // only one task per stream is queued or running at any time (scheduled),
+  // which keeps the frames of a stream in order
+  for (size_t n = 0; n < framesPerSlice; ++n)
+  {
+    PendingFrame frame;
+    {
+      std::unique_lock<std::mutex> lock(stream->mutex);
+      if (stream->pending.empty()) {
+        stream->scheduled = false;
+        return;
+      }
+      frame = std::move(stream->pending.front());
+      stream->pending.pop_front();
+    }
+
+    bool failed = false;
+    try
+    {
+      stream->bgs->processFrame(frame.img_input, stream->img_foreground, stream->img_background);
+      if (stream->callback)
+        stream->callback(stream->id, frame.frameNumber, stream->img_foreground, stream->img_background);
+    }
+    catch (const std::exception &e)
+    {
+      std::cerr << "Stream " << stream->id << " failed at frame " << frame.frameNumber << ": " << e.what() << std::endl;
+      failed = true;
+    }
+    catch (...)
+    {
+      std::cerr << "Stream " << stream->id << " failed at frame " << frame.frameNumber << ": unknown exception" << std::endl;
+      failed = true;
+    }
+
+    long discarded = 0;
+    {
+      std::unique_lock<std::mutex> lock(stream->mutex);
+      if (!failed)
+        stream->stats.processed++;
+      else {
+        // the model state is unknown after an exception, stop the stream
+        stream->stats.failed = true;
+        discarded = static_cast<long>(stream->pending.size());
+        stream->stats.dropped += discarded;
+        stream->pending.clear();
+      }
+    }
+    finishFrames(1 + discarded);
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(stream->mutex);
+    if (stream->pending.empty()) {
+      stream->scheduled = false;
+      return;
+    }
+  }
+  // go to the back of the queue to give the other streams their turn
+  pool.submit([this, stream]() { runStream(stream); });
+}
+
+void StreamManager::finishFrames(long count)
+{
+  if (count == 0)
+    return;
+  std::unique_lock<std::mutex> lock(idleMutex);
+  inFlight -= count;
+  if (inFlight == 0)
+    idleCondition.notify_all();
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "../algorithms/IBGS.h"
+#include "../utils/WorkStealingPool.h"
+
+namespace bgslibrary
+{
+  namespace tools
+  {
+    // Runs many independent background subtractors (one per stream) on a
+    // shared pool of worker threads, instead of one thread per camera.
+    // Frames of the same stream are processed one at a time and in the order
+    // they were submitted; a stream gives its worker back after framesPerSlice
+    // frames so that busy streams cannot starve the others.
+    class StreamManager
+    {
+    public:
+      // Called on a worker thread after each processed frame. The masks are
+      // only valid during the call, clone them to keep them.
+      typedef std::function<void(int streamId, long frameNumber,
+        const cv::Mat &img_foreground, const cv::Mat &img_background)> FrameCallback;
+
+      struct StreamStats
+      {
+        long submitted = 0;
+        long processed = 0;
+        long dropped = 0;
+        bool failed = false;
+      };
+
+      explicit StreamManager(size_t numThreads = 0, size_t maxQueuedFrames = 8,
+        bool dropFrames = true, size_t framesPerSlice = 1);
+      ~StreamManager();
+
+      // Creates the algorithm through BGS_Factory, returns -1 if it is unknown.
+      int addStream(const std::string &algorithmName, FrameCallback callback = FrameCallback());
+      // Discards the frames still queued for the stream.
+      bool removeStream(int streamId);
+      // Queues a copy of the frame. When the stream queue is full the oldest
+      // frame is dropped (dropFrames) or false is returned.
+      bool submit(int streamId, const cv::Mat &img_input);
+      // Blocks until every submitted frame has been processed or dropped.
+      void waitIdle();
+
+      std::shared_ptr<algorithms::IBGS> getAlgorithm(int streamId);
+      StreamStats getStats(int streamId);
+      std::vector<int> getStreamIds();
+      size_t numThreads() const;
+
+    private:
+      struct PendingFrame
+      {
+        long frameNumber;
+        cv::Mat img_input;
+      };
+      struct Stream
+      {
+        int id;
+        std::shared_ptr<algorithms::IBGS> bgs;
+        long nextFrameNumber = 0;
+        FrameCallback callback;
+        std::mutex mutex;
+        std::deque<PendingFrame> pending;
+        bool scheduled = false;
+        bool removed = false;
+        StreamStats stats;
+        // only touched by the task currently processing the stream
+        cv::Mat img_foreground;
+        cv::Mat img_background;
+      };
+
+      const size_t maxQueuedFrames;
+      const bool dropFrames;
+      const size_t framesPerSlice;
+
+      std::mutex streamsMutex;
+      std::map<int, std::shared_ptr<Stream>> streams;
+      int nextStreamId;
+
+      std::mutex idleMutex;
+      std::condition_variable idleCondition;
+      long inFlight;
+
+      // declared last: destroyed (and drained) before the streams
+      WorkStealingPool pool;
+
+      std::shared_ptr<Stream> findStream(int streamId);
+      void runStream(const std::shared_ptr<Stream> &stream);
+      void finishFrames(long count);
+    };
+  }
+}
@@ -0,0 +1,136 @@
+#include "StripeParallelBGS.h"
+
+#include <future>
+
+using namespace bgslibrary::tools;
+
+StripeParallelBGS::StripeParallelBGS(const std::string &_algorithmName,
+  size_t numStripes, size_t numThreads) :
+  IBGS("StripeParallel:" + _algorithmName), wrappedName(_algorithmName),
+  registered(false), halo(-1), maxStripes(numStripes), threadPool(numThreads)
+{
+  debug_construction(StripeParallelBGS);
+  auto bgs = algorithms::BGS_Factory::Instance()->Create(wrappedName);
+  if (bgs) {
+    registered = true;
+    halo = bgs->getStripeHalo();
+  }
+  else
+    std::cerr << "Unknown algorithm " << wrappedName << std::endl;
+  if (maxStripes == 0)
+    maxStripes = threadPool.size();
+}
+
+StripeParallelBGS::~StripeParallelBGS() {
+  debug_destruction(StripeParallelBGS);
+}
+
+int StripeParallelBGS::getStripeHalo() const {
+  return halo;
+}
+
+size_t StripeParallelBGS::getModelMemory() const
+{
+  size_t bytes = 0;
+  for (const auto &stripe : stripes)
+    bytes += stripe.bgs->getModelMemory();
+  return bytes;
+}
+
+size_t StripeParallelBGS::getNumStripes() const {
+  return stripes.size();
+}
+
+void StripeParallelBGS::createStripes(const cv::Size &size)
+{
+  int numStripes = 1;
+  if (halo >= 0) {
+    int minRows = 2 * halo + 1;
+    if (minRows < MIN_STRIPE_ROWS)
+      minRows = MIN_STRIPE_ROWS;
+    numStripes = std::max(1, std::min(static_cast<int>(maxStripes), size.height / minRows));
+  }
+  else
+    std::cerr << wrappedName << " cannot be split in stripes, running it on the whole frame" << std::endl;
+
+  stripes.clear();
+  stripes.resize(numStripes);
+  for (int i = 0; i < numStripes; ++i) {
+    Stripe &stripe = stripes[i];
+    stripe.begin = size.height * i / numStripes;
+    stripe.end = size.height * (i + 1) / numStripes;
+    stripe.padBegin = std::max(0, stripe.begin - std::max(halo, 0));
+    stripe.padEnd = std::min(size.height, stripe.end + std::max(halo, 0));
+    // one model per stripe, so per-instance state (RNG included) is per stripe
+    stripe.bgs = algorithms::BGS_Factory::Instance()->Acquire(wrappedName);
+    stripe.bgs->setShowOutput(false);
+    // distinct streams, otherwise all the stripes draw the same samples
+    stripe.bgs->setRandomSeed(randomSeed + i);
+  }
+  frameSize = size;
+}
+
+void StripeParallelBGS::process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img_bgmodel)
+{
+  if (img_input.empty() || !registered)
+    return;
+
+  // the models depend on the frame size, start over when it changes
+  if (firstTime || img_input.size() != frameSize)
+    createStripes(img_input.size());
+
+  if (stripes.size() == 1)
+    stripes[0].bgs->process(img_input, img_output, img_bgmodel);
+  else
+  {
+    std::vector<std::future<void>> results;
+    results.reserve(stripes.size());
+    for (size_t i = 0; i < stripes.size(); ++i) {
+      Stripe *stripe = &stripes[i];
+      results.push_back(threadPool.enqueue([stripe, &img_input]() {
+        stripe->bgs->process(img_input.rowRange(stripe->padBegin, stripe->padEnd),
+          stripe->img_foreground, stripe->img_background);
+      }));
+    }
+    // wait for all the stripes before rethrowing
+    for (auto &result : results)
+      result.wait();
+    for (auto &result : results)
+      result.get();
+
+    stitch(img_output, true);
+    stitch(img_bgmodel, false);
+  }
+
+#ifndef MEX_COMPILE_FLAG
+  if (showOutput)
+    cv::imshow(wrappedName + "_FG", img_output);
+#endif
+
+  firstTime = false;
+}
+
+void StripeParallelBGS::stitch(cv::Mat &img_output, bool foreground)
+{
+  const cv::Mat &first = foreground ? stripes[0].img_foreground : stripes[0].img_background;
+  if (first.empty())
+    return;
+
+  img_output.create(frameSize, first.type());
+  for (size_t i = 0; i < stripes.size(); ++i) {
+    const Stripe &stripe = stripes[i];
+    const cv::Mat &img_stripe = foreground ? stripe.img_foreground : stripe.img_background;
+    cv::Mat img_rows = img_output.rowRange(stripe.begin, stripe.end);
+    if (img_stripe.empty() || img_stripe.type() != first.type())
+      img_rows.setTo(cv::Scalar::all(0));
+    else
+      img_stripe.rowRange(stripe.begin - stripe.padBegin, stripe.end - stripe.padBegin).copyTo(img_rows);
+  }
+}
+
+void StripeParallelBGS::save_config(cv::FileStorage &fs) {
+  // the wrapped algorithms read their own config files
+}
+
+void StripeParallelBGS::load_config(cv::FileStorage &fs) {
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "../algorithms/IBGS.h"
+#include "../utils/ThreadPool.h"
+
+namespace bgslibrary
+{
+  namespace tools
+  {
+    // Splits the frame into horizontal stripes and runs one instance of the
+    // algorithm per stripe in parallel, then stitches the masks. Each stripe
+    // is processed with getStripeHalo() extra rows above and below, which
+    // are dropped when stitching. Algorithms that cannot be split (halo -1,
+    // e.g. the models updating their neighbours) run on a single stripe.
+    // The wrapper records its stats under "StripeParallel:<name>".
+    class StripeParallelBGS : public algorithms::IBGS
+    {
+    public:
+      // numStripes = 0 uses one stripe per thread
+      explicit StripeParallelBGS(const std::string &_algorithmName,
+        size_t numStripes = 0, size_t numThreads = 0);
+      ~StripeParallelBGS();
+
+      void process(const cv::Mat &img_input, cv::Mat &img_output, cv::Mat &img_bgmodel);
+      int getStripeHalo() const;
+      size_t getModelMemory() const;
+      size_t getNumStripes() const;
+
+    private:
+      struct Stripe
+      {
+        int begin, end;         // rows written to the output
+        int padBegin, padEnd;   // rows given to the algorithm
+        std::shared_ptr<algorithms::IBGS> bgs;
+        cv::Mat img_foreground;
+        cv::Mat img_background;
+      };
+
+      // stripes smaller than this are not worth a task
+      static const int MIN_STRIPE_ROWS = 16;
+
+      std::string wrappedName;
+      bool registered;
+      int halo;
+      size_t maxStripes;
+      cv::Size frameSize;
+      std::vector<Stripe> stripes;
+      ThreadPool threadPool;
+
+      void createStripes(const cv::Size &size);
+      void stitch(cv::Mat &img_output, bool foreground);
+      void save_config(cv::FileStorage &fs);
+      void load_config(cv::FileStorage &fs);
+    };
+  }
+}
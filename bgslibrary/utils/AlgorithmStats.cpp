@@ -0,0 +1,55 @@
+#include "AlgorithmStats.h"
+
+#ifdef BGS_COUNT_ALLOCATIONS
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+  std::atomic<long> allocations(0);
+}
+
+void* operator new(std::size_t size)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(size ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+long bgslibrary::allocationCount()
+{
+  return allocations.load(std::memory_order_relaxed);
+}
+#else
+long bgslibrary::allocationCount()
+{
+  return 0;
+}
+#endif
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace bgslibrary
+{
+  // Number of heap allocations (operator new) made so far by all the threads
+  // of the process, so the work done by thread pools is included. Only
+  // counted when the library is built with BGS_COUNT_ALLOCATIONS, otherwise
+  // always 0. The pixel buffers of cv::Mat come from cv::fastMalloc and are
+  // not counted, but OpenCV >= 3 allocates a UMatData with operator new for
+  // each of them, so every cv::Mat allocation still counts once.
+  long allocationCount();
+
+  // Latency histogram with 8 buckets per power of two of microseconds,
+  // i.e. percentiles are exact to about 9%.
+  class LatencyHistogram
+  {
+  public:
+    static const int SUB_BUCKETS = 8;
+    static const int NUM_BUCKETS = 32 * SUB_BUCKETS;
+
+    LatencyHistogram() : buckets(NUM_BUCKETS, 0), count(0), sum(0), max(0) {}
+
+    void record(double seconds, long times = 1) {
+      double us = std::max(seconds * 1e6, 1.0);
+      int index = static_cast<int>(std::log2(us) * SUB_BUCKETS);
+      buckets[std::min(index, NUM_BUCKETS - 1)] += times;
+      count += times;
+      sum += seconds * times;
+      this->max = std::max(this->max, seconds);
+    }
+    void merge(const LatencyHistogram &other) {
+      for (int i = 0; i < NUM_BUCKETS; ++i)
+        buckets[i] += other.buckets[i];
+      count += other.count;
+      sum += other.sum;
+      max = std::max(max, other.max);
+    }
+    // upper bound of the bucket holding the p-th percentile (0 < p <= 1)
+    double percentile(double p) const {
+      if (count == 0)
+        return 0;
+      long rank = static_cast<long>(std::ceil(p * count));
+      long seen = 0;
+      for (int i = 0; i < NUM_BUCKETS; ++i) {
+        seen += buckets[i];
+        if (seen >= rank)
+          return std::min(std::exp2(static_cast<double>(i + 1) / SUB_BUCKETS) * 1e-6, max);
+      }
+      return max;
+    }
+    long getCount() const { return count; }
+    double getMean() const { return count ? sum / count : 0; }
+    double getMax() const { return max; }
+
+  private:
+    std::vector<long> buckets;
+    long count;
+    double sum;
+    double max;
+  };
+
+  // Counters of one algorithm, shared by all its instances.
+  class AlgorithmStats
+  {
+  public:
+    struct Summary
+    {
+      std::string algorithm;
+      long frames = 0;
+      double meanSeconds = 0;
+      double p50Seconds = 0;
+      double p99Seconds = 0;
+      double maxSeconds = 0;
+      size_t modelBytes = 0;      // last value reported by an instance
+      size_t peakModelBytes = 0;
+      // process-wide count (see allocationCount), so it includes the
+      // allocations of whatever else ran at the same time
+      double allocationsPerFrame = 0;
+    };
+
+    explicit AlgorithmStats(const std::string &_algorithm) :
+      algorithm(_algorithm), allocations(0), modelBytes(0), peakModelBytes(0) {}
+
+    void record(double seconds, long _allocations, size_t _modelBytes, long frames = 1) {
+      std::lock_guard<std::mutex> lock(mutex);
+      latency.record(frames > 1 ? seconds / frames : seconds, frames);
+      allocations += _allocations;
+      modelBytes = _modelBytes;
+      peakModelBytes = std::max(peakModelBytes, _modelBytes);
+    }
+    Summary getSummary() {
+      std::lock_guard<std::mutex> lock(mutex);
+      Summary summary;
+      summary.algorithm = algorithm;
+      summary.frames = latency.getCount();
+      summary.meanSeconds = latency.getMean();
+      summary.p50Seconds = latency.percentile(0.5);
+      summary.p99Seconds = latency.percentile(0.99);
+      summary.maxSeconds = latency.getMax();
+      summary.modelBytes = modelBytes;
+      summary.peakModelBytes = peakModelBytes;
+      summary.allocationsPerFrame = summary.frames ? static_cast<double>(allocations) / summary.frames : 0;
+      return summary;
+    }
+    void reset() {
+      std::lock_guard<std::mutex> lock(mutex);
+      latency = LatencyHistogram();
+      allocations = 0;
+      modelBytes = peakModelBytes = 0;
+    }
+
+  private:
+    std::string algorithm;
+    std::mutex mutex;
+    LatencyHistogram latency;
+    long allocations;
+    size_t modelBytes;
+    size_t peakModelBytes;
+  };
+
+  // Process-wide table of AlgorithmStats, keyed by algorithm name.
+  class StatsRegistry
+  {
+  public:
+    static StatsRegistry* Instance() {
+      static StatsRegistry registry;
+      return &registry;
+    }
+    ~StatsRegistry() {
+      if (!exitJsonPath.empty())
+        dumpJSON(exitJsonPath);
+      if (!exitCsvPath.empty())
+        dumpCSV(exitCsvPath);
+    }
+
+    std::shared_ptr<AlgorithmStats> get(const std::string &algorithm) {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto &stats = table[algorithm];
+      if (!stats)
+        stats = std::make_shared<AlgorithmStats>(algorithm);
+      return stats;
+    }
+    std::vector<AlgorithmStats::Summary> getSummaries() {
+      std::vector<std::shared_ptr<AlgorithmStats>> all;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = table.begin(); it != table.end(); ++it)
+          all.push_back(it->second);
+      }
+      std::vector<AlgorithmStats::Summary> summaries;
+      for (auto &stats : all)
+        summaries.push_back(stats->getSummary());
+      return summaries;
+    }
+    void reset() {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (auto it = table.begin(); it != table.end(); ++it)
+        it->second->reset();
+    }
+
+    bool dumpJSON(const std::string &path) {
+      std::ofstream file(path.c_str());
+      if (!file) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return false;
+      }
+      auto summaries = getSummaries();
+      file << "[" << std::endl;
+      for (size_t i = 0; i < summaries.size(); ++i) {
+        const auto &s = summaries[i];
+        file << "  {\"algorithm\": \"" << escapeJSON(s.algorithm) << "\""
+          << ", \"frames\": " << s.frames
+          << ", \"mean_ms\": " << s.meanSeconds * 1e3
+          << ", \"p50_ms\": " << s.p50Seconds * 1e3
+          << ", \"p99_ms\": " << s.p99Seconds * 1e3
+          << ", \"max_ms\": " << s.maxSeconds * 1e3
+          << ", \"model_bytes\": " << s.modelBytes
+          << ", \"peak_model_bytes\": " << s.peakModelBytes
+          << ", \"allocations_per_frame\": " << s.allocationsPerFrame
+          << "}" << (i + 1 < summaries.size() ? "," : "") << std::endl;
+      }
+      file << "]" << std::endl;
+      return true;
+    }
+    bool dumpCSV(const std::string &path) {
+      std::ofstream file(path.c_str());
+      if (!file) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return false;
+      }
+      file << "algorithm,frames,mean_ms,p50_ms,p99_ms,max_ms,model_bytes,peak_model_bytes,allocations_per_frame" << std::endl;
+      for (const auto &s : getSummaries())
+        file << s.algorithm << "," << s.frames << "," << s.meanSeconds * 1e3 << ","
+          << s.p50Seconds * 1e3 << "," << s.p99Seconds * 1e3 << "," << s.maxSeconds * 1e3 << ","
+          << s.modelBytes << "," << s.peakModelBytes << "," << s.allocationsPerFrame << std::endl;
+      return true;
+    }
+    // Writes the stats when the process exits (empty path to skip a format).
+    void setDumpOnExit(const std::string &jsonPath, const std::string &csvPath) {
+      std::lock_guard<std::mutex> lock(mutex);
+      exitJsonPath = jsonPath;
+      exitCsvPath = csvPath;
+    }
+
+  private:
+    static std::string escapeJSON(const std::string &text) {
+      std::string escaped;
+      for (char c : text) {
+        if (c == '"' || c == '\\')
+          escaped += '\\';
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char code[8];
+          std::snprintf(code, sizeof(code), "\\u%04x", static_cast<int>(c));
+          escaped += code;
+        }
+        else
+          escaped += c;
+      }
+      return escaped;
+    }
+
+    std::mutex mutex;
+    std::map<std::string, std::shared_ptr<AlgorithmStats>> table;
+    std::string exitJsonPath;
+    std::string exitCsvPath;
+  };
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <type_traits>
+#include <utility>
+
+namespace bgslibrary
+{
+  // Heap array of trivial values whose first element is aligned on
+  // ALIGNMENT bytes (a cache line by default), for models read with
+  // aligned SIMD loads. The values are not initialized.
+  template<typename T, size_t ALIGNMENT = 64>
+  class AlignedBuffer
+  {
+    static_assert(std::is_trivially_destructible<T>::value, "AlignedBuffer only holds trivial types");
+    static_assert((ALIGNMENT & (ALIGNMENT - 1)) == 0 && ALIGNMENT >= sizeof(void*), "ALIGNMENT must be a power of two");
+
+  public:
+    AlignedBuffer() : ptr(nullptr), count(0) {}
+    explicit AlignedBuffer(size_t _count) : ptr(nullptr), count(0) {
+      allocate(_count);
+    }
+    AlignedBuffer(AlignedBuffer &&other) : ptr(other.ptr), count(other.count) {
+      other.ptr = nullptr;
+      other.count = 0;
+    }
+    AlignedBuffer& operator=(AlignedBuffer &&other) {
+      std::swap(ptr, other.ptr);
+      std::swap(count, other.count);
+      return *this;
+    }
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+    ~AlignedBuffer() {
+      release();
+    }
+
+    // Keeps the memory when the count does not change.
+    bool allocate(size_t _count) {
+      if (_count == count)
+        return true;
+      release();
+      if (_count == 0)
+        return true;
+      void *memory = nullptr;
+#if defined(_MSC_VER)
+      memory = _aligned_malloc(_count * sizeof(T), ALIGNMENT);
+#else
+      if (posix_memalign(&memory, ALIGNMENT, _count * sizeof(T)) != 0)
+        memory = nullptr;
+#endif
+      if (memory == nullptr)
+        return false;
+      ptr = static_cast<T*>(memory);
+      count = _count;
+      return true;
+    }
+    void release() {
+#if defined(_MSC_VER)
+      _aligned_free(ptr);
+#else
+      free(ptr);
+#endif
+      ptr = nullptr;
+      count = 0;
+    }
+
+    T* data() { return ptr; }
+    const T* data() const { return ptr; }
+    T& operator[](size_t i) { return ptr[i]; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+    size_t size() const { return count; }
+    size_t bytes() const { return count * sizeof(T); }
+    bool empty() const { return count == 0; }
+
+    // Rounds a count of values up so that consecutive arrays of that
+    // count (e.g. planes) all start on an aligned address.
+    static size_t padded(size_t _count) {
+      const size_t step = ALIGNMENT % sizeof(T) == 0 ? ALIGNMENT / sizeof(T) : ALIGNMENT;
+      return (_count + step - 1) / step * step;
+    }
+
+  private:
+    T *ptr;
+    size_t count;
+  };
+}
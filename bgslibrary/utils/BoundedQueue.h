@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace bgslibrary
+{
+  // Fixed capacity ring buffer shared by a producer and a consumer thread.
+  // When full, push() either blocks the producer (backpressure) or
+  // discards the oldest element (drop policy). close() wakes everybody up,
+  // after that push() fails and pop() drains what is left.
+  template<typename T>
+  class BoundedQueue
+  {
+  public:
+    explicit BoundedQueue(size_t _capacity) :
+      buffer(std::max<size_t>(1, _capacity)), head(0), count(0),
+      dropped(0), closed(false) {}
+
+    bool push(T value, bool dropOldest = false) {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (dropOldest) {
+        if (!closed && count == buffer.size()) {
+          head = (head + 1) % buffer.size();
+          count--;
+          dropped++;
+        }
+      }
+      else
+        notFull.wait(lock, [this] { return closed || count < buffer.size(); });
+      if (closed)
+        return false;
+      buffer[(head + count) % buffer.size()] = std::move(value);
+      count++;
+      notEmpty.notify_one();
+      return true;
+    }
+
+    bool pop(T &value) {
+      std::unique_lock<std::mutex> lock(mutex);
+      notEmpty.wait(lock, [this] { return closed || count > 0; });
+      if (count == 0)
+        return false;
+      value = std::move(buffer[head]);
+      head = (head + 1) % buffer.size();
+      count--;
+      notFull.notify_one();
+      return true;
+    }
+
+    void close() {
+      std::unique_lock<std::mutex> lock(mutex);
+      closed = true;
+      notEmpty.notify_all();
+      notFull.notify_all();
+    }
+
+    size_t capacity() const {
+      return buffer.size();
+    }
+    size_t droppedCount() {
+      std::unique_lock<std::mutex> lock(mutex);
+      return dropped;
+    }
+
+  private:
+    std::vector<T> buffer;
+    size_t head;
+    size_t count;
+    size_t dropped;
+    bool closed;
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+  };
+}
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <opencv2/core/core.hpp>
+
+namespace bgslibrary
+{
+  // Value of a config key, as read from the file or set by an override.
+  struct ConfigValue
+  {
+    enum Type { INT, REAL, STRING };
+    Type type = INT;
+    int intValue = 0;
+    double realValue = 0;
+    std::string stringValue;
+  };
+
+  // Immutable content of a config file with the overrides applied.
+  // Instances configured from a snapshot keep it, later reloads and
+  // overrides only produce new snapshots.
+  class ConfigSnapshot
+  {
+  public:
+    bool has(const std::string &key) const {
+      return values.find(key) != values.end();
+    }
+    int getInt(const std::string &key, int defaultValue = 0) const {
+      auto it = values.find(key);
+      if (it == values.end())
+        return defaultValue;
+      if (it->second.type == ConfigValue::REAL)
+        return static_cast<int>(it->second.realValue);
+      return it->second.type == ConfigValue::INT ? it->second.intValue : defaultValue;
+    }
+    double getDouble(const std::string &key, double defaultValue = 0) const {
+      auto it = values.find(key);
+      if (it == values.end())
+        return defaultValue;
+      if (it->second.type == ConfigValue::INT)
+        return it->second.intValue;
+      return it->second.type == ConfigValue::REAL ? it->second.realValue : defaultValue;
+    }
+    bool getBool(const std::string &key, bool defaultValue = false) const {
+      return getInt(key, defaultValue ? 1 : 0) != 0;
+    }
+    std::string getString(const std::string &key, const std::string &defaultValue = "") const {
+      auto it = values.find(key);
+      if (it == values.end() || it->second.type != ConfigValue::STRING)
+        return defaultValue;
+      return it->second.stringValue;
+    }
+    const std::map<std::string, ConfigValue>& getValues() const {
+      return values;
+    }
+    // the snapshot as a cv::FileStorage document, for load_config
+    const std::string& getDocument() const {
+      return document;
+    }
+
+  private:
+    friend class ConfigRegistry;
+    std::map<std::string, ConfigValue> values;
+    std::string document;
+  };
+
+  // Process-wide registry of the config files, keyed by config name
+  // (e.g. "ViBe"). Each file is parsed once; when it does not exist the
+  // defaults of the first instance are used (and written to disk unless
+  // the registry is read-only). Overrides and reloads never touch the
+  // instances already configured.
+  class ConfigRegistry
+  {
+  public:
+    typedef std::function<void(cv::FileStorage&)> DefaultsWriter;
+
+    static ConfigRegistry* Instance() {
+      static ConfigRegistry registry;
+      return &registry;
+    }
+
+    // Returns the snapshot of the config, parsing the file on first use.
+    // Returns nullptr if the config could not be read nor generated.
+    std::shared_ptr<const ConfigSnapshot> get(const std::string &name,
+      const std::string &path, const DefaultsWriter &writeDefaults) {
+      std::lock_guard<std::mutex> lock(mutex);
+      Entry &entry = entries[name];
+      if (!entry.snapshot) {
+        entry.path = path;
+        if (!readFile(entry) && !generateDefaults(entry, writeDefaults))
+          return nullptr;
+        rebuild(entry);
+      }
+      return entry.snapshot;
+    }
+
+    void setOverride(const std::string &name, const std::string &key, int value) {
+      ConfigValue v;
+      v.type = ConfigValue::INT;
+      v.intValue = value;
+      setOverride(name, key, v);
+    }
+    void setOverride(const std::string &name, const std::string &key, bool value) {
+      setOverride(name, key, value ? 1 : 0);
+    }
+    void setOverride(const std::string &name, const std::string &key, double value) {
+      ConfigValue v;
+      v.type = ConfigValue::REAL;
+      v.realValue = value;
+      setOverride(name, key, v);
+    }
+    void setOverride(const std::string &name, const std::string &key, const std::string &value) {
+      ConfigValue v;
+      v.type = ConfigValue::STRING;
+      v.stringValue = value;
+      setOverride(name, key, v);
+    }
+    void setOverride(const std::string &name, const std::string &key, const char *value) {
+      setOverride(name, key, std::string(value));
+    }
+    void clearOverrides(const std::string &name) {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = entries.find(name);
+      if (it == entries.end())
+        return;
+      it->second.overrides.clear();
+      if (it->second.snapshot)
+        rebuild(it->second);
+    }
+
+    // Replaces the parsed file with a cv::FileStorage document held in memory.
+    bool setDocument(const std::string &name, const std::string &document) {
+      std::lock_guard<std::mutex> lock(mutex);
+      Entry &entry = entries[name];
+      if (!parse(document, entry.base))
+        return false;
+      entry.loaded = true;
+      rebuild(entry);
+      return true;
+    }
+
+    // Reads the file again on the next get() (hot reload after editing it).
+    void reload(const std::string &name) {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = entries.find(name);
+      if (it != entries.end()) {
+        it->second.loaded = false;
+        it->second.snapshot.reset();
+      }
+    }
+    void reloadAll() {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (auto it = entries.begin(); it != entries.end(); ++it) {
+        it->second.loaded = false;
+        it->second.snapshot.reset();
+      }
+    }
+
+    // A read-only registry never writes the missing config files.
+    void setReadOnly(bool _readOnly) {
+      std::lock_guard<std::mutex> lock(mutex);
+      readOnly = _readOnly;
+    }
+
+  private:
+    struct Entry
+    {
+      std::string path;
+      bool loaded = false;
+      std::map<std::string, ConfigValue> base;
+      std::map<std::string, ConfigValue> overrides;
+      std::shared_ptr<const ConfigSnapshot> snapshot;
+    };
+
+    std::mutex mutex;
+    std::map<std::string, Entry> entries;
+    bool readOnly = false;
+
+    ConfigRegistry() {}
+
+    void setOverride(const std::string &name, const std::string &key, const ConfigValue &value) {
+      std::lock_guard<std::mutex> lock(mutex);
+      Entry &entry = entries[name];
+      entry.overrides[key] = value;
+      if (entry.snapshot)
+        rebuild(entry);
+    }
+
+    bool readFile(Entry &entry) {
+      if (entry.loaded)
+        return true;
+      std::ifstream file(entry.path.c_str());
+      if (!file)
+        return false;
+      std::stringstream buffer;
+      buffer << file.rdbuf();
+      if (!parse(buffer.str(), entry.base)) {
+        std::cerr << "Failed to parse " << entry.path << std::endl;
+        return false;
+      }
+      entry.loaded = true;
+      return true;
+    }
+
+    bool generateDefaults(Entry &entry, const DefaultsWriter &writeDefaults) {
+      if (!writeDefaults)
+        return false;
+      cv::FileStorage fs(".xml", cv::FileStorage::WRITE | cv::FileStorage::MEMORY);
+      writeDefaults(fs);
+      std::string document = fs.releaseAndGetString();
+      if (!parse(document, entry.base))
+        return false;
+      entry.loaded = true;
+      if (!readOnly) {
+        std::ofstream file(entry.path.c_str());
+        if (file)
+          file << document;
+        else
+          std::cerr << "Failed to open " << entry.path << std::endl;
+      }
+      return true;
+    }
+
+    static bool parse(const std::string &document, std::map<std::string, ConfigValue> &values) {
+      cv::FileStorage fs;
+      try {
+        if (!fs.open(document, cv::FileStorage::READ | cv::FileStorage::MEMORY))
+          return false;
+      }
+      catch (const cv::Exception &) {
+        return false;
+      }
+      values.clear();
+      cv::FileNode root = fs.root();
+      for (cv::FileNodeIterator it = root.begin(); it != root.end(); ++it) {
+        cv::FileNode node = *it;
+        ConfigValue value;
+        if (node.isInt()) {
+          value.type = ConfigValue::INT;
+          value.intValue = static_cast<int>(node);
+        }
+        else if (node.isReal()) {
+          value.type = ConfigValue::REAL;
+          value.realValue = static_cast<double>(node);
+        }
+        else if (node.isString()) {
+          value.type = ConfigValue::STRING;
+          value.stringValue = static_cast<std::string>(node);
+        }
+        else
+          continue;
+        values[node.name()] = value;
+      }
+      return true;
+    }
+
+    static void rebuild(Entry &entry) {
+      auto snapshot = std::make_shared<ConfigSnapshot>();
+      snapshot->values = entry.base;
+      for (auto it = entry.overrides.begin(); it != entry.overrides.end(); ++it)
+        snapshot->values[it->first] = it->second;
+
+      cv::FileStorage fs(".xml", cv::FileStorage::WRITE | cv::FileStorage::MEMORY);
+      for (auto it = snapshot->values.begin(); it != snapshot->values.end(); ++it) {
+        const ConfigValue &value = it->second;
+        if (value.type == ConfigValue::INT)
+          fs << it->first << value.intValue;
+        else if (value.type == ConfigValue::REAL)
+          fs << it->first << value.realValue;
+        else
+          fs << it->first << value.stringValue;
+      }
+      snapshot->document = fs.releaseAndGetString();
+      entry.snapshot = snapshot;
+    }
+  };
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace bgslibrary
+{
+  // Small PCG32 generator, used instead of rand() so that each model owns
+  // its random state: no global lock, no sharing between instances or
+  // threads, and a given seed always replays the same sequence.
+  // operator() returns a value in [0, 2^31), like rand() with a 31-bit
+  // RAND_MAX, so `rand() % n` can be written `rng() % n`.
+  class FastRNG
+  {
+  public:
+    static const uint64_t DEFAULT_SEED = 0x853c49e6748fea9bULL;
+
+    explicit FastRNG(uint64_t _seed = DEFAULT_SEED) {
+      seed(_seed);
+    }
+
+    void seed(uint64_t _seed) {
+      // splitmix64, so that close seeds (e.g. 1, 2, 3) give unrelated streams
+      uint64_t z = _seed + 0x9e3779b97f4a7c15ULL;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      state = 0;
+      next();
+      state += z ^ (z >> 31);
+      next();
+    }
+
+    uint32_t next() {
+      uint64_t old = state;
+      state = old * 6364136223846793005ULL + INCREMENT;
+      uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+      uint32_t rot = (uint32_t)(old >> 59);
+      return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    int operator()() {
+      return (int)(next() >> 1);
+    }
+
+  private:
+    static const uint64_t INCREMENT = 1442695040888963407ULL;
+    uint64_t state;
+  };
+}
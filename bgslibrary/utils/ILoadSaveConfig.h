@@ -2,9 +2,11 @@
 
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <string>
 
 #include "GenericMacros.h"
+#include "ConfigRegistry.h"
 
 namespace bgslibrary
 {
@@ -35,21 +37,38 @@ namespace bgslibrary
     virtual void load_config(cv::FileStorage &fs) = 0;
     void initLoadSaveConfig(const std::string _config_file_name) {
       if(!_config_file_name.empty()) {
+        config_name = _config_file_name;
         config_file_path = config_base_path + "/" + _config_file_name + config_extension;
-        if (!std::ifstream(config_file_path))
-          _save_config();
-        _load_config();
+        config_snapshot = ConfigRegistry::Instance()->get(config_name, config_file_path,
+          [this](cv::FileStorage &fs) { save_config(fs); });
+        if (config_snapshot)
+          _load_config(config_snapshot->getDocument());
+        else
+          _load_config();
       }
     }
-    
-  private:
-    void _save_config() {
-      //std::cout << "_save_config: " << config_file_path << std::endl;
-      cv::FileStorage fs(config_file_path, cv::FileStorage::WRITE);
-      if (_is_valid(fs))
-        save_config(fs);
-      fs.release();
+    std::shared_ptr<const ConfigSnapshot> getConfigSnapshot() const {
+      return config_snapshot;
+    }
+
+  public:
+    // Applies the current snapshot of the registry (after an override or a
+    // reload) to this instance. Must not run concurrently with process().
+    void reloadConfig() {
+      if (config_name.empty())
+        return;
+      auto snapshot = ConfigRegistry::Instance()->get(config_name, config_file_path,
+        [this](cv::FileStorage &fs) { save_config(fs); });
+      if (snapshot && snapshot != config_snapshot) {
+        config_snapshot = snapshot;
+        _load_config(config_snapshot->getDocument());
+      }
     }
+
+  private:
+    std::string config_name;
+    std::shared_ptr<const ConfigSnapshot> config_snapshot;
+
     void _load_config() {
       //std::cout << "_load_config: " << config_file_path << std::endl;
       cv::FileStorage fs;
@@ -58,6 +77,13 @@ namespace bgslibrary
         load_config(fs);
       fs.release();
     }
+    void _load_config(const std::string &content) {
+      cv::FileStorage fs;
+      fs.open(content, cv::FileStorage::READ | cv::FileStorage::MEMORY);
+      if (_is_valid(fs))
+        load_config(fs);
+      fs.release();
+    }
     bool _is_valid(cv::FileStorage &fs) {
       if (!fs.isOpened()) {
         std::cerr << "Failed to open " << config_file_path << std::endl;
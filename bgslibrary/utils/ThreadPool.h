@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace bgslibrary
+{
+  // Fixed size pool of worker threads consuming a shared FIFO of tasks.
+  // enqueue() returns a future that is ready when the task has finished
+  // (and rethrows any exception raised by the task on get()).
+  class ThreadPool
+  {
+  public:
+    explicit ThreadPool(size_t _numThreads = 0) : stop(false) {
+      if (_numThreads == 0)
+        _numThreads = defaultNumThreads();
+      workers.reserve(_numThreads);
+      for (size_t i = 0; i < _numThreads; ++i)
+        workers.emplace_back([this] { workerLoop(); });
+    }
+    ~ThreadPool() {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        stop = true;
+      }
+      condition.notify_all();
+      for (auto &worker : workers)
+        worker.join();
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    static size_t defaultNumThreads() {
+      return std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t size() const {
+      return workers.size();
+    }
+
+    std::future<void> enqueue(std::function<void()> task) {
+      auto packaged = std::make_shared<std::packaged_task<void()>>(std::move(task));
+      auto result = packaged->get_future();
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        tasks.emplace([packaged]() { (*packaged)(); });
+      }
+      condition.notify_one();
+      return result;
+    }
+
+  private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stop;
+
+    void workerLoop() {
+      for (;;) {
+        std::function<void()> task;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          condition.wait(lock, [this] { return stop || !tasks.empty(); });
+          if (stop && tasks.empty())
+            return;
+          task = std::move(tasks.front());
+          tasks.pop();
+        }
+        task();
+      }
+    }
+  };
+
+  // Splits [0, count) in pool->size() + 1 contiguous bands (fewer when count
+  // is smaller) and calls bandFunc(begin, end) for each of them: the first
+  // band on the calling thread, the others on the pool. Without a pool the
+  // whole range is one band. Returns once all the bands are done, rethrowing
+  // the first exception raised by one of them.
+  template<typename Index, typename BandFunc>
+  void parallelBands(ThreadPool *pool, Index count, const BandFunc &bandFunc) {
+    Index bands = pool ? (Index)(pool->size() + 1) : 1;
+    if (bands > count)
+      bands = count;
+    if (bands <= 1) {
+      if (count > 0)
+        bandFunc((Index)0, count);
+      return;
+    }
+    std::vector<std::future<void>> results;
+    results.reserve((size_t)bands - 1);
+    for (Index band = 1; band < bands; ++band) {
+      Index begin = (Index)((long long)count * band / bands);
+      Index end = (Index)((long long)count * (band + 1) / bands);
+      results.push_back(pool->enqueue([&bandFunc, begin, end]() { bandFunc(begin, end); }));
+    }
+    std::exception_ptr exception;
+    try {
+      bandFunc((Index)0, (Index)((long long)count / bands));
+    }
+    catch (...) {
+      exception = std::current_exception();
+    }
+    // all bands must be done before returning, even when one of them failed
+    for (auto &result : results) {
+      try {
+        result.get();
+      }
+      catch (...) {
+        if (!exception)
+          exception = std::current_exception();
+      }
+    }
+    if (exception)
+      std::rethrow_exception(exception);
+  }
+}
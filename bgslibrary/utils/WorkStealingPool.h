@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bgslibrary
+{
+  // Pool of worker threads where each worker owns a task deque.
+  // Tasks submitted from outside the pool are spread round-robin over the
+  // workers, tasks submitted from a worker go to its own deque. A worker
+  // runs its own tasks in FIFO order and, when it runs out of work, steals
+  // the oldest task of another deque, so a task resubmitted to go to the
+  // back of the line does not overtake the ones already waiting. Idle
+  // workers block until a task is submitted. The destructor runs all the
+  // tasks still queued before joining the workers.
+  class WorkStealingPool
+  {
+  public:
+    explicit WorkStealingPool(size_t _numThreads = 0) :
+      queued(0), nextQueue(0), stop(false) {
+      if (_numThreads == 0)
+        _numThreads = std::max(1u, std::thread::hardware_concurrency());
+      for (size_t i = 0; i < _numThreads; ++i)
+        queues.emplace_back(new TaskQueue);
+      workers.reserve(_numThreads);
+      for (size_t i = 0; i < _numThreads; ++i)
+        workers.emplace_back([this, i] { workerLoop(i); });
+    }
+    ~WorkStealingPool() {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        stop = true;
+      }
+      condition.notify_all();
+      for (auto &worker : workers)
+        worker.join();
+    }
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    size_t size() const {
+      return workers.size();
+    }
+
+    void submit(std::function<void()> task) {
+      size_t index;
+      if (currentPool() == this)
+        index = currentIndex();
+      else
+        index = nextQueue.fetch_add(1) % queues.size();
+      {
+        // queued and made visible under the pool mutex, so a worker seeing
+        // queued > 0 finds the task (unless another worker took it first)
+        // and a worker going to sleep cannot miss it
+        std::unique_lock<std::mutex> lock(mutex);
+        std::unique_lock<std::mutex> queueLock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+        queued++;
+      }
+      condition.notify_one();
+    }
+
+  private:
+    struct TaskQueue
+    {
+      std::mutex mutex;
+      std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued;   // tasks in the deques
+    std::atomic<size_t> nextQueue;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stop;
+
+    static const WorkStealingPool*& currentPool() {
+      static thread_local const WorkStealingPool *pool = nullptr;
+      return pool;
+    }
+    static size_t& currentIndex() {
+      static thread_local size_t index = 0;
+      return index;
+    }
+
+    bool popLocal(size_t index, std::function<void()> &task) {
+      std::unique_lock<std::mutex> lock(queues[index]->mutex);
+      if (queues[index]->tasks.empty())
+        return false;
+      task = std::move(queues[index]->tasks.front());
+      queues[index]->tasks.pop_front();
+      queued--;
+      return true;
+    }
+    bool steal(size_t index, std::function<void()> &task) {
+      for (size_t i = 1; i < queues.size(); ++i) {
+        TaskQueue &victim = *queues[(index + i) % queues.size()];
+        std::unique_lock<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty())
+          continue;
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        queued--;
+        return true;
+      }
+      return false;
+    }
+
+    void workerLoop(size_t index) {
+      currentPool() = this;
+      currentIndex() = index;
+      for (;;) {
+        std::function<void()> task;
+        if (popLocal(index, task) || steal(index, task)) {
+          task();
+          continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return stop || queued > 0; });
+        if (stop && queued == 0)
+          return;
+      }
+    }
+  };
+}
@@ -1,4 +1,5 @@
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
 #include <exception>
 
 #include <opencv2/opencv.hpp>
@@ -43,45 +44,77 @@ PYBIND11_MODULE(pybgs, m)
   m.def("show_image", &show_image, "A function that show an image", py::arg("image"));
   m.def("transpose_image", &transpose_image, "A function that transpose an image", py::arg("image"));
 
+  // Instrumentation
+  py::class_<bgslibrary::AlgorithmStats::Summary>(m, "AlgorithmStats")
+    .def_readonly("algorithm", &bgslibrary::AlgorithmStats::Summary::algorithm)
+    .def_readonly("frames", &bgslibrary::AlgorithmStats::Summary::frames)
+    .def_readonly("mean_seconds", &bgslibrary::AlgorithmStats::Summary::meanSeconds)
+    .def_readonly("p50_seconds", &bgslibrary::AlgorithmStats::Summary::p50Seconds)
+    .def_readonly("p99_seconds", &bgslibrary::AlgorithmStats::Summary::p99Seconds)
+    .def_readonly("max_seconds", &bgslibrary::AlgorithmStats::Summary::maxSeconds)
+    .def_readonly("model_bytes", &bgslibrary::AlgorithmStats::Summary::modelBytes)
+    .def_readonly("peak_model_bytes", &bgslibrary::AlgorithmStats::Summary::peakModelBytes)
+    .def_readonly("allocations_per_frame", &bgslibrary::AlgorithmStats::Summary::allocationsPerFrame)
+    ;
+  m.def("get_algorithm_stats", []() { return bgslibrary::StatsRegistry::Instance()->getSummaries(); },
+    "Latency, frames, model size and allocations of every algorithm used so far");
+  m.def("reset_algorithm_stats", []() { bgslibrary::StatsRegistry::Instance()->reset(); });
+  m.def("dump_algorithm_stats_json", [](const std::string &path) { return bgslibrary::StatsRegistry::Instance()->dumpJSON(path); }, py::arg("path"));
+  m.def("dump_algorithm_stats_csv", [](const std::string &path) { return bgslibrary::StatsRegistry::Instance()->dumpCSV(path); }, py::arg("path"));
+
   py::class_<FrameDifference>(m, "FrameDifference")
   .def(py::init<>())
   .def("apply", &FrameDifference::apply)
+  .def("applyBatch", &FrameDifference::applyBatch)
+  .def("getStats", &FrameDifference::getStats)
   .def("getBackgroundModel", &FrameDifference::getBackgroundModel)
   ;
 
   py::class_<StaticFrameDifference>(m, "StaticFrameDifference")
     .def(py::init<>())
     .def("apply", &StaticFrameDifference::apply)
+    .def("applyBatch", &StaticFrameDifference::applyBatch)
+    .def("getStats", &StaticFrameDifference::getStats)
     .def("getBackgroundModel", &StaticFrameDifference::getBackgroundModel)
     ;
 
   py::class_<WeightedMovingMean>(m, "WeightedMovingMean")
     .def(py::init<>())
     .def("apply", &WeightedMovingMean::apply)
+    .def("applyBatch", &WeightedMovingMean::applyBatch)
+    .def("getStats", &WeightedMovingMean::getStats)
     .def("getBackgroundModel", &WeightedMovingMean::getBackgroundModel)
     ;
 
   py::class_<WeightedMovingVariance>(m, "WeightedMovingVariance")
     .def(py::init<>())
     .def("apply", &WeightedMovingVariance::apply)
+    .def("applyBatch", &WeightedMovingVariance::applyBatch)
+    .def("getStats", &WeightedMovingVariance::getStats)
     .def("getBackgroundModel", &WeightedMovingVariance::getBackgroundModel)
     ;
 
   py::class_<AdaptiveBackgroundLearning>(m, "AdaptiveBackgroundLearning")
     .def(py::init<>())
     .def("apply", &AdaptiveBackgroundLearning::apply)
+    .def("applyBatch", &AdaptiveBackgroundLearning::applyBatch)
+    .def("getStats", &AdaptiveBackgroundLearning::getStats)
     .def("getBackgroundModel", &AdaptiveBackgroundLearning::getBackgroundModel)
     ;
 
   py::class_<AdaptiveSelectiveBackgroundLearning>(m, "AdaptiveSelectiveBackgroundLearning")
     .def(py::init<>())
     .def("apply", &AdaptiveSelectiveBackgroundLearning::apply)
+    .def("applyBatch", &AdaptiveSelectiveBackgroundLearning::applyBatch)
+    .def("getStats", &AdaptiveSelectiveBackgroundLearning::getStats)
     .def("getBackgroundModel", &AdaptiveSelectiveBackgroundLearning::getBackgroundModel)
     ;
 
   py::class_<MixtureOfGaussianV2>(m, "MixtureOfGaussianV2")
     .def(py::init<>())
     .def("apply", &MixtureOfGaussianV2::apply)
+    .def("applyBatch", &MixtureOfGaussianV2::applyBatch)
+    .def("getStats", &MixtureOfGaussianV2::getStats)
     .def("getBackgroundModel", &MixtureOfGaussianV2::getBackgroundModel)
     ;
 
@@ -89,6 +122,8 @@ PYBIND11_MODULE(pybgs, m)
   py::class_<MixtureOfGaussianV1>(m, "MixtureOfGaussianV1")
     .def(py::init<>())
     .def("apply", &MixtureOfGaussianV1::apply)
+    .def("applyBatch", &MixtureOfGaussianV1::applyBatch)
+    .def("getStats", &MixtureOfGaussianV1::getStats)
     .def("getBackgroundModel", &MixtureOfGaussianV1::getBackgroundModel)
     ;
 #endif
@@ -97,6 +132,8 @@ PYBIND11_MODULE(pybgs, m)
   py::class_<GMG>(m, "GMG")
     .def(py::init<>())
     .def("apply", &GMG::apply)
+    .def("applyBatch", &GMG::applyBatch)
+    .def("getStats", &GMG::getStats)
     .def("getBackgroundModel", &GMG::getBackgroundModel)
     ;
 #endif
@@ -105,6 +142,8 @@ PYBIND11_MODULE(pybgs, m)
   py::class_<KNN>(m, "KNN")
     .def(py::init<>())
     .def("apply", &KNN::apply)
+    .def("applyBatch", &KNN::applyBatch)
+    .def("getStats", &KNN::getStats)
     .def("getBackgroundModel", &KNN::getBackgroundModel)
     ;
 #endif
@@ -113,78 +152,104 @@ PYBIND11_MODULE(pybgs, m)
   py::class_<DPAdaptiveMedian>(m, "DPAdaptiveMedian")
     .def(py::init<>())
     .def("apply", &DPAdaptiveMedian::apply)
+    .def("applyBatch", &DPAdaptiveMedian::applyBatch)
+    .def("getStats", &DPAdaptiveMedian::getStats)
     .def("getBackgroundModel", &DPAdaptiveMedian::getBackgroundModel)
     ;
 
   py::class_<DPGrimsonGMM>(m, "DPGrimsonGMM")
     .def(py::init<>())
     .def("apply", &DPGrimsonGMM::apply)
+    .def("applyBatch", &DPGrimsonGMM::applyBatch)
+    .def("getStats", &DPGrimsonGMM::getStats)
     .def("getBackgroundModel", &DPGrimsonGMM::getBackgroundModel)
     ;
 
   py::class_<DPZivkovicAGMM>(m, "DPZivkovicAGMM")
     .def(py::init<>())
     .def("apply", &DPZivkovicAGMM::apply)
+    .def("applyBatch", &DPZivkovicAGMM::applyBatch)
+    .def("getStats", &DPZivkovicAGMM::getStats)
     .def("getBackgroundModel", &DPZivkovicAGMM::getBackgroundModel)
     ;
 
   py::class_<DPMean>(m, "DPMean")
     .def(py::init<>())
     .def("apply", &DPMean::apply)
+    .def("applyBatch", &DPMean::applyBatch)
+    .def("getStats", &DPMean::getStats)
     .def("getBackgroundModel", &DPMean::getBackgroundModel)
     ;
 
   py::class_<DPWrenGA>(m, "DPWrenGA")
     .def(py::init<>())
     .def("apply", &DPWrenGA::apply)
+    .def("applyBatch", &DPWrenGA::applyBatch)
+    .def("getStats", &DPWrenGA::getStats)
     .def("getBackgroundModel", &DPWrenGA::getBackgroundModel)
     ;
 
   py::class_<DPPratiMediod>(m, "DPPratiMediod")
     .def(py::init<>())
     .def("apply", &DPPratiMediod::apply)
+    .def("applyBatch", &DPPratiMediod::applyBatch)
+    .def("getStats", &DPPratiMediod::getStats)
     .def("getBackgroundModel", &DPPratiMediod::getBackgroundModel)
     ;
 
   py::class_<DPEigenbackground>(m, "DPEigenbackground")
     .def(py::init<>())
     .def("apply", &DPEigenbackground::apply)
+    .def("applyBatch", &DPEigenbackground::applyBatch)
+    .def("getStats", &DPEigenbackground::getStats)
     .def("getBackgroundModel", &DPEigenbackground::getBackgroundModel)
     ;
 
   py::class_<DPTexture>(m, "DPTexture")
     .def(py::init<>())
     .def("apply", &DPTexture::apply)
+    .def("applyBatch", &DPTexture::applyBatch)
+    .def("getStats", &DPTexture::getStats)
     .def("getBackgroundModel", &DPTexture::getBackgroundModel)
     ;
 
   py::class_<T2FGMM_UM>(m, "T2FGMM_UM")
     .def(py::init<>())
     .def("apply", &T2FGMM_UM::apply)
+    .def("applyBatch", &T2FGMM_UM::applyBatch)
+    .def("getStats", &T2FGMM_UM::getStats)
     .def("getBackgroundModel", &T2FGMM_UM::getBackgroundModel)
     ;
 
   py::class_<T2FGMM_UV>(m, "T2FGMM_UV")
     .def(py::init<>())
     .def("apply", &T2FGMM_UV::apply)
+    .def("applyBatch", &T2FGMM_UV::applyBatch)
+    .def("getStats", &T2FGMM_UV::getStats)
     .def("getBackgroundModel", &T2FGMM_UV::getBackgroundModel)
     ;
 
   py::class_<T2FMRF_UM>(m, "T2FMRF_UM")
     .def(py::init<>())
     .def("apply", &T2FMRF_UM::apply)
+    .def("applyBatch", &T2FMRF_UM::applyBatch)
+    .def("getStats", &T2FMRF_UM::getStats)
     .def("getBackgroundModel", &T2FMRF_UM::getBackgroundModel)
     ;
 
   py::class_<T2FMRF_UV>(m, "T2FMRF_UV")
     .def(py::init<>())
     .def("apply", &T2FMRF_UV::apply)
+    .def("applyBatch", &T2FMRF_UV::applyBatch)
+    .def("getStats", &T2FMRF_UV::getStats)
     .def("getBackgroundModel", &T2FMRF_UV::getBackgroundModel)
     ;
 
   py::class_<MultiCue>(m, "MultiCue")
     .def(py::init<>())
     .def("apply", &MultiCue::apply)
+    .def("applyBatch", &MultiCue::applyBatch)
+    .def("getStats", &MultiCue::getStats)
     .def("getBackgroundModel", &MultiCue::getBackgroundModel)
     ;
 #endif
@@ -192,60 +257,80 @@ PYBIND11_MODULE(pybgs, m)
   py::class_<FuzzySugenoIntegral>(m, "FuzzySugenoIntegral")
     .def(py::init<>())
     .def("apply", &FuzzySugenoIntegral::apply)
+    .def("applyBatch", &FuzzySugenoIntegral::applyBatch)
+    .def("getStats", &FuzzySugenoIntegral::getStats)
     .def("getBackgroundModel", &FuzzySugenoIntegral::getBackgroundModel)
     ;
 
   py::class_<FuzzyChoquetIntegral>(m, "FuzzyChoquetIntegral")
     .def(py::init<>())
     .def("apply", &FuzzyChoquetIntegral::apply)
+    .def("applyBatch", &FuzzyChoquetIntegral::applyBatch)
+    .def("getStats", &FuzzyChoquetIntegral::getStats)
     .def("getBackgroundModel", &FuzzyChoquetIntegral::getBackgroundModel)
     ;
 
   py::class_<LBSimpleGaussian>(m, "LBSimpleGaussian")
     .def(py::init<>())
     .def("apply", &LBSimpleGaussian::apply)
+    .def("applyBatch", &LBSimpleGaussian::applyBatch)
+    .def("getStats", &LBSimpleGaussian::getStats)
     .def("getBackgroundModel", &LBSimpleGaussian::getBackgroundModel)
     ;
 
   py::class_<LBFuzzyGaussian>(m, "LBFuzzyGaussian")
     .def(py::init<>())
     .def("apply", &LBFuzzyGaussian::apply)
+    .def("applyBatch", &LBFuzzyGaussian::applyBatch)
+    .def("getStats", &LBFuzzyGaussian::getStats)
     .def("getBackgroundModel", &LBFuzzyGaussian::getBackgroundModel)
     ;
 
   py::class_<LBMixtureOfGaussians>(m, "LBMixtureOfGaussians")
     .def(py::init<>())
     .def("apply", &LBMixtureOfGaussians::apply)
+    .def("applyBatch", &LBMixtureOfGaussians::applyBatch)
+    .def("getStats", &LBMixtureOfGaussians::getStats)
     .def("getBackgroundModel", &LBMixtureOfGaussians::getBackgroundModel)
     ;
 
   py::class_<LBAdaptiveSOM>(m, "LBAdaptiveSOM")
     .def(py::init<>())
     .def("apply", &LBAdaptiveSOM::apply)
+    .def("applyBatch", &LBAdaptiveSOM::applyBatch)
+    .def("getStats", &LBAdaptiveSOM::getStats)
     .def("getBackgroundModel", &LBAdaptiveSOM::getBackgroundModel)
     ;
 
   py::class_<LBFuzzyAdaptiveSOM>(m, "LBFuzzyAdaptiveSOM")
     .def(py::init<>())
     .def("apply", &LBFuzzyAdaptiveSOM::apply)
+    .def("applyBatch", &LBFuzzyAdaptiveSOM::applyBatch)
+    .def("getStats", &LBFuzzyAdaptiveSOM::getStats)
     .def("getBackgroundModel", &LBFuzzyAdaptiveSOM::getBackgroundModel)
     ;
 
   py::class_<VuMeter>(m, "VuMeter")
     .def(py::init<>())
     .def("apply", &VuMeter::apply)
+    .def("applyBatch", &VuMeter::applyBatch)
+    .def("getStats", &VuMeter::getStats)
     .def("getBackgroundModel", &VuMeter::getBackgroundModel)
     ;
 
   py::class_<KDE>(m, "KDE")
     .def(py::init<>())
     .def("apply", &KDE::apply)
+    .def("applyBatch", &KDE::applyBatch)
+    .def("getStats", &KDE::getStats)
     .def("getBackgroundModel", &KDE::getBackgroundModel)
     ;
 
   py::class_<IndependentMultimodal>(m, "IndependentMultimodal")
     .def(py::init<>())
     .def("apply", &IndependentMultimodal::apply)
+    .def("applyBatch", &IndependentMultimodal::applyBatch)
+    .def("getStats", &IndependentMultimodal::getStats)
     .def("getBackgroundModel", &IndependentMultimodal::getBackgroundModel)
     ;
 
@@ -253,12 +338,16 @@ PYBIND11_MODULE(pybgs, m)
   py::class_<LBP_MRF>(m, "LBP_MRF")
     .def(py::init<>())
     .def("apply", &LBP_MRF::apply)
+    .def("applyBatch", &LBP_MRF::applyBatch)
+    .def("getStats", &LBP_MRF::getStats)
     .def("getBackgroundModel", &LBP_MRF::getBackgroundModel)
     ;
 
   py::class_<MultiLayer>(m, "MultiLayer")
     .def(py::init<>())
     .def("apply", &MultiLayer::apply)
+    .def("applyBatch", &MultiLayer::applyBatch)
+    .def("getStats", &MultiLayer::getStats)
     .def("getBackgroundModel", &MultiLayer::getBackgroundModel)
     ;
 #endif
@@ -266,48 +355,64 @@ PYBIND11_MODULE(pybgs, m)
   py::class_<PixelBasedAdaptiveSegmenter>(m, "PixelBasedAdaptiveSegmenter")
     .def(py::init<>())
     .def("apply", &PixelBasedAdaptiveSegmenter::apply)
+    .def("applyBatch", &PixelBasedAdaptiveSegmenter::applyBatch)
+    .def("getStats", &PixelBasedAdaptiveSegmenter::getStats)
     .def("getBackgroundModel", &PixelBasedAdaptiveSegmenter::getBackgroundModel)
     ;
 
   py::class_<SigmaDelta>(m, "SigmaDelta")
     .def(py::init<>())
     .def("apply", &SigmaDelta::apply)
+    .def("applyBatch", &SigmaDelta::applyBatch)
+    .def("getStats", &SigmaDelta::getStats)
     .def("getBackgroundModel", &SigmaDelta::getBackgroundModel)
     ;
 
   py::class_<SuBSENSE>(m, "SuBSENSE")
     .def(py::init<>())
     .def("apply", &SuBSENSE::apply)
+    .def("applyBatch", &SuBSENSE::applyBatch)
+    .def("getStats", &SuBSENSE::getStats)
     .def("getBackgroundModel", &SuBSENSE::getBackgroundModel)
     ;
 
   py::class_<LOBSTER>(m, "LOBSTER")
     .def(py::init<>())
     .def("apply", &LOBSTER::apply)
+    .def("applyBatch", &LOBSTER::applyBatch)
+    .def("getStats", &LOBSTER::getStats)
     .def("getBackgroundModel", &LOBSTER::getBackgroundModel)
     ;
 
   py::class_<PAWCS>(m, "PAWCS")
     .def(py::init<>())
     .def("apply", &PAWCS::apply)
+    .def("applyBatch", &PAWCS::applyBatch)
+    .def("getStats", &PAWCS::getStats)
     .def("getBackgroundModel", &PAWCS::getBackgroundModel)
     ;
 
   py::class_<TwoPoints>(m, "TwoPoints")
     .def(py::init<>())
     .def("apply", &TwoPoints::apply)
+    .def("applyBatch", &TwoPoints::applyBatch)
+    .def("getStats", &TwoPoints::getStats)
     .def("getBackgroundModel", &TwoPoints::getBackgroundModel)
     ;
 
   py::class_<ViBe>(m, "ViBe")
     .def(py::init<>())
     .def("apply", &ViBe::apply)
+    .def("applyBatch", &ViBe::applyBatch)
+    .def("getStats", &ViBe::getStats)
     .def("getBackgroundModel", &ViBe::getBackgroundModel)
     ;
 
   py::class_<CodeBook>(m, "CodeBook")
     .def(py::init<>())
     .def("apply", &CodeBook::apply)
+    .def("applyBatch", &CodeBook::applyBatch)
+    .def("getStats", &CodeBook::getStats)
     .def("getBackgroundModel", &CodeBook::getBackgroundModel)
     ;
 }